@@ -0,0 +1,109 @@
+/**
+ * Tests that closed time-series buckets are compressed in the background, including buckets of
+ * namespaces which are no longer being inserted into, and that compression does not interfere with
+ * retryable writes.
+ * @tags: [
+ *   requires_replication,
+ * ]
+ */
+(function() {
+'use strict';
+
+load('jstests/core/timeseries/libs/timeseries.js');
+
+const kBucketMaxCount = 10;
+
+const rst = new ReplSetTest({
+    nodes: 1,
+    nodeOptions: {
+        setParameter: {
+            featureFlagTimeseriesBucketCompression: true,
+            timeseriesBucketMaxCount: kBucketMaxCount,
+            // Expire every idle bucket as soon as another bucket is opened.
+            timeseriesIdleBucketExpiryMemoryUsageThreshold: 1,
+        },
+    },
+});
+rst.startSet();
+rst.initiate();
+
+const primary = rst.getPrimary();
+if (!TimeseriesTest.timeseriesCollectionsEnabled(primary)) {
+    jsTestLog('Skipping test because the time-series collection feature flag is disabled');
+    rst.stopSet();
+    return;
+}
+
+const kCompressedVersion = 2;
+const session = primary.startSession({retryWrites: true});
+const testDB = session.getDatabase(jsTestName());
+
+const makeMeasurements = function(start, count) {
+    const measurements = [];
+    for (let i = start; i < start + count; ++i) {
+        measurements.push({_id: i, time: ISODate(), meta: 'a', value: i});
+    }
+    return measurements;
+};
+
+const checkMeasurements = function(coll, count) {
+    const measurements = coll.find({}, {_id: 1, value: 1}).sort({_id: 1}).toArray();
+    assert.eq(count, measurements.length, tojson(measurements));
+    measurements.forEach((measurement, i) => assert.docEq({_id: i, value: i}, measurement));
+};
+
+const getBucketVersions = function(coll) {
+    return testDB.getCollection('system.buckets.' + coll.getName())
+        .find({}, {'control.version': 1})
+        .toArray()
+        .map(bucket => bucket.control.version);
+};
+
+const collA = testDB.getCollection('a');
+const collB = testDB.getCollection('b');
+for (const coll of [collA, collB]) {
+    assert.commandWorked(testDB.createCollection(
+        coll.getName(), {timeseries: {timeField: 'time', metaField: 'meta'}}));
+}
+
+// Fill a bucket of 'a' and roll it over with retryable inserts. The closed bucket is compressed
+// outside of the user's session, so that retrying the insert returns the original result.
+let txnNumber = 0;
+const insertCmd = {
+    insert: collA.getName(),
+    documents: makeMeasurements(0, kBucketMaxCount + 1),
+    lsid: session.getSessionId(),
+    txnNumber: NumberLong(txnNumber),
+};
+assert.commandWorked(testDB.runCommand(insertCmd));
+const retryResult = assert.commandWorked(testDB.runCommand(insertCmd));
+assert.eq(kBucketMaxCount + 1, retryResult.n, tojson(retryResult));
+checkMeasurements(collA, kBucketMaxCount + 1);
+
+let versions;
+assert.soon(() => {
+    versions = getBucketVersions(collA);
+    assert.eq(2, versions.length, tojson(versions));
+    return versions.includes(kCompressedVersion);
+}, () => tojson(versions));
+
+// The open bucket of 'a' is expired by inserts into 'b' only, and still gets compressed.
+assert.commandWorked(testDB.runCommand({
+    insert: collB.getName(),
+    documents: [{time: ISODate(), meta: 'b'}],
+    lsid: session.getSessionId(),
+    txnNumber: NumberLong(++txnNumber),
+}));
+assert.soon(() => {
+    versions = getBucketVersions(collA);
+    return friendlyEqual([kCompressedVersion, kCompressedVersion], versions);
+}, () => tojson(versions));
+checkMeasurements(collA, kBucketMaxCount + 1);
+
+// Measurements can still be inserted into the namespace whose buckets are all compressed.
+assert.commandWorked(collA.insert(makeMeasurements(kBucketMaxCount + 1, 1)));
+checkMeasurements(collA, kBucketMaxCount + 2);
+
+session.endSession();
+rst.stopSet();
+})();
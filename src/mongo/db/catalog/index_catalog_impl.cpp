@@ -1386,6 +1386,16 @@ Status IndexCatalogImpl::_indexFilteredRecords(OperationContext* opCtx,
     InsertDeleteOptions options;
     prepareInsertDeleteOptions(opCtx, coll->ns(), index->descriptor(), &options);
 
+    if (!index->isHybridBuilding()) {
+        int64_t numInserted = 0;
+        Status status = index->accessMethod()->insert(
+            opCtx, coll, bsonRecords, options, keysInsertedOut ? &numInserted : nullptr);
+        if (keysInsertedOut) {
+            *keysInsertedOut += numInserted;
+        }
+        return status;
+    }
+
     for (auto bsonRecord : bsonRecords) {
         invariant(bsonRecord.id != RecordId());
 
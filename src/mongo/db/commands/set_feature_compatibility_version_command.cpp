@@ -33,6 +33,7 @@
 
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/coll_mod.h"
+#include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/drop_indexes.h"
@@ -56,6 +57,9 @@
 #include "mongo/db/s/config/sharding_catalog_manager.h"
 #include "mongo/db/s/sharding_ddl_coordinator_service.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/storage/storage_parameters_gen.h"
+#include "mongo/db/timeseries/bucket_compression.h"
+#include "mongo/db/timeseries/timeseries_field_names.h"
 #include "mongo/db/transaction_history_iterator.h"
 #include "mongo/db/vector_clock.h"
 #include "mongo/db/views/view_catalog.h"
@@ -187,6 +191,47 @@ void removeTimeseriesEntriesFromConfigTransactions(OperationContext* opCtx) {
     }
 }
 
+/**
+ * Rewrites every compressed time-series bucket back into the uncompressed format, which is the only
+ * one understood by versions without bucket compression. Buckets stop being compressed as soon as
+ * the FCV starts downgrading, so this must be called after the global lock barrier.
+ */
+void decompressTimeseriesBuckets(OperationContext* opCtx) {
+    DBDirectClient dbClient(opCtx);
+    auto collCatalog = CollectionCatalog::get(opCtx);
+    for (const auto& dbName : collCatalog->getAllDbNames()) {
+        for (const auto& nss : collCatalog->getAllCollectionNamesFromDb(opCtx, dbName)) {
+            if (!nss.isTimeseriesBucketsCollection()) {
+                continue;
+            }
+
+            auto cursor = dbClient.query(
+                nss,
+                Query(BSON("control.version" << timeseries::kTimeseriesControlCompressedVersion)));
+            while (cursor->more()) {
+                auto bucketDoc = cursor->nextSafe();
+                const auto commandResponse = dbClient.runCommand([&] {
+                    // Only replace the bucket if it has not been modified since it was read.
+                    write_ops::UpdateCommandRequest updateOp(nss);
+                    updateOp.setUpdates({write_ops::UpdateOpEntry(
+                        BSON("_id" << bucketDoc["_id"] << timeseries::kBucketControlFieldName
+                                   << bucketDoc[timeseries::kBucketControlFieldName].Obj()),
+                        write_ops::UpdateModification::parseFromClassicUpdate(
+                            timeseries::decompressBucket(bucketDoc)))});
+
+                    // The schema validation of the bucket collection is intended for end users.
+                    write_ops::WriteCommandRequestBase base;
+                    base.setBypassDocumentValidation(true);
+                    updateOp.setWriteCommandRequestBase(std::move(base));
+                    return updateOp.serialize({});
+                }());
+                uassertStatusOK(
+                    getStatusFromWriteCommandReply(commandResponse->getCommandReply()));
+            }
+        }
+    }
+}
+
 /**
  * Sets the minimum allowed feature compatibility version for the cluster. The cluster should not
  * use any new features introduced in binary versions that are newer than the feature compatibility
@@ -604,6 +649,13 @@ private:
                 "Failing upgrade due to 'failDowngrading' failpoint set",
                 !failDowngrading.shouldFail());
 
+        // Versions without time-series bucket compression cannot read compressed buckets.
+        if (feature_flags::gTimeseriesBucketCompression.isEnabledAndIgnoreFCV() &&
+            requestedVersion < feature_flags::gTimeseriesBucketCompression.getVersion()) {
+            decompressTimeseriesBuckets(opCtx);
+            LOGV2(5640103, "Decompressed all time-series buckets");
+        }
+
         if (serverGlobalParams.clusterRole == ClusterRole::ConfigServer) {
             // TODO SERVER-53283: This block can removed once 5.0 becomes last-lts.
             // TODO SERVER-53774: Replace kLatest by the version defined in the feature flag IDL
@@ -65,6 +65,8 @@
 #include "mongo/db/storage/duplicate_key_error_info.h"
 #include "mongo/db/storage/durable_catalog.h"
 #include "mongo/db/timeseries/bucket_catalog.h"
+#include "mongo/db/timeseries/bucket_compression.h"
+#include "mongo/db/timeseries/timeseries_field_names.h"
 #include "mongo/db/transaction_participant.h"
 #include "mongo/db/views/view_catalog.h"
 #include "mongo/db/write_concern.h"
@@ -121,9 +123,6 @@ bool isTimeseries(OperationContext* opCtx, const NamespaceString& ns) {
         .get();
 }
 
-// Default for control.version in time-series bucket collection.
-const int kTimeseriesControlVersion = 1;
-
 /**
  * Transforms a single time-series insert to an update request on an existing bucket.
  */
@@ -220,7 +219,8 @@ BSONObj makeTimeseriesInsertDocument(std::shared_ptr<BucketCatalog::WriteBatch>
     builder.append("_id", batch->bucket()->id());
     {
         BSONObjBuilder bucketControlBuilder(builder.subobjStart("control"));
-        bucketControlBuilder.append("version", kTimeseriesControlVersion);
+        bucketControlBuilder.append(timeseries::kBucketControlVersionFieldName,
+                                   timeseries::kTimeseriesControlDefaultVersion);
         bucketControlBuilder.append("min", batch->min());
         bucketControlBuilder.append("max", batch->max());
     }
@@ -30,9 +30,158 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/exec/bucket_unpacker.h"
+
+#include <cmath>
+#include <functional>
+#include <type_traits>
+
+#include "mongo/db/timeseries/bucket_compression.h"
 #include "mongo/db/timeseries/timeseries_field_names.h"
 
 namespace mongo {
+namespace {
+// The states of a cell for the column predicate kernels: the cell certainly fails the predicate,
+// its value must be compared against the predicate's constant, or it may pass the predicate
+// without a comparison.
+constexpr uint8_t kCellRejected = 0;
+constexpr uint8_t kCellCompare = 1;
+constexpr uint8_t kCellAccepted = 2;
+
+// The largest magnitude up to which every integer is exactly representable as a double.
+constexpr double kMaxExactDouble = static_cast<double>(1LL << 53);
+
+/**
+ * Returns the row index named by the canonical decimal 'rowKey', or -1 if it does not name a row
+ * index smaller than 'numRows'.
+ */
+int32_t parseRowKey(StringData rowKey, int32_t numRows) {
+    if (rowKey.empty() || rowKey.size() > 9 || (rowKey.size() > 1 && rowKey[0] == '0')) {
+        return -1;
+    }
+
+    int32_t row = 0;
+    for (auto c : rowKey) {
+        if (c < '0' || c > '9') {
+            return -1;
+        }
+        row = row * 10 + (c - '0');
+    }
+    return row < numRows ? row : -1;
+}
+
+/**
+ * Decodes the cells of 'column' by row index into 'values' and 'states', for a comparison against
+ * a number if 'T' is double or against a date if 'T' is long long. Returns false if the column has
+ * a row key which does not name a row index of the bucket.
+ */
+template <typename T>
+bool decodeColumn(const BSONObj& column,
+                  int32_t numRows,
+                  std::vector<T>* values,
+                  std::vector<uint8_t>* states) {
+    constexpr bool isNumeric = std::is_same_v<T, double>;
+
+    for (auto&& elem : column) {
+        auto row = parseRowKey(elem.fieldNameStringData(), numRows);
+        if (row < 0) {
+            return false;
+        }
+
+        auto& state = (*states)[row];
+        auto& value = (*values)[row];
+        switch (elem.type()) {
+            case Array:
+                // An array matches if any of its elements does.
+                state = kCellAccepted;
+                break;
+            case NumberInt:
+                if constexpr (isNumeric) {
+                    value = elem._numberInt();
+                    state = kCellCompare;
+                }
+                break;
+            case NumberLong:
+                if constexpr (isNumeric) {
+                    auto number = elem._numberLong();
+                    if (std::abs(static_cast<double>(number)) <= kMaxExactDouble) {
+                        value = number;
+                        state = kCellCompare;
+                    } else {
+                        state = kCellAccepted;
+                    }
+                }
+                break;
+            case NumberDouble:
+                if constexpr (isNumeric) {
+                    value = elem._numberDouble();
+                    state = std::isnan(value) ? kCellAccepted : kCellCompare;
+                }
+                break;
+            case NumberDecimal:
+                if constexpr (isNumeric) {
+                    state = kCellAccepted;
+                }
+                break;
+            case Date:
+                if constexpr (!isNumeric) {
+                    value = elem.date().toMillisSinceEpoch();
+                    state = kCellCompare;
+                }
+                break;
+            default:
+                // Comparisons only match values of the same canonical type as the constant.
+                break;
+        }
+    }
+    return true;
+}
+
+/**
+ * Narrows 'selected' down to the cells which are accepted, or which must be compared and for which
+ * 'cmp(value, constant)' holds. The loop is kept free of branches so that it can be vectorized.
+ */
+template <typename T, typename Cmp>
+void applyColumnComparison(const std::vector<T>& values,
+                           const std::vector<uint8_t>& states,
+                           T constant,
+                           Cmp cmp,
+                           std::vector<uint8_t>* selected) {
+    const auto n = selected->size();
+    const T* valuesData = values.data();
+    const uint8_t* statesData = states.data();
+    uint8_t* selectedData = selected->data();
+    for (size_t i = 0; i < n; ++i) {
+        selectedData[i] &= static_cast<uint8_t>(
+            (statesData[i] >> 1) |
+            ((statesData[i] & kCellCompare) & static_cast<uint8_t>(cmp(valuesData[i], constant))));
+    }
+}
+
+template <typename T>
+void applyColumnPredicate(BucketColumnPredicate::Op op,
+                          const std::vector<T>& values,
+                          const std::vector<uint8_t>& states,
+                          T constant,
+                          std::vector<uint8_t>* selected) {
+    switch (op) {
+        case BucketColumnPredicate::Op::kEq:
+            applyColumnComparison(values, states, constant, std::equal_to<T>{}, selected);
+            break;
+        case BucketColumnPredicate::Op::kLt:
+            applyColumnComparison(values, states, constant, std::less<T>{}, selected);
+            break;
+        case BucketColumnPredicate::Op::kLte:
+            applyColumnComparison(values, states, constant, std::less_equal<T>{}, selected);
+            break;
+        case BucketColumnPredicate::Op::kGt:
+            applyColumnComparison(values, states, constant, std::greater<T>{}, selected);
+            break;
+        case BucketColumnPredicate::Op::kGte:
+            applyColumnComparison(values, states, constant, std::greater_equal<T>{}, selected);
+            break;
+    }
+}
+}  // namespace
 
 /**
  * Erase computed meta projection fields if they are present in the exclusion field set.
@@ -88,10 +237,18 @@ int BucketUnpacker::computeMeasurementCount(int targetTimestampObjSize) {
 void BucketUnpacker::reset(BSONObj&& bucket) {
     _fieldIters.clear();
     _timeFieldIter = boost::none;
+    _selectedRows.clear();
+    _numberOfMeasurements = 0;
 
     _bucket = std::move(bucket);
     uassert(5346510, "An empty bucket cannot be unpacked", !_bucket.isEmpty());
 
+    // Closed buckets may have had their data region compressed into columns, which are expanded
+    // back to the row-keyed layout the rest of the unpacker works with.
+    if (timeseries::isCompressedBucket(_bucket)) {
+        _bucket = timeseries::decompressBucket(_bucket);
+    }
+
     auto&& dataRegion = _bucket.getField(timeseries::kBucketDataFieldName).Obj();
     if (dataRegion.isEmpty()) {
         // If the data field of a bucket is present but it holds an empty object, there's nothing to
@@ -150,6 +307,83 @@ void BucketUnpacker::reset(BSONObj&& bucket) {
 
     // Save the measurement count for the bucket.
     _numberOfMeasurements = computeMeasurementCount(timeFieldElem.objsize());
+
+    if (!_columnPredicates.empty()) {
+        _evaluateColumnPredicates(dataRegion, timeFieldElem.Obj().nFields());
+        _skipRejectedMeasurements();
+    }
+}
+
+void BucketUnpacker::_evaluateColumnPredicates(const BSONObj& dataRegion, int32_t numRows) {
+    _selectedRows.assign(numRows, 1);
+
+    std::vector<uint8_t> states;
+    std::vector<double> numbers;
+    std::vector<long long> dates;
+    for (auto&& predicate : _columnPredicates) {
+        // A missing column rejects every measurement, since a missing field never compares equal
+        // to, or orders against, a number or a date.
+        states.assign(numRows, kCellRejected);
+        auto column = dataRegion[predicate.field];
+        if (column && column.type() != Object) {
+            _selectedRows.clear();
+            return;
+        }
+
+        if (predicate.constant.getType() == Date) {
+            dates.assign(numRows, 0);
+            if (column && !decodeColumn(column.Obj(), numRows, &dates, &states)) {
+                _selectedRows.clear();
+                return;
+            }
+            applyColumnPredicate(predicate.op,
+                                 dates,
+                                 states,
+                                 predicate.constant.getDate().toMillisSinceEpoch(),
+                                 &_selectedRows);
+        } else {
+            numbers.assign(numRows, 0);
+            if (column && !decodeColumn(column.Obj(), numRows, &numbers, &states)) {
+                _selectedRows.clear();
+                return;
+            }
+            applyColumnPredicate(
+                predicate.op, numbers, states, predicate.constant.coerceToDouble(), &_selectedRows);
+        }
+    }
+
+    if (std::all_of(_selectedRows.begin(), _selectedRows.end(), [](auto row) { return row; })) {
+        _selectedRows.clear();
+    }
+}
+
+void BucketUnpacker::_skipRejectedMeasurements() {
+    if (_selectedRows.empty()) {
+        return;
+    }
+
+    while (_timeFieldIter->more()) {
+        auto timeElem = **_timeFieldIter;
+        auto rowKey = timeElem.fieldNameStringData();
+        auto row = parseRowKey(rowKey, static_cast<int32_t>(_selectedRows.size()));
+        if (row < 0 || _selectedRows[row]) {
+            return;
+        }
+
+        _timeFieldIter->advance(timeElem);
+        _advanceFieldIters(rowKey, nullptr);
+    }
+}
+
+void BucketUnpacker::_advanceFieldIters(StringData rowKey, MutableDocument* measurement) {
+    for (auto&& [colName, colIter] : _fieldIters) {
+        if (auto&& elem = *colIter; colIter.more() && elem.fieldNameStringData() == rowKey) {
+            if (measurement) {
+                measurement->addField(colName, Value{elem});
+            }
+            colIter.advance(elem);
+        }
+    }
 }
 
 void BucketUnpacker::setBucketSpecAndBehavior(BucketSpec&& bucketSpec, Behavior behavior) {
@@ -193,19 +427,16 @@ Document BucketUnpacker::getNext() {
         measurement.addField(*_spec.metaField, Value{_metaValue});
     }
 
-    auto& currentIdx = timeElem.fieldNameStringData();
-    for (auto&& [colName, colIter] : _fieldIters) {
-        if (auto&& elem = *colIter; colIter.more() && elem.fieldNameStringData() == currentIdx) {
-            measurement.addField(colName, Value{elem});
-            colIter.advance(elem);
-        }
-    }
+    _advanceFieldIters(timeElem.fieldNameStringData(), &measurement);
 
     // Add computed meta projections.
     for (auto&& name : _spec.computedMetaProjFields) {
         measurement.addField(name, Value{_computedMetaProjections[name]});
     }
 
+    // Position the iterators at the next measurement which may match the column predicates.
+    _skipRejectedMeasurements();
+
     return measurement.freeze();
 }
 
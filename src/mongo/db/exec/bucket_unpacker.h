@@ -56,6 +56,24 @@ struct BucketSpec {
     std::vector<std::string> computedMetaProjFields;
 };
 
+/**
+ * A comparison of a measurement field against a numeric or date constant, which the BucketUnpacker
+ * evaluates over a whole column of a bucket at a time in order to skip the measurements that cannot
+ * match without materializing them. The evaluation is conservative: a measurement is only skipped
+ * if the equivalent $match predicate would certainly reject it.
+ */
+struct BucketColumnPredicate {
+    enum class Op { kEq, kLt, kLte, kGt, kGte };
+
+    // A top-level measurement field, which must not be the metaField.
+    std::string field;
+
+    Op op;
+
+    // Either a number which can be represented exactly as a double, or a date.
+    Value constant;
+};
+
 /**
  * BucketUnpacker will unpack bucket fields for metadata and the provided fields.
  */
@@ -144,7 +162,37 @@ public:
     // Add computed meta projection names to the bucket specification.
     void addComputedMetaProjFields(const std::vector<StringData>& computedFieldNames);
 
+    /**
+     * Sets the predicates that 'getNext()' uses to skip measurements of subsequently reset
+     * buckets. All predicates must hold for a measurement to be unpacked.
+     */
+    void setColumnPredicates(std::vector<BucketColumnPredicate> predicates) {
+        _columnPredicates = std::move(predicates);
+    }
+
+    const std::vector<BucketColumnPredicate>& columnPredicates() const {
+        return _columnPredicates;
+    }
+
 private:
+    /**
+     * Evaluates '_columnPredicates' over the columns of 'dataRegion', which holds 'numRows'
+     * measurements, recording which measurements may match in '_selectedRows'. Leaves
+     * '_selectedRows' empty if every measurement may match.
+     */
+    void _evaluateColumnPredicates(const BSONObj& dataRegion, int32_t numRows);
+
+    /**
+     * Advances the iterators past the measurements that were rejected by '_columnPredicates'.
+     */
+    void _skipRejectedMeasurements();
+
+    /**
+     * Advances the column iterators positioned at the measurement with row key 'rowKey', appending
+     * the values to 'measurement' if it is not null.
+     */
+    void _advanceFieldIters(StringData rowKey, MutableDocument* measurement);
+
     BucketSpec _spec;
     Behavior _unpackerBehavior;
 
@@ -175,6 +223,13 @@ private:
 
     // The number of measurements in the bucket.
     int32_t _numberOfMeasurements = 0;
+
+    // Predicates used to skip measurements before they are materialized.
+    std::vector<BucketColumnPredicate> _columnPredicates;
+
+    // For each row index of the current bucket, whether the measurement may match
+    // '_columnPredicates'. Empty if no measurement is to be skipped.
+    std::vector<uint8_t> _selectedRows;
 };
 
 /**
@@ -32,6 +32,7 @@
 #include "mongo/bson/json.h"
 #include "mongo/db/exec/bucket_unpacker.h"
 #include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/timeseries/bucket_compression.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -386,6 +387,96 @@ TEST_F(BucketUnpackerTest, UnpackerResetThrowsOnEmptyBucket) {
                              5346510);
 }
 
+TEST_F(BucketUnpackerTest, UnpackCompressedBucket) {
+    std::set<std::string> fields{};
+
+    auto bucket = fromjson(
+        "{control: {version: 1}, meta: {'m1': 999, 'm2': 9999}, data: {_id: {'0':1, '1':2, "
+        "'2':3, '3':4, '4':5, '5':6}, time: {'0':1, '1':2, '2':3, '3':4, '4':5, '5':6}, "
+        "a:{'0':1, '1':1, '2':1, '3':1, '4':1, '5':1}, b:{'2':1, '5':'x'}}}");
+    auto compressed = timeseries::compressBucket(bucket);
+    ASSERT(compressed);
+    ASSERT(timeseries::isCompressedBucket(*compressed));
+
+    auto unpacker = makeBucketUnpacker(std::move(fields),
+                                       BucketUnpacker::Behavior::kExclude,
+                                       std::move(*compressed),
+                                       kUserDefinedMetaName.toString());
+    ASSERT_EQ(unpacker.numberOfMeasurements(), 6);
+
+    for (auto i = 1; i <= 6; ++i) {
+        ASSERT_TRUE(unpacker.hasNext());
+        MutableDocument expected{Document{
+            {"time", i}, {"myMeta", Document{{"m1", 999}, {"m2", 9999}}}, {"_id", i}, {"a", 1}}};
+        if (i == 3) {
+            expected.addField("b", Value{1});
+        } else if (i == 6) {
+            expected.addField("b", Value{"x"_sd});
+        }
+        assertGetNext(unpacker, expected.freeze());
+    }
+    ASSERT_FALSE(unpacker.hasNext());
+}
+
+TEST_F(BucketUnpackerTest, ColumnPredicatesSkipRejectedMeasurements) {
+    std::set<std::string> fields{};
+
+    auto bucket = fromjson(
+        "{meta: {'m1': 999, 'm2': 9999}, data: {_id: {'0':1, '1':2, '2':3, '3':4, '4':5}, "
+        "time: {'0':1, '1':2, '2':3, '3':4, '4':5}, "
+        "a:{'0':1, '1':10, '2':{$numberLong: '20'}, '3':'abc', '4':[1, 30]}, b:{'1':1, '2':2}}}");
+
+    auto spec = BucketSpec{
+        kUserDefinedTimeName.toString(), kUserDefinedMetaName.toString(), std::move(fields)};
+    BucketUnpacker unpacker{std::move(spec), BucketUnpacker::Behavior::kExclude};
+    unpacker.setColumnPredicates({{"a", BucketColumnPredicate::Op::kGte, Value{10}}});
+    unpacker.reset(std::move(bucket));
+
+    // The string is rejected, while the array is left for the $match to evaluate.
+    ASSERT_TRUE(unpacker.hasNext());
+    assertGetNext(
+        unpacker,
+        Document{fromjson("{time: 2, myMeta: {m1: 999, m2: 9999}, _id: 2, a: 10, b: 1}")});
+    ASSERT_TRUE(unpacker.hasNext());
+    assertGetNext(
+        unpacker,
+        Document{fromjson(
+            "{time: 3, myMeta: {m1: 999, m2: 9999}, _id: 3, a: {$numberLong: '20'}, b: 2}")});
+    ASSERT_TRUE(unpacker.hasNext());
+    assertGetNext(unpacker,
+                  Document{fromjson("{time: 5, myMeta: {m1: 999, m2: 9999}, _id: 5, a: [1, 30]}")});
+    ASSERT_FALSE(unpacker.hasNext());
+}
+
+TEST_F(BucketUnpackerTest, ColumnPredicatesOnSparseAndDateColumns) {
+    std::set<std::string> fields{};
+
+    auto bucket = BSON("data" << BSON(
+                           "time" << BSON("0" << Date_t::fromMillisSinceEpoch(1000) << "1"
+                                              << Date_t::fromMillisSinceEpoch(2000) << "2"
+                                              << Date_t::fromMillisSinceEpoch(3000))
+                                  << "a" << BSON("0" << 1.5 << "2" << 2.5)));
+
+    auto spec = BucketSpec{kUserDefinedTimeName.toString(), boost::none, std::move(fields)};
+    BucketUnpacker unpacker{std::move(spec), BucketUnpacker::Behavior::kExclude};
+    unpacker.setColumnPredicates(
+        {{"time", BucketColumnPredicate::Op::kGt, Value{Date_t::fromMillisSinceEpoch(1000)}},
+         {"a", BucketColumnPredicate::Op::kLt, Value{3}}});
+    unpacker.reset(bucket.getOwned());
+
+    // The second measurement is missing 'a', so only the third one can match.
+    ASSERT_TRUE(unpacker.hasNext());
+    assertGetNext(unpacker,
+                  Document{{"time", Date_t::fromMillisSinceEpoch(3000)}, {"a", 2.5}});
+    ASSERT_FALSE(unpacker.hasNext());
+
+    // A bucket in which every measurement is rejected has nothing to unpack.
+    unpacker.setColumnPredicates({{"b", BucketColumnPredicate::Op::kEq, Value{1}}});
+    unpacker.reset(bucket.getOwned());
+    ASSERT_FALSE(unpacker.hasNext());
+    ASSERT_EQ(unpacker.numberOfMeasurements(), 3);
+}
+
 TEST_F(BucketUnpackerTest, EraseMetaFromFieldSetAndDetermineIncludeMeta) {
     // Tests a missing 'metaField' in the spec.
     std::set<std::string> empFields{};
@@ -375,6 +375,8 @@ static stdx::unordered_map<std::string, BuiltinFn> kBuiltinFunctions = {
     {"newObj", BuiltinFn{[](size_t n) { return n % 2 == 0; }, vm::Builtin::newObj, false}},
     {"ksToString", BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::ksToString, false}},
     {"ks", BuiltinFn{[](size_t n) { return n > 2; }, vm::Builtin::newKs, false}},
+    {"ksFromValue",
+     BuiltinFn{[](size_t n) { return n == 4; }, vm::Builtin::newKsFromValue, false}},
     {"abs", BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::abs, false}},
     {"ceil", BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::ceil, false}},
     {"floor", BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::floor, false}},
@@ -388,6 +390,14 @@ static stdx::unordered_map<std::string, BuiltinFn> kBuiltinFunctions = {
     {"collAddToSet", BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::collAddToSet, true}},
     {"doubleDoubleSum",
      BuiltinFn{[](size_t n) { return n > 0; }, vm::Builtin::doubleDoubleSum, false}},
+    {"aggDoubleDoubleSum",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::aggDoubleDoubleSum, true}},
+    {"aggMergeDoubleDoubleSums",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::aggMergeDoubleDoubleSums, true}},
+    {"doubleDoubleSumFinalize",
+     BuiltinFn{[](size_t n) { return n == 1; }, vm::Builtin::doubleDoubleSumFinalize, false}},
+    {"doubleDoubleAvgFinalize",
+     BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::doubleDoubleAvgFinalize, false}},
     {"bitTestZero", BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::bitTestZero, false}},
     {"bitTestMask", BuiltinFn{[](size_t n) { return n == 2; }, vm::Builtin::bitTestMask, false}},
     {"bitTestPosition",
@@ -1131,6 +1131,8 @@ void Parser::walkGroup(AstQuery& ast) {
         lookupSlots(std::move(ast.nodes[1]->projects)),
         collatorSlotPos ? lookupSlot(std::move(ast.nodes[collatorSlotPos]->identifier))
                         : boost::none,
+        false,
+        HashAggStage::MergingExprMap{},
         getCurrentPlanNodeId());
 }
 
@@ -1154,6 +1156,7 @@ void Parser::walkHashJoin(AstQuery& ast) {
                              lookupSlots(innerNode->nodes[0]->identifiers),  // inner conditions
                              lookupSlots(innerNode->nodes[1]->identifiers),  // inner projections
                              collatorSlot,                                   // collator
+                             false,                                          // allowDiskUse
                              getCurrentPlanNodeId());
 }
 
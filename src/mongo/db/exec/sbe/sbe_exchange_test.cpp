@@ -0,0 +1,161 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+/**
+ * This file contains tests for sbe::ExchangeConsumer and sbe::ExchangeProducer.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/exchange.h"
+#include "mongo/db/exec/sbe/stages/hash_agg.h"
+#include "mongo/db/query/query_knobs_gen.h"
+
+namespace mongo::sbe {
+
+using ExchangeStageTest = PlanStageTestFixture;
+
+TEST_F(ExchangeStageTest, PartitionedHashAgg) {
+    const size_t degreeOfParallelism = 3;
+
+    // Every producer of the partitioning exchange runs its own clone of the virtual scan, so each
+    // key is counted once per producer. Equal numbers of different types belong to the same group
+    // and must therefore be sent to the same consumer.
+    auto [scanSlot, scanStage] = generateVirtualScan(BSON_ARRAY(1 << 2 << "a" << 1.0 << 2LL << "b"
+                                                                  << "a" << 3));
+
+    auto partitionStage = makeS<ExchangeConsumer>(
+        std::move(scanStage),
+        degreeOfParallelism,
+        makeSV(scanSlot),
+        ExchangePolicy::partition,
+        stage_builder::makeFunction("shardHash", makeE<EVariable>(scanSlot)),
+        nullptr,
+        kEmptyPlanNodeId);
+
+    auto countSlot = generateSlotId();
+    auto hashAggStage = makeS<HashAggStage>(
+        std::move(partitionStage),
+        makeSV(scanSlot),
+        makeEM(countSlot,
+               stage_builder::makeFunction(
+                   "sum",
+                   makeE<EConstant>(value::TypeTags::NumberInt64, value::bitcastFrom<int64_t>(1)))),
+        boost::none,
+        false,
+        HashAggStage::MergingExprMap{},
+        kEmptyPlanNodeId);
+
+    auto gatherStage = makeS<ExchangeConsumer>(std::move(hashAggStage),
+                                               degreeOfParallelism,
+                                               makeSV(scanSlot, countSlot),
+                                               ExchangePolicy::roundrobin,
+                                               nullptr,
+                                               nullptr,
+                                               kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    auto resultAccessors = prepareTree(ctx.get(), gatherStage.get(), makeSV(scanSlot, countSlot));
+    auto [resultsTag, resultsVal] = getAllResultsMulti(gatherStage.get(), resultAccessors);
+    value::ValueGuard resultsGuard{resultsTag, resultsVal};
+    gatherStage->close();
+
+    // The groups are gathered in no particular order, but each of them must have been aggregated
+    // by a single consumer.
+    auto [expectedTag, expectedVal] =
+        stage_builder::makeValue(BSON_ARRAY(BSON_ARRAY(1 << 6) << BSON_ARRAY(2 << 6)
+                                                               << BSON_ARRAY("a" << 6)
+                                                               << BSON_ARRAY("b" << 3)
+                                                               << BSON_ARRAY(3 << 3)));
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    auto resultsView = value::getArrayView(resultsVal);
+    ASSERT_EQ(resultsView->size(), 5U);
+    for (value::ArrayEnumerator expected{expectedTag, expectedVal}; !expected.atEnd();
+         expected.advance()) {
+        auto [expectedRowTag, expectedRowVal] = expected.getViewOfValue();
+        bool found = false;
+        for (size_t idx = 0; idx < resultsView->size() && !found; ++idx) {
+            auto [rowTag, rowVal] = resultsView->getAt(idx);
+            found = valueEquals(rowTag, rowVal, expectedRowTag, expectedRowVal);
+        }
+        ASSERT_TRUE(found);
+    }
+}
+
+TEST_F(ExchangeStageTest, ProducersAreInterruptedWithTheParentOperation) {
+    const size_t degreeOfParallelism = 2;
+
+    // Enough rows for the producers to check for interrupt while they run.
+    BSONArrayBuilder rows;
+    for (int i = 0; i < 10 * internalQueryExecYieldIterations.load(); ++i) {
+        rows.append(i);
+    }
+    auto [scanSlot, scanStage] = generateVirtualScan(rows.arr());
+
+    auto gatherStage = makeS<ExchangeConsumer>(std::move(scanStage),
+                                               degreeOfParallelism,
+                                               makeSV(scanSlot),
+                                               ExchangePolicy::roundrobin,
+                                               nullptr,
+                                               nullptr,
+                                               kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    auto resultAccessors = prepareTree(ctx.get(), gatherStage.get(), makeSV(scanSlot));
+    {
+        stdx::lock_guard<Client> lk(*opCtx()->getClient());
+        opCtx()->markKilled(ErrorCodes::Interrupted);
+    }
+
+    // The consumer sees the producers stop early, and their error is raised once it is closed.
+    ASSERT_THROWS_CODE(
+        [&] {
+            getAllResultsMulti(gatherStage.get(), resultAccessors);
+            gatherStage->close();
+        }(),
+        DBException,
+        ErrorCodes::Interrupted);
+}
+
+TEST_F(ExchangeStageTest, ThreadReservationsDoNotExceedThePool) {
+    auto reservation = ExchangeThreadReservation::tryReserve(100);
+    ASSERT(reservation);
+    ASSERT_FALSE(ExchangeThreadReservation::tryReserve(29));
+
+    auto otherReservation = ExchangeThreadReservation::tryReserve(28);
+    ASSERT(otherReservation);
+
+    // Threads are given back once the plan holding them is destroyed.
+    reservation.reset();
+    ASSERT(ExchangeThreadReservation::tryReserve(100));
+}
+}  // namespace mongo::sbe
@@ -37,6 +37,10 @@
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo::sbe {
 
@@ -82,6 +86,8 @@ TEST_F(HashAggStageTest, HashAggMinMaxTest) {
                    stage_builder::makeFunction(
                        "collMax", collExpr->clone(), makeE<EVariable>(scanSlot))),
             boost::none,
+            false,
+            HashAggStage::MergingExprMap{},
             kEmptyPlanNodeId);
 
         auto outSlot = generateSlotId();
@@ -136,6 +142,8 @@ TEST_F(HashAggStageTest, HashAggAddToSetTest) {
                    stage_builder::makeFunction(
                        "collAddToSet", std::move(collExpr), makeE<EVariable>(scanSlot))),
             boost::none,
+            false,
+            HashAggStage::MergingExprMap{},
             kEmptyPlanNodeId);
 
         return std::make_pair(hashAggSlot, std::move(hashAggStage));
@@ -220,6 +228,8 @@ TEST_F(HashAggStageTest, HashAggCollationTest) {
                                                makeE<EConstant>(value::TypeTags::NumberInt64,
                                                                 value::bitcastFrom<int64_t>(1)))),
                                     boost::optional<value::SlotId>{useCollator, collatorSlot},
+                                    false,
+                                    HashAggStage::MergingExprMap{},
                                     kEmptyPlanNodeId);
 
             return std::make_pair(countsSlot, std::move(hashAggStage));
@@ -280,4 +290,98 @@ TEST_F(HashAggStageTest, HashAggCollationTest) {
     }
 }
 
+TEST_F(HashAggStageTest, HashAggSpillTest) {
+    unittest::TempDir tempDir("HashAggStageTest");
+    const auto oldDbPath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = oldDbPath; });
+
+    // Force a spill after every new group, so that the partial counts of each group end up spread
+    // across several sorted runs which must be merged back together.
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill", 1);
+
+    BSONArrayBuilder bab1;
+    bab1.append("c").append("a").append("b").append("a").append("c").append("a");
+    auto [inputTag, inputVal] = stage_builder::makeValue(bab1.arr());
+    value::ValueGuard inputGuard{inputTag, inputVal};
+
+    // Spilled groups are returned in the order of their keys.
+    BSONArrayBuilder bab2;
+    bab2.append(BSON_ARRAY("a" << 3)).append(BSON_ARRAY("b" << 1)).append(BSON_ARRAY("c" << 2));
+    auto [expectedTag, expectedVal] = stage_builder::makeValue(bab2.arr());
+    value::ValueGuard expectedGuard{expectedTag, expectedVal};
+
+    inputGuard.reset();
+    auto [scanSlot, scanStage] = generateVirtualScan(inputTag, inputVal);
+
+    auto countSlot = generateSlotId();
+    auto spilledCountSlot = generateSlotId();
+    HashAggStage::MergingExprMap mergingExprs;
+    mergingExprs.emplace(
+        countSlot,
+        std::make_pair(spilledCountSlot,
+                       stage_builder::makeFunction("sum", makeE<EVariable>(spilledCountSlot))));
+
+    auto hashAggStage = makeS<HashAggStage>(
+        std::move(scanStage),
+        makeSV(scanSlot),
+        makeEM(countSlot,
+               stage_builder::makeFunction("sum",
+                                           makeE<EConstant>(value::TypeTags::NumberInt64,
+                                                            value::bitcastFrom<int64_t>(1)))),
+        boost::none,
+        true,
+        std::move(mergingExprs),
+        kEmptyPlanNodeId);
+    auto stats = static_cast<const HashAggStats*>(hashAggStage->getSpecificStats());
+
+    auto outSlot = generateSlotId();
+    auto stage = makeProjectStage(
+        std::move(hashAggStage),
+        kEmptyPlanNodeId,
+        outSlot,
+        stage_builder::makeFunction(
+            "newArray", makeE<EVariable>(scanSlot), makeE<EVariable>(countSlot)));
+
+    auto ctx = makeCompileCtx();
+    auto resultAccessor = prepareTree(ctx.get(), stage.get(), outSlot);
+    auto [resultsTag, resultsVal] = getAllResults(stage.get(), resultAccessor);
+    value::ValueGuard resultGuard{resultsTag, resultsVal};
+    assertValuesEqual(resultsTag, resultsVal, expectedTag, expectedVal);
+
+    ASSERT_TRUE(stats->usedDisk);
+    ASSERT_EQ(stats->spills, 6U);
+    ASSERT_EQ(stats->spilledRecords, 6U);
+}
+
+TEST_F(HashAggStageTest, HashAggExceedsMemoryLimitWithoutDiskUse) {
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill", 1);
+
+    BSONArrayBuilder bab;
+    bab.append("a").append("b");
+    auto [inputTag, inputVal] = stage_builder::makeValue(bab.arr());
+
+    auto [scanSlot, scanStage] = generateVirtualScan(inputTag, inputVal);
+    auto countSlot = generateSlotId();
+    auto stage = makeS<HashAggStage>(
+        std::move(scanStage),
+        makeSV(scanSlot),
+        makeEM(countSlot,
+               stage_builder::makeFunction("sum",
+                                           makeE<EConstant>(value::TypeTags::NumberInt64,
+                                                            value::bitcastFrom<int64_t>(1)))),
+        boost::none,
+        false,
+        HashAggStage::MergingExprMap{},
+        kEmptyPlanNodeId);
+
+    auto ctx = makeCompileCtx();
+    auto resultAccessor = prepareTree(ctx.get(), stage.get(), countSlot);
+    ASSERT_THROWS_CODE(getAllResults(stage.get(), resultAccessor),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
 }  // namespace mongo::sbe
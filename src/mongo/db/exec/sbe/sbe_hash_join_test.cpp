@@ -37,6 +37,10 @@
 #include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo::sbe {
 
@@ -79,6 +83,7 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
                                      makeSV(innerCondSlot),
                                      makeSV(),
                                      boost::optional<value::SlotId>{useCollator, collatorSlot},
+                                     false /* allowDiskUse */,
                                      kEmptyPlanNodeId);
 
             return std::make_pair(makeSV(innerCondSlot, outerCondSlot), std::move(hashJoinStage));
@@ -136,4 +141,93 @@ TEST_F(HashJoinStageTest, HashJoinCollationTest) {
     }
 }
 
+TEST_F(HashJoinStageTest, HashJoinSpillTest) {
+    unittest::TempDir tempDir("HashJoinStageTest");
+    const auto oldDbPath = storageGlobalParams.dbpath;
+    storageGlobalParams.dbpath = tempDir.path();
+    ON_BLOCK_EXIT([&] { storageGlobalParams.dbpath = oldDbPath; });
+
+    // Spill a partition after every row inserted into the hash table, so that the whole outer side
+    // ends up on disk and every spilled partition has to be loaded one row at a time.
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill", 1);
+
+    auto [outerTag, outerVal] = stage_builder::makeValue(BSON_ARRAY("a"
+                                                                    << "b"
+                                                                    << "c"
+                                                                    << "a"));
+    auto [innerTag, innerVal] = stage_builder::makeValue(BSON_ARRAY("a"
+                                                                    << "b"
+                                                                    << "b"
+                                                                    << "c"
+                                                                    << "d"));
+    auto [outerCondSlot, outerStage] = generateVirtualScan(outerTag, outerVal);
+    auto [innerCondSlot, innerStage] = generateVirtualScan(innerTag, innerVal);
+
+    auto hashJoinStage = makeS<HashJoinStage>(std::move(outerStage),
+                                              std::move(innerStage),
+                                              makeSV(outerCondSlot),
+                                              makeSV(),
+                                              makeSV(innerCondSlot),
+                                              makeSV(),
+                                              boost::none,
+                                              true /* allowDiskUse */,
+                                              kEmptyPlanNodeId);
+    auto stats = static_cast<const HashJoinStats*>(hashJoinStage->getSpecificStats());
+
+    auto ctx = makeCompileCtx();
+    auto resultAccessors =
+        prepareTree(ctx.get(), hashJoinStage.get(), makeSV(outerCondSlot, innerCondSlot));
+
+    // The spilled partitions are joined in hash order, so sort the results before comparing them.
+    std::vector<std::pair<std::string, std::string>> results;
+    for (auto st = hashJoinStage->getNext(); st == PlanState::ADVANCED;
+         st = hashJoinStage->getNext()) {
+        auto [outerResTag, outerResVal] = resultAccessors[0]->getViewOfValue();
+        auto [innerResTag, innerResVal] = resultAccessors[1]->getViewOfValue();
+        ASSERT_TRUE(value::isString(outerResTag));
+        ASSERT_TRUE(value::isString(innerResTag));
+        results.emplace_back(value::getStringView(outerResTag, outerResVal).toString(),
+                             value::getStringView(innerResTag, innerResVal).toString());
+    }
+    std::sort(results.begin(), results.end());
+
+    std::vector<std::pair<std::string, std::string>> expected{
+        {"a", "a"}, {"a", "a"}, {"b", "b"}, {"b", "b"}, {"c", "c"}};
+    ASSERT(results == expected);
+
+    ASSERT_TRUE(stats->usedDisk);
+    ASSERT_GTE(stats->spills, 1U);
+    ASSERT_GTE(stats->spilledRecords, 4U);
+
+    hashJoinStage->close();
+}
+
+TEST_F(HashJoinStageTest, HashJoinExceedsMemoryLimitWithoutDiskUse) {
+    RAIIServerParameterControllerForTest memoryLimit(
+        "internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill", 1);
+
+    auto [outerTag, outerVal] = stage_builder::makeValue(BSON_ARRAY("a"
+                                                                    << "b"));
+    auto [innerTag, innerVal] = stage_builder::makeValue(BSON_ARRAY("a"));
+    auto [outerCondSlot, outerStage] = generateVirtualScan(outerTag, outerVal);
+    auto [innerCondSlot, innerStage] = generateVirtualScan(innerTag, innerVal);
+
+    auto hashJoinStage = makeS<HashJoinStage>(std::move(outerStage),
+                                              std::move(innerStage),
+                                              makeSV(outerCondSlot),
+                                              makeSV(),
+                                              makeSV(innerCondSlot),
+                                              makeSV(),
+                                              boost::none,
+                                              false /* allowDiskUse */,
+                                              kEmptyPlanNodeId);
+
+    // The outer side is loaded into the hash table when the stage is opened.
+    auto ctx = makeCompileCtx();
+    ASSERT_THROWS_CODE(prepareTree(ctx.get(), hashJoinStage.get()),
+                       DBException,
+                       ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed);
+}
+
 }  // namespace mongo::sbe
@@ -0,0 +1,180 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+/**
+ * This file contains tests for sbe::HashLookupStage.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/sbe_plan_stage_test.h"
+#include "mongo/db/exec/sbe/stages/hash_lookup.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/idl/server_parameter_test_util.h"
+
+namespace mongo::sbe {
+
+class HashLookupStageTest : public PlanStageTestFixture {
+public:
+    /**
+     * Joins 'outer' with 'inner' through a HashLookupStage and checks that the stage returns
+     * 'expected'. The 'outer' rows are [key, id] pairs, the 'inner' rows are [key, value] pairs
+     * and each expected row is the outer id followed by the array of matched inner values. The
+     * join is run both with the hash table in memory and with a memory budget too small for it.
+     */
+    void runLookupTest(const BSONArray& outer,
+                       const BSONArray& inner,
+                       const BSONArray& expected,
+                       const CollatorInterface* collator = nullptr) {
+        runLookupTestOnce(outer, inner, expected, collator);
+
+        RAIIServerParameterControllerForTest memoryLimit(
+            "internalQuerySBELookupApproxMemoryUseInBytesBeforeRescan", 1);
+        runLookupTestOnce(outer, inner, expected, collator);
+    }
+
+private:
+    void runLookupTestOnce(const BSONArray& outer,
+                           const BSONArray& inner,
+                           const BSONArray& expected,
+                           const CollatorInterface* collator) {
+        auto ctx = makeCompileCtx();
+
+        auto collatorSlot = generateSlotId();
+        value::OwnedValueAccessor collatorAccessor;
+        if (collator) {
+            ctx->pushCorrelated(collatorSlot, &collatorAccessor);
+            collatorAccessor.reset(value::TypeTags::collator,
+                                   value::bitcastFrom<const CollatorInterface*>(collator));
+        }
+
+        auto [outerSlots, outerStage] = generateVirtualScanMulti(2, outer);
+        auto [innerSlots, innerStage] = generateVirtualScanMulti(2, inner);
+        auto outputSlot = generateSlotId();
+
+        auto stage = makeS<HashLookupStage>(
+            std::move(outerStage),
+            std::move(innerStage),
+            outerSlots[0],
+            innerSlots[0],
+            innerSlots[1],
+            outputSlot,
+            collator ? boost::make_optional(collatorSlot) : boost::none,
+            kEmptyPlanNodeId);
+
+        auto resultAccessors =
+            prepareTree(ctx.get(), stage.get(), makeSV(outerSlots[1], outputSlot));
+
+        auto [resultsTag, resultsVal] = getAllResultsMulti(stage.get(), resultAccessors);
+        value::ValueGuard resultsGuard{resultsTag, resultsVal};
+
+        auto [expectedTag, expectedVal] = stage_builder::makeValue(expected);
+        value::ValueGuard expectedGuard{expectedTag, expectedVal};
+        assertValuesEqual(resultsTag, resultsVal, expectedTag, expectedVal);
+
+        // Reopening the stage must rebuild the hash table and produce the same results again.
+        stage->open(true);
+        auto [reopenTag, reopenVal] = getAllResultsMulti(stage.get(), resultAccessors);
+        value::ValueGuard reopenGuard{reopenTag, reopenVal};
+        assertValuesEqual(reopenTag, reopenVal, expectedTag, expectedVal);
+
+        stage->close();
+    }
+};
+
+TEST_F(HashLookupStageTest, ScalarKeys) {
+    runLookupTest(BSON_ARRAY(BSON_ARRAY(1 << 10) << BSON_ARRAY(2 << 11) << BSON_ARRAY(3 << 12)),
+                  BSON_ARRAY(BSON_ARRAY(2 << "a") << BSON_ARRAY(1 << "b") << BSON_ARRAY(2 << "c")
+                                                  << BSON_ARRAY(2.0 << "d")),
+                  BSON_ARRAY(BSON_ARRAY(10 << BSON_ARRAY("b"))
+                             << BSON_ARRAY(11 << BSON_ARRAY("a"
+                                                            << "c"
+                                                            << "d"))
+                             << BSON_ARRAY(12 << BSONArray())));
+}
+
+TEST_F(HashLookupStageTest, ArrayKeys) {
+    // An inner array matches both by its elements and as a whole, while an outer array is a list
+    // of keys to look up. Each inner row is returned at most once per outer row.
+    runLookupTest(
+        BSON_ARRAY(BSON_ARRAY(1 << 10) << BSON_ARRAY(BSON_ARRAY(2 << 3) << 11)
+                                       << BSON_ARRAY(BSON_ARRAY(1 << 2) << 12)
+                                       << BSON_ARRAY(BSON_ARRAY(BSON_ARRAY(1 << 2)) << 13)),
+        BSON_ARRAY(BSON_ARRAY(1 << "a") << BSON_ARRAY(BSON_ARRAY(1 << 2) << "b")
+                                        << BSON_ARRAY(2 << "c")),
+        BSON_ARRAY(BSON_ARRAY(10 << BSON_ARRAY("a"
+                                               << "b"))
+                   << BSON_ARRAY(11 << BSON_ARRAY("b"
+                                                  << "c"))
+                   << BSON_ARRAY(12 << BSON_ARRAY("a"
+                                                  << "b"
+                                                  << "c"))
+                   << BSON_ARRAY(13 << BSON_ARRAY("b"))));
+}
+
+TEST_F(HashLookupStageTest, NullAndEmptyArrayKeys) {
+    // An empty array on the outer side looks up null. An empty array on the inner side has no
+    // elements, so it can only be matched as a whole.
+    runLookupTest(BSON_ARRAY(BSON_ARRAY(BSONNULL << 10)
+                             << BSON_ARRAY(BSONArray() << 11)
+                             << BSON_ARRAY(BSON_ARRAY(BSONArray()) << 12)),
+                  BSON_ARRAY(BSON_ARRAY(BSONNULL << "a") << BSON_ARRAY(BSONArray() << "b")),
+                  BSON_ARRAY(BSON_ARRAY(10 << BSON_ARRAY("a"))
+                             << BSON_ARRAY(11 << BSON_ARRAY("a"))
+                             << BSON_ARRAY(12 << BSON_ARRAY("b"))));
+}
+
+TEST_F(HashLookupStageTest, RegexKeys) {
+    // As in the classic $lookup, a regular expression is not matched as a pattern against strings.
+    runLookupTest(BSON_ARRAY(BSON_ARRAY(BSONRegEx("^x") << 10)),
+                  BSON_ARRAY(BSON_ARRAY("xyz"
+                                        << "a")
+                             << BSON_ARRAY("abc"
+                                           << "b")
+                             << BSON_ARRAY(BSONRegEx("^x") << "c")
+                             << BSON_ARRAY("xx"
+                                           << "d")),
+                  BSON_ARRAY(BSON_ARRAY(10 << BSON_ARRAY("c"))));
+}
+
+TEST_F(HashLookupStageTest, Collation) {
+    CollatorInterfaceMock collator{CollatorInterfaceMock::MockType::kToLowerString};
+    runLookupTest(BSON_ARRAY(BSON_ARRAY("a" << 10) << BSON_ARRAY("B" << 11)),
+                  BSON_ARRAY(BSON_ARRAY("A"
+                                        << "x")
+                             << BSON_ARRAY("b"
+                                           << "y")
+                             << BSON_ARRAY("a"
+                                           << "z")),
+                  BSON_ARRAY(BSON_ARRAY(10 << BSON_ARRAY("x"
+                                                         << "z"))
+                             << BSON_ARRAY(11 << BSON_ARRAY("y"))),
+                  &collator);
+}
+}  // namespace mongo::sbe
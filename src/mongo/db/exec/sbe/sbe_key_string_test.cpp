@@ -30,6 +30,7 @@
 #include <queue>
 
 #include "mongo/db/exec/sbe/expression_test_base.h"
+#include "mongo/db/exec/sbe/values/bson.h"
 #include "mongo/db/storage/key_string.h"
 
 namespace mongo::sbe {
@@ -172,6 +173,61 @@ TEST_F(SBEKeyStringTest, Basic) {
     ASSERT(keyStringQueue.empty());
 }
 
+TEST_F(SBEKeyStringTest, KsFromValueMatchesIndexKeys) {
+    // The keys built by 'ksFromValue' are used to seek into indexes, so they must be the keys which
+    // an index stores for the same values.
+    value::ViewOfValueAccessor valueAccessor;
+    auto valueSlot = bindAccessor(&valueAccessor);
+    value::OwnedValueAccessor discriminatorAccessor;
+    auto discriminatorSlot = bindAccessor(&discriminatorAccessor);
+
+    auto ksExpr = makeE<EFunction>(
+        "ksFromValue",
+        makeEs(makeE<EConstant>(value::TypeTags::NumberInt64,
+                                value::bitcastFrom<int64_t>(
+                                    static_cast<int64_t>(KeyString::Version::V1))),
+               makeE<EConstant>(value::TypeTags::NumberInt32, value::bitcastFrom<int32_t>(0)),
+               makeE<EVariable>(valueSlot),
+               makeE<EVariable>(discriminatorSlot)));
+    auto compiledExpr = compileExpression(*ksExpr);
+
+    auto testValues = BSON_ARRAY(1 << 2.5 << 1LL << Decimal128("1.5") << "str"
+                                   << BSONNULL << true << BSONRegEx("^x", "i")
+                                   << BSON("a" << 1) << BSON_ARRAY(1 << 2)
+                                   << OID("010203040506070809101112")
+                                   << Date_t::fromMillisSinceEpoch(123) << MINKEY << MAXKEY);
+    for (auto&& element : testValues) {
+        auto [tag, val] = bson::convertFrom(true,
+                                            element.rawdata(),
+                                            element.rawdata() + element.size(),
+                                            element.fieldNameSize() - 1);
+        valueAccessor.reset(tag, val);
+
+        for (auto discriminator : {KeyString::Discriminator::kExclusiveBefore,
+                                   KeyString::Discriminator::kInclusive,
+                                   KeyString::Discriminator::kExclusiveAfter}) {
+            discriminatorAccessor.reset(
+                value::TypeTags::NumberInt64,
+                value::bitcastFrom<int64_t>(static_cast<int64_t>(discriminator)));
+
+            auto [resultTag, resultVal] = runCompiledExpression(compiledExpr.get());
+            value::ValueGuard guard{resultTag, resultVal};
+            ASSERT(resultTag == value::TypeTags::ksValue) << element;
+
+            BSONObjBuilder keyBob;
+            keyBob.appendAs(element, ""_sd);
+            KeyString::HeapBuilder expected{
+                KeyString::Version::V1, keyBob.obj(), KeyString::ALL_ASCENDING, discriminator};
+            ASSERT_EQ(value::getKeyStringView(resultVal)->compare(expected.release()), 0)
+                << element;
+        }
+    }
+
+    // Values which are missing have no key.
+    valueAccessor.reset(value::TypeTags::Nothing, 0);
+    runAndAssertNothing(compiledExpr.get());
+}
+
 TEST(SBEKeyStringTest, KeyComponentInclusion) {
     KeyString::Builder keyStringBuilder(KeyString::Version::V1, KeyString::ALL_ASCENDING);
     keyStringBuilder.appendNumberLong(12345);  // Included
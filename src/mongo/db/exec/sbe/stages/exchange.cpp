@@ -33,20 +33,44 @@
 
 #include "mongo/base/init.h"
 #include "mongo/db/client.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo::sbe {
+namespace {
+constexpr size_t kMaxParallelExecutionThreads = 128;
+
+// The number of threads of the parallel execution pool reserved by running plans.
+AtomicWord<size_t> reservedThreads{0};
+}  // namespace
+
 std::unique_ptr<ThreadPool> s_globalThreadPool;
 MONGO_INITIALIZER(s_globalThreadPool)(InitializerContext* context) {
     ThreadPool::Options options;
     options.poolName = "parallel execution pool";
     options.threadNamePrefix = "ExchProd";
     options.minThreads = 0;
-    options.maxThreads = 128;
-    options.onCreateThread = [](const std::string& name) { Client::initThread(name); };
+    options.maxThreads = kMaxParallelExecutionThreads;
     s_globalThreadPool = std::make_unique<ThreadPool>(options);
     s_globalThreadPool->startup();
 }
 
+std::unique_ptr<ExchangeThreadReservation> ExchangeThreadReservation::tryReserve(
+    size_t numThreads) {
+    auto reserved = reservedThreads.load();
+    do {
+        if (reserved + numThreads > kMaxParallelExecutionThreads) {
+            return nullptr;
+        }
+    } while (!reservedThreads.compareAndSwap(&reserved, reserved + numThreads));
+
+    return std::unique_ptr<ExchangeThreadReservation>(new ExchangeThreadReservation(numThreads));
+}
+
+ExchangeThreadReservation::~ExchangeThreadReservation() {
+    reservedThreads.subtractAndFetch(_numThreads);
+}
+
 ExchangePipe::ExchangePipe(size_t size) {
     // All buffers start empty.
     _fullCount = 0;
@@ -121,12 +145,14 @@ ExchangeState::ExchangeState(size_t numOfProducers,
                              value::SlotVector fields,
                              ExchangePolicy policy,
                              std::unique_ptr<EExpression> partition,
-                             std::unique_ptr<EExpression> orderLess)
+                             std::unique_ptr<EExpression> orderLess,
+                             std::unique_ptr<ExchangeThreadReservation> threadReservation)
     : _policy(policy),
       _numOfProducers(numOfProducers),
       _fields(std::move(fields)),
       _partition(std::move(partition)),
-      _orderLess(std::move(orderLess)) {}
+      _orderLess(std::move(orderLess)),
+      _threadReservation(std::move(threadReservation)) {}
 
 ExchangePipe* ExchangeState::pipe(size_t consumerTid, size_t producerTid) {
     return _consumers[consumerTid]->pipe(producerTid);
@@ -159,11 +185,16 @@ ExchangeConsumer::ExchangeConsumer(std::unique_ptr<PlanStage> input,
                                    ExchangePolicy policy,
                                    std::unique_ptr<EExpression> partition,
                                    std::unique_ptr<EExpression> orderLess,
-                                   PlanNodeId planNodeId)
+                                   PlanNodeId planNodeId,
+                                   std::unique_ptr<ExchangeThreadReservation> threadReservation)
     : PlanStage("exchange"_sd, planNodeId) {
     _children.emplace_back(std::move(input));
-    _state = std::make_shared<ExchangeState>(
-        numOfProducers, std::move(fields), policy, std::move(partition), std::move(orderLess));
+    _state = std::make_shared<ExchangeState>(numOfProducers,
+                                             std::move(fields),
+                                             policy,
+                                             std::move(partition),
+                                             std::move(orderLess),
+                                             std::move(threadReservation));
 
     _tid = _state->addConsumer(this);
     _orderPreserving = _state->isOrderPreserving();
@@ -181,8 +212,12 @@ void ExchangeConsumer::prepare(CompileCtx& ctx) {
         _outgoing.emplace_back(ExchangeBuffer::Accessor{});
     }
 
-    for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
-        _state->producerCompileCtxs().push_back(ctx.makeCopy(true));
+    // Only the first consumer starts the producers, and the other consumers may be prepared
+    // concurrently on the threads of an enclosing exchange.
+    if (_tid == 0) {
+        for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
+            _state->producerCompileCtxs().push_back(ctx.makeCopy(true));
+        }
     }
     // Compile '<' function once we implement order preserving exchange.
 }
@@ -249,21 +284,52 @@ void ExchangeConsumer::open(bool reOpen) {
                 }
             }
 
-            // Start n producers.
+            // Start n producers. They run on behalf of this operation, so they are bound by its
+            // time limit, and its kills are passed on to them.
             invariant(_state->producerCompileCtxs().size() == _state->numOfProducers());
+            _state->setParentOpCtx(_opCtx);
+            auto serviceContext = _opCtx->getServiceContext();
+            auto deadline = _opCtx->getDeadline();
+            auto timeoutError = _opCtx->getTimeoutError();
             for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
                 auto pf = makePromiseFuture<void>();
                 s_globalThreadPool->schedule(
-                    [this, idx, promise = std::move(pf.promise)](auto status) mutable {
+                    [this,
+                     idx,
+                     serviceContext,
+                     deadline,
+                     timeoutError,
+                     promise = std::move(pf.promise)](auto status) mutable {
                         invariant(status);
 
-                        auto opCtx = cc().makeOperationContext();
-
-                        promise.setWith([&] {
-                            ExchangeProducer::start(opCtx.get(),
-                                                    _state->producerCompileCtxs()[idx],
-                                                    std::move(_state->producerPlans()[idx]));
-                        });
+                        // The client only lives as long as the producer, and is gone by the time
+                        // the consumer learns that the producer has finished, so that the threads
+                        // of the pool never outlive the service context with clients of it.
+                        auto result = Status::OK();
+                        {
+                            ThreadClient client("ExchProd", serviceContext);
+                            auto opCtx = cc().makeOperationContext();
+                            if (deadline != Date_t::max()) {
+                                opCtx->setDeadlineByDate(deadline, timeoutError);
+                            }
+
+                            try {
+                                ExchangeProducer::start(opCtx.get(),
+                                                        _state->producerCompileCtxs()[idx],
+                                                        static_cast<ExchangeProducer*>(
+                                                            _state->producerPlans()[idx].get()));
+                            } catch (...) {
+                                // Any error, not only a DBException, has to reach the consumer
+                                // rather than escape the thread pool.
+                                result = exceptionToStatus();
+                            }
+                        }
+
+                        if (result.isOK()) {
+                            promise.emplaceValue();
+                        } else {
+                            promise.setError(std::move(result));
+                        }
                     });
                 _state->addProducerFuture(std::move(pf.future));
             }
@@ -340,9 +406,9 @@ void ExchangeConsumer::close() {
 
         if (_tid == 0) {
             // Consumer ID 0
-            // Wait for n producers to finish.
-            for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
-                _state->producerResults()[idx].wait();
+            // Wait for n producers to finish. There are none if the consumer was never opened.
+            for (auto& result : _state->producerResults()) {
+                result.wait();
             }
         }
 
@@ -359,15 +425,27 @@ void ExchangeConsumer::close() {
     // We can do it outside of the lock as everybody else is gone by now.
     if (_tid == 0) {
         // Consumer ID 0
-        for (size_t idx = 0; idx < _state->numOfProducers(); ++idx) {
-            _state->producerResults()[idx].get();
+        for (auto& result : _state->producerResults()) {
+            result.get();
         }
     }
 }
 
 std::unique_ptr<PlanStageStats> ExchangeConsumer::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
-    ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    if (!_children.empty()) {
+        ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    } else if (_tid == 0) {
+        // Once opened, the subtree has been handed over to the producers. Only report the
+        // producers which have finished, as the others are still running on their own threads.
+        auto& results = _state->producerResults();
+        for (size_t idx = 0; idx < results.size(); ++idx) {
+            if (results[idx].isReady()) {
+                ret->children.emplace_back(
+                    _state->producerPlans()[idx]->getStats(includeDebugInfo));
+            }
+        }
+    }
     return ret;
 }
 
@@ -396,12 +474,20 @@ std::vector<DebugPrinter::Block> ExchangeConsumer::debugPrint() const {
         case ExchangePolicy::roundrobin:
             DebugPrinter::addKeyword(ret, "round");
             break;
+        case ExchangePolicy::partition:
+            DebugPrinter::addKeyword(ret, "part");
+            ret.emplace_back("{`");
+            DebugPrinter::addBlocks(ret, _state->partition()->debugPrint());
+            ret.emplace_back("`}");
+            break;
         default:
             uasserted(4822835, "policy not yet implemented");
     }
 
-    DebugPrinter::addNewLine(ret);
-    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+    if (!_children.empty()) {
+        DebugPrinter::addNewLine(ret);
+        DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+    }
 
     return ret;
 }
@@ -457,12 +543,10 @@ ExchangeProducer::ExchangeProducer(std::unique_ptr<PlanStage> input,
     }
 }
 
-void ExchangeProducer::start(OperationContext* opCtx,
-                             CompileCtx& ctx,
-                             std::unique_ptr<PlanStage> producer) {
-    ExchangeProducer* p = static_cast<ExchangeProducer*>(producer.get());
-
+void ExchangeProducer::start(OperationContext* opCtx, CompileCtx& ctx, ExchangeProducer* p) {
     p->attachToOperationContext(opCtx);
+    // The operation context only lives as long as the producer runs.
+    ON_BLOCK_EXIT([&] { p->detachFromOperationContext(); });
 
     try {
         p->prepare(ctx);
@@ -491,6 +575,14 @@ void ExchangeProducer::prepare(CompileCtx& ctx) {
     for (auto& f : _state->fields()) {
         _incoming.emplace_back(_children[0]->getAccessor(ctx, f));
     }
+
+    if (_state->policy() == ExchangePolicy::partition) {
+        uassert(5843150,
+                "partition exchange requires a partitioning function",
+                _state->partition());
+        ctx.root = this;
+        _partitionCode = _state->partition()->compile(ctx);
+    }
 }
 value::SlotAccessor* ExchangeProducer::getAccessor(CompileCtx& ctx, value::SlotId slot) {
     return _children[0]->getAccessor(ctx, slot);
@@ -503,6 +595,31 @@ void ExchangeProducer::open(bool reOpen) {
         uasserted(4822839, "exchange producer cannot be reopened");
     }
     _children[0]->open(reOpen);
+
+    _yieldTracker.emplace(_opCtx->getServiceContext()->getFastClockSource(),
+                          internalQueryExecYieldIterations.load(),
+                          Milliseconds(internalQueryExecYieldPeriodMS.load()));
+}
+void ExchangeProducer::checkForInterruptAndYield() {
+    if (!_yieldTracker->intervalHasElapsed()) {
+        return;
+    }
+
+    {
+        auto parentOpCtx = _state->parentOpCtx();
+        stdx::lock_guard<Client> lk(*parentOpCtx->getClient());
+        if (auto killStatus = parentOpCtx->getKillStatus(); killStatus != ErrorCodes::OK) {
+            // Any exchange started by this producer passes the kill on in turn.
+            _opCtx->markKilled(killStatus);
+        }
+    }
+    _opCtx->checkForInterrupt();
+
+    // The rows produced so far have been copied into the exchange buffers, so nothing refers to
+    // the storage snapshot any more.
+    _children[0]->saveState();
+    _opCtx->recoveryUnit()->abandonSnapshot();
+    _children[0]->restoreState();
 }
 bool ExchangeProducer::appendData(size_t consumerId) {
     auto buffer = getBuffer(consumerId);
@@ -542,12 +659,27 @@ PlanState ExchangeProducer::getNext() {
                 _roundRobinCounter = (_roundRobinCounter + 1) % _pipes.size();
             } break;
             case ExchangePolicy::partition: {
-                uasserted(4822840, "policy not yet implemented");
+                auto [owned, tag, val] = _bytecode.run(_partitionCode.get());
+                if (owned) {
+                    value::releaseValue(tag, val);
+                }
+                uassert(4822840,
+                        "partitioning function must return a 64-bit integer",
+                        tag == value::TypeTags::NumberInt64);
+
+                auto consumerId =
+                    static_cast<uint64_t>(value::bitcastTo<int64_t>(val)) % _pipes.size();
+                // Detect early out.
+                if (!appendData(consumerId)) {
+                    return trackPlanState(PlanState::IS_EOF);
+                }
             } break;
             default:
                 MONGO_UNREACHABLE;
                 break;
         }
+
+        checkForInterruptAndYield();
     }
 
     // Send off partially filled buffers and the eof marker.
@@ -36,6 +36,7 @@
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/future.h"
 #include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/elapsed_tracker.h"
 #include "mongo/util/future.h"
 
 namespace mongo::sbe {
@@ -44,6 +45,30 @@ class ExchangeProducer;
 
 enum class ExchangePolicy { broadcast, roundrobin, partition };
 
+/**
+ * Threads of the parallel execution pool set aside for the producers of a plan. The producers of
+ * exchanges stacked on top of each other wait on one another, so a plan which could only start
+ * some of them would never finish. The threads are given back when the reservation is destroyed.
+ */
+class ExchangeThreadReservation {
+public:
+    /**
+     * Reserves 'numThreads' threads, or returns nullptr if the pool does not have that many threads
+     * left.
+     */
+    static std::unique_ptr<ExchangeThreadReservation> tryReserve(size_t numThreads);
+
+    ExchangeThreadReservation(const ExchangeThreadReservation&) = delete;
+    ExchangeThreadReservation& operator=(const ExchangeThreadReservation&) = delete;
+
+    ~ExchangeThreadReservation();
+
+private:
+    explicit ExchangeThreadReservation(size_t numThreads) : _numThreads(numThreads) {}
+
+    const size_t _numThreads;
+};
+
 // A unit of exchange between a consumer and a producer
 class ExchangeBuffer {
 public:
@@ -150,7 +175,8 @@ public:
                   value::SlotVector fields,
                   ExchangePolicy policy,
                   std::unique_ptr<EExpression> partition,
-                  std::unique_ptr<EExpression> orderLess);
+                  std::unique_ptr<EExpression> orderLess,
+                  std::unique_ptr<ExchangeThreadReservation> threadReservation);
 
     bool isOrderPreserving() const {
         return !!_orderLess;
@@ -215,8 +241,21 @@ public:
     auto& fields() const {
         return _fields;
     }
+    const EExpression* partition() const {
+        return _partition.get();
+    }
     ExchangePipe* pipe(size_t consumerTid, size_t producerTid);
 
+    /**
+     * The operation on whose behalf the producers run, set by the consumer which starts them.
+     */
+    OperationContext* parentOpCtx() const {
+        return _parentOpCtx;
+    }
+    void setParentOpCtx(OperationContext* opCtx) {
+        _parentOpCtx = opCtx;
+    }
+
 private:
     const ExchangePolicy _policy;
     const size_t _numOfProducers;
@@ -235,6 +274,11 @@ private:
     // The '<' function for order preserving exchange.
     const std::unique_ptr<EExpression> _orderLess;
 
+    // Threads reserved for the producers of this exchange and of any exchange below it, if any.
+    const std::unique_ptr<ExchangeThreadReservation> _threadReservation;
+
+    OperationContext* _parentOpCtx{nullptr};
+
     // This is verbose and heavyweight. Recondsider something lighter
     // at minimum try to share a single mutex (i.e. _stateMutex) if safe
     mongo::Mutex _consumerOpenMutex;
@@ -254,7 +298,8 @@ public:
                      ExchangePolicy policy,
                      std::unique_ptr<EExpression> partition,
                      std::unique_ptr<EExpression> orderLess,
-                     PlanNodeId planNodeId);
+                     PlanNodeId planNodeId,
+                     std::unique_ptr<ExchangeThreadReservation> threadReservation = nullptr);
 
     ExchangeConsumer(std::shared_ptr<ExchangeState> state, PlanNodeId planNodeId);
 
@@ -305,9 +350,11 @@ public:
                      std::shared_ptr<ExchangeState> state,
                      PlanNodeId planNodeId);
 
-    static void start(OperationContext* opCtx,
-                      CompileCtx& ctx,
-                      std::unique_ptr<PlanStage> producer);
+    /**
+     * Runs the 'producer' to completion on behalf of 'opCtx'. The plan of the producer is owned by
+     * the exchange state, so that its statistics remain available once it has finished.
+     */
+    static void start(OperationContext* opCtx, CompileCtx& ctx, ExchangeProducer* producer);
 
     std::unique_ptr<PlanStage> clone() const final;
 
@@ -327,14 +374,27 @@ private:
     void closePipes();
     bool appendData(size_t consumerId);
 
+    /**
+     * Periodically passes on a kill of the parent operation to the operation of this producer, and
+     * abandons the storage snapshot of the producer plan, saving the plan before and restoring it
+     * after. This does not yield locks the way a PlanYieldPolicy does.
+     */
+    void checkForInterruptAndYield();
+
     std::shared_ptr<ExchangeState> _state;
     size_t _tid{0};
     size_t _roundRobinCounter{0};
 
     std::vector<value::SlotAccessor*> _incoming;
 
+    // Partitioning function compiled for this producer, only used by the 'partition' policy.
+    std::unique_ptr<vm::CodeFragment> _partitionCode;
+    vm::ByteCode _bytecode;
+
     std::vector<ExchangePipe*> _pipes;
 
+    boost::optional<ElapsedTracker> _yieldTracker;
+
     // Current empty buffers that this producer is processing.
     std::vector<std::unique_ptr<ExchangeBuffer>> _emptyBuffers;
 };
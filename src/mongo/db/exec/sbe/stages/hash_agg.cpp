@@ -31,20 +31,54 @@
 
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/stats/resource_consumption_metrics.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/util/destructor_guard.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashAggFileCounter;
+    return "extsort-hash-agg-sbe." + std::to_string(hashAggFileCounter.fetchAndAdd(1));
+}
+
+// The minimum number of input rows between two full walks of the hash table which refresh its
+// memory usage estimate.
+constexpr size_t kMinRowsBetweenMemoryChecks = 1024;
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
 HashAggStage::HashAggStage(std::unique_ptr<PlanStage> input,
                            value::SlotVector gbs,
                            value::SlotMap<std::unique_ptr<EExpression>> aggs,
                            boost::optional<value::SlotId> collatorSlot,
-                           PlanNodeId planNodeId)
+                           bool allowDiskUse,
+                           MergingExprMap mergingExprs,
+                           PlanNodeId planNodeId,
+                           boost::optional<long long> approxMemoryUseInBytesBeforeSpill)
     : PlanStage("group"_sd, planNodeId),
       _gbs(std::move(gbs)),
       _aggs(std::move(aggs)),
-      _collatorSlot(collatorSlot) {
+      _collatorSlot(collatorSlot),
+      _allowDiskUse(allowDiskUse),
+      _mergingExprs(std::move(mergingExprs)),
+      _approxMemoryUseInBytesBeforeSpill(approxMemoryUseInBytesBeforeSpill.value_or(
+          internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.load())) {
     _children.emplace_back(std::move(input));
+
+    tassert(5843100,
+            "HashAggStage must have a merging expression for every aggregate or none at all",
+            _mergingExprs.empty() || _mergingExprs.size() == _aggs.size());
+}
+
+HashAggStage::~HashAggStage() {
+    if (!_spillFileName.empty()) {
+        DESTRUCTOR_GUARD(boost::filesystem::remove(_spillFileName));
+    }
 }
 
 std::unique_ptr<PlanStage> HashAggStage::clone() const {
@@ -52,8 +86,18 @@ std::unique_ptr<PlanStage> HashAggStage::clone() const {
     for (auto& [k, v] : _aggs) {
         aggs.emplace(k, v->clone());
     }
-    return std::make_unique<HashAggStage>(
-        _children[0]->clone(), _gbs, std::move(aggs), _collatorSlot, _commonStats.nodeId);
+    MergingExprMap mergingExprs;
+    for (auto& [k, v] : _mergingExprs) {
+        mergingExprs.emplace(k, std::make_pair(v.first, v.second->clone()));
+    }
+    return std::make_unique<HashAggStage>(_children[0]->clone(),
+                                          _gbs,
+                                          std::move(aggs),
+                                          _collatorSlot,
+                                          _allowDiskUse,
+                                          std::move(mergingExprs),
+                                          _commonStats.nodeId,
+                                          _approxMemoryUseInBytesBeforeSpill);
 }
 
 void HashAggStage::prepare(CompileCtx& ctx) {
@@ -96,11 +140,48 @@ void HashAggStage::prepare(CompileCtx& ctx) {
 
         _aggCodes.emplace_back(expr->compile(ctx));
         ctx.aggExpression = false;
+
+        if (!_mergingExprs.empty()) {
+            auto mergingIt = _mergingExprs.find(slot);
+            uassert(5843101,
+                    str::stream() << "missing merging expression for: " << slotId,
+                    mergingIt != _mergingExprs.end());
+            auto spilledSlot = mergingIt->second.first;
+            uassert(5843102,
+                    str::stream() << "duplicate field: " << spilledSlot,
+                    dupCheck.emplace(spilledSlot).second);
+            _spilledAggAccessors.emplace_back(
+                std::make_unique<value::MaterializedSingleRowAccessor>(_spilledAggRow,
+                                                                       counter - 1));
+            _spilledAggAccessorMap[spilledSlot] = _spilledAggAccessors.back().get();
+        }
+    }
+
+    // The merging expressions are compiled in the same order as the aggregates, so that the
+    // partial aggregates written to disk can be matched with the right expression by position.
+    counter = 0;
+    for (auto& [slot, expr] : _aggs) {
+        if (_mergingExprs.empty()) {
+            break;
+        }
+
+        ctx.root = this;
+        ctx.aggExpression = true;
+        ctx.accumulator = _outAggAccessors[counter++].get();
+
+        _mergingExprCodes.emplace_back(_mergingExprs.find(slot)->second.second->compile(ctx));
+        ctx.aggExpression = false;
     }
+    _spilledAggRow.resize(_mergingExprCodes.size());
+
     _compiled = true;
 }
 
 value::SlotAccessor* HashAggStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (auto it = _spilledAggAccessorMap.find(slot); it != _spilledAggAccessorMap.end()) {
+        return it->second;
+    }
+
     if (_compiled) {
         if (auto it = _outAccessors.find(slot); it != _outAccessors.end()) {
             return it->second;
@@ -121,14 +202,18 @@ void HashAggStage::open(bool reOpen) {
     if (_collatorAccessor) {
         auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
         uassert(5402503, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
-        auto collatorView = value::getCollatorView(collatorVal);
-        const value::MaterializedRowHasher hasher(collatorView);
-        const value::MaterializedRowEq equator(collatorView);
+        _collator = value::getCollatorView(collatorVal);
+        const value::MaterializedRowHasher hasher(_collator);
+        const value::MaterializedRowEq equator(_collator);
         _ht.emplace(0, hasher, equator);
     } else {
         _ht.emplace();
     }
 
+    _memoryUseInBytes = 0;
+    _rowsSinceMemoryCheck = 0;
+    dropSpilledData();
+
     while (_children[0]->getNext() == PlanState::ADVANCED) {
         value::MaterializedRow key{_inKeyAccessors.size()};
         // Copy keys in order to do the lookup.
@@ -152,16 +237,166 @@ void HashAggStage::open(bool reOpen) {
             auto [owned, tag, val] = _bytecode.run(_aggCodes[idx].get());
             _outAggAccessors[idx]->reset(owned, tag, val);
         }
+
+        checkMemoryUsageAndSpillIfNecessary(inserted);
     }
 
     _children[0]->close();
 
+    if (!_spilledRuns.empty()) {
+        // Write out what is left in memory as the last run, so that the merged stream observes the
+        // groups' partial aggregates in the same order as they were computed.
+        if (!_ht->empty()) {
+            spill();
+        }
+
+        auto comparator = [this](const SpilledRow& lhs, const SpilledRow& rhs) {
+            return compareSpilledKeys(lhs.first, rhs.first);
+        };
+        _mergeIt.reset(SpillIterator::merge(_spilledRuns, SortOptions(), comparator));
+        if (_mergeIt->more()) {
+            _nextSpilledRow = _mergeIt->next();
+        }
+    }
+
     _htIt = _ht->end();
 }
 
+void HashAggStage::checkMemoryUsageAndSpillIfNecessary(bool newGroup) {
+    if (newGroup) {
+        _memoryUseInBytes += _htIt->first.memUsageForSorter() + _htIt->second.memUsageForSorter();
+    }
+
+    if (++_rowsSinceMemoryCheck >= std::max(_ht->size(), kMinRowsBetweenMemoryChecks)) {
+        _memoryUseInBytes = 0;
+        for (auto&& [key, aggs] : *_ht) {
+            _memoryUseInBytes += key.memUsageForSorter() + aggs.memUsageForSorter();
+        }
+        _rowsSinceMemoryCheck = 0;
+    }
+
+    if (_memoryUseInBytes <= _approxMemoryUseInBytesBeforeSpill) {
+        return;
+    }
+
+    uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+            "Exceeded memory limit for $group, but didn't allow external sort."
+            " Pass allowDiskUse:true to opt in.",
+            _allowDiskUse);
+    uassert(5843103,
+            "Exceeded memory limit for $group, but the aggregates cannot be spilled to disk",
+            !_mergingExprs.empty());
+
+    spill();
+}
+
+int HashAggStage::compareSpilledKeys(const value::MaterializedRow& lhs,
+                                     const value::MaterializedRow& rhs) const {
+    for (size_t idx = 0; idx < lhs.size(); ++idx) {
+        auto [lhsTag, lhsVal] = lhs.getViewOfValue(idx);
+        auto [rhsTag, rhsVal] = rhs.getViewOfValue(idx);
+        auto [tag, val] = value::compareValue(lhsTag, lhsVal, rhsTag, rhsVal, _collator);
+        uassert(5843104,
+                "Group keys of a spilled $group must be comparable",
+                tag == value::TypeTags::NumberInt32);
+
+        if (auto result = value::bitcastTo<int32_t>(val); result != 0) {
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+void HashAggStage::spill() {
+    if (_spillFileName.empty()) {
+        _spillFileName = storageGlobalParams.dbpath + "/_tmp/" + nextFileName();
+        _nextSpillFileOffset = 0;
+    }
+
+    std::vector<const TableType::value_type*> groups;
+    groups.reserve(_ht->size());
+    for (auto&& group : *_ht) {
+        groups.push_back(&group);
+    }
+    std::sort(groups.begin(), groups.end(), [this](auto lhs, auto rhs) {
+        return compareSpilledKeys(lhs->first, rhs->first) < 0;
+    });
+
+    SortedFileWriter<value::MaterializedRow, value::MaterializedRow> writer(
+        SortOptions().TempDir(storageGlobalParams.dbpath + "/_tmp"),
+        _spillFileName,
+        _nextSpillFileOffset);
+    for (auto group : groups) {
+        writer.addAlreadySorted(group->first, group->second);
+    }
+    _spilledRuns.emplace_back(writer.done());
+    _nextSpillFileOffset = writer.getFileEndOffset();
+
+    auto& metricsCollector = ResourceConsumption::MetricsCollector::get(_opCtx);
+    metricsCollector.incrementKeysSorted(groups.size());
+    metricsCollector.incrementSorterSpills(1);
+
+    _specificStats.usedDisk = true;
+    _specificStats.spills++;
+    _specificStats.spilledRecords += groups.size();
+
+    _ht->clear();
+    _memoryUseInBytes = 0;
+    _rowsSinceMemoryCheck = 0;
+}
+
+void HashAggStage::dropSpilledData() {
+    _nextSpilledRow = boost::none;
+    _mergeIt.reset();
+    _spilledRuns.clear();
+    if (!_spillFileName.empty()) {
+        DESTRUCTOR_GUARD(boost::filesystem::remove(_spillFileName));
+        _spillFileName.clear();
+    }
+}
+
+bool HashAggStage::getNextSpilledGroup() {
+    if (!_nextSpilledRow) {
+        return false;
+    }
+
+    // Reuse the hash table to hold the single group being merged, so that the output accessors
+    // work the same way as when no data was spilled.
+    _ht->clear();
+    auto [it, inserted] = _ht->try_emplace(std::move(_nextSpilledRow->first),
+                                           value::MaterializedRow{_outAggAccessors.size()});
+    _htIt = it;
+    _spilledAggRow = std::move(_nextSpilledRow->second);
+
+    while (true) {
+        for (size_t idx = 0; idx < _outAggAccessors.size(); ++idx) {
+            auto [owned, tag, val] = _bytecode.run(_mergingExprCodes[idx].get());
+            _outAggAccessors[idx]->reset(owned, tag, val);
+        }
+
+        if (!_mergeIt->more()) {
+            _nextSpilledRow = boost::none;
+            break;
+        }
+
+        _nextSpilledRow = _mergeIt->next();
+        if (compareSpilledKeys(_htIt->first, _nextSpilledRow->first) != 0) {
+            break;
+        }
+        _spilledAggRow = std::move(_nextSpilledRow->second);
+    }
+
+    return true;
+}
+
 PlanState HashAggStage::getNext() {
     auto optTimer(getOptTimer(_opCtx));
 
+    if (_mergeIt) {
+        return trackPlanState(getNextSpilledGroup() ? PlanState::ADVANCED : PlanState::IS_EOF);
+    }
+
     if (_htIt == _ht->end()) {
         _htIt = _ht->begin();
     } else {
@@ -177,6 +412,7 @@ PlanState HashAggStage::getNext() {
 
 std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashAggStats>(_specificStats);
 
     if (includeDebugInfo) {
         DebugPrinter printer;
@@ -188,6 +424,9 @@ std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) co
                 childrenBob.append(str::stream() << slot, printer.print(expr->debugPrint()));
             }
         }
+        bob.appendBool("usedDisk", _specificStats.usedDisk);
+        bob.appendNumber("spills", static_cast<long long>(_specificStats.spills));
+        bob.appendNumber("spilledRecords", static_cast<long long>(_specificStats.spilledRecords));
         ret->debugInfo = bob.obj();
     }
 
@@ -196,7 +435,7 @@ std::unique_ptr<PlanStageStats> HashAggStage::getStats(bool includeDebugInfo) co
 }
 
 const SpecificStats* HashAggStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 void HashAggStage::close() {
@@ -204,6 +443,7 @@ void HashAggStage::close() {
 
     _commonStats.closes++;
     _ht = boost::none;
+    dropSpilledData();
 }
 
 std::vector<DebugPrinter::Block> HashAggStage::debugPrint() const {
@@ -36,15 +36,44 @@
 #include "mongo/db/exec/sbe/vm/vm.h"
 #include "mongo/stdx/unordered_map.h"
 
+namespace mongo {
+template <typename Key, typename Value>
+class SortIteratorInterface;
+}  // namespace mongo
+
 namespace mongo {
 namespace sbe {
+/**
+ * Groups the rows of its child by the values in the 'gbs' slots and computes the 'aggs' aggregate
+ * expressions for every group.
+ *
+ * The hash table is kept in memory until its approximate size exceeds
+ * 'internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill'. At that point, if 'allowDiskUse' is set,
+ * the contents of the table are sorted by key and written to a temporary file, and the table is
+ * emptied. Once the input is exhausted, the spilled runs are merged back in key order and partial
+ * aggregates of the same group are combined using 'mergingExprs'. If disk use is not allowed,
+ * exceeding the memory budget fails the query. 'approxMemoryUseInBytesBeforeSpill' overrides the
+ * budget, e.g. to share it between copies of the stage running in parallel.
+ *
+ * 'mergingExprs' maps every aggregate output slot to a pair of a slot and an aggregate expression.
+ * While merging, the slot holds a partial aggregate read back from disk, and the expression folds
+ * it into the group's accumulator (e.g. 'sum(s5)' merges partial sums). It must either be empty,
+ * in which case the stage never spills, or provide an entry for each slot in 'aggs'.
+ */
 class HashAggStage final : public PlanStage {
 public:
+    using MergingExprMap = value::SlotMap<std::pair<value::SlotId, std::unique_ptr<EExpression>>>;
+
     HashAggStage(std::unique_ptr<PlanStage> input,
                  value::SlotVector gbs,
                  value::SlotMap<std::unique_ptr<EExpression>> aggs,
                  boost::optional<value::SlotId> collatorSlot,
-                 PlanNodeId planNodeId);
+                 bool allowDiskUse,
+                 MergingExprMap mergingExprs,
+                 PlanNodeId planNodeId,
+                 boost::optional<long long> approxMemoryUseInBytesBeforeSpill = boost::none);
+
+    ~HashAggStage();
 
     std::unique_ptr<PlanStage> clone() const final;
 
@@ -59,6 +88,9 @@ public:
     std::vector<DebugPrinter::Block> debugPrint() const final;
 
 private:
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+
     using TableType = stdx::unordered_map<value::MaterializedRow,
                                           value::MaterializedRow,
                                           value::MaterializedRowHasher,
@@ -70,6 +102,8 @@ private:
     const value::SlotVector _gbs;
     const value::SlotMap<std::unique_ptr<EExpression>> _aggs;
     const boost::optional<value::SlotId> _collatorSlot;
+    const bool _allowDiskUse;
+    const MergingExprMap _mergingExprs;
 
     value::SlotAccessorMap _outAccessors;
     std::vector<value::SlotAccessor*> _inKeyAccessors;
@@ -80,6 +114,7 @@ private:
 
     // Only set if collator slot provided on construction.
     value::SlotAccessor* _collatorAccessor = nullptr;
+    CollatorInterface* _collator = nullptr;
 
     boost::optional<TableType> _ht;
     TableType::iterator _htIt;
@@ -87,6 +122,55 @@ private:
     vm::ByteCode _bytecode;
 
     bool _compiled{false};
+
+    /**
+     * Adds the approximate size of the group at '_htIt' to the memory estimate and spills the hash
+     * table to disk once the memory budget is exceeded. The estimate for existing groups, whose
+     * accumulators may grow (e.g. 'addToArray'), is refreshed by walking the whole table, which is
+     * done with a period proportional to the table size to keep the amortized cost constant.
+     */
+    void checkMemoryUsageAndSpillIfNecessary(bool newGroup);
+
+    /**
+     * Writes the contents of the hash table, sorted by group key, to the spill file and empties
+     * the table.
+     */
+    void spill();
+
+    /**
+     * Reads all spilled partial aggregates that belong to the next group from the merged spill
+     * runs, and combines them into a single-entry hash table positioned at '_htIt'.
+     */
+    bool getNextSpilledGroup();
+
+    /**
+     * Releases the merge iterators and removes the spill file, if any.
+     */
+    void dropSpilledData();
+
+    int compareSpilledKeys(const value::MaterializedRow& lhs,
+                           const value::MaterializedRow& rhs) const;
+
+    // Memory budget of the hash table, initialized from the query knob on construction.
+    const long long _approxMemoryUseInBytesBeforeSpill;
+    long long _memoryUseInBytes{0};
+    size_t _rowsSinceMemoryCheck{0};
+
+    // Compiled merging expressions, in the same order as '_aggCodes', and the accessors that
+    // expose a partial aggregate read back from disk to them.
+    std::vector<std::unique_ptr<vm::CodeFragment>> _mergingExprCodes;
+    value::MaterializedRow _spilledAggRow;
+    std::vector<std::unique_ptr<value::MaterializedSingleRowAccessor>> _spilledAggAccessors;
+    value::SlotAccessorMap _spilledAggAccessorMap;
+
+    // All spills of a single execution append to the same file to stay below open file limits.
+    std::string _spillFileName;
+    std::streampos _nextSpillFileOffset{0};
+    std::vector<std::shared_ptr<SpillIterator>> _spilledRuns;
+    std::unique_ptr<SpillIterator> _mergeIt;
+    boost::optional<SpilledRow> _nextSpilledRow;
+
+    HashAggStats _specificStats;
 };
 }  // namespace sbe
 }  // namespace mongo
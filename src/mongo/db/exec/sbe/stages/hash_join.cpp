@@ -32,10 +32,42 @@
 #include "mongo/db/exec/sbe/stages/hash_join.h"
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/util/destructor_guard.h"
 #include "mongo/util/str.h"
 
+namespace {
+std::string nextFileName() {
+    static mongo::AtomicWord<unsigned> hashJoinFileCounter;
+    return "extsort-hash-join-sbe." + std::to_string(hashJoinFileCounter.fetchAndAdd(1));
+}
+
+// The number of partitions the outer side is split into when spilling is allowed.
+constexpr size_t kNumPartitions = 16;
+
+// Rows that belong to spilled partitions are buffered in memory and written out together once the
+// buffers grow past this size.
+constexpr long long kMaxSpillBufferBytes = 1024 * 1024;
+}  // namespace
+
+#include "mongo/db/sorter/sorter.cpp"
+
 namespace mongo {
 namespace sbe {
+struct HashJoinStage::Partition {
+    bool spilled{false};
+
+    // Approximate size of the partition's rows in the hash table, while it is not spilled.
+    long long memUsage{0};
+
+    // Rows waiting to be written to disk, and the file ranges they were written to.
+    std::vector<SpilledRow> outerBuffer;
+    std::vector<SpilledRow> innerBuffer;
+    std::vector<SorterRange> outerRanges;
+    std::vector<SorterRange> innerRanges;
+};
+
 HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
                              std::unique_ptr<PlanStage> inner,
                              value::SlotVector outerCond,
@@ -43,6 +75,7 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
                              value::SlotVector innerCond,
                              value::SlotVector innerProjects,
                              boost::optional<value::SlotId> collatorSlot,
+                             bool allowDiskUse,
                              PlanNodeId planNodeId)
     : PlanStage("hj"_sd, planNodeId),
       _outerCond(std::move(outerCond)),
@@ -50,7 +83,10 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
       _innerCond(std::move(innerCond)),
       _innerProjects(std::move(innerProjects)),
       _collatorSlot(collatorSlot),
-      _probeKey(0) {
+      _allowDiskUse(allowDiskUse),
+      _probeKey(0),
+      _approxMemoryUseInBytesBeforeSpill(
+          internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill.load()) {
     if (_outerCond.size() != _innerCond.size()) {
         uasserted(4822823, "left and right size do not match");
     }
@@ -59,6 +95,12 @@ HashJoinStage::HashJoinStage(std::unique_ptr<PlanStage> outer,
     _children.emplace_back(std::move(inner));
 }
 
+HashJoinStage::~HashJoinStage() {
+    if (!_spillFileName.empty()) {
+        DESTRUCTOR_GUARD(boost::filesystem::remove(_spillFileName));
+    }
+}
+
 std::unique_ptr<PlanStage> HashJoinStage::clone() const {
     return std::make_unique<HashJoinStage>(_children[0]->clone(),
                                            _children[1]->clone(),
@@ -67,6 +109,7 @@ std::unique_ptr<PlanStage> HashJoinStage::clone() const {
                                            _innerCond,
                                            _innerProjects,
                                            _collatorSlot,
+                                           _allowDiskUse,
                                            _commonStats.nodeId);
 }
 
@@ -113,6 +156,39 @@ void HashJoinStage::prepare(CompileCtx& ctx) {
 
     _probeKey.resize(_inInnerKeyAccessors.size());
 
+    if (_allowDiskUse) {
+        value::SlotSet innerDupCheck;
+        for (auto& slot : _innerProjects) {
+            auto [it, inserted] = innerDupCheck.emplace(slot);
+            uassert(5843110, str::stream() << "duplicate field: " << slot, inserted);
+
+            _inInnerProjectAccessors.emplace_back(_children[1]->getAccessor(ctx, slot));
+        }
+
+        _spilledInnerRow.first.resize(_innerCond.size());
+        _spilledInnerRow.second.resize(_innerProjects.size());
+
+        auto addSwitchAccessor = [&](value::SlotId slot,
+                                     value::SlotAccessor* childAccessor,
+                                     value::MaterializedRow& row,
+                                     size_t idx) {
+            _spilledInnerAccessors.emplace_back(
+                std::make_unique<value::MaterializedSingleRowAccessor>(row, idx));
+            _outInnerSwitchAccessors.emplace_back(std::make_unique<value::SwitchAccessor>(
+                std::vector<value::SlotAccessor*>{childAccessor,
+                                                  _spilledInnerAccessors.back().get()}));
+            _outInnerAccessors[slot] = _outInnerSwitchAccessors.back().get();
+        };
+        for (size_t idx = 0; idx < _innerCond.size(); ++idx) {
+            addSwitchAccessor(
+                _innerCond[idx], _inInnerKeyAccessors[idx], _spilledInnerRow.first, idx);
+        }
+        for (size_t idx = 0; idx < _innerProjects.size(); ++idx) {
+            addSwitchAccessor(
+                _innerProjects[idx], _inInnerProjectAccessors[idx], _spilledInnerRow.second, idx);
+        }
+    }
+
     _compiled = true;
 }
 
@@ -122,6 +198,10 @@ value::SlotAccessor* HashJoinStage::getAccessor(CompileCtx& ctx, value::SlotId s
             return it->second;
         }
 
+        if (auto it = _outInnerAccessors.find(slot); it != _outInnerAccessors.end()) {
+            return it->second;
+        }
+
         return _children[1]->getAccessor(ctx, slot);
     }
 
@@ -134,14 +214,21 @@ void HashJoinStage::open(bool reOpen) {
     if (_collatorAccessor) {
         auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
         uassert(5402504, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
-        auto collatorView = value::getCollatorView(collatorVal);
-        const value::MaterializedRowHasher hasher(collatorView);
-        const value::MaterializedRowEq equator(collatorView);
+        _collator = value::getCollatorView(collatorVal);
+        const value::MaterializedRowHasher hasher(_collator);
+        const value::MaterializedRowEq equator(_collator);
         _ht.emplace(0, hasher, equator);
     } else {
         _ht.emplace();
     }
 
+    dropSpilledData();
+    if (_allowDiskUse) {
+        for (size_t idx = 0; idx < kNumPartitions; ++idx) {
+            _partitions.emplace_back(std::make_unique<Partition>());
+        }
+    }
+
     _commonStats.opens++;
     _children[0]->open(reOpen);
     // Insert the outer side into the hash table.
@@ -163,17 +250,198 @@ void HashJoinStage::open(bool reOpen) {
             project.reset(idx++, true, tag, val);
         }
 
-        _ht->emplace(std::move(key), std::move(project));
+        insertOuterRow(std::move(key), std::move(project));
     }
 
     _children[0]->close();
 
+    if (_spilled) {
+        flushSpillBuffers();
+    }
+
     _children[1]->open(reOpen);
 
     _htIt = _ht->end();
     _htItEnd = _ht->end();
 }
 
+size_t HashJoinStage::partitionOf(const value::MaterializedRow& key) const {
+    return value::MaterializedRowHasher{_collator}(key) % kNumPartitions;
+}
+
+void HashJoinStage::insertOuterRow(value::MaterializedRow key, value::MaterializedRow project) {
+    if (!_allowDiskUse) {
+        _memoryUseInBytes += key.memUsageForSorter() + project.memUsageForSorter();
+        uassert(ErrorCodes::QueryExceededMemoryLimitNoDiskUseAllowed,
+                "Exceeded memory limit for hash join, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _memoryUseInBytes <= _approxMemoryUseInBytesBeforeSpill);
+        _ht->emplace(std::move(key), std::move(project));
+        return;
+    }
+
+    auto& partition = *_partitions[partitionOf(key)];
+    if (partition.spilled) {
+        bufferSpilledRow(partition.outerBuffer, std::move(key), std::move(project));
+        return;
+    }
+
+    const long long size = key.memUsageForSorter() + project.memUsageForSorter();
+    _ht->emplace(std::move(key), std::move(project));
+    partition.memUsage += size;
+    _memoryUseInBytes += size;
+
+    while (_memoryUseInBytes > _approxMemoryUseInBytesBeforeSpill) {
+        spillLargestPartition();
+    }
+}
+
+void HashJoinStage::spillLargestPartition() {
+    Partition* victim = nullptr;
+    for (auto&& partition : _partitions) {
+        if (!partition->spilled && (!victim || partition->memUsage > victim->memUsage)) {
+            victim = partition.get();
+        }
+    }
+    invariant(victim);
+
+    victim->spilled = true;
+    for (auto it = _ht->begin(); it != _ht->end();) {
+        auto current = it++;
+        if (_partitions[partitionOf(current->first)].get() == victim) {
+            auto node = _ht->extract(current);
+            bufferSpilledRow(
+                victim->outerBuffer, std::move(node.key()), std::move(node.mapped()));
+        }
+    }
+    _memoryUseInBytes -= victim->memUsage;
+    victim->memUsage = 0;
+
+    _spilled = true;
+    _specificStats.usedDisk = true;
+    _specificStats.spills++;
+}
+
+void HashJoinStage::bufferSpilledRow(std::vector<SpilledRow>& buffer,
+                                     value::MaterializedRow key,
+                                     value::MaterializedRow project) {
+    _spillBufferBytes += key.memUsageForSorter() + project.memUsageForSorter();
+    buffer.emplace_back(std::move(key), std::move(project));
+    _specificStats.spilledRecords++;
+
+    if (_spillBufferBytes > kMaxSpillBufferBytes) {
+        flushSpillBuffers();
+    }
+}
+
+void HashJoinStage::flushSpillBuffers() {
+    if (_spillFileName.empty()) {
+        _spillFileName = storageGlobalParams.dbpath + "/_tmp/" + nextFileName();
+        _nextSpillFileOffset = 0;
+    }
+
+    auto writeRange = [&](std::vector<SpilledRow>& buffer, std::vector<SorterRange>& ranges) {
+        if (buffer.empty()) {
+            return;
+        }
+
+        SortedFileWriter<value::MaterializedRow, value::MaterializedRow> writer(
+            SortOptions().TempDir(storageGlobalParams.dbpath + "/_tmp"),
+            _spillFileName,
+            _nextSpillFileOffset);
+        for (auto&& row : buffer) {
+            writer.addAlreadySorted(row.first, row.second);
+        }
+        std::unique_ptr<SpillIterator> it(writer.done());
+        ranges.push_back(it->getRange());
+        _nextSpillFileOffset = writer.getFileEndOffset();
+        buffer.clear();
+    };
+
+    for (auto&& partition : _partitions) {
+        writeRange(partition->outerBuffer, partition->outerRanges);
+        writeRange(partition->innerBuffer, partition->innerRanges);
+    }
+    _spillBufferBytes = 0;
+}
+
+std::unique_ptr<HashJoinStage::SpillIterator> HashJoinStage::openSpilledRange(
+    const SorterRange& range) {
+    auto it =
+        std::make_unique<sorter::FileIterator<value::MaterializedRow, value::MaterializedRow>>(
+            _spillFileName,
+            range.getStartOffset(),
+            range.getEndOffset(),
+            SpillIterator::Settings(),
+            boost::none,
+            range.getChecksum());
+    it->openSource();
+    return it;
+}
+
+bool HashJoinStage::loadNextSpilledChunk() {
+    _ht->clear();
+    _htIt = _ht->end();
+    _htItEnd = _ht->end();
+
+    while (_spilledPartitionIdx < _partitions.size()) {
+        auto& partition = *_partitions[_spilledPartitionIdx];
+
+        // A spilled partition without inner rows cannot produce any results.
+        if (partition.spilled && !partition.innerRanges.empty()) {
+            long long chunkBytes = 0;
+            while (chunkBytes <= _approxMemoryUseInBytesBeforeSpill) {
+                if (_outerRangeIt && _outerRangeIt->more()) {
+                    auto [key, project] = _outerRangeIt->next();
+                    chunkBytes += key.memUsageForSorter() + project.memUsageForSorter();
+                    _ht->emplace(std::move(key), std::move(project));
+                } else if (_outerRangeIt) {
+                    _outerRangeIt->closeSource();
+                    _outerRangeIt.reset();
+                } else if (_nextOuterRange < partition.outerRanges.size()) {
+                    _outerRangeIt = openSpilledRange(partition.outerRanges[_nextOuterRange++]);
+                } else {
+                    break;
+                }
+            }
+
+            if (!_ht->empty()) {
+                _nextInnerRange = 0;
+                return true;
+            }
+        }
+
+        ++_spilledPartitionIdx;
+        _nextOuterRange = 0;
+    }
+
+    return false;
+}
+
+bool HashJoinStage::nextSpilledInnerRow() {
+    while (_spilledPartitionIdx < _partitions.size()) {
+        if (_innerRangeIt) {
+            if (_innerRangeIt->more()) {
+                _spilledInnerRow = _innerRangeIt->next();
+                return true;
+            }
+            _innerRangeIt->closeSource();
+            _innerRangeIt.reset();
+        }
+
+        auto& partition = *_partitions[_spilledPartitionIdx];
+        if (_nextInnerRange < partition.innerRanges.size()) {
+            _innerRangeIt = openSpilledRange(partition.innerRanges[_nextInnerRange++]);
+            continue;
+        }
+
+        // All inner rows of the partition were probed against the current chunk of outer rows.
+        loadNextSpilledChunk();
+    }
+
+    return false;
+}
+
 PlanState HashJoinStage::getNext() {
     auto optTimer(getOptTimer(_opCtx));
 
@@ -183,8 +451,32 @@ PlanState HashJoinStage::getNext() {
 
     if (_htIt == _htItEnd) {
         while (_htIt == _htItEnd) {
+            if (_joiningSpilledPartitions) {
+                if (!nextSpilledInnerRow()) {
+                    return trackPlanState(PlanState::IS_EOF);
+                }
+
+                auto [low, hi] = _ht->equal_range(_spilledInnerRow.first);
+                _htIt = low;
+                _htItEnd = hi;
+                continue;
+            }
+
             auto state = _children[1]->getNext();
             if (state == PlanState::IS_EOF) {
+                if (_spilled) {
+                    // Join the spilled partitions now that all of their inner rows are on disk.
+                    flushSpillBuffers();
+                    for (auto&& accessor : _outInnerSwitchAccessors) {
+                        accessor->setIndex(1);
+                    }
+                    _joiningSpilledPartitions = true;
+                    _spilledPartitionIdx = 0;
+                    _nextOuterRange = 0;
+                    loadNextSpilledChunk();
+                    continue;
+                }
+
                 // LEFT and OUTER joins should enumerate "non-returned" rows here.
                 return trackPlanState(state);
             }
@@ -196,6 +488,20 @@ PlanState HashJoinStage::getNext() {
                 _probeKey.reset(idx++, false, tag, val);
             }
 
+            if (_spilled) {
+                if (auto& partition = *_partitions[partitionOf(_probeKey)]; partition.spilled) {
+                    value::MaterializedRow project{_inInnerProjectAccessors.size()};
+                    idx = 0;
+                    for (auto& p : _inInnerProjectAccessors) {
+                        auto [tag, val] = p->getViewOfValue();
+                        project.reset(idx++, false, tag, val);
+                    }
+                    bufferSpilledRow(
+                        partition.innerBuffer, _probeKey.getOwned(), project.getOwned());
+                    continue;
+                }
+            }
+
             auto [low, hi] = _ht->equal_range(_probeKey);
             _htIt = low;
             _htItEnd = hi;
@@ -207,23 +513,51 @@ PlanState HashJoinStage::getNext() {
     return trackPlanState(PlanState::ADVANCED);
 }
 
+void HashJoinStage::dropSpilledData() {
+    _partitions.clear();
+    _spilled = false;
+    _joiningSpilledPartitions = false;
+    _memoryUseInBytes = 0;
+    _spillBufferBytes = 0;
+    _outerRangeIt.reset();
+    _innerRangeIt.reset();
+    for (auto&& accessor : _outInnerSwitchAccessors) {
+        accessor->setIndex(0);
+    }
+    if (!_spillFileName.empty()) {
+        DESTRUCTOR_GUARD(boost::filesystem::remove(_spillFileName));
+        _spillFileName.clear();
+    }
+}
+
 void HashJoinStage::close() {
     auto optTimer(getOptTimer(_opCtx));
 
     _commonStats.closes++;
     _children[1]->close();
     _ht = boost::none;
+    dropSpilledData();
 }
 
 std::unique_ptr<PlanStageStats> HashJoinStage::getStats(bool includeDebugInfo) const {
     auto ret = std::make_unique<PlanStageStats>(_commonStats);
+    ret->specific = std::make_unique<HashJoinStats>(_specificStats);
+
+    if (includeDebugInfo && _allowDiskUse) {
+        BSONObjBuilder bob;
+        bob.appendBool("usedDisk", _specificStats.usedDisk);
+        bob.appendNumber("spills", static_cast<long long>(_specificStats.spills));
+        bob.appendNumber("spilledRecords", static_cast<long long>(_specificStats.spilledRecords));
+        ret->debugInfo = bob.obj();
+    }
+
     ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
     ret->children.emplace_back(_children[1]->getStats(includeDebugInfo));
     return ret;
 }
 
 const SpecificStats* HashJoinStage::getSpecificStats() const {
-    return nullptr;
+    return &_specificStats;
 }
 
 std::vector<DebugPrinter::Block> HashJoinStage::debugPrint() const {
@@ -34,7 +34,27 @@
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/vm/vm.h"
 
+namespace mongo {
+class SorterRange;
+template <typename Key, typename Value>
+class SortIteratorInterface;
+}  // namespace mongo
+
 namespace mongo::sbe {
+/**
+ * Joins the rows of the 'outer' child, which are loaded into a hash table keyed by the
+ * 'outerCond' slots, with the rows of the 'inner' child whose 'innerCond' slots match.
+ *
+ * If 'allowDiskUse' is set, the stage runs as a hybrid hash join. The outer rows are split into
+ * partitions by key hash, and once the hash table exceeds
+ * 'internalQuerySBEHashJoinApproxMemoryUseInBytesBeforeSpill', whole partitions are moved to a
+ * temporary file. Inner rows that fall into a spilled partition are written to disk as well, and
+ * the spilled partitions are joined one at a time after the inner side is exhausted. A partition
+ * that does not fit in memory by itself is loaded in chunks, and its inner rows are re-read once
+ * per chunk. In this mode only the 'innerCond' and 'innerProjects' slots of the inner side are
+ * visible to the parent stage. Without 'allowDiskUse', the stage fails with
+ * QueryExceededMemoryLimitNoDiskUseAllowed once the hash table exceeds that limit.
+ */
 class HashJoinStage final : public PlanStage {
 public:
     HashJoinStage(std::unique_ptr<PlanStage> outer,
@@ -44,8 +64,11 @@ public:
                   value::SlotVector innerCond,
                   value::SlotVector innerProjects,
                   boost::optional<value::SlotId> collatorSlot,
+                  bool allowDiskUse,
                   PlanNodeId planNodeId);
 
+    ~HashJoinStage();
+
     std::unique_ptr<PlanStage> clone() const final;
 
     void prepare(CompileCtx& ctx) final;
@@ -59,6 +82,11 @@ public:
     std::vector<DebugPrinter::Block> debugPrint() const final;
 
 private:
+    struct Partition;
+
+    using SpilledRow = std::pair<value::MaterializedRow, value::MaterializedRow>;
+    using SpillIterator = SortIteratorInterface<value::MaterializedRow, value::MaterializedRow>;
+
     using TableType = std::unordered_multimap<value::MaterializedRow,  // NOLINT
                                               value::MaterializedRow,
                                               value::MaterializedRowHasher,
@@ -72,6 +100,7 @@ private:
     const value::SlotVector _innerCond;
     const value::SlotVector _innerProjects;
     const boost::optional<value::SlotId> _collatorSlot;
+    const bool _allowDiskUse;
 
     // All defined values from the outer side (i.e. they come from the hash table).
     value::SlotAccessorMap _outOuterAccessors;
@@ -104,5 +133,78 @@ private:
     vm::ByteCode _bytecode;
 
     bool _compiled{false};
+
+    size_t partitionOf(const value::MaterializedRow& key) const;
+
+    /**
+     * Inserts a row of the outer side either into the hash table, or into the spill buffer of its
+     * partition if that partition has already been spilled. Throws if the hash table outgrows its
+     * memory limit and spilling is not allowed.
+     */
+    void insertOuterRow(value::MaterializedRow key, value::MaterializedRow project);
+
+    /**
+     * Moves the in-memory partition with the largest footprint out of the hash table and marks it
+     * as spilled.
+     */
+    void spillLargestPartition();
+
+    void bufferSpilledRow(std::vector<SpilledRow>& buffer,
+                          value::MaterializedRow key,
+                          value::MaterializedRow project);
+
+    /**
+     * Writes out all spill buffers, each one as a separate run of the shared spill file.
+     */
+    void flushSpillBuffers();
+
+    std::unique_ptr<SpillIterator> openSpilledRange(const SorterRange& range);
+
+    /**
+     * Replaces the contents of the hash table with the next chunk of outer rows of the spilled
+     * partition being joined, moving on to the next spilled partition when the current one is
+     * exhausted. Returns false when there are no more spilled partitions.
+     */
+    bool loadNextSpilledChunk();
+
+    /**
+     * Reads the next inner row of the spilled partition being joined into '_spilledInnerRow'.
+     * Returns false when all spilled partitions have been joined.
+     */
+    bool nextSpilledInnerRow();
+
+    void dropSpilledData();
+
+    // Accessors of the inner slots which must be preserved when an inner row is written to disk.
+    std::vector<value::SlotAccessor*> _inInnerProjectAccessors;
+
+    // When spilling is allowed, the inner slots are exposed through switch accessors, which read
+    // either from the inner child or from an inner row read back from disk.
+    value::SlotAccessorMap _outInnerAccessors;
+    std::vector<std::unique_ptr<value::SwitchAccessor>> _outInnerSwitchAccessors;
+    std::vector<std::unique_ptr<value::MaterializedSingleRowAccessor>> _spilledInnerAccessors;
+    SpilledRow _spilledInnerRow;
+
+    CollatorInterface* _collator = nullptr;
+
+    const long long _approxMemoryUseInBytesBeforeSpill;
+    long long _memoryUseInBytes{0};
+    long long _spillBufferBytes{0};
+
+    std::vector<std::unique_ptr<Partition>> _partitions;
+    bool _spilled{false};
+
+    // State of the join of the spilled partitions, which starts once the inner side is exhausted.
+    bool _joiningSpilledPartitions{false};
+    size_t _spilledPartitionIdx{0};
+    size_t _nextOuterRange{0};
+    size_t _nextInnerRange{0};
+    std::unique_ptr<SpillIterator> _outerRangeIt;
+    std::unique_ptr<SpillIterator> _innerRangeIt;
+
+    std::string _spillFileName;
+    std::streampos _nextSpillFileOffset{0};
+
+    HashJoinStats _specificStats;
 };
 }  // namespace mongo::sbe
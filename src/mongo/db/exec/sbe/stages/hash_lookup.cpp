@@ -0,0 +1,361 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/sbe/stages/hash_lookup.h"
+
+#include <algorithm>
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/util/str.h"
+
+namespace mongo::sbe {
+HashLookupStage::HashLookupStage(std::unique_ptr<PlanStage> outer,
+                                 std::unique_ptr<PlanStage> inner,
+                                 value::SlotId outerKeySlot,
+                                 value::SlotId innerKeySlot,
+                                 value::SlotId innerProjectSlot,
+                                 value::SlotId outputSlot,
+                                 boost::optional<value::SlotId> collatorSlot,
+                                 PlanNodeId planNodeId)
+    : PlanStage("hash_lookup"_sd, planNodeId),
+      _outerKeySlot(outerKeySlot),
+      _innerKeySlot(innerKeySlot),
+      _innerProjectSlot(innerProjectSlot),
+      _outputSlot(outputSlot),
+      _collatorSlot(collatorSlot),
+      _approxMemoryUseInBytesBeforeRescan(
+          internalQuerySBELookupApproxMemoryUseInBytesBeforeRescan.load()) {
+    _children.emplace_back(std::move(outer));
+    _children.emplace_back(std::move(inner));
+}
+
+std::unique_ptr<PlanStage> HashLookupStage::clone() const {
+    return std::make_unique<HashLookupStage>(_children[0]->clone(),
+                                             _children[1]->clone(),
+                                             _outerKeySlot,
+                                             _innerKeySlot,
+                                             _innerProjectSlot,
+                                             _outputSlot,
+                                             _collatorSlot,
+                                             _commonStats.nodeId);
+}
+
+void HashLookupStage::prepare(CompileCtx& ctx) {
+    _children[0]->prepare(ctx);
+    _children[1]->prepare(ctx);
+
+    if (_collatorSlot) {
+        _collatorAccessor = getAccessor(ctx, *_collatorSlot);
+        tassert(5843140,
+                "collator accessor should exist if collator slot provided to HashLookupStage",
+                _collatorAccessor != nullptr);
+    }
+
+    _outerKeyAccessor = _children[0]->getAccessor(ctx, _outerKeySlot);
+    _innerKeyAccessor = _children[1]->getAccessor(ctx, _innerKeySlot);
+    _innerProjectAccessor = _children[1]->getAccessor(ctx, _innerProjectSlot);
+
+    _compiled = true;
+}
+
+value::SlotAccessor* HashLookupStage::getAccessor(CompileCtx& ctx, value::SlotId slot) {
+    if (_compiled) {
+        if (slot == _outputSlot) {
+            return &_outputAccessor;
+        }
+
+        return _children[0]->getAccessor(ctx, slot);
+    }
+
+    return ctx.getAccessor(slot);
+}
+
+std::pair<value::MaterializedRowHasher, value::MaterializedRowEq>
+HashLookupStage::makeKeyFunctions() const {
+    return {value::MaterializedRowHasher(_collator), value::MaterializedRowEq(_collator)};
+}
+
+void HashLookupStage::insertInnerKey(value::TypeTags tag, value::Value val, size_t rowIdx) {
+    value::MaterializedRow key{1};
+    if (tag == value::TypeTags::Nothing) {
+        key.reset(0, false, value::TypeTags::Null, 0);
+    } else {
+        auto [copyTag, copyVal] = value::copyValue(tag, val);
+        key.reset(0, true, copyTag, copyVal);
+    }
+    _memoryUseInBytes += key.memUsageForSorter() + sizeof(size_t);
+
+    auto& rows = (*_ht)[std::move(key)];
+    // An inner row can produce the same key several times, for example when its array contains
+    // duplicate elements, but it must be recorded only once.
+    if (rows.empty() || rows.back() != rowIdx) {
+        rows.push_back(rowIdx);
+    }
+}
+
+void HashLookupStage::probe(value::TypeTags tag, value::Value val) {
+    if (tag == value::TypeTags::Nothing) {
+        tag = value::TypeTags::Null;
+        val = 0;
+    }
+
+    _probeKey.reset(0, false, tag, val);
+    if (auto it = _ht->find(_probeKey); it != _ht->end()) {
+        _matches.insert(_matches.end(), it->second.begin(), it->second.end());
+    }
+}
+
+void HashLookupStage::insertOuterKey(value::TypeTags tag, value::Value val) {
+    if (tag == value::TypeTags::Nothing) {
+        tag = value::TypeTags::Null;
+        val = 0;
+    }
+
+    // The keys are views of the current outer row, which stays valid until they are cleared.
+    value::MaterializedRow key{1};
+    key.reset(0, false, tag, val);
+    _outerKeys->insert(std::move(key));
+}
+
+bool HashLookupStage::matchesOuterKeys(value::TypeTags tag, value::Value val) {
+    if (tag == value::TypeTags::Nothing) {
+        tag = value::TypeTags::Null;
+        val = 0;
+    }
+
+    _probeKey.reset(0, false, tag, val);
+    return _outerKeys->count(_probeKey) > 0;
+}
+
+void HashLookupStage::rescanInner() {
+    auto [resultTag, resultVal] = value::makeNewArray();
+    value::ValueGuard guard{resultTag, resultVal};
+    auto result = value::getArrayView(resultVal);
+
+    _children[1]->open(true);
+    while (_children[1]->getNext() == PlanState::ADVANCED) {
+        auto [tag, val] = _innerKeyAccessor->getViewOfValue();
+        bool matches = matchesOuterKeys(tag, val);
+        if (value::isArray(tag)) {
+            for (value::ArrayEnumerator arr{tag, val}; !matches && !arr.atEnd(); arr.advance()) {
+                auto [elemTag, elemVal] = arr.getViewOfValue();
+                matches = matchesOuterKeys(elemTag, elemVal);
+            }
+        }
+
+        if (matches) {
+            auto [projectTag, projectVal] = _innerProjectAccessor->copyOrMoveValue();
+            result->push_back(projectTag, projectVal);
+        }
+    }
+
+    guard.reset();
+    _outputAccessor.reset(true, resultTag, resultVal);
+}
+
+void HashLookupStage::open(bool reOpen) {
+    auto optTimer(getOptTimer(_opCtx));
+
+    _commonStats.opens++;
+
+    if (_collatorAccessor) {
+        auto [tag, collatorVal] = _collatorAccessor->getViewOfValue();
+        uassert(5843141, "collatorSlot must be of collator type", tag == value::TypeTags::collator);
+        _collator = value::getCollatorView(collatorVal);
+    }
+    auto [hasher, equator] = makeKeyFunctions();
+    _ht.emplace(0, hasher, equator);
+    _buffer.clear();
+    _memoryUseInBytes = 0;
+    _rescanInner = false;
+    _outerKeys = boost::none;
+
+    // Load the inner side into the hash table.
+    _children[1]->open(reOpen);
+    while (_children[1]->getNext() == PlanState::ADVANCED) {
+        const size_t rowIdx = _buffer.size();
+
+        value::MaterializedRow project{1};
+        auto [projectTag, projectVal] = _innerProjectAccessor->copyOrMoveValue();
+        project.reset(0, true, projectTag, projectVal);
+        _memoryUseInBytes += project.memUsageForSorter();
+        _buffer.emplace_back(std::move(project));
+
+        auto [tag, val] = _innerKeyAccessor->getViewOfValue();
+        insertInnerKey(tag, val, rowIdx);
+        if (value::isArray(tag)) {
+            for (value::ArrayEnumerator arr{tag, val}; !arr.atEnd(); arr.advance()) {
+                auto [elemTag, elemVal] = arr.getViewOfValue();
+                insertInnerKey(elemTag, elemVal, rowIdx);
+            }
+        }
+
+        if (_memoryUseInBytes > _approxMemoryUseInBytesBeforeRescan) {
+            // The inner side does not fit in the memory budget. Scan it again for every outer row
+            // instead, which keeps only the keys of one outer row in memory.
+            _ht = boost::none;
+            _buffer.clear();
+            _rescanInner = true;
+            _outerKeys.emplace(0, hasher, equator);
+            break;
+        }
+    }
+    if (!_rescanInner) {
+        _children[1]->close();
+    }
+
+    _children[0]->open(reOpen);
+}
+
+PlanState HashLookupStage::getNext() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    auto state = _children[0]->getNext();
+    if (state != PlanState::ADVANCED) {
+        return trackPlanState(state);
+    }
+
+    _matches.clear();
+    if (_rescanInner) {
+        _outerKeys->clear();
+    }
+    auto addOuterKey = [this](value::TypeTags tag, value::Value val) {
+        if (_rescanInner) {
+            insertOuterKey(tag, val);
+        } else {
+            probe(tag, val);
+        }
+    };
+
+    auto [tag, val] = _outerKeyAccessor->getViewOfValue();
+    if (value::isArray(tag)) {
+        value::ArrayEnumerator arr{tag, val};
+        if (arr.atEnd()) {
+            addOuterKey(value::TypeTags::Null, 0);
+        }
+        for (; !arr.atEnd(); arr.advance()) {
+            auto [elemTag, elemVal] = arr.getViewOfValue();
+            addOuterKey(elemTag, elemVal);
+        }
+    } else {
+        addOuterKey(tag, val);
+    }
+
+    if (_rescanInner) {
+        rescanInner();
+        return trackPlanState(PlanState::ADVANCED);
+    }
+
+    std::sort(_matches.begin(), _matches.end());
+    _matches.erase(std::unique(_matches.begin(), _matches.end()), _matches.end());
+
+    auto [resultTag, resultVal] = value::makeNewArray();
+    value::ValueGuard guard{resultTag, resultVal};
+    auto result = value::getArrayView(resultVal);
+    result->reserve(_matches.size());
+    for (auto rowIdx : _matches) {
+        auto [projectTag, projectVal] = _buffer[rowIdx].getViewOfValue(0);
+        auto [copyTag, copyVal] = value::copyValue(projectTag, projectVal);
+        result->push_back(copyTag, copyVal);
+    }
+    guard.reset();
+    _outputAccessor.reset(true, resultTag, resultVal);
+
+    return trackPlanState(PlanState::ADVANCED);
+}
+
+void HashLookupStage::close() {
+    auto optTimer(getOptTimer(_opCtx));
+
+    _commonStats.closes++;
+    _children[0]->close();
+    if (_rescanInner) {
+        _children[1]->close();
+        _rescanInner = false;
+    }
+    _ht = boost::none;
+    _buffer.clear();
+    _outerKeys = boost::none;
+    _outputAccessor.reset();
+}
+
+std::unique_ptr<PlanStageStats> HashLookupStage::getStats(bool includeDebugInfo) const {
+    auto ret = std::make_unique<PlanStageStats>(_commonStats);
+
+    if (includeDebugInfo) {
+        BSONObjBuilder bob;
+        bob.appendNumber("outerKeySlot", static_cast<long long>(_outerKeySlot));
+        bob.appendNumber("innerKeySlot", static_cast<long long>(_innerKeySlot));
+        bob.appendNumber("innerProjectSlot", static_cast<long long>(_innerProjectSlot));
+        bob.appendNumber("outputSlot", static_cast<long long>(_outputSlot));
+        ret->debugInfo = bob.obj();
+    }
+
+    ret->children.emplace_back(_children[0]->getStats(includeDebugInfo));
+    ret->children.emplace_back(_children[1]->getStats(includeDebugInfo));
+    return ret;
+}
+
+const SpecificStats* HashLookupStage::getSpecificStats() const {
+    return nullptr;
+}
+
+std::vector<DebugPrinter::Block> HashLookupStage::debugPrint() const {
+    auto ret = PlanStage::debugPrint();
+
+    DebugPrinter::addIdentifier(ret, _outputSlot);
+
+    ret.emplace_back(DebugPrinter::Block::cmdIncIndent);
+
+    DebugPrinter::addKeyword(ret, "outer");
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    DebugPrinter::addIdentifier(ret, _outerKeySlot);
+    ret.emplace_back(DebugPrinter::Block("`]"));
+    ret.emplace_back(DebugPrinter::Block::cmdIncIndent);
+    DebugPrinter::addBlocks(ret, _children[0]->debugPrint());
+    ret.emplace_back(DebugPrinter::Block::cmdDecIndent);
+
+    DebugPrinter::addKeyword(ret, "inner");
+    ret.emplace_back(DebugPrinter::Block("[`"));
+    DebugPrinter::addIdentifier(ret, _innerKeySlot);
+    ret.emplace_back(DebugPrinter::Block("`,"));
+    DebugPrinter::addIdentifier(ret, _innerProjectSlot);
+    ret.emplace_back(DebugPrinter::Block("`]"));
+    ret.emplace_back(DebugPrinter::Block::cmdIncIndent);
+    DebugPrinter::addBlocks(ret, _children[1]->debugPrint());
+    ret.emplace_back(DebugPrinter::Block::cmdDecIndent);
+
+    ret.emplace_back(DebugPrinter::Block::cmdDecIndent);
+
+    return ret;
+}
+}  // namespace mongo::sbe
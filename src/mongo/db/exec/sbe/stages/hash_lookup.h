@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <unordered_set>
+#include <vector>
+
+#include "mongo/db/exec/sbe/stages/stages.h"
+#include "mongo/db/exec/sbe/vm/vm.h"
+
+namespace mongo::sbe {
+/**
+ * Implements the local/foreign field join of $lookup. The rows of the 'inner' child are loaded
+ * into a hash table keyed by the value in 'innerKeySlot'. Then, for each row of the 'outer' child,
+ * the stage collects the 'innerProjectSlot' values of all the matching inner rows into an array
+ * which is exposed through 'outputSlot'. Outer rows without matches get an empty array, so every
+ * outer row is returned exactly once and in its original order.
+ *
+ * Keys are matched the way {<foreignField>: {$in: <local values>}} would match:
+ *   - an array in 'outerKeySlot' is a list of keys to look up, and a missing value or an empty
+ *     array looks up null;
+ *   - an array in 'innerKeySlot' is matched both as a whole and by each of its elements, and a
+ *     missing value is matched as null;
+ *   - any other key only matches an equal key, so that a regular expression from the outer side
+ *     only matches an identical regular expression, as it would under $eq.
+ * Matching inner rows are returned in the order in which the 'inner' child produced them, and each
+ * of them at most once per outer row.
+ *
+ * The hash table is kept in memory as long as its approximate size does not exceed
+ * 'internalQuerySBELookupApproxMemoryUseInBytesBeforeRescan'. Past that, the table is dropped and
+ * the 'inner' child is instead reopened for every outer row, and its rows are matched against the
+ * keys of that outer row.
+ *
+ * Only the slots of the 'outer' child and 'outputSlot' are visible to the parent stage.
+ */
+class HashLookupStage final : public PlanStage {
+public:
+    HashLookupStage(std::unique_ptr<PlanStage> outer,
+                    std::unique_ptr<PlanStage> inner,
+                    value::SlotId outerKeySlot,
+                    value::SlotId innerKeySlot,
+                    value::SlotId innerProjectSlot,
+                    value::SlotId outputSlot,
+                    boost::optional<value::SlotId> collatorSlot,
+                    PlanNodeId planNodeId);
+
+    std::unique_ptr<PlanStage> clone() const final;
+
+    void prepare(CompileCtx& ctx) final;
+    value::SlotAccessor* getAccessor(CompileCtx& ctx, value::SlotId slot) final;
+    void open(bool reOpen) final;
+    PlanState getNext() final;
+    void close() final;
+
+    std::unique_ptr<PlanStageStats> getStats(bool includeDebugInfo) const final;
+    const SpecificStats* getSpecificStats() const final;
+    std::vector<DebugPrinter::Block> debugPrint() const final;
+
+private:
+    using TableType = std::unordered_map<value::MaterializedRow,  // NOLINT
+                                         std::vector<size_t>,
+                                         value::MaterializedRowHasher,
+                                         value::MaterializedRowEq>;
+
+    using KeySetType = std::unordered_set<value::MaterializedRow,  // NOLINT
+                                          value::MaterializedRowHasher,
+                                          value::MaterializedRowEq>;
+
+    /**
+     * Returns a hasher and an equality predicate honoring '_collator'.
+     */
+    std::pair<value::MaterializedRowHasher, value::MaterializedRowEq> makeKeyFunctions() const;
+
+    /**
+     * Adds 'key' to the hash table as a key of the inner row stored at 'rowIdx' in '_buffer'.
+     */
+    void insertInnerKey(value::TypeTags tag, value::Value val, size_t rowIdx);
+
+    /**
+     * Appends the '_buffer' indexes of the inner rows matching the outer key 'tag'/'val' to
+     * '_matches'.
+     */
+    void probe(value::TypeTags tag, value::Value val);
+
+    /**
+     * Adds 'key' to '_outerKeys', once the hash table has been dropped.
+     */
+    void insertOuterKey(value::TypeTags tag, value::Value val);
+
+    /**
+     * Returns true if the inner key 'tag'/'val' matches one of the keys in '_outerKeys'.
+     */
+    bool matchesOuterKeys(value::TypeTags tag, value::Value val);
+
+    /**
+     * Produces the output array of the current outer row by scanning the 'inner' child again.
+     */
+    void rescanInner();
+
+    const value::SlotId _outerKeySlot;
+    const value::SlotId _innerKeySlot;
+    const value::SlotId _innerProjectSlot;
+    const value::SlotId _outputSlot;
+    const boost::optional<value::SlotId> _collatorSlot;
+
+    value::SlotAccessor* _outerKeyAccessor{nullptr};
+    value::SlotAccessor* _innerKeyAccessor{nullptr};
+    value::SlotAccessor* _innerProjectAccessor{nullptr};
+    value::SlotAccessor* _collatorAccessor{nullptr};
+
+    value::OwnedValueAccessor _outputAccessor;
+
+    // The 'innerProjectSlot' values of all the inner rows, in the order they were read.
+    std::vector<value::MaterializedRow> _buffer;
+
+    // Maps every key of the inner side to the '_buffer' indexes of the rows having that key.
+    boost::optional<TableType> _ht;
+
+    // Key used to probe inside the hash table.
+    value::MaterializedRow _probeKey{1};
+
+    // Indexes of the inner rows matching the current outer row. Kept here to avoid repeated
+    // allocations.
+    std::vector<size_t> _matches;
+
+    // Memory budget of the hash table, initialized from the query knob on construction.
+    const long long _approxMemoryUseInBytesBeforeRescan;
+    long long _memoryUseInBytes{0};
+
+    // Set once the hash table has been dropped for exceeding its memory budget. The keys of the
+    // current outer row are then collected into '_outerKeys' instead.
+    bool _rescanInner{false};
+    boost::optional<KeySetType> _outerKeys;
+
+    CollatorInterface* _collator{nullptr};
+
+    bool _compiled{false};
+};
+}  // namespace mongo::sbe
@@ -182,6 +182,29 @@ struct LoopJoinStats final : public SpecificStats {
     size_t innerCloses{0};
 };
 
+struct HashJoinStats : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<HashJoinStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    void accumulate(PlanSummaryStats& summary) const final {
+        if (usedDisk) {
+            summary.usedDisk = true;
+        }
+    }
+
+    // Whether the hash table exceeded its memory budget and partitions were moved to disk.
+    bool usedDisk{false};
+    // The number of partitions which were spilled to disk.
+    size_t spills{0};
+    // The number of outer and inner rows written to disk.
+    size_t spilledRecords{0};
+};
+
 struct TraverseStats : public SpecificStats {
     std::unique_ptr<SpecificStats> clone() const final {
         return std::make_unique<TraverseStats>(*this);
@@ -195,6 +218,29 @@ struct TraverseStats : public SpecificStats {
     size_t innerCloses{0};
 };
 
+struct HashAggStats : public SpecificStats {
+    std::unique_ptr<SpecificStats> clone() const final {
+        return std::make_unique<HashAggStats>(*this);
+    }
+
+    uint64_t estimateObjectSizeInBytes() const final {
+        return sizeof(*this);
+    }
+
+    void accumulate(PlanSummaryStats& summary) const final {
+        if (usedDisk) {
+            summary.usedDisk = true;
+        }
+    }
+
+    // Whether the hash table exceeded its memory budget and had to be written to disk.
+    bool usedDisk{false};
+    // The number of times the hash table was spilled to disk.
+    size_t spills{0};
+    // The total number of groups written to disk, counted once per spill.
+    size_t spilledRecords{0};
+};
+
 /**
  * Calculates the total number of physical reads in the given plan stats tree. If a stage can do
  * a physical read (e.g. COLLSCAN or IXSCAN), then its 'numReads' stats is added to the total.
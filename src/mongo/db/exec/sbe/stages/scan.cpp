@@ -651,14 +651,16 @@ void ParallelScanStage::open(bool reOpen) {
             stdx::unique_lock lock(_state->mutex);
             if (_state->ranges.empty()) {
                 auto ranges = collection->getRecordStore()->numRecords(_opCtx) / 10240;
-                if (ranges < 2) {
+                // The ranges are sampled with a random cursor, which not all record stores have.
+                auto randomCursor = ranges < 2
+                    ? nullptr
+                    : collection->getRecordStore()->getRandomCursor(_opCtx);
+                if (!randomCursor) {
                     _state->ranges.emplace_back(Range{RecordId{}, RecordId{}});
                 } else {
                     if (ranges > 1024) {
                         ranges = 1024;
                     }
-                    auto randomCursor = collection->getRecordStore()->getRandomCursor(_opCtx);
-                    invariant(randomCursor);
                     std::set<RecordId> rids;
                     while (ranges--) {
                         auto nextRecord = randomCursor->next();
@@ -688,7 +690,20 @@ boost::optional<Record> ParallelScanStage::nextRange() {
     if (_currentRange < _state->ranges.size()) {
         _range = _state->ranges[_currentRange];
 
-        return _range.begin.isNull() ? _cursor->next() : _cursor->seekExact(_range.begin);
+        // Only the first range starts at the beginning of the collection, and it is always
+        // scanned by a fresh cursor.
+        if (_range.begin.isNull()) {
+            return _cursor->next();
+        }
+
+        // The record the range starts at may have been deleted since the ranges were sampled, so
+        // position on the first record at or after it. A forward 'seekNear()' lands on the closest
+        // record before the start if there is no exact match.
+        auto nextRecord = _cursor->seekNear(_range.begin);
+        if (nextRecord && nextRecord->id < _range.begin) {
+            nextRecord = _cursor->next();
+        }
+        return nextRecord;
     } else {
         return boost::none;
     }
@@ -725,7 +740,9 @@ PlanState ParallelScanStage::getNext() {
             return trackPlanState(PlanState::IS_EOF);
         }
 
-        if (!_range.end.isNull() && nextRecord->id == _range.end) {
+        // The range ends right before the start of the next range, whether or not the record the
+        // next range starts at still exists.
+        if (!_range.end.isNull() && nextRecord->id >= _range.end) {
             setNeedsRange();
             nextRecord = boost::none;
             continue;
@@ -60,6 +60,11 @@ void UniqueStage::open(bool reOpen) {
 
     ++_commonStats.opens;
     _children[0]->open(reOpen);
+    // A re-opened child produces a new stream of rows, which is deduplicated independently of the
+    // previous one.
+    if (reOpen) {
+        _seen.clear();
+    }
 }
 
 PlanState UniqueStage::getNext() {
@@ -536,6 +536,16 @@ public:
         return {_typeTags[idx], _values[idx]};
     }
 
+    /**
+     * Replaces the element at 'idx', taking ownership of the new value and releasing the old one.
+     */
+    void setAt(std::size_t idx, TypeTags tag, Value val) {
+        invariant(idx < _values.size() && tag != TypeTags::Nothing);
+        releaseValue(_typeTags[idx], _values[idx]);
+        _typeTags[idx] = tag;
+        _values[idx] = val;
+    }
+
     void reserve(size_t s) {
         // Normalize to at least 1.
         s = s ? s : 1;
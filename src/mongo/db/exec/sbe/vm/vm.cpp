@@ -987,6 +987,57 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinNewKeyString(Ar
             value::bitcastFrom<KeyString::Value*>(new KeyString::Value(kb.release()))};
 }
 
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinNewKeyStringFromValue(
+    ArityType arity) {
+    invariant(arity == 4);
+
+    auto [_, tagInVersion, valInVersion] = getFromStack(0);
+    if (!value::isNumber(tagInVersion) ||
+        !(value::numericCast<int64_t>(tagInVersion, valInVersion) == 0 ||
+          value::numericCast<int64_t>(tagInVersion, valInVersion) == 1)) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+    KeyString::Version version =
+        static_cast<KeyString::Version>(value::numericCast<int64_t>(tagInVersion, valInVersion));
+
+    auto [__, tagInOrdering, valInOrdering] = getFromStack(1);
+    if (!value::isNumber(tagInOrdering)) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+    auto orderingBits = value::numericCast<int32_t>(tagInOrdering, valInOrdering);
+    BSONObjBuilder orderingBob;
+    for (size_t i = 0; i < Ordering::kMaxCompoundIndexKeys; ++i) {
+        orderingBob.append(""_sd, (orderingBits & (1 << i)) ? 1 : 0);
+    }
+
+    auto [___, tag, val] = getFromStack(2);
+    if (tag == value::TypeTags::Nothing) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    auto [____, tagInDiscrim, valInDiscrim] = getFromStack(3);
+    if (!value::isNumber(tagInDiscrim)) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+    auto discrimNum = value::numericCast<int64_t>(tagInDiscrim, valInDiscrim);
+    if (discrimNum < 0 || discrimNum > 2) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    // Unlike 'ks', which only accepts integers and strings, the value is converted through BSON so
+    // that the resulting key compares exactly like the key an index would store for it.
+    BSONObjBuilder bob;
+    bson::appendValueToBsonObj(bob, ""_sd, tag, val);
+    KeyString::HeapBuilder kb{version,
+                              bob.done(),
+                              Ordering::make(orderingBob.done()),
+                              static_cast<KeyString::Discriminator>(discrimNum)};
+
+    return {true,
+            value::TypeTags::ksValue,
+            value::bitcastFrom<KeyString::Value*>(new KeyString::Value(kb.release()))};
+}
+
 std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinAbs(ArityType arity) {
     invariant(arity == 1);
 
@@ -1294,6 +1345,253 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinDoubleDoubleSum
     return {false, value::TypeTags::Nothing, 0};
 }
 
+namespace {
+/**
+ * The partial result of the 'aggDoubleDoubleSum' aggregate is an array laid out as below. Together
+ * the elements hold the same state as the classic AccumulatorSum, so that the final result gets
+ * the same type and precision.
+ */
+enum class AggSumValueElems : size_t {
+    // The widest numeric type of the inputs, stored as a NumberInt32 holding a TypeTags value.
+    kNonDecimalTotalTag,
+    // The two doubles of the double-double sum of the non-decimal inputs.
+    kNonDecimalTotalSum,
+    kNonDecimalTotalAddend,
+    // The sum of the decimal inputs. Only present once a decimal input has been seen.
+    kDecimalTotal,
+};
+
+std::pair<value::TypeTags, value::Value> getSumElem(const value::Array* arr,
+                                                   AggSumValueElems elem) {
+    return arr->getAt(static_cast<size_t>(elem));
+}
+
+/**
+ * The unpacked form of the 'aggDoubleDoubleSum' partial result.
+ */
+struct DoubleDoubleSumState {
+    static DoubleDoubleSumState read(value::TypeTags tag, value::Value val) {
+        invariant(tag == value::TypeTags::Array);
+        auto arr = value::getArrayView(val);
+
+        auto [totalTagTag, totalTagVal] = getSumElem(arr, AggSumValueElems::kNonDecimalTotalTag);
+        auto [sumTag, sumVal] = getSumElem(arr, AggSumValueElems::kNonDecimalTotalSum);
+        auto [addendTag, addendVal] = getSumElem(arr, AggSumValueElems::kNonDecimalTotalAddend);
+        invariant(totalTagTag == value::TypeTags::NumberInt32 &&
+                  sumTag == value::TypeTags::NumberDouble &&
+                  addendTag == value::TypeTags::NumberDouble);
+
+        DoubleDoubleSumState state;
+        state.totalTag = static_cast<value::TypeTags>(value::bitcastTo<int32_t>(totalTagVal));
+        state.nonDecimalTotal = DoubleDoubleSummation::create(value::bitcastTo<double>(sumVal),
+                                                              value::bitcastTo<double>(addendVal));
+        auto [decimalTag, decimalVal] = getSumElem(arr, AggSumValueElems::kDecimalTotal);
+        if (decimalTag == value::TypeTags::NumberDecimal) {
+            state.decimalTotal = value::bitcastTo<Decimal128>(decimalVal);
+        }
+        return state;
+    }
+
+    /**
+     * Stores the state into 'arr', which is either empty or holds a previous state.
+     */
+    void write(value::Array* arr) const {
+        auto set = [arr](AggSumValueElems elem, value::TypeTags tag, value::Value val) {
+            auto idx = static_cast<size_t>(elem);
+            if (idx < arr->size()) {
+                arr->setAt(idx, tag, val);
+            } else {
+                invariant(idx == arr->size());
+                arr->push_back(tag, val);
+            }
+        };
+
+        auto [sum, addend] = nonDecimalTotal.getDoubleDouble();
+        set(AggSumValueElems::kNonDecimalTotalTag,
+            value::TypeTags::NumberInt32,
+            value::bitcastFrom<int32_t>(static_cast<int32_t>(totalTag)));
+        set(AggSumValueElems::kNonDecimalTotalSum,
+            value::TypeTags::NumberDouble,
+            value::bitcastFrom<double>(sum));
+        set(AggSumValueElems::kNonDecimalTotalAddend,
+            value::TypeTags::NumberDouble,
+            value::bitcastFrom<double>(addend));
+        if (decimalTotal) {
+            auto [tag, val] = value::makeCopyDecimal(*decimalTotal);
+            set(AggSumValueElems::kDecimalTotal, tag, val);
+        }
+    }
+
+    void add(value::TypeTags tag, value::Value val) {
+        totalTag = value::getWidestNumericalType(totalTag, tag);
+        switch (tag) {
+            case value::TypeTags::NumberInt32:
+                nonDecimalTotal.addInt(value::bitcastTo<int32_t>(val));
+                break;
+            case value::TypeTags::NumberInt64:
+                nonDecimalTotal.addLong(value::bitcastTo<int64_t>(val));
+                break;
+            case value::TypeTags::NumberDouble:
+                nonDecimalTotal.addDouble(value::bitcastTo<double>(val));
+                break;
+            case value::TypeTags::NumberDecimal:
+                decimalTotal = decimalTotal.value_or(Decimal128{}).add(
+                    value::bitcastTo<Decimal128>(val));
+                break;
+            default:
+                MONGO_UNREACHABLE;
+        }
+    }
+
+    void merge(const DoubleDoubleSumState& other) {
+        totalTag = value::getWidestNumericalType(totalTag, other.totalTag);
+        auto [sum, addend] = other.nonDecimalTotal.getDoubleDouble();
+        nonDecimalTotal.addDouble(sum);
+        nonDecimalTotal.addDouble(addend);
+        if (other.decimalTotal) {
+            decimalTotal = decimalTotal.value_or(Decimal128{}).add(*other.decimalTotal);
+        }
+    }
+
+    Decimal128 getDecimal() const {
+        return decimalTotal.value_or(Decimal128{}).add(nonDecimalTotal.getDecimal());
+    }
+
+    value::TypeTags totalTag = value::TypeTags::NumberInt32;
+    DoubleDoubleSummation nonDecimalTotal;
+    boost::optional<Decimal128> decimalTotal;
+};
+}  // namespace
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinAggDoubleDoubleSum(
+    ArityType arity) {
+    auto [ownAgg, tagAgg, valAgg] = getFromStack(0);
+    auto [_, tagField, valField] = getFromStack(1);
+
+    // Non-numeric inputs do not take part in the sum.
+    if (!value::isNumber(tagField)) {
+        if (tagAgg == value::TypeTags::Nothing) {
+            return {false, value::TypeTags::Nothing, 0};
+        }
+        topStack(false, value::TypeTags::Nothing, 0);
+        return {ownAgg, tagAgg, valAgg};
+    }
+
+    DoubleDoubleSumState state;
+    if (tagAgg == value::TypeTags::Nothing) {
+        ownAgg = true;
+        std::tie(tagAgg, valAgg) = value::makeNewArray();
+    } else {
+        // Take ownership of the accumulator.
+        topStack(false, value::TypeTags::Nothing, 0);
+        state = DoubleDoubleSumState::read(tagAgg, valAgg);
+    }
+    value::ValueGuard guard{tagAgg, valAgg};
+    invariant(ownAgg);
+
+    state.add(tagField, valField);
+    state.write(value::getArrayView(valAgg));
+
+    guard.reset();
+    return {ownAgg, tagAgg, valAgg};
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinAggMergeDoubleDoubleSums(
+    ArityType arity) {
+    auto [ownAgg, tagAgg, valAgg] = getFromStack(0);
+    auto [_, tagField, valField] = getFromStack(1);
+
+    // The partial result of a group that saw no numeric input is Nothing.
+    if (tagField == value::TypeTags::Nothing) {
+        if (tagAgg == value::TypeTags::Nothing) {
+            return {false, value::TypeTags::Nothing, 0};
+        }
+        topStack(false, value::TypeTags::Nothing, 0);
+        return {ownAgg, tagAgg, valAgg};
+    }
+
+    DoubleDoubleSumState state;
+    if (tagAgg == value::TypeTags::Nothing) {
+        ownAgg = true;
+        std::tie(tagAgg, valAgg) = value::makeNewArray();
+    } else {
+        // Take ownership of the accumulator.
+        topStack(false, value::TypeTags::Nothing, 0);
+        state = DoubleDoubleSumState::read(tagAgg, valAgg);
+    }
+    value::ValueGuard guard{tagAgg, valAgg};
+    invariant(ownAgg);
+
+    state.merge(DoubleDoubleSumState::read(tagField, valField));
+    state.write(value::getArrayView(valAgg));
+
+    guard.reset();
+    return {ownAgg, tagAgg, valAgg};
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinDoubleDoubleSumFinalize(
+    ArityType arity) {
+    auto [_, tagState, valState] = getFromStack(0);
+    if (tagState == value::TypeTags::Nothing) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    // Pick the result type the same way as the classic $sum accumulator.
+    auto state = DoubleDoubleSumState::read(tagState, valState);
+    switch (state.totalTag) {
+        case value::TypeTags::NumberInt32:
+            if (state.nonDecimalTotal.fitsLong()) {
+                auto result = state.nonDecimalTotal.getLong();
+                if (result >= std::numeric_limits<int32_t>::min() &&
+                    result <= std::numeric_limits<int32_t>::max()) {
+                    return {false,
+                            value::TypeTags::NumberInt32,
+                            value::bitcastFrom<int32_t>(result)};
+                }
+            }
+            // Fall through to the larger type.
+        case value::TypeTags::NumberInt64:
+            if (state.nonDecimalTotal.fitsLong()) {
+                return {false,
+                        value::TypeTags::NumberInt64,
+                        value::bitcastFrom<int64_t>(state.nonDecimalTotal.getLong())};
+            }
+            // Fall through: a sum too large for a 64-bit integer is returned as a double.
+        case value::TypeTags::NumberDouble:
+            return {false,
+                    value::TypeTags::NumberDouble,
+                    value::bitcastFrom<double>(state.nonDecimalTotal.getDouble())};
+        case value::TypeTags::NumberDecimal: {
+            auto [tag, val] = value::makeCopyDecimal(state.getDecimal());
+            return {true, tag, val};
+        }
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+std::tuple<bool, value::TypeTags, value::Value> ByteCode::builtinDoubleDoubleAvgFinalize(
+    ArityType arity) {
+    auto [ownState, tagState, valState] = getFromStack(0);
+    auto [ownCount, tagCount, valCount] = getFromStack(1);
+    if (tagState == value::TypeTags::Nothing || tagCount != value::TypeTags::NumberInt64) {
+        return {false, value::TypeTags::Nothing, 0};
+    }
+
+    // As in the classic $avg accumulator, the average is a decimal if any of the inputs was a
+    // decimal and a double otherwise.
+    auto state = DoubleDoubleSumState::read(tagState, valState);
+    auto count = value::bitcastTo<int64_t>(valCount);
+    if (state.totalTag == value::TypeTags::NumberDecimal) {
+        auto [tag, val] = value::makeCopyDecimal(state.getDecimal().divide(Decimal128(count)));
+        return {true, tag, val};
+    }
+    return {false,
+            value::TypeTags::NumberDouble,
+            value::bitcastFrom<double>(state.nonDecimalTotal.getDouble() /
+                                       static_cast<double>(count))};
+}
+
 /**
  * A helper for the builtinDate method. The formal parameters yearOrWeekYear and monthOrWeek carry
  * values depending on wether the date is a year-month-day or ISOWeekYear.
@@ -3075,6 +3373,8 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::dispatchBuiltin(Builti
             return builtinKeyStringToString(arity);
         case Builtin::newKs:
             return builtinNewKeyString(arity);
+        case Builtin::newKsFromValue:
+            return builtinNewKeyStringFromValue(arity);
         case Builtin::abs:
             return builtinAbs(arity);
         case Builtin::ceil:
@@ -3099,6 +3399,14 @@ std::tuple<bool, value::TypeTags, value::Value> ByteCode::dispatchBuiltin(Builti
             return builtinCollAddToSet(arity);
         case Builtin::doubleDoubleSum:
             return builtinDoubleDoubleSum(arity);
+        case Builtin::aggDoubleDoubleSum:
+            return builtinAggDoubleDoubleSum(arity);
+        case Builtin::aggMergeDoubleDoubleSums:
+            return builtinAggMergeDoubleDoubleSums(arity);
+        case Builtin::doubleDoubleSumFinalize:
+            return builtinDoubleDoubleSumFinalize(arity);
+        case Builtin::doubleDoubleAvgFinalize:
+            return builtinDoubleDoubleAvgFinalize(arity);
         case Builtin::bitTestZero:
             return builtinBitTestZero(arity);
         case Builtin::bitTestMask:
@@ -280,6 +280,7 @@ enum class Builtin : uint8_t {
     newObj,
     ksToString,  // KeyString to string
     newKs,       // new KeyString
+    newKsFromValue,  // new KeyString holding a single value of any type
     abs,         // absolute value
     ceil,
     floor,
@@ -292,6 +293,10 @@ enum class Builtin : uint8_t {
     addToSet,         // agg function to append to a set
     collAddToSet,     // agg function to append to a set (with collation)
     doubleDoubleSum,  // special double summation
+    aggDoubleDoubleSum,        // agg function to sum numbers with double-double precision
+    aggMergeDoubleDoubleSums,  // agg function to merge partial results of aggDoubleDoubleSum
+    doubleDoubleSumFinalize,   // the $sum result of an aggDoubleDoubleSum partial result
+    doubleDoubleAvgFinalize,   // the $avg result of an aggDoubleDoubleSum partial result
     bitTestZero,      // test bitwise mask & value is zero
     bitTestMask,      // test bitwise mask & value is mask
     bitTestPosition,  // test BinData with a bit position list
@@ -692,6 +697,7 @@ private:
     std::tuple<bool, value::TypeTags, value::Value> builtinNewObj(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinKeyStringToString(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinNewKeyString(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinNewKeyStringFromValue(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinAbs(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinCeil(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinFloor(ArityType arity);
@@ -704,6 +710,13 @@ private:
     std::tuple<bool, value::TypeTags, value::Value> builtinAddToSet(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinCollAddToSet(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinDoubleDoubleSum(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinAggDoubleDoubleSum(ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinAggMergeDoubleDoubleSums(
+        ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinDoubleDoubleSumFinalize(
+        ArityType arity);
+    std::tuple<bool, value::TypeTags, value::Value> builtinDoubleDoubleAvgFinalize(
+        ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinBitTestZero(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinBitTestMask(ArityType arity);
     std::tuple<bool, value::TypeTags, value::Value> builtinBitTestPosition(ArityType arity);
@@ -33,16 +33,20 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include "mongo/base/error_codes.h"
+#include "mongo/base/init.h"
 #include "mongo/base/status.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog/index_consistency.h"
 #include "mongo/db/client.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
+#include "mongo/db/index/index_access_method_gen.h"
 #include "mongo/db/index/index_build_interceptor.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/jsobj.h"
@@ -54,6 +58,7 @@
 #include "mongo/db/storage/execution_context.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/logv2/log.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/progress_meter.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/stacktrace.h"
@@ -69,6 +74,20 @@ MONGO_FAIL_POINT_DEFINE(hangIndexBuildDuringBulkLoadPhase);
 
 namespace {
 
+// Sorts and merges the keys of index builds which use more than one sort thread. The number of
+// threads is not limited, because each index build's sorter needs to be able to run as many tasks
+// at once as it has sort threads.
+std::unique_ptr<ThreadPool> indexBuildSortThreadPool;
+MONGO_INITIALIZER(IndexBuildSortThreadPool)(InitializerContext* context) {
+    ThreadPool::Options options;
+    options.poolName = "IndexBuildSortThreadPool";
+    options.threadNamePrefix = "IndexBuildSort-";
+    options.minThreads = 0;
+    options.maxThreads = ThreadPool::Options::kUnlimited;
+    indexBuildSortThreadPool = std::make_unique<ThreadPool>(options);
+    indexBuildSortThreadPool->startup();
+}
+
 /**
  * Returns true if at least one prefix of any of the indexed fields causes the index to be
  * multikey, and returns false otherwise. This function returns false if the 'multikeyPaths'
@@ -85,7 +104,8 @@ SortOptions makeSortOptions(size_t maxMemoryUsageBytes, StringData dbName) {
         .TempDir(storageGlobalParams.dbpath + "/_tmp")
         .ExtSortAllowed()
         .MaxMemoryUsageBytes(maxMemoryUsageBytes)
-        .DBName(dbName.toString());
+        .DBName(dbName.toString())
+        .Parallelism(indexBuildSortThreadPool.get(), maxIndexBuildSortThreads.load());
 }
 
 MultikeyPaths createMultikeyPaths(const std::vector<MultikeyPath>& multikeyPathsVec) {
@@ -153,6 +173,125 @@ Status AbstractIndexAccessMethod::insert(OperationContext* opCtx,
                                             numInserted);
 }
 
+Status AbstractIndexAccessMethod::insert(OperationContext* opCtx,
+                                         const CollectionPtr& coll,
+                                         const std::vector<BsonRecord>& bsonRecords,
+                                         const InsertDeleteOptions& options,
+                                         int64_t* numInserted) {
+    invariant(options.fromIndexBuilder || !_indexCatalogEntry->isHybridBuilding());
+
+    if (numInserted) {
+        *numInserted = 0;
+    }
+
+    // The storage engine writes a batch either entirely at the documents' timestamps or entirely
+    // untimestamped. A batch mixing the two is inserted one document at a time instead, each one at
+    // its own timestamp if it has one, as are the documents of unique indexes which tolerate
+    // duplicates, as those retry each conflicting key individually.
+    const size_t numTimestamped =
+        std::count_if(bsonRecords.begin(), bsonRecords.end(), [](const BsonRecord& bsonRecord) {
+            return !bsonRecord.ts.isNull();
+        });
+    const bool mixedTimestamps = numTimestamped != 0 && numTimestamped != bsonRecords.size();
+    if ((_descriptor->unique() && options.dupsAllowed) || mixedTimestamps) {
+        for (const auto& bsonRecord : bsonRecords) {
+            if (!bsonRecord.ts.isNull()) {
+                Status status = opCtx->recoveryUnit()->setTimestamp(bsonRecord.ts);
+                if (!status.isOK())
+                    return status;
+            }
+
+            int64_t inserted = 0;
+            Status status = insert(
+                opCtx, coll, *bsonRecord.docPtr, bsonRecord.id, options, nullptr, &inserted);
+            if (!status.isOK())
+                return status;
+            if (numInserted) {
+                *numInserted += inserted;
+            }
+        }
+        return Status::OK();
+    }
+
+    auto& executionCtx = StorageExecutionContext::get(opCtx);
+
+    // Each key is written at the timestamp of the document it was generated from. Replicated
+    // inserts usually carry a distinct timestamp per document, so the keys of the whole batch are
+    // sorted together and the storage engine switches the write timestamp as it goes, rather than
+    // the batch being split wherever the timestamp changes.
+    std::vector<std::pair<KeyString::Value, Timestamp>> timestampedKeys;
+    std::vector<std::tuple<KeyStringSet, MultikeyPaths, Timestamp>> multikeyUpdates;
+    for (const auto& bsonRecord : bsonRecords) {
+        invariant(bsonRecord.id != RecordId());
+
+        auto docKeys = executionCtx.keys();
+        auto multikeyMetadataKeys = executionCtx.multikeyMetadataKeys();
+        auto multikeyPaths = executionCtx.multikeyPaths();
+
+        getKeys(executionCtx.pooledBufferBuilder(),
+                *bsonRecord.docPtr,
+                options.getKeysMode,
+                GetKeysContext::kAddingKeys,
+                docKeys.get(),
+                multikeyMetadataKeys.get(),
+                multikeyPaths.get(),
+                bsonRecord.id,
+                kNoopOnSuppressedErrorFn);
+
+        for (const auto& key : *docKeys) {
+            timestampedKeys.emplace_back(key, bsonRecord.ts);
+        }
+        if (shouldMarkIndexAsMultikey(docKeys->size(), *multikeyMetadataKeys, *multikeyPaths)) {
+            multikeyUpdates.emplace_back(*multikeyMetadataKeys, *multikeyPaths, bsonRecord.ts);
+        }
+    }
+
+    // The index is marked multikey at the timestamp of the first document that makes it so, so
+    // that no reader sees a multikey key in an index that is not yet marked multikey.
+    for (const auto& [metadataKeys, paths, ts] : multikeyUpdates) {
+        if (!ts.isNull()) {
+            Status status = opCtx->recoveryUnit()->setTimestamp(ts);
+            if (!status.isOK())
+                return status;
+        }
+        _indexCatalogEntry->setMultikey(opCtx, coll, metadataKeys, paths);
+        if (numInserted) {
+            *numInserted += metadataKeys.size();
+        }
+    }
+
+    // Every KeyString ends with its RecordId, so keys from different documents never compare
+    // equal and sorting yields the order in which they are laid out in the index.
+    std::sort(timestampedKeys.begin(),
+              timestampedKeys.end(),
+              [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+    std::vector<KeyString::Value> keys;
+    std::vector<Timestamp> timestamps;
+    keys.reserve(timestampedKeys.size());
+    for (auto& [key, ts] : timestampedKeys) {
+        keys.push_back(std::move(key));
+        if (!ts.isNull()) {
+            timestamps.push_back(ts);
+        }
+    }
+    invariant(timestamps.empty() || timestamps.size() == keys.size());
+
+    Status status = _newInterface->insertBatch(opCtx, keys, !_descriptor->unique(), timestamps);
+    if (!status.isOK())
+        return status;
+    if (numInserted) {
+        *numInserted += keys.size();
+    }
+
+    // Leave the recovery unit at the timestamp of the last document, as inserting the documents
+    // one at a time would.
+    if (!bsonRecords.empty() && !bsonRecords.back().ts.isNull()) {
+        return opCtx->recoveryUnit()->setTimestamp(bsonRecords.back().ts);
+    }
+    return Status::OK();
+}
+
 Status AbstractIndexAccessMethod::insertKeysAndUpdateMultikeyPaths(
     OperationContext* opCtx,
     const CollectionPtr& coll,
@@ -47,6 +47,7 @@ namespace mongo {
 
 class BSONObjBuilder;
 class MatchExpression;
+struct BsonRecord;
 struct UpdateTicket;
 struct InsertDeleteOptions;
 
@@ -94,6 +95,21 @@ public:
                           KeyHandlerFn&& onDuplicateKey,
                           int64_t* numInserted) = 0;
 
+    /**
+     * Internally generate the keys for each document in 'bsonRecords' and insert them into the
+     * index, updating the multikey state as the single-document insert() would. The keys of all
+     * documents are sorted and inserted together, each at its document's timestamp, so that the
+     * storage engine can insert them in key order with a single cursor. If only some of the
+     * documents have a timestamp, they are inserted one at a time instead.
+     *
+     * If 'numInserted' is not null, it will be set to the number of keys added to the index.
+     */
+    virtual Status insert(OperationContext* opCtx,
+                          const CollectionPtr& coll,
+                          const std::vector<BsonRecord>& bsonRecords,
+                          const InsertDeleteOptions& options,
+                          int64_t* numInserted) = 0;
+
     /**
      * Inserts the specified keys into the index. and determines whether these keys should cause the
      * index to become multikey. If so, this method also handles the task of marking the index as
@@ -465,6 +481,12 @@ public:
                   KeyHandlerFn&& onDuplicateKey,
                   int64_t* numInserted) final;
 
+    Status insert(OperationContext* opCtx,
+                  const CollectionPtr& coll,
+                  const std::vector<BsonRecord>& bsonRecords,
+                  const InsertDeleteOptions& options,
+                  int64_t* numInserted) final;
+
     Status insertKeys(OperationContext* opCtx,
                       const CollectionPtr& coll,
                       const KeyStringSet& keys,
@@ -168,6 +168,7 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/db/storage/storage_parameters_gen.h"
 #include "mongo/db/system_index.h"
+#include "mongo/db/timeseries/periodic_runner_job_compress_closed_buckets.h"
 #include "mongo/db/transaction_participant.h"
 #include "mongo/db/ttl.h"
 #include "mongo/db/vector_clock_metadata_hook.h"
@@ -719,13 +720,15 @@ ExitCode _initAndListen(ServiceContext* serviceContext, int listenPort) {
 
     // Start up a background task to periodically check for and kill expired transactions; and a
     // background task to periodically check for and decrease cache pressure by decreasing the
-    // target size setting for the storage engine's window of available snapshots.
+    // target size setting for the storage engine's window of available snapshots. A third one
+    // compresses the time-series buckets closed by inserts.
     //
     // Only do this on storage engines supporting snapshot reads, which hold resources we wish to
     // release periodically in order to avoid storage cache pressure build up.
     if (storageEngine->supportsReadConcernSnapshot()) {
         try {
             PeriodicThreadToAbortExpiredTransactions::get(serviceContext)->start();
+            PeriodicThreadToCompressClosedBuckets::get(serviceContext)->start();
         } catch (ExceptionFor<ErrorCodes::PeriodicJobIsStopped>&) {
             LOGV2_WARNING(4747501, "Not starting periodic jobs as shutdown is in progress");
             // Shutdown has already started before initialization is complete. Wait for the
@@ -1182,6 +1185,9 @@ void shutdownTask(const ShutdownTaskArgs& shutdownArgs) {
         if (storageEngine->supportsReadConcernSnapshot()) {
             LOGV2(4784908, "Shutting down the PeriodicThreadToAbortExpiredTransactions");
             PeriodicThreadToAbortExpiredTransactions::get(serviceContext)->stop();
+
+            LOGV2(5640102, "Shutting down the PeriodicThreadToCompressClosedBuckets");
+            PeriodicThreadToCompressClosedBuckets::get(serviceContext)->stop();
         }
 
         ServiceContext::UniqueOperationContext uniqueOpCtx;
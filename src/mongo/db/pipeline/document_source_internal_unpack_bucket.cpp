@@ -32,6 +32,7 @@
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 
 #include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
@@ -431,15 +432,20 @@ DocumentSource::GetNextResult DocumentSourceInternalUnpackBucket::doGetNext() {
     }
 
     auto nextResult = pSource->getNext();
-    if (nextResult.isAdvanced()) {
+    while (nextResult.isAdvanced()) {
         auto bucket = nextResult.getDocument().toBson();
         _bucketUnpacker.reset(std::move(bucket));
+        if (_bucketUnpacker.hasNext()) {
+            return _bucketUnpacker.getNext();
+        }
+
+        // Unless the column predicates rejected every measurement, the bucket is empty.
         uassert(5346509,
                 str::stream() << "A bucket with _id "
                               << _bucketUnpacker.bucket()[timeseries::kBucketIdFieldName].toString()
                               << " contains an empty data region",
-                _bucketUnpacker.hasNext());
-        return _bucketUnpacker.getNext();
+                _bucketUnpacker.numberOfMeasurements() > 0);
+        nextResult = pSource->getNext();
     }
 
     return nextResult;
@@ -640,6 +646,40 @@ std::unique_ptr<MatchExpression> createComparisonPredicate(
     MONGO_UNREACHABLE_TASSERT(5348303);
 }
 
+/**
+ * Maps an $in on a measurement field to predicates on the control field that select the buckets
+ * whose range of values overlaps the range of the $in's values. For example, the predicate
+ * {a: {$in: [3, 1, 2]}} will generate the predicate
+ * {$and: [{control.max.a: {$_internalExprGte: 1}}, {control.min.a: {$_internalExprLte: 3}}]}.
+ */
+std::unique_ptr<MatchExpression> createInPredicate(const InMatchExpression* matchExpr,
+                                                   const BucketSpec& bucketSpec,
+                                                   int bucketMaxSpanSeconds) {
+    // The range of values is only meaningful if all of them are of the same canonical type, and
+    // regexes and nulls are excluded for the same reasons as for comparisons.
+    auto&& equalities = matchExpr->getEqualities();
+    if (equalities.empty() || !matchExpr->getRegexes().empty() || matchExpr->hasNull() ||
+        std::any_of(equalities.begin(), equalities.end(), [&](auto&& elem) {
+            return elem.canonicalType() != equalities.front().canonicalType();
+        })) {
+        return nullptr;
+    }
+
+    // The equalities are sorted, so the first and last ones bound the range of values.
+    GTEMatchExpression lowerBound{matchExpr->path(), equalities.front()};
+    LTEMatchExpression upperBound{matchExpr->path(), equalities.back()};
+    auto lowerPredicate = createComparisonPredicate(&lowerBound, bucketSpec, bucketMaxSpanSeconds);
+    auto upperPredicate = createComparisonPredicate(&upperBound, bucketSpec, bucketMaxSpanSeconds);
+    if (!lowerPredicate || !upperPredicate) {
+        return nullptr;
+    }
+
+    auto andMatchExpr = std::make_unique<AndMatchExpression>();
+    andMatchExpr->add(std::move(lowerPredicate));
+    andMatchExpr->add(std::move(upperPredicate));
+    return andMatchExpr;
+}
+
 std::unique_ptr<MatchExpression>
 DocumentSourceInternalUnpackBucket::createPredicatesOnBucketLevelField(
     const MatchExpression* matchExpr) const {
@@ -655,6 +695,26 @@ DocumentSourceInternalUnpackBucket::createPredicatesOnBucketLevelField(
         if (andMatchExpr->numChildren() > 0) {
             return andMatchExpr;
         }
+    } else if (matchExpr->matchType() == MatchExpression::OR) {
+        // A bucket can only be skipped if it can be skipped for every branch of the $or, so every
+        // branch must have a predicate on the bucket level fields.
+        auto nextOr = static_cast<const OrMatchExpression*>(matchExpr);
+        auto orMatchExpr = std::make_unique<OrMatchExpression>();
+
+        for (size_t i = 0; i < nextOr->numChildren(); i++) {
+            auto child = createPredicatesOnBucketLevelField(nextOr->getChild(i));
+            if (!child) {
+                return nullptr;
+            }
+            orMatchExpr->add(std::move(child));
+        }
+        if (orMatchExpr->numChildren() > 0) {
+            return orMatchExpr;
+        }
+    } else if (matchExpr->matchType() == MatchExpression::MATCH_IN) {
+        return createInPredicate(static_cast<const InMatchExpression*>(matchExpr),
+                                 _bucketUnpacker.bucketSpec(),
+                                 _bucketMaxSpanSeconds);
     } else if (ComparisonMatchExpression::isComparisonMatchExpression(matchExpr)) {
         return createComparisonPredicate(static_cast<const ComparisonMatchExpression*>(matchExpr),
                                          _bucketUnpacker.bucketSpec(),
@@ -664,6 +724,77 @@ DocumentSourceInternalUnpackBucket::createPredicatesOnBucketLevelField(
     return nullptr;
 }
 
+std::vector<BucketColumnPredicate> DocumentSourceInternalUnpackBucket::createColumnPredicates(
+    const MatchExpression* matchExpr) const {
+    std::vector<BucketColumnPredicate> predicates;
+    if (matchExpr->matchType() == MatchExpression::AND) {
+        for (size_t i = 0; i < matchExpr->numChildren(); i++) {
+            auto childPredicates = createColumnPredicates(matchExpr->getChild(i));
+            std::move(childPredicates.begin(),
+                      childPredicates.end(),
+                      std::back_inserter(predicates));
+        }
+        return predicates;
+    }
+
+    if (!ComparisonMatchExpression::isComparisonMatchExpression(matchExpr)) {
+        return predicates;
+    }
+
+    auto op = [&]() -> boost::optional<BucketColumnPredicate::Op> {
+        switch (matchExpr->matchType()) {
+            case MatchExpression::EQ:
+                return BucketColumnPredicate::Op::kEq;
+            case MatchExpression::LT:
+                return BucketColumnPredicate::Op::kLt;
+            case MatchExpression::LTE:
+                return BucketColumnPredicate::Op::kLte;
+            case MatchExpression::GT:
+                return BucketColumnPredicate::Op::kGt;
+            case MatchExpression::GTE:
+                return BucketColumnPredicate::Op::kGte;
+            default:
+                return boost::none;
+        }
+    }();
+    if (!op) {
+        return predicates;
+    }
+
+    // Only top-level measurement fields are stored as columns of the bucket.
+    auto&& bucketSpec = _bucketUnpacker.bucketSpec();
+    auto path = matchExpr->path();
+    if (path.empty() || path.find('.') != std::string::npos ||
+        (bucketSpec.metaField && path == *bucketSpec.metaField) ||
+        fieldIsComputed(bucketSpec, path.toString())) {
+        return predicates;
+    }
+
+    // The column kernels compare numbers as doubles, so only constants which are exactly
+    // representable as one can be evaluated over the columns.
+    auto rhs = static_cast<const ComparisonMatchExpression*>(matchExpr)->getData();
+    switch (rhs.type()) {
+        case NumberInt:
+        case Date:
+            break;
+        case NumberLong:
+            if (std::abs(static_cast<double>(rhs._numberLong())) > static_cast<double>(1LL << 53)) {
+                return predicates;
+            }
+            break;
+        case NumberDouble:
+            if (std::isnan(rhs._numberDouble())) {
+                return predicates;
+            }
+            break;
+        default:
+            return predicates;
+    }
+
+    predicates.push_back({path.toString(), *op, Value{rhs}});
+    return predicates;
+}
+
 std::pair<boost::intrusive_ptr<DocumentSourceMatch>, boost::intrusive_ptr<DocumentSourceMatch>>
 DocumentSourceInternalUnpackBucket::splitMatchOnMetaAndRename(
     boost::intrusive_ptr<DocumentSourceMatch> match) {
@@ -883,6 +1014,16 @@ Pipeline::SourceContainer::iterator DocumentSourceInternalUnpackBucket::doOptimi
         }
     }
 
+    // Let the unpacker evaluate the comparisons of the following $match over the columns of each
+    // bucket, so that measurements which cannot match are never materialized. The $match stays in
+    // place to evaluate the full predicate on the measurements which are unpacked.
+    if (auto nextMatch = dynamic_cast<DocumentSourceMatch*>(std::next(itr)->get());
+        nextMatch && !_sampleSize && !_triedColumnPredicatesPushdown) {
+        _triedColumnPredicatesPushdown = true;
+        _bucketUnpacker.setColumnPredicates(
+            createColumnPredicates(nextMatch->getMatchExpression()));
+    }
+
     // Attempt to push down a $project on the metaField past $_internalUnpackBucket.
     if (!haveComputedMetaField) {
         if (auto [metaProject, deleteRemainder] = extractProjectForPushDown(std::next(itr)->get());
@@ -151,11 +151,25 @@ public:
      *      {control.min.time: {$_internalExprLt: new Date(...)}}
      * ]}
      *
+     * Predicates on any other measurement field are mapped onto 'control.min.<field>' and
+     * 'control.max.<field>' in the same way. An $in is mapped to a predicate on the range of its
+     * values, and an $or is mapped if each of its branches can be.
+     *
      * If the provided predicate is ineligible for this mapping, the function will return a nullptr.
      */
     std::unique_ptr<MatchExpression> createPredicatesOnBucketLevelField(
         const MatchExpression* matchExpr) const;
 
+    /**
+     * Takes a predicate after $_internalUnpackBucket and extracts the comparisons in its top-level
+     * conjunction of measurement fields against numbers or dates, for the unpacker to evaluate over
+     * the columns of each bucket. For example, the predicate
+     * {$and: [{time: {$gte: new Date(...)}}, {a: {$gt: 5}}, {b: {$in: [1, 2]}}]} will generate
+     * column predicates for 'time' and 'a'. Returns an empty vector if nothing can be extracted.
+     */
+    std::vector<BucketColumnPredicate> createColumnPredicates(
+        const MatchExpression* matchExpr) const;
+
     /**
      * Sets the sample size to 'n' and the maximum number of measurements in a bucket to be
      * 'bucketMaxCount'. Calling this method implicitly changes the behavior from having the stage
@@ -207,6 +221,7 @@ private:
     // Used to avoid infinite loops after we step backwards to optimize a $match on bucket level
     // fields, otherwise we may do an infinite number of $match pushdowns.
     bool _triedBucketLevelFieldsPredicatesPushdown = false;
+    bool _triedColumnPredicatesPushdown = false;
     bool _optimizedEndOfPipeline = false;
     bool _triedInternalizeProject = false;
 };
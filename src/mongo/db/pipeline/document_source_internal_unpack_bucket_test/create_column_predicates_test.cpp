@@ -0,0 +1,129 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
+#include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/util/make_data_structure.h"
+
+namespace mongo {
+namespace {
+
+using InternalUnpackBucketColumnPredicatesTest = AggregationContextFixture;
+
+std::vector<BucketColumnPredicate> createColumnPredicates(
+    const boost::intrusive_ptr<ExpressionContext>& expCtx, const BSONObj& match) {
+    auto pipeline = Pipeline::parse(
+        makeVector(fromjson("{$_internalUnpackBucket: {exclude: [], timeField: 'time', metaField: "
+                            "'myMeta', bucketMaxSpanSeconds: 3600}}"),
+                   BSON("$match" << match)),
+        expCtx);
+    auto& container = pipeline->getSources();
+    ASSERT_EQ(container.size(), 2U);
+
+    auto original = dynamic_cast<DocumentSourceMatch*>(container.back().get());
+    return dynamic_cast<DocumentSourceInternalUnpackBucket*>(container.front().get())
+        ->createColumnPredicates(original->getMatchExpression());
+}
+
+TEST_F(InternalUnpackBucketColumnPredicatesTest, CreatesPredicatesFromConjunction) {
+    auto predicates = createColumnPredicates(
+        getExpCtx(),
+        BSON("time" << BSON("$gte" << Date_t::fromMillisSinceEpoch(1000)) << "a"
+                    << BSON("$lt" << 5.5) << "b" << BSON("$in" << BSON_ARRAY(1 << 2)) << "c"
+                    << 3));
+
+    ASSERT_EQ(predicates.size(), 3U);
+    ASSERT_EQ(predicates[0].field, "time");
+    ASSERT(predicates[0].op == BucketColumnPredicate::Op::kGte);
+    ASSERT_VALUE_EQ(predicates[0].constant, Value{Date_t::fromMillisSinceEpoch(1000)});
+    ASSERT_EQ(predicates[1].field, "a");
+    ASSERT(predicates[1].op == BucketColumnPredicate::Op::kLt);
+    ASSERT_VALUE_EQ(predicates[1].constant, Value{5.5});
+    ASSERT_EQ(predicates[2].field, "c");
+    ASSERT(predicates[2].op == BucketColumnPredicate::Op::kEq);
+    ASSERT_VALUE_EQ(predicates[2].constant, Value{3});
+}
+
+TEST_F(InternalUnpackBucketColumnPredicatesTest, DoesNotCreatePredicatesOnMetaOrDottedFields) {
+    ASSERT(createColumnPredicates(getExpCtx(), fromjson("{myMeta: {$gt: 1}}")).empty());
+    ASSERT(createColumnPredicates(getExpCtx(), fromjson("{'myMeta.a': {$gt: 1}}")).empty());
+    ASSERT(createColumnPredicates(getExpCtx(), fromjson("{'a.b': {$gt: 1}}")).empty());
+}
+
+TEST_F(InternalUnpackBucketColumnPredicatesTest, DoesNotCreatePredicatesOnOtherConstants) {
+    ASSERT(createColumnPredicates(getExpCtx(), fromjson("{a: {$gt: 'abc'}}")).empty());
+    ASSERT(createColumnPredicates(getExpCtx(), fromjson("{a: {$eq: null}}")).empty());
+    ASSERT(createColumnPredicates(getExpCtx(), fromjson("{a: {$lt: NaN}}")).empty());
+    ASSERT(createColumnPredicates(getExpCtx(),
+                                  fromjson("{a: {$lt: {$numberLong: '9223372036854775807'}}}"))
+               .empty());
+    ASSERT(createColumnPredicates(getExpCtx(), fromjson("{a: {$lt: {$numberDecimal: '1'}}}"))
+               .empty());
+}
+
+TEST_F(InternalUnpackBucketColumnPredicatesTest, DoesNotCreatePredicatesUnderDisjunction) {
+    ASSERT(createColumnPredicates(getExpCtx(), fromjson("{$or: [{a: {$gt: 1}}, {b: {$lt: 1}}]}"))
+               .empty());
+    ASSERT(createColumnPredicates(getExpCtx(), fromjson("{a: {$not: {$gt: 1}}}")).empty());
+}
+
+TEST_F(InternalUnpackBucketColumnPredicatesTest, OptimizeSetsColumnPredicatesAndKeepsMatch) {
+    auto pipeline = Pipeline::parse(
+        makeVector(fromjson("{$_internalUnpackBucket: {exclude: [], timeField: 'time', metaField: "
+                            "'myMeta', bucketMaxSpanSeconds: 3600}}"),
+                   fromjson("{$match: {myMeta: {$eq: 1}, a: {$gt: 5}}}")),
+        getExpCtx());
+    pipeline->optimizePipeline();
+
+    auto& container = pipeline->getSources();
+    auto unpack = std::find_if(container.begin(), container.end(), [](auto&& stage) {
+        return dynamic_cast<DocumentSourceInternalUnpackBucket*>(stage.get());
+    });
+    ASSERT(unpack != container.end());
+
+    auto predicates = static_cast<DocumentSourceInternalUnpackBucket*>(unpack->get())
+                          ->bucketUnpacker()
+                          .columnPredicates();
+    ASSERT_EQ(predicates.size(), 1U);
+    ASSERT_EQ(predicates[0].field, "a");
+    ASSERT(predicates[0].op == BucketColumnPredicate::Op::kGt);
+
+    // The $match on the measurements is still evaluated after unpacking.
+    ASSERT(std::next(unpack) != container.end());
+    ASSERT(dynamic_cast<DocumentSourceMatch*>(std::next(unpack)->get()));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -115,14 +115,17 @@ TEST_F(OptimizePipeline, MixedMatchOnlyMetaMatchPushedDown) {
 
     pipeline->optimizePipeline();
 
-    // We should push down the $match on the metaField but not the predicate on '$a', which is
-    // ineligible because of the $in.
-    auto serialized = pipeline->serializeToBson();
-    ASSERT_EQ(3u, serialized.size());
-    ASSERT_BSONOBJ_EQ(fromjson("{$match: {$and: [{meta: {$gte: 0}}, {meta: {$lte: 5}}]}}"),
-                      serialized[0]);
-    ASSERT_BSONOBJ_EQ(unpack, serialized[1]);
-    ASSERT_BSONOBJ_EQ(fromjson("{$match: {a: {$in: [1, 2, 3]}}}"), serialized[2]);
+    // We should push down the $match on the metaField and map the $in on 'a' to predicates on the
+    // range of its values against the control field.
+    auto stages = pipeline->writeExplainOps(ExplainOptions::Verbosity::kQueryPlanner);
+    ASSERT_EQ(3u, stages.size());
+    ASSERT_BSONOBJ_EQ(fromjson("{$match: {$and: [{'control.max.a': {$_internalExprGte: 1}}, "
+                               "{'control.min.a': {$_internalExprLte: 3}}, {meta: {$gte: 0}}, "
+                               "{meta: {$lte: 5}}]}}"),
+                      stages[0].getDocument().toBson());
+    ASSERT_BSONOBJ_EQ(unpack, stages[1].getDocument().toBson());
+    ASSERT_BSONOBJ_EQ(fromjson("{$match: {a: {$in: [1, 2, 3]}}}"),
+                      stages[2].getDocument().toBson());
 }
 
 TEST_F(OptimizePipeline, MultipleMatchesPushedDown) {
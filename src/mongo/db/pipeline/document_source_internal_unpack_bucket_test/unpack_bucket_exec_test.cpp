@@ -33,6 +33,8 @@
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
 #include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/db/query/util/make_data_structure.h"
 #include "mongo/db/timeseries/timeseries_field_names.h"
 
 namespace mongo {
@@ -437,6 +439,40 @@ TEST_F(InternalUnpackBucketExecTest, UnpackWithStrangeTimestampOrdering) {
     ASSERT_TRUE(next.isEOF());
 }
 
+TEST_F(InternalUnpackBucketExecTest, UnpackSkipsMeasurementsRejectedByColumnPredicates) {
+    auto expCtx = getExpCtx();
+    auto pipeline = Pipeline::parse(
+        makeVector(BSON("$_internalUnpackBucket"
+                        << BSON("exclude" << BSONArray() << timeseries::kTimeFieldName
+                                          << kUserDefinedTimeName << "bucketMaxSpanSeconds"
+                                          << 3600)),
+                   fromjson("{$match: {time: {$gt: 3}, a: {$lte: 10}}}")),
+        expCtx);
+    pipeline->optimizePipeline();
+
+    auto& container = pipeline->getSources();
+    auto unpack = std::find_if(container.begin(), container.end(), [](auto&& stage) {
+        return dynamic_cast<DocumentSourceInternalUnpackBucket*>(stage.get());
+    });
+    ASSERT(unpack != container.end());
+
+    // Every measurement of the first bucket is rejected, so it is skipped entirely.
+    auto source = DocumentSourceMock::createForTest(
+        {"{data: {_id: {'0':1, '1':2, '2':3}, time: {'0':1, '1':2, '2':3}, "
+         "a: {'0':1, '1':2, '2':3}}}",
+         "{data: {_id: {'0':4, '1':5, '2':6}, time: {'0':4, '1':5, '2':6}, "
+         "a: {'0':20, '2':6}}}"},
+        expCtx);
+    (*unpack)->setSource(source.get());
+
+    auto next = (*unpack)->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(next.getDocument(), Document(fromjson("{time: 6, _id: 6, a: 6}")));
+
+    next = (*unpack)->getNext();
+    ASSERT_TRUE(next.isEOF());
+}
+
 TEST_F(InternalUnpackBucketExecTest, BucketUnpackerHandlesMissingMetadataWhenMetaFieldUnspecified) {
     auto expCtx = getExpCtx();
     auto spec = BSON("$_internalUnpackBucket"
@@ -613,6 +613,11 @@ void DocumentSourceLookUp::doDispose() {
     }
 }
 
+bool DocumentSourceLookUp::isFromNsView() const {
+    return _resolvedNs != _fromNs ||
+        (_resolvedIntrospectionPipeline && !_resolvedIntrospectionPipeline->getSources().empty());
+}
+
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
                                                       const FieldPath& localFieldPath,
                                                       const std::string& foreignFieldName,
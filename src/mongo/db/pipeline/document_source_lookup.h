@@ -171,6 +171,26 @@ public:
         return _localField;
     }
 
+    const NamespaceString& getFromNs() const {
+        return _fromNs;
+    }
+
+    const FieldPath& getAsField() const {
+        return _as;
+    }
+
+    /**
+     * Returns true if the foreign namespace is a view, whose pipeline has to run before the join.
+     */
+    bool isFromNsView() const;
+
+    /**
+     * Returns true if a $match or an $unwind following this stage has been absorbed into it.
+     */
+    bool hasAbsorbedStages() const {
+        return _additionalFilter || _matchSrc || _unwindSrc;
+    }
+
     const std::vector<LetVariable>& getLetVariables() const {
         return _letVariables;
     }
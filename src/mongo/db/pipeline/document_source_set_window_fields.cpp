@@ -283,6 +283,7 @@ boost::intrusive_ptr<DocumentSource> DocumentSourceInternalSetWindowFields::crea
 
 void DocumentSourceInternalSetWindowFields::initialize() {
     _maxMemory = internalDocumentSourceSetWindowFieldsMaxMemoryBytes.load();
+    _iterator.setMaxMemoryBytes(_maxMemory);
     for (auto& wfs : _outputFields) {
         _executableOutputs[wfs.fieldName] =
             WindowFunctionExec::create(pExpCtx.get(), &_iterator, wfs, _sortBy);
@@ -311,8 +312,15 @@ DocumentSource::GetNextResult DocumentSourceInternalSetWindowFields::doGetNext()
     for (auto&& [fieldName, function] : _executableOutputs) {
         addFieldsSpec.addField(fieldName, function->getNext());
         functionMemUsage += function->getApproximateSize();
+        if (functionMemUsage + _iterator.getApproximateSize() >= _maxMemory &&
+            _iterator.canSpill()) {
+            _iterator.spillToDisk();
+        }
         uassert(5414201,
-                "Exceeded memory limit in DocumentSourceSetWindowFields",
+                str::stream() << "Exceeded memory limit in DocumentSourceSetWindowFields"
+                              << (_iterator.canSpill()
+                                      ? ""
+                                      : ". Pass allowDiskUse:true to opt in to spilling to disk."),
                 functionMemUsage + _iterator.getApproximateSize() < _maxMemory);
     }
 
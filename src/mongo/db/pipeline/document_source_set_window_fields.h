@@ -101,7 +101,7 @@ public:
         return StageConstraints(StreamType::kBlocking,
                                 PositionRequirement::kNone,
                                 HostTypeRequirement::kNone,
-                                DiskUseRequirement::kNoDiskUse,
+                                DiskUseRequirement::kWritesTmpData,
                                 FacetRequirement::kAllowed,
                                 TransactionRequirement::kAllowed,
                                 LookupRequirement::kAllowed,
@@ -128,6 +128,10 @@ public:
         _iterator.setSource(source);
     }
 
+    bool usedDisk() final {
+        return _iterator.usedDisk();
+    }
+
 private:
     DocumentSource::GetNextResult getNextInput();
     void initialize();
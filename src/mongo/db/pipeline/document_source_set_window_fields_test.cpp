@@ -38,6 +38,8 @@
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_source_set_window_fields.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/unittest/unittest.h"
 
 namespace mongo {
@@ -134,5 +136,32 @@ TEST_F(DocumentSourceSetWindowFieldsTest, HandlesEmptyInputCorrectly) {
               (int)parsedStage->getNext().getStatus());
 }
 
+TEST_F(DocumentSourceSetWindowFieldsTest, ReportsUsedDiskAfterSpilling) {
+    getExpCtx()->allowDiskUse = true;
+    RAIIServerParameterControllerForTest maxMemory(
+        "internalDocumentSourceSetWindowFieldsMaxMemoryBytes", 1024);
+
+    auto spec = fromjson(R"(
+        {$_internalSetWindowFields: {partitionBy: '$key', output: {total:
+        {$sum: '$a', window: {documents: ["unbounded", "unbounded"]}}}}})");
+    auto parsedStage =
+        DocumentSourceInternalSetWindowFields::createFromBson(spec.firstElement(), getExpCtx());
+    std::deque<DocumentSource::GetNextResult> docs;
+    for (int i = 0; i < 100; ++i) {
+        docs.emplace_back(Document{{"key", 1}, {"a", i}});
+    }
+    const auto mock = DocumentSourceMock::createForTest(docs, getExpCtx());
+    parsedStage->setSource(mock.get());
+    ASSERT_FALSE(parsedStage->usedDisk());
+
+    for (int i = 0; i < 100; ++i) {
+        auto next = parsedStage->getNext();
+        ASSERT_TRUE(next.isAdvanced());
+        ASSERT_VALUE_EQ(next.getDocument()["total"], Value(4950));
+    }
+    ASSERT_TRUE(parsedStage->getNext().isEOF());
+    ASSERT_TRUE(parsedStage->usedDisk());
+}
+
 }  // namespace
 }  // namespace mongo
@@ -62,18 +62,24 @@
 #include "mongo/db/pipeline/document_source_geo_near_cursor.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_internal_unpack_bucket.h"
+#include "mongo/db/pipeline/document_source_lookup.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
 #include "mongo/db/pipeline/document_source_single_document_transformation.h"
 #include "mongo/db/pipeline/document_source_sort.h"
+#include "mongo/db/pipeline/inner_pipeline_stage_impl.h"
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/pipeline/skip_and_limit.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_executor_factory.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_feature_flags_gen.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/sbe_stage_builder_accumulator.h"
+#include "mongo/db/query/sbe_stage_builder_lookup.h"
 #include "mongo/db/query/sort_pattern.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/service_context.h"
@@ -260,6 +266,87 @@ createRandomCursorExecutor(const CollectionPtr& coll,
                      !trialStage || !trialStage->pickedBackupPlan()};
 }
 
+/**
+ * Returns true if 'groupStage' can be lowered into a HashAggStage by the SBE stage builder.
+ */
+bool isGroupSbeCompatible(const DocumentSourceGroup& groupStage) {
+    if (groupStage.doingMerge()) {
+        return false;
+    }
+
+    auto idFields = groupStage.getIdFields();
+    if (idFields.size() != 1 || !idFields.count("_id")) {
+        return false;
+    }
+
+    auto&& accumulatedFields = groupStage.getAccumulatedFields();
+    return std::all_of(accumulatedFields.begin(), accumulatedFields.end(), [](auto&& acc) {
+        return stage_builder::isAccumulatorSbeCompatible(acc);
+    });
+}
+
+/**
+ * Returns how 'lookupStage' can be lowered into a join by the SBE stage builder, or boost::none if
+ * it cannot be.
+ */
+boost::optional<stage_builder::LookupPlan> planSbeLookup(OperationContext* opCtx,
+                                                         const CanonicalQuery* cq,
+                                                         const DocumentSourceLookUp& lookupStage) {
+    // The SBE scans of the foreign collection do not check its shard version, so they cannot tell
+    // whether the collection is sharded.
+    if (serverGlobalParams.clusterRole == ClusterRole::ShardServer) {
+        return boost::none;
+    }
+
+    return stage_builder::planLookup(opCtx, lookupStage, cq->getCollator());
+}
+
+/**
+ * Returns the $group and $lookup stages at the front of 'pipeline' which can be executed as part
+ * of the SBE plan for 'cq', so that they can be attached to 'cq'. Nothing is returned unless the
+ * query is going to be executed by SBE. The stages are left in 'pipeline'; the caller removes them
+ * once it has an executor for 'cq'.
+ */
+std::vector<std::unique_ptr<InnerPipelineStageInterface>> findSbeCompatibleStagesForPushdown(
+    OperationContext* opCtx, const CanonicalQuery* cq, size_t plannerOpts, Pipeline* pipeline) {
+    std::vector<std::unique_ptr<InnerPipelineStageInterface>> stagesForPushdown;
+    if (!pipeline || !feature_flags::gSBE.isEnabledAndIgnoreFCV() ||
+        !isQuerySbeCompatible(opCtx, cq, plannerOpts) ||
+        (plannerOpts & QueryPlannerParams::TRACK_LATEST_OPLOG_TS) ||
+        cq->getFindCommandRequest().getTailable()) {
+        return stagesForPushdown;
+    }
+
+    // When the results of this pipeline are merged by another node, $group has to produce partial
+    // results for the merging $group, which SBE does not support.
+    if (cq->getExpCtx()->needsMerge) {
+        return stagesForPushdown;
+    }
+
+    for (auto&& source : pipeline->getSources()) {
+        if (auto groupStage = dynamic_cast<DocumentSourceGroup*>(source.get())) {
+            if (internalQuerySlotBasedExecutionDisableGroupPushdown.load() ||
+                !isGroupSbeCompatible(*groupStage)) {
+                break;
+            }
+            stagesForPushdown.push_back(std::make_unique<InnerPipelineStageImpl>(source));
+        } else if (auto lookupStage = dynamic_cast<DocumentSourceLookUp*>(source.get())) {
+            if (internalQuerySlotBasedExecutionDisableLookupPushdown.load()) {
+                break;
+            }
+            auto lookupPlan = planSbeLookup(opCtx, cq, *lookupStage);
+            if (!lookupPlan) {
+                break;
+            }
+            stagesForPushdown.push_back(std::make_unique<stage_builder::InnerPipelineLookupStage>(
+                lookupStage, std::move(*lookupPlan)));
+        } else {
+            break;
+        }
+    }
+    return stagesForPushdown;
+}
+
 StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> attemptToGetExecutor(
     const intrusive_ptr<ExpressionContext>& expCtx,
     const CollectionPtr& collection,
@@ -272,7 +359,8 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> attemptToGetExe
     boost::optional<std::string> groupIdForDistinctScan,
     const AggregateCommandRequest* aggRequest,
     const size_t plannerOpts,
-    const MatchExpressionParser::AllowedFeatureSet& matcherFeatures) {
+    const MatchExpressionParser::AllowedFeatureSet& matcherFeatures,
+    Pipeline* pipeline) {
     auto findCommand = std::make_unique<FindCommandRequest>(nss);
     query_request_helper::setTailableMode(expCtx->tailableMode, findCommand.get());
     findCommand->setFilter(queryObj.getOwned());
@@ -345,9 +433,25 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> attemptToGetExe
         }
     }
 
+    // If the query will run in SBE, the $group and $lookup stages at the front of the pipeline can
+    // run as part of the query's plan, avoiding the materialization of the documents they consume.
+    auto stagesForPushdown = findSbeCompatibleStagesForPushdown(
+        expCtx->opCtx, cq.getValue().get(), plannerOpts, pipeline);
+    const auto numStagesPushedDown = stagesForPushdown.size();
+    cq.getValue()->setPipeline(std::move(stagesForPushdown));
+
     bool permitYield = true;
-    return getExecutorFind(
+    auto executor = getExecutorFind(
         expCtx->opCtx, &collection, std::move(cq.getValue()), permitYield, plannerOpts);
+
+    // The caller may try again with a different query if this attempt failed, in which case the
+    // pipeline must still have all of its stages.
+    if (executor.isOK()) {
+        for (size_t idx = 0; idx < numStagesPushedDown; ++idx) {
+            pipeline->popFront();
+        }
+    }
+    return executor;
 }
 
 /**
@@ -915,7 +1019,8 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
                                                       rewrittenGroupStage->groupId(),
                                                       aggRequest,
                                                       plannerOpts,
-                                                      matcherFeatures);
+                                                      matcherFeatures,
+                                                      nullptr /* pipeline */);
 
         if (swExecutorGrouped.isOK()) {
             // Any $limit stage before the $group stage should make the pipeline ineligible for this
@@ -955,7 +1060,8 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
                                 boost::none, /* groupIdForDistinctScan */
                                 aggRequest,
                                 plannerOpts,
-                                matcherFeatures);
+                                matcherFeatures,
+                                pipeline);
 }
 
 Timestamp PipelineD::getLatestOplogTimestamp(const Pipeline* pipeline) {
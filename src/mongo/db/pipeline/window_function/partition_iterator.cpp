@@ -86,6 +86,7 @@ PartitionIterator::PartitionIterator(ExpressionContext* expCtx,
       _source(source),
       _partitionExpr(std::move(partitionExpr)),
       _sortExpr(exprFromSort(_expCtx, sortPattern)),
+      _cache(expCtx->allowDiskUse && !expCtx->inMongos ? expCtx->tempDir : std::string{}),
       _state(IteratorState::kNotInitialized) {}
 
 optional<Document> PartitionIterator::operator[](int index) {
@@ -500,17 +501,20 @@ void PartitionIterator::getNextDocument() {
             advanceToNextPartition();
         } else if (_expCtx->getValueComparator().compare(curKey, _partitionKey) != 0) {
             _nextPartition = NextPartitionState{std::move(doc), std::move(curKey)};
-            _memUsageBytes += getNextPartitionStateSize();
             _state = IteratorState::kAwaitingAdvanceToNext;
         } else {
-            _memUsageBytes += doc.getApproximateSize();
             _cache.emplace_back(std::move(doc));
         }
     } else {
-        _memUsageBytes += doc.getApproximateSize();
         _cache.emplace_back(std::move(doc));
         _state = IteratorState::kIntraPartition;
     }
+
+    // Rather than holding the whole partition in memory, page the cached documents out to disk
+    // once they exceed the memory limit.
+    if (_cache.canSpill() && _cache.getApproximateSize() > _maxMemoryBytes) {
+        _cache.spill();
+    }
 }
 
 }  // namespace mongo
@@ -31,6 +31,7 @@
 
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/window_function/spillable_cache.h"
 #include "mongo/db/pipeline/window_function/window_bounds.h"
 #include "mongo/db/query/sort_pattern.h"
 
@@ -45,6 +46,9 @@ namespace mongo {
  * current partition exists.
  *
  * The 'sortPattern' is used for resolving range-based and time-based bounds, in 'getEndpoints()'.
+ *
+ * If the query allows disk use, documents of the current partition are written to a temporary
+ * file once they use more memory than allowed, and are read back from it when accessed.
  */
 class PartitionIterator {
 public:
@@ -100,12 +104,40 @@ public:
     }
 
     /**
-     * Returns the value in bytes of the data being stored by this partition iterator. Does not
-     * include the size of the constant size objects being held or the overhead of the data
-     * structures.
+     * Returns the value in bytes of the data being stored in memory by this partition iterator.
+     * Does not include the size of the constant size objects being held, the overhead of the data
+     * structures or any documents spilled to disk.
+     */
+    size_t getApproximateSize() const {
+        return _cache.getApproximateSize() + _partitionKey.getApproximateSize() +
+            getNextPartitionStateSize();
+    }
+
+    /**
+     * Sets the size in bytes that the documents held in memory may reach before the iterator
+     * spills them to disk. Has no effect if spilling is not allowed.
      */
-    auto getApproximateSize() const {
-        return _memUsageBytes;
+    void setMaxMemoryBytes(size_t maxMemoryBytes) {
+        _maxMemoryBytes = maxMemoryBytes;
+    }
+
+    /**
+     * Returns true if the documents held by the iterator may be spilled to disk.
+     */
+    bool canSpill() const {
+        return _cache.canSpill();
+    }
+
+    /**
+     * Writes every document of the current partition held in memory to disk. Only valid if
+     * 'canSpill()' is true.
+     */
+    void spillToDisk() {
+        _cache.spill();
+    }
+
+    bool usedDisk() const {
+        return _cache.usedDisk();
     }
 
 private:
@@ -199,7 +231,6 @@ private:
     void resetCache() {
         _cache.clear();
         // Everything should be empty at this point.
-        _memUsageBytes = 0;
         _currentCacheIndex = 0;
         _currentPartitionIndex = 0;
         for (size_t slot = 0; slot < _slots.size(); slot++) {
@@ -215,8 +246,6 @@ private:
                 "Invalid call to PartitionIterator::advanceToNextPartition",
                 _nextPartition != boost::none);
         resetCache();
-        // Cache is cleared, and we are moving the _nextPartition value to different positions.
-        _memUsageBytes = getNextPartitionStateSize();
         _cache.emplace_back(std::move(_nextPartition->_doc));
         _partitionKey = std::move(_nextPartition->_partitionKey);
         _nextPartition.reset();
@@ -239,7 +268,7 @@ private:
     // the value of the "$ts" field. This _sortExpr is used in getEndpoints().
     boost::optional<boost::intrusive_ptr<ExpressionFieldPath>> _sortExpr;
 
-    std::deque<Document> _cache;
+    SpillableCache _cache;
     // '_cache[_currentCacheIndex]' is the current document, which '(*this)[0]' returns.
     int _currentCacheIndex = 0;
     int _currentPartitionIndex = 0;
@@ -253,7 +282,7 @@ private:
         Value _partitionKey;
     };
     boost::optional<NextPartitionState> _nextPartition;
-    size_t getNextPartitionStateSize() {
+    size_t getNextPartitionStateSize() const {
         if (_nextPartition) {
             return _nextPartition->_doc.getApproximateSize() +
                 _nextPartition->_partitionKey.getApproximateSize();
@@ -261,9 +290,9 @@ private:
         return 0;
     }
 
-    // The value in bytes of the data being held. Does not include the size of the constant size
-    // data members or overhead of data structures.
-    size_t _memUsageBytes = 0;
+    // The size in bytes that the documents in '_cache' may reach before they are spilled, if
+    // spilling is allowed.
+    size_t _maxMemoryBytes = std::numeric_limits<size_t>::max();
 
     enum class IteratorState {
         // Default state, no documents have been pulled into the cache.
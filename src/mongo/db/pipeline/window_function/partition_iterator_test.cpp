@@ -282,6 +282,54 @@ TEST_F(PartitionIteratorTest, OutsideOfPartitionAccessShouldNotTassert) {
     ASSERT_FALSE(accessor[2]);
 }
 
+TEST_F(PartitionIteratorTest, SpilledDocumentsRemainAccessible) {
+    getExpCtx()->allowDiskUse = true;
+    std::deque<DocumentSource::GetNextResult> docs;
+    for (int i = 0; i < 10; ++i) {
+        docs.emplace_back(Document{{"key", 1}, {"a", i}});
+    }
+    docs.emplace_back(Document{{"key", 2}, {"a", 10}});
+    const auto mock = DocumentSourceMock::createForTest(docs, getExpCtx());
+    auto key = ExpressionFieldPath::createPathFromString(
+        getExpCtx().get(), "key", getExpCtx()->variablesParseState);
+    auto partIter = PartitionIterator(getExpCtx().get(),
+                                      mock.get(),
+                                      boost::optional<boost::intrusive_ptr<Expression>>(key),
+                                      boost::none);
+    auto accessor = PartitionAccessor(&partIter, PartitionAccessor::Policy::kEndpoints);
+    ASSERT_TRUE(partIter.canSpill());
+
+    // Every document is spilled as soon as it is pulled into the cache.
+    partIter.setMaxMemoryBytes(1);
+    ASSERT_FALSE(accessor[10]);
+    ASSERT_TRUE(partIter.usedDisk());
+    ASSERT_LT(partIter.getApproximateSize(), docs[9].getDocument().getApproximateSize() * 10);
+
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_DOCUMENT_EQ(docs[i].getDocument(), *accessor[0]);
+        ASSERT_DOCUMENT_EQ(docs[0].getDocument(), *accessor[-i]);
+        ASSERT_DOCUMENT_EQ(docs[9].getDocument(), *accessor[9 - i]);
+        auto expected = i < 9 ? PartitionIterator::AdvanceResult::kAdvanced
+                              : PartitionIterator::AdvanceResult::kNewPartition;
+        ASSERT_ADVANCE_RESULT(expected, partIter.advance());
+    }
+    ASSERT_DOCUMENT_EQ(docs[10].getDocument(), *accessor[0]);
+    ASSERT_FALSE(accessor[-1]);
+}
+
+TEST_F(PartitionIteratorTest, CannotSpillWithoutAllowDiskUse) {
+    const auto docs = std::deque<DocumentSource::GetNextResult>{Document{{"a", 1}},
+                                                                Document{{"a", 2}}};
+    const auto mock = DocumentSourceMock::createForTest(docs, getExpCtx());
+    auto partIter = PartitionIterator(getExpCtx().get(), mock.get(), boost::none, boost::none);
+    auto accessor = PartitionAccessor(&partIter, PartitionAccessor::Policy::kEndpoints);
+    ASSERT_FALSE(partIter.canSpill());
+
+    partIter.setMaxMemoryBytes(1);
+    ASSERT_DOCUMENT_EQ(docs[1].getDocument(), *accessor[1]);
+    ASSERT_FALSE(partIter.usedDisk());
+}
+
 DEATH_TEST_F(PartitionIteratorTest,
              SingleConsumerDefaultPolicy,
              "Invalid access of expired document") {
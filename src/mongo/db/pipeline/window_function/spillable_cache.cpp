@@ -0,0 +1,235 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/window_function/spillable_cache.h"
+
+#include <algorithm>
+#include <boost/filesystem/operations.hpp>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/destructor_guard.h"
+#include "mongo/util/errno_util.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/str.h"
+
+namespace mongo {
+
+namespace {
+std::string nextFileName() {
+    static AtomicWord<unsigned> windowFunctionFileCounter;
+    return "extsort-window-fields." + std::to_string(windowFunctionFileCounter.fetchAndAdd(1));
+}
+}  // namespace
+
+SpillableCache::~SpillableCache() {
+    if (!_fileName.empty()) {
+        _file.close();
+        DESTRUCTOR_GUARD(boost::filesystem::remove(_fileName));
+    }
+}
+
+Document SpillableCache::operator[](size_t index) {
+    if (index >= _diskOffsets.size()) {
+        return _memCache[index - _diskOffsets.size()];
+    }
+
+    const auto spilledIndex = _numSpilledPopped + index;
+    for (auto it = _readBlocks.begin(); it != _readBlocks.end(); ++it) {
+        if (spilledIndex >= it->firstSpilledIndex &&
+            spilledIndex < it->firstSpilledIndex + it->docs.size()) {
+            auto doc = it->docs[spilledIndex - it->firstSpilledIndex];
+            std::rotate(it, it + 1, _readBlocks.end());
+            return doc;
+        }
+    }
+
+    if (_readBlocks.size() == kMaxReadBlocks) {
+        _readBlocks.erase(_readBlocks.begin());
+    }
+    _readBlocks.push_back(readBlock(index));
+    return _readBlocks.back().docs.front();
+}
+
+SpillableCache::ReadBlock SpillableCache::readBlock(size_t index) {
+    // Read as many of the following documents as fit in a block, and at least the requested one.
+    const auto beginOffset = _diskOffsets[index];
+    auto endIndex = index + 1;
+    while (endIndex < _diskOffsets.size() &&
+           diskEndOffset(endIndex) - beginOffset <= kReadBlockBytes) {
+        ++endIndex;
+    }
+    const auto blockSize = diskEndOffset(endIndex - 1) - beginOffset;
+
+    auto buffer = SharedBuffer::allocate(blockSize);
+    _file.seekg(beginOffset);
+    _file.read(buffer.get(), blockSize);
+    uassert(5843180,
+            str::stream() << "error reading file \"" << _fileName
+                          << "\": " << errnoWithDescription(),
+            _file.good());
+
+    ReadBlock block{_numSpilledPopped + index, {}};
+    block.docs.reserve(endIndex - index);
+    for (auto i = index; i < endIndex; ++i) {
+        const auto docOffset = _diskOffsets[i] - beginOffset;
+        BSONObj bson(buffer.get() + docOffset);
+        uassert(5843181,
+                str::stream() << "corrupt document in file \"" << _fileName << "\"",
+                bson.objsize() == diskEndOffset(i) - _diskOffsets[i]);
+        block.docs.push_back(Document::fromBsonWithMetaData(bson.shareOwnershipWith(buffer)));
+    }
+    return block;
+}
+
+void SpillableCache::pop_front() {
+    if (_diskOffsets.empty()) {
+        _memUsageBytes -= _memCache.front().getApproximateSize();
+        _memCache.pop_front();
+        return;
+    }
+
+    _diskOffsets.pop_front();
+    ++_numSpilledPopped;
+    _readBlocks.erase(std::remove_if(_readBlocks.begin(),
+                                     _readBlocks.end(),
+                                     [&](const ReadBlock& block) {
+                                         return block.firstSpilledIndex + block.docs.size() <=
+                                             _numSpilledPopped;
+                                     }),
+                      _readBlocks.end());
+
+    if (_diskOffsets.empty()) {
+        removeFile();
+        return;
+    }
+
+    // Rewriting the remaining documents once the removed ones outweigh them bounds both the size of
+    // the file and the amount of data copied to twice the size of the documents still on disk.
+    const auto removedBytes = _diskOffsets.front();
+    if (removedBytes >= kMinCompactionBytes && removedBytes >= _fileEndOffset - removedBytes) {
+        compactFile();
+    }
+}
+
+void SpillableCache::clear() {
+    _diskOffsets.clear();
+    _numSpilledPopped = 0;
+    _readBlocks.clear();
+    _memCache.clear();
+    _memUsageBytes = 0;
+    removeFile();
+}
+
+void SpillableCache::spill() {
+    tassert(5843182, "Attempted to spill a window function cache with no temp dir", canSpill());
+    if (_memCache.empty()) {
+        return;
+    }
+    if (_fileName.empty()) {
+        openFile();
+    }
+
+    _file.seekp(_fileEndOffset);
+    for (auto&& doc : _memCache) {
+        auto bson = doc.toBsonWithMetaData();
+        _file.write(bson.objdata(), bson.objsize());
+        _diskOffsets.push_back(_fileEndOffset);
+        _fileEndOffset += bson.objsize();
+    }
+    _file.flush();
+    uassert(5843183,
+            str::stream() << "error writing to file \"" << _fileName
+                          << "\": " << errnoWithDescription(),
+            _file.good());
+
+    _memCache.clear();
+    _memUsageBytes = 0;
+    _usedDisk = true;
+}
+
+void SpillableCache::compactFile() {
+    const auto removedBytes = _diskOffsets.front();
+    std::fstream oldFile;
+    oldFile.swap(_file);
+    const auto oldFileName = _fileName;
+    ON_BLOCK_EXIT([&] {
+        oldFile.close();
+        DESTRUCTOR_GUARD(boost::filesystem::remove(oldFileName));
+    });
+    openFile();
+
+    auto buffer = SharedBuffer::allocate(kReadBlockBytes);
+    oldFile.seekg(removedBytes);
+    for (auto offset = removedBytes; offset < _fileEndOffset;) {
+        const auto chunkSize = std::min(kReadBlockBytes, _fileEndOffset - offset);
+        oldFile.read(buffer.get(), chunkSize);
+        uassert(5843185,
+                str::stream() << "error reading file \"" << oldFileName
+                              << "\": " << errnoWithDescription(),
+                oldFile.good());
+        _file.write(buffer.get(), chunkSize);
+        offset += chunkSize;
+    }
+    _file.flush();
+    uassert(5843186,
+            str::stream() << "error writing to file \"" << _fileName
+                          << "\": " << errnoWithDescription(),
+            _file.good());
+
+    for (auto&& offset : _diskOffsets) {
+        offset -= removedBytes;
+    }
+    _fileEndOffset -= removedBytes;
+}
+
+void SpillableCache::removeFile() {
+    if (_fileName.empty()) {
+        return;
+    }
+    _file.close();
+    boost::filesystem::remove(_fileName);
+    _fileName.clear();
+    _fileEndOffset = 0;
+}
+
+void SpillableCache::openFile() {
+    boost::filesystem::create_directories(_tempDir);
+    _fileName = _tempDir + "/" + nextFileName();
+    _file.open(_fileName.c_str(),
+               std::ios::in | std::ios::out | std::ios::trunc | std::ios::binary);
+    uassert(5843184,
+            str::stream() << "error opening file \"" << _fileName
+                          << "\": " << errnoWithDescription(),
+            _file.good());
+}
+
+}  // namespace mongo
@@ -0,0 +1,186 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <deque>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "mongo/db/exec/document_value/document.h"
+
+namespace mongo {
+
+/**
+ * A double-ended queue of documents used as the cache of a PartitionIterator, which can move the
+ * documents it holds to a temporary file when they use too much memory.
+ *
+ * Spilling always moves every in-memory document to the end of the file, so the documents on disk
+ * are always at the front of the queue, followed by the ones still held in memory. Documents on
+ * disk remain accessible by index. They are read back sequentially, a block of neighbouring
+ * documents at a time, and the last few blocks read are kept in memory since window functions
+ * access the same documents repeatedly. Once the documents removed from the front of the queue take
+ * up more of the file than the remaining ones, the remaining ones are moved to a new file so that
+ * the file does not grow with the size of the partition.
+ */
+class SpillableCache {
+public:
+    // The number of bytes of spilled documents read from the file at once, unless a single document
+    // is larger.
+    static constexpr std::streamoff kReadBlockBytes = 1024 * 1024;
+    // The number of blocks of spilled documents kept in memory once read.
+    static constexpr size_t kMaxReadBlocks = 2;
+    // The minimum number of bytes of removed documents at the front of the file before the
+    // remaining documents are moved to a new file.
+    static constexpr std::streamoff kMinCompactionBytes = 8 * kReadBlockBytes;
+
+    /**
+     * Creates a cache which spills to a file in 'tempDir'. An empty 'tempDir' means that spilling
+     * is not allowed.
+     */
+    explicit SpillableCache(std::string tempDir) : _tempDir(std::move(tempDir)) {}
+
+    ~SpillableCache();
+
+    SpillableCache(const SpillableCache&) = delete;
+    SpillableCache& operator=(const SpillableCache&) = delete;
+
+    size_t size() const {
+        return _diskOffsets.size() + _memCache.size();
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * Returns the document at position 'index' from the front of the queue, reading it from the
+     * spill file if it is neither held in memory nor part of a recently read block.
+     */
+    Document operator[](size_t index);
+
+    void emplace_back(Document doc) {
+        _memUsageBytes += doc.getApproximateSize();
+        _memCache.emplace_back(std::move(doc));
+    }
+
+    void pop_front();
+
+    /**
+     * Removes every document and deletes the spill file, if any.
+     */
+    void clear();
+
+    /**
+     * Writes every document held in memory to the spill file and releases it from memory.
+     */
+    void spill();
+
+    bool canSpill() const {
+        return !_tempDir.empty();
+    }
+
+    /**
+     * Returns true if any document was ever spilled to disk.
+     */
+    bool usedDisk() const {
+        return _usedDisk;
+    }
+
+    /**
+     * Returns the approximate size in bytes of the documents held in memory. The blocks of spilled
+     * documents read back from disk are not included, as they are bounded by
+     * kMaxReadBlocks * kReadBlockBytes.
+     */
+    size_t getApproximateSize() const {
+        return _memUsageBytes;
+    }
+
+    /**
+     * Returns the size in bytes of the spill file.
+     */
+    std::streamoff getFileSize() const {
+        return _fileEndOffset;
+    }
+
+private:
+    // A run of consecutive spilled documents read from the file at once.
+    struct ReadBlock {
+        // The position of the first document of the block among all the documents ever spilled
+        // since the cache was last cleared.
+        size_t firstSpilledIndex;
+        std::vector<Document> docs;
+    };
+
+    void openFile();
+
+    /**
+     * Returns the offset in the spill file at which the document at position 'index' ends.
+     */
+    std::streamoff diskEndOffset(size_t index) const {
+        return index + 1 < _diskOffsets.size() ? _diskOffsets[index + 1] : _fileEndOffset;
+    }
+
+    /**
+     * Reads the block of spilled documents starting at position 'index' from the file.
+     */
+    ReadBlock readBlock(size_t index);
+
+    /**
+     * Moves the documents still on disk to a new spill file, and deletes the old one.
+     */
+    void compactFile();
+
+    /**
+     * Deletes the spill file, if any, which must no longer hold any document.
+     */
+    void removeFile();
+
+    const std::string _tempDir;
+    std::string _fileName;
+    std::fstream _file;
+    std::streamoff _fileEndOffset = 0;
+
+    // The offsets in the spill file of the documents at the front of the queue.
+    std::deque<std::streamoff> _diskOffsets;
+    // The number of spilled documents removed from the front of the queue since the cache was last
+    // cleared, that is the spilled index of the document at '_diskOffsets.front()'.
+    size_t _numSpilledPopped = 0;
+    // The blocks of spilled documents most recently read, the most recently used one last.
+    std::vector<ReadBlock> _readBlocks;
+    // The documents at the back of the queue, following those in '_diskOffsets'.
+    std::deque<Document> _memCache;
+
+    size_t _memUsageBytes = 0;
+    bool _usedDisk = false;
+};
+
+}  // namespace mongo
@@ -0,0 +1,130 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/pipeline/window_function/spillable_cache.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+Document makeDoc(int i, size_t paddingBytes) {
+    return Document{{"i", i}, {"padding", std::string(paddingBytes, 'x')}};
+}
+
+TEST(SpillableCacheTest, SpilledDocumentsAreReadBackInAnyOrder) {
+    unittest::TempDir tempDir("SpillableCacheTest");
+    SpillableCache cache(tempDir.path());
+
+    // Mix documents larger than a read block with small ones, over several spills.
+    std::vector<Document> docs;
+    for (int i = 0; i < 200; ++i) {
+        docs.push_back(makeDoc(i, i % 50 == 0 ? SpillableCache::kReadBlockBytes + 1 : 1024));
+        cache.emplace_back(docs.back());
+        if (i % 70 == 0) {
+            cache.spill();
+        }
+    }
+    cache.spill();
+    ASSERT_TRUE(cache.usedDisk());
+    ASSERT_EQ(cache.getApproximateSize(), 0U);
+    ASSERT_EQ(cache.size(), docs.size());
+
+    for (size_t i = 0; i < docs.size(); ++i) {
+        ASSERT_DOCUMENT_EQ(docs[i], cache[i]);
+        ASSERT_DOCUMENT_EQ(docs[docs.size() - 1 - i], cache[docs.size() - 1 - i]);
+        ASSERT_DOCUMENT_EQ(docs[0], cache[0]);
+    }
+}
+
+TEST(SpillableCacheTest, SpillFileIsCompactedAsDocumentsArePopped) {
+    unittest::TempDir tempDir("SpillableCacheTest");
+    SpillableCache cache(tempDir.path());
+
+    const size_t kPaddingBytes = 16 * 1024;
+    const int kNumDocs = 4 * SpillableCache::kMinCompactionBytes / kPaddingBytes;
+    for (int i = 0; i < kNumDocs; ++i) {
+        cache.emplace_back(makeDoc(i, kPaddingBytes));
+    }
+    cache.spill();
+    const auto initialFileSize = cache.getFileSize();
+    ASSERT_GT(initialFileSize, 4 * SpillableCache::kMinCompactionBytes);
+
+    // The file is rewritten once the removed documents outweigh the remaining ones.
+    int popped = 0;
+    while (cache.getFileSize() == initialFileSize) {
+        ASSERT_DOCUMENT_EQ(makeDoc(popped, kPaddingBytes), cache[0]);
+        cache.pop_front();
+        ++popped;
+    }
+    ASSERT_GTE(popped, kNumDocs / 2);
+    ASSERT_LTE(cache.getFileSize(), initialFileSize / 2);
+
+    // The remaining documents are still readable from the new file, and documents spilled later
+    // are appended after them.
+    cache.emplace_back(makeDoc(kNumDocs, kPaddingBytes));
+    cache.spill();
+    ASSERT_EQ(cache.size(), static_cast<size_t>(kNumDocs + 1 - popped));
+    for (size_t i = 0; i < cache.size(); ++i) {
+        ASSERT_DOCUMENT_EQ(makeDoc(popped + static_cast<int>(i), kPaddingBytes), cache[i]);
+    }
+
+    // The file is removed once every spilled document has been popped.
+    while (!cache.empty()) {
+        cache.pop_front();
+    }
+    ASSERT_EQ(cache.getFileSize(), 0);
+}
+
+TEST(SpillableCacheTest, InMemoryDocumentsFollowSpilledOnes) {
+    unittest::TempDir tempDir("SpillableCacheTest");
+    SpillableCache cache(tempDir.path());
+
+    cache.emplace_back(makeDoc(0, 10));
+    cache.spill();
+    cache.emplace_back(makeDoc(1, 10));
+    ASSERT_EQ(cache.size(), 2U);
+    ASSERT_DOCUMENT_EQ(makeDoc(0, 10), cache[0]);
+    ASSERT_DOCUMENT_EQ(makeDoc(1, 10), cache[1]);
+
+    cache.pop_front();
+    ASSERT_EQ(cache.getFileSize(), 0);
+    ASSERT_DOCUMENT_EQ(makeDoc(1, 10), cache[0]);
+
+    cache.clear();
+    ASSERT_TRUE(cache.empty());
+    ASSERT_EQ(cache.getApproximateSize(), 0U);
+}
+
+}  // namespace
+}  // namespace mongo
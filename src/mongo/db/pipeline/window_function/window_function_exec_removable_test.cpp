@@ -87,6 +87,10 @@ public:
         return _iter->advance();
     }
 
+    void spillIterator() {
+        _iter->spillToDisk();
+    }
+
 private:
     boost::intrusive_ptr<DocumentSourceMock> _docSource;
     std::unique_ptr<PartitionIterator> _iter;
@@ -349,6 +353,23 @@ TEST_F(WindowFunctionExecRemovableDocumentTest, InputExpressionAllowedToCreateVa
     ASSERT_VALUE_EQ(Value(std::vector<Value>{Value(2), Value(3)}), mgr.getNext());
 }
 
+TEST_F(WindowFunctionExecRemovableDocumentTest, RemovesDocumentsSpilledToDisk) {
+    getExpCtx()->allowDiskUse = true;
+    std::deque<DocumentSource::GetNextResult> docs;
+    for (int i = 10; i > 0; --i) {
+        docs.emplace_back(Document{{"a", i}});
+    }
+    auto mgr = createForFieldPath(std::move(docs), "$a", WindowBounds::DocumentBased{-2, 0});
+    ASSERT_VALUE_EQ(Value(10), mgr.getNext());
+    for (int i = 1; i < 10; ++i) {
+        // Spill the whole window, so that the documents leaving it must be read back from disk to
+        // be removed.
+        spillIterator();
+        advanceIterator();
+        ASSERT_VALUE_EQ(Value(10 - std::max(0, i - 2)), mgr.getNext());
+    }
+}
+
 TEST_F(WindowFunctionExecRemovableDocumentTest, CanReceiveSortByExpression) {
     const auto docs = std::deque<DocumentSource::GetNextResult>{Document{{"x", 1}, {"y", 0}},
                                                                 Document{{"x", 3}, {"y", 2}},
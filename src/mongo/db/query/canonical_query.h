@@ -35,6 +35,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/extensions_callback_noop.h"
+#include "mongo/db/pipeline/inner_pipeline_stage_interface.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/projection.h"
 #include "mongo/db/query/projection_policies.h"
@@ -231,6 +232,18 @@ public:
         return _expCtx.get();
     }
 
+    /**
+     * Attaches the aggregation pipeline stages which were removed from the pipeline to be executed
+     * on top of this query's plan.
+     */
+    void setPipeline(std::vector<std::unique_ptr<InnerPipelineStageInterface>> pipeline) {
+        _pipeline = std::move(pipeline);
+    }
+
+    const std::vector<std::unique_ptr<InnerPipelineStageInterface>>& pipeline() const {
+        return _pipeline;
+    }
+
 private:
     // You must go through canonicalize to create a CanonicalQuery.
     CanonicalQuery() {}
@@ -264,6 +277,9 @@ private:
     bool _canHaveNoopMatchNodes = false;
 
     bool _explain = false;
+
+    // Aggregation pipeline stages which are executed on top of the plan for this query.
+    std::vector<std::unique_ptr<InnerPipelineStageInterface>> _pipeline;
 };
 
 }  // namespace mongo
@@ -94,6 +94,20 @@ void CursorResponseBuilder::abandon() {
     _active = false;
 }
 
+void reserveReplyBytesForBatch(const std::vector<BSONObj>& batch,
+                               rpc::ReplyBuilderInterface* replyBuilder) {
+    // Room for the cursor fields, the command status and any metadata appended to the reply.
+    static constexpr std::size_t kReplyOverheadBytes = 1024;
+    // Each array element adds a type byte and a NUL-terminated decimal index as its field name.
+    static constexpr std::size_t kPerElementOverheadBytes = 1 + 8;
+
+    std::size_t bytes = kReplyOverheadBytes;
+    for (const auto& obj : batch) {
+        bytes += obj.objsize() + kPerElementOverheadBytes;
+    }
+    replyBuilder->reserveBytes(bytes);
+}
+
 void appendCursorResponseObject(long long cursorId,
                                 StringData cursorNamespace,
                                 BSONArray firstBatch,
@@ -126,6 +126,14 @@ private:
     bool _partialResultsReturned = false;
 };
 
+/**
+ * Ensures 'replyBuilder' has room for a cursor reply carrying 'batch'. Callers that have the whole
+ * batch in hand before serializing it use this so that the reply buffer is allocated once, rather
+ * than regrown (and its contents copied) repeatedly while a large batch is appended.
+ */
+void reserveReplyBytesForBatch(const std::vector<BSONObj>& batch,
+                               rpc::ReplyBuilderInterface* replyBuilder);
+
 /**
  * Builds a cursor response object from the provided cursor identifiers and "firstBatch",
  * and appends the response object to the provided builder under the field name "cursor".
@@ -259,6 +259,33 @@ TEST(CursorResponseTest, roundTripThroughCursorResponseBuilderWithPartialResults
     ASSERT(!cursorBuilderIt.more());
 }
 
+TEST(CursorResponseTest, reserveReplyBytesForBatchAvoidsRegrowingReply) {
+    std::vector<BSONObj> batch;
+    for (int i = 0; i < 20000; ++i) {
+        batch.push_back(BSON("_id" << i << "payload" << std::string(100, 'x')));
+    }
+
+    rpc::OpMsgReplyBuilder builder;
+    reserveReplyBytesForBatch(batch, &builder);
+    const char* reservedBuffer = builder.getBodyBuilder().bb().buf();
+
+    CursorResponseBuilder::Options options;
+    CursorResponseBuilder crb(&builder, options);
+    for (const auto& obj : batch) {
+        crb.append(obj);
+    }
+    crb.done(CursorId(123), "db.coll");
+    builder.getBodyBuilder().append("ok", 1.0);
+
+    // The whole reply fit in the buffer allocated up front.
+    auto msg = builder.done();
+    ASSERT_EQ(msg.buf(), reservedBuffer);
+
+    auto swCursorResponse = CursorResponse::parseFromBSON(OpMsg::parse(msg).body);
+    ASSERT_OK(swCursorResponse.getStatus());
+    ASSERT_EQ(swCursorResponse.getValue().getBatch().size(), batch.size());
+}
+
 TEST(CursorResponseTest, parseFromBSONHandleErrorResponse) {
     StatusWith<CursorResponse> result =
         CursorResponse::parseFromBSON(BSON("ok" << 0 << "code" << 123 << "errmsg"
@@ -1025,6 +1025,10 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getClassicExecu
     std::unique_ptr<CanonicalQuery> canonicalQuery,
     PlanYieldPolicy::YieldPolicy yieldPolicy,
     size_t plannerOptions) {
+    tassert(5843123,
+            "Pipeline stages pushed down into a query can only be executed by SBE",
+            canonicalQuery->pipeline().empty());
+
     auto ws = std::make_unique<WorkingSet>();
     ClassicPrepareExecutionHelper helper{
         opCtx, *collection, ws.get(), canonicalQuery.get(), nullptr, plannerOptions};
@@ -1165,10 +1169,11 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getSlotBasedExe
                                        std::move(yieldPolicy));
 }
 
-// Checks if the given query can be executed with the SBE engine.
-inline bool isQuerySbeCompatible(OperationContext* opCtx,
-                                 const CanonicalQuery* const cq,
-                                 size_t plannerOptions) {
+}  // namespace
+
+bool isQuerySbeCompatible(OperationContext* opCtx,
+                          const CanonicalQuery* const cq,
+                          size_t plannerOptions) {
     invariant(cq);
     auto expCtx = cq->getExpCtxRaw();
     const auto& sortPattern = cq->getSortPattern();
@@ -1193,7 +1198,6 @@ inline bool isQuerySbeCompatible(OperationContext* opCtx,
         isNotLegacy && doesNotNeedEnsureSorted && isQueryNotAgainstTimeseriesCollection &&
         doesNotSortOnMetaOrPathWithNumericComponents;
 }
-}  // namespace
 
 StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutor(
     OperationContext* opCtx,
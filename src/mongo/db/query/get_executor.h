@@ -110,6 +110,13 @@ bool shouldWaitForOplogVisibility(OperationContext* opCtx,
                                   const CollectionPtr& collection,
                                   bool tailable);
 
+/**
+ * Checks if the given query can be executed with the SBE engine.
+ */
+bool isQuerySbeCompatible(OperationContext* opCtx,
+                          const CanonicalQuery* const cq,
+                          size_t plannerOptions);
+
 /**
  * Get a plan executor for a query.
  *
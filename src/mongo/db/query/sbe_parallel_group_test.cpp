@@ -0,0 +1,171 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+/**
+ * This file contains tests for the parallel execution of pushed down $group stages in SBE.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/catalog/catalog_test_fixture.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/exec/sbe/stages/exchange.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/pipeline/inner_pipeline_stage_impl.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/sbe_stage_builder.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo::stage_builder {
+namespace {
+const NamespaceString kNss{"test.coll"};
+
+// Enough documents for the parallel scan to split the collection into several ranges.
+const int kNumDocs = 50000;
+const int kNumGroups = 7;
+
+class SbeParallelGroupTest : public CatalogTestFixture {
+protected:
+    // The parallel scan samples its ranges with a random cursor.
+    SbeParallelGroupTest() : CatalogTestFixture("wiredTiger") {}
+
+    void setUp() override {
+        CatalogTestFixture::setUp();
+        ASSERT_OK(storageInterface()->createCollection(
+            operationContext(), kNss, CollectionOptions()));
+
+        std::vector<InsertStatement> inserts;
+        for (int i = 0; i < kNumDocs; ++i) {
+            inserts.emplace_back(BSON("_id" << i << "a" << i % kNumGroups << "b" << 1));
+        }
+        ASSERT_OK(storageInterface()->insertDocuments(operationContext(), kNss, inserts));
+    }
+
+    /**
+     * Builds the SBE plan for a collection scan feeding the $group stage 'groupSpec'.
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageData> buildGroup(const BSONObj& groupSpec) {
+        auto opCtx = operationContext();
+        auto expCtx = make_intrusive<ExpressionContextForTest>(opCtx, kNss);
+
+        auto csn = std::make_unique<CollectionScanNode>();
+        csn->name = kNss.ns();
+        csn->direction = CollectionScanParams::FORWARD;
+        QuerySolution querySolution{QueryPlannerParams::Options::DEFAULT};
+        querySolution.setRoot(std::move(csn));
+
+        auto cq = unittest::assertGet(CanonicalQuery::canonicalize(
+            opCtx, std::make_unique<FindCommandRequest>(kNss), false, expCtx));
+        std::vector<std::unique_ptr<InnerPipelineStageInterface>> pipeline;
+        pipeline.push_back(std::make_unique<InnerPipelineStageImpl>(
+            DocumentSourceGroup::createFromBson(groupSpec.firstElement(), expCtx)));
+        cq->setPipeline(std::move(pipeline));
+
+        AutoGetCollectionForRead coll(opCtx, kNss);
+        SlotBasedStageBuilder builder{opCtx,
+                                      coll.getCollection(),
+                                      *cq,
+                                      querySolution,
+                                      nullptr /* yieldPolicy */,
+                                      nullptr /* shardFilterer */};
+        auto stage = builder.build(querySolution.root());
+        return {std::move(stage), builder.getPlanStageData()};
+    }
+
+    /**
+     * Runs the plan built by 'buildGroup()' and returns the groups indexed by their key.
+     */
+    BSONObj runGroup(sbe::PlanStage* stage, PlanStageData& data) {
+        stage->attachToOperationContext(operationContext());
+        stage->prepare(data.ctx);
+        auto resultAccessor =
+            stage->getAccessor(data.ctx, data.outputs.get(PlanStageSlots::kResult));
+        stage->open(false);
+
+        BSONObjBuilder resultsBob;
+        for (auto st = stage->getNext(); st == sbe::PlanState::ADVANCED; st = stage->getNext()) {
+            auto [tag, val] = resultAccessor->getViewOfValue();
+            ASSERT_TRUE(tag == sbe::value::TypeTags::Object);
+            BSONObjBuilder bob;
+            sbe::bson::convertToBsonObj(bob, sbe::value::getObjectView(val));
+            auto group = bob.obj();
+            resultsBob.append(group["_id"].toString(false), group);
+        }
+        stage->close();
+        return resultsBob.obj();
+    }
+
+    static bool isParallel(const sbe::PlanStage& stage) {
+        auto plan = sbe::DebugPrinter{}.print(stage.debugPrint());
+        return plan.find("pscan") != std::string::npos &&
+            plan.find("exchange") != std::string::npos;
+    }
+};
+
+TEST_F(SbeParallelGroupTest, EveryDocumentIsAggregatedOnce) {
+    RAIIServerParameterControllerForTest dop("internalQueryDefaultDOP", 4);
+    auto [stage, data] = buildGroup(fromjson("{$group: {_id: '$a', n: {$sum: '$b'}}}"));
+    ASSERT_TRUE(isParallel(*stage));
+
+    auto results = runGroup(stage.get(), data);
+    ASSERT_EQ(results.nFields(), kNumGroups);
+    for (int group = 0; group < kNumGroups; ++group) {
+        auto expectedCount = kNumDocs / kNumGroups + (group < kNumDocs % kNumGroups ? 1 : 0);
+        ASSERT_EQ(results[std::to_string(group)]["n"].numberInt(), expectedCount);
+    }
+}
+
+TEST_F(SbeParallelGroupTest, OrderSensitiveAccumulatorsAreAggregatedSerially) {
+    RAIIServerParameterControllerForTest dop("internalQueryDefaultDOP", 4);
+    for (auto&& groupSpec : {"{$group: {_id: '$a', f: {$first: '$b'}}}",
+                             "{$group: {_id: '$a', l: {$last: '$b'}}}"}) {
+        ASSERT_FALSE(isParallel(*buildGroup(fromjson(groupSpec)).first));
+    }
+}
+
+TEST_F(SbeParallelGroupTest, FallsBackToSerialWithoutThreadsLeft) {
+    RAIIServerParameterControllerForTest dop("internalQueryDefaultDOP", 4);
+    auto reservation = sbe::ExchangeThreadReservation::tryReserve(128 - 7);
+    ASSERT(reservation);
+
+    auto [stage, data] = buildGroup(fromjson("{$group: {_id: '$a', n: {$sum: '$b'}}}"));
+    ASSERT_FALSE(isParallel(*stage));
+    ASSERT_EQ(runGroup(stage.get(), data).nFields(), kNumGroups);
+
+    // The threads are available again once the other plan is gone.
+    reservation.reset();
+    ASSERT_TRUE(isParallel(*buildGroup(fromjson("{$group: {_id: '$a', n: {$sum: '$b'}}}")).first));
+}
+}  // namespace
+}  // namespace mongo::stage_builder
@@ -35,9 +35,12 @@
 
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/exec/sbe/stages/co_scan.h"
+#include "mongo/db/exec/sbe/stages/exchange.h"
 #include "mongo/db/exec/sbe/stages/filter.h"
 #include "mongo/db/exec/sbe/stages/hash_agg.h"
 #include "mongo/db/exec/sbe/stages/hash_join.h"
+#include "mongo/db/exec/sbe/stages/hash_lookup.h"
+#include "mongo/db/exec/sbe/stages/ix_scan.h"
 #include "mongo/db/exec/sbe/stages/limit_skip.h"
 #include "mongo/db/exec/sbe/stages/loop_join.h"
 #include "mongo/db/exec/sbe/stages/makeobj.h"
@@ -49,18 +52,26 @@
 #include "mongo/db/exec/sbe/stages/traverse.h"
 #include "mongo/db/exec/sbe/stages/union.h"
 #include "mongo/db/exec/sbe/stages/unique.h"
+#include "mongo/db/exec/sbe/stages/unwind.h"
 #include "mongo/db/exec/sbe/values/sort_spec.h"
 #include "mongo/db/exec/shard_filterer.h"
 #include "mongo/db/fts/fts_index_format.h"
 #include "mongo/db/fts/fts_query_impl.h"
 #include "mongo/db/fts/fts_spec.h"
 #include "mongo/db/index/fts_access_method.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_lookup.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/db/query/sbe_stage_builder_accumulator.h"
 #include "mongo/db/query/sbe_stage_builder_coll_scan.h"
+#include "mongo/db/query/sbe_stage_builder_expression.h"
 #include "mongo/db/query/sbe_stage_builder_filter.h"
 #include "mongo/db/query/sbe_stage_builder_helpers.h"
 #include "mongo/db/query/sbe_stage_builder_index_scan.h"
+#include "mongo/db/query/sbe_stage_builder_lookup.h"
 #include "mongo/db/query/sbe_stage_builder_projection.h"
 #include "mongo/db/query/util/make_data_structure.h"
+#include "mongo/db/repl/read_concern_args.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/storage/execution_context.h"
 #include "mongo/logv2/log.h"
@@ -283,6 +294,77 @@ const QuerySolutionNode* getNodeByType(const QuerySolutionNode* root, StageType
     return nullptr;
 }
 
+/**
+ * Every producer of an exchange runs on a thread of the parallel execution pool, and partitioned
+ * aggregation stacks two exchanges on top of each other. This keeps both of them within the size
+ * of the pool, so that a single query can always reserve its threads when the pool is idle.
+ */
+constexpr size_t kMaxDegreeOfParallelism = 64;
+
+/**
+ * The number of threads of the parallel execution pool needed by a plan scanning with
+ * 'degreeOfParallelism' threads: one per producer of the partitioning exchange and one per producer
+ * of the gathering exchange on top of it.
+ */
+size_t numExchangeThreads(size_t degreeOfParallelism) {
+    return 2 * degreeOfParallelism;
+}
+
+/**
+ * Returns the number of threads the plan for 'solution' should be executed with, as configured by
+ * 'internalQueryDefaultDOP'. Only a forward scan of a regular collection whose documents are
+ * grouped by a pushed down $group is parallelized: the order in which the documents are scanned
+ * does not matter there, as long as no accumulator depends on it, and the groups can be partitioned
+ * between the threads. The threads read under their own operation contexts and storage snapshots,
+ * so queries which require a particular snapshot, run in a transaction, or are being explained are
+ * executed serially.
+ */
+size_t computeDegreeOfParallelism(OperationContext* opCtx,
+                                  const CollectionPtr& collection,
+                                  const CanonicalQuery& cq,
+                                  const QuerySolution& solution) {
+    auto degreeOfParallelism = static_cast<size_t>(internalQueryDefaultDOP.load());
+    if (degreeOfParallelism <= 1) {
+        return 1;
+    }
+
+    auto root = solution.root();
+    if (!collection || collection->ns().isOplog() || root->getType() != STAGE_COLLSCAN) {
+        return 1;
+    }
+
+    auto csn = static_cast<const CollectionScanNode*>(root);
+    if (csn->direction != CollectionScanParams::FORWARD || csn->tailable || csn->minRecord ||
+        csn->maxRecord || csn->resumeAfterRecordId || csn->requestResumeToken ||
+        csn->shouldTrackLatestOplogTimestamp) {
+        return 1;
+    }
+
+    // The rows are partitioned between the threads by a hash of the group key which does not take
+    // the collation into account.
+    if (cq.pipeline().empty() || cq.getCollator()) {
+        return 1;
+    }
+    auto groupStage =
+        dynamic_cast<const DocumentSourceGroup*>(cq.pipeline().front()->documentSource());
+    if (!groupStage ||
+        std::any_of(groupStage->getAccumulatedFields().begin(),
+                    groupStage->getAccumulatedFields().end(),
+                    [](auto&& acc) { return isAccumulatorOrderSensitive(acc); })) {
+        return 1;
+    }
+
+    const auto& readConcernArgs = repl::ReadConcernArgs::get(opCtx);
+    if (cq.getExpCtx()->explain || opCtx->inMultiDocumentTransaction() ||
+        readConcernArgs.getLevel() != repl::ReadConcernLevel::kLocalReadConcern ||
+        readConcernArgs.getArgsAfterClusterTime() || readConcernArgs.getArgsAtClusterTime() ||
+        readConcernArgs.getArgsOpTime()) {
+        return 1;
+    }
+
+    return std::min(degreeOfParallelism, kMaxDegreeOfParallelism);
+}
+
 sbe::LockAcquisitionCallback makeLockAcquisitionCallback(bool checkNodeCanServeReads) {
     if (!checkNodeCanServeReads) {
         return {};
@@ -487,6 +569,22 @@ SlotBasedStageBuilder::SlotBasedStageBuilder(OperationContext* opCtx,
         auto vsn = static_cast<const VirtualScanNode*>(node);
         _shouldProduceRecordIdSlot = vsn->hasRecordId;
     }
+
+    // The documents produced by the aggregation pipeline stages pushed down into the query do not
+    // have record ids.
+    if (!_cq.pipeline().empty()) {
+        _shouldProduceRecordIdSlot = false;
+    }
+
+    _degreeOfParallelism = computeDegreeOfParallelism(_opCtx, _collection, _cq, solution);
+    if (_degreeOfParallelism > 1) {
+        // Execute the plan serially rather than wait for threads which other queries are using.
+        _exchangeThreadReservation =
+            sbe::ExchangeThreadReservation::tryReserve(numExchangeThreads(_degreeOfParallelism));
+        if (!_exchangeThreadReservation) {
+            _degreeOfParallelism = 1;
+        }
+    }
 }
 
 std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::build(const QuerySolutionNode* root) {
@@ -503,6 +601,31 @@ std::unique_ptr<sbe::PlanStage> SlotBasedStageBuilder::build(const QuerySolution
     // Build the SBE plan stage tree.
     auto [stage, outputs] = build(root, reqs);
 
+    // Lower the aggregation pipeline stages which were pushed down into the query on top of the
+    // plan for the find part of the query. Only the stage sitting directly on top of a parallel
+    // scan is executed in parallel.
+    auto degreeOfParallelism = _degreeOfParallelism;
+    for (auto&& innerStage : _cq.pipeline()) {
+        auto source = innerStage->documentSource();
+        std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> lowered;
+        if (auto groupStage = dynamic_cast<const DocumentSourceGroup*>(source)) {
+            lowered = buildGroup(
+                std::move(stage), outputs, *groupStage, degreeOfParallelism, root->nodeId());
+        } else if (auto lookupStage =
+                       dynamic_cast<const InnerPipelineLookupStage*>(innerStage.get())) {
+            lowered = buildLookup(std::move(stage),
+                                  outputs,
+                                  lookupStage->lookupStage(),
+                                  lookupStage->plan(),
+                                  root->nodeId());
+        } else {
+            tasserted(5843120, "Only $group and $lookup stages can be pushed down into SBE");
+        }
+        stage = std::move(lowered.first);
+        outputs = std::move(lowered.second);
+        degreeOfParallelism = 1;
+    }
+
     // Assert that we produced a 'resultSlot' and that we prouced a 'recordIdSlot' if the
     // 'shouldProduceRecordIdSlot' flag was set. Also assert that we produced an 'oplogTsSlot' if
     // it's needed.
@@ -528,6 +651,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                              _yieldPolicy,
                                              _data.env,
                                              reqs.getIsTailableCollScanResumeBranch(),
+                                             _degreeOfParallelism > 1 /* parallelScan */,
                                              _lockAcquisitionCallback);
 
     if (reqs.has(kReturnKey)) {
@@ -705,11 +829,17 @@ SlotBasedStageBuilder::makeLoopJoinForFetch(std::unique_ptr<sbe::PlanStage> inpu
     auto resultSlot = _slotIdGenerator.generate();
     auto recordIdSlot = _slotIdGenerator.generate();
 
-    using namespace std::placeholders;
-    sbe::ScanCallbacks callbacks(
-        _lockAcquisitionCallback,
-        indexKeyCorruptionCheckCallback,
-        std::bind(indexKeyConsistencyCheckCallback, _1, std::move(iamMap), _2, _3, _4, _5));
+    // The placeholders are qualified because boost's are visible in the global namespace too.
+    namespace ph = std::placeholders;
+    sbe::ScanCallbacks callbacks(_lockAcquisitionCallback,
+                                 indexKeyCorruptionCheckCallback,
+                                 std::bind(indexKeyConsistencyCheckCallback,
+                                           ph::_1,
+                                           std::move(iamMap),
+                                           ph::_2,
+                                           ph::_3,
+                                           ph::_4,
+                                           ph::_5));
     // Scan the collection in the range [seekKeySlot, Inf).
     auto scanStage = sbe::makeS<sbe::ScanStage>(_collection->uuid(),
                                                 resultSlot,
@@ -1692,6 +1822,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                         innerCondSlots,
                                                         innerProjectSlots,
                                                         collatorSlot,
+                                                        _cq.getExpCtx()->allowDiskUse,
                                                         root->nodeId());
 
     // If there are more than 2 children, iterate all remaining children and hash
@@ -1714,6 +1845,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
                                                        innerCondSlots,
                                                        innerProjectSlots,
                                                        collatorSlot,
+                                                       _cq.getExpCtx()->allowDiskUse,
                                                        root->nodeId());
     }
 
@@ -2160,6 +2292,314 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder
             std::move(outputs)};
 }
 
+std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder::buildGroup(
+    std::unique_ptr<sbe::PlanStage> stage,
+    const PlanStageSlots& outputs,
+    const DocumentSourceGroup& groupStage,
+    size_t degreeOfParallelism,
+    PlanNodeId planNodeId) {
+    tassert(5843121, "Merging $group stages are not supported in SBE", !groupStage.doingMerge());
+
+    auto idFields = groupStage.getIdFields();
+    tassert(5843122,
+            "Only $group stages with a single _id expression are supported in SBE",
+            idFields.size() == 1 && idFields.count("_id"));
+
+    auto rootSlot = outputs.get(kResult);
+    auto collatorSlot = _data.env->getSlotIfExists("collator"_sd);
+
+    // Every expression is evaluated against the document in 'rootSlot', and the slots they are
+    // projected into must be visible to the expressions generated after them.
+    auto relevantSlots = sbe::makeSV(rootSlot);
+    auto projectExpression = [&](Expression* expr) {
+        auto [slot, sbeExpr, exprStage] = generateExpression(_opCtx,
+                                                             expr,
+                                                             std::move(stage),
+                                                             &_slotIdGenerator,
+                                                             &_frameIdGenerator,
+                                                             rootSlot,
+                                                             _data.env,
+                                                             planNodeId,
+                                                             &relevantSlots);
+        stage = sbe::makeProjectStage(std::move(exprStage), planNodeId, slot, std::move(sbeExpr));
+        relevantSlots.push_back(slot);
+        return slot;
+    };
+
+    // A missing group key is grouped as null.
+    auto idSlot = projectExpression(idFields["_id"].get());
+    auto groupBySlot = _slotIdGenerator.generate();
+    stage = sbe::makeProjectStage(std::move(stage),
+                                  planNodeId,
+                                  groupBySlot,
+                                  makeFillEmptyNull(makeVariable(idSlot)));
+
+    sbe::value::SlotMap<std::unique_ptr<sbe::EExpression>> aggs;
+    sbe::HashAggStage::MergingExprMap mergingExprs;
+    std::vector<sbe::value::SlotVector> aggSlotsByAccumulator;
+    auto aggInputSlots = sbe::makeSV(groupBySlot);
+    for (auto&& acc : groupStage.getAccumulatedFields()) {
+        auto argSlot = projectExpression(acc.expr.argument.get());
+        aggInputSlots.push_back(argSlot);
+
+        auto accExprs = buildAccumulator(acc, argSlot, collatorSlot);
+        sbe::value::SlotVector aggSlots;
+        sbe::value::SlotVector spilledSlots;
+        for (auto&& accExpr : accExprs) {
+            aggSlots.push_back(_slotIdGenerator.generate());
+            spilledSlots.push_back(_slotIdGenerator.generate());
+            aggs.emplace(aggSlots.back(), std::move(accExpr));
+        }
+
+        auto mergeExprs = buildAccumulatorMerge(acc, spilledSlots, collatorSlot);
+        for (size_t idx = 0; idx < mergeExprs.size(); ++idx) {
+            mergingExprs.emplace(aggSlots[idx],
+                                 std::make_pair(spilledSlots[idx], std::move(mergeExprs[idx])));
+        }
+        aggSlotsByAccumulator.push_back(std::move(aggSlots));
+    }
+
+    if (degreeOfParallelism > 1) {
+        // Route the rows produced by the threads scanning the collection to the thread aggregating
+        // their group, so that every group is aggregated by exactly one of the threads.
+        stage = sbe::makeS<sbe::ExchangeConsumer>(
+            std::move(stage),
+            degreeOfParallelism,
+            std::move(aggInputSlots),
+            sbe::ExchangePolicy::partition,
+            makeFunction("shardHash"_sd, makeVariable(groupBySlot)),
+            nullptr /* orderLess */,
+            planNodeId);
+    }
+
+    // Every thread aggregates its share of the groups in a copy of the stage, so they share the
+    // memory budget of a single $group.
+    const auto memoryBudget = std::max(
+        internalQuerySBEAggApproxMemoryUseInBytesBeforeSpill.load() /
+            static_cast<long long>(degreeOfParallelism),
+        1LL);
+    stage = sbe::makeS<sbe::HashAggStage>(std::move(stage),
+                                          sbe::makeSV(groupBySlot),
+                                          std::move(aggs),
+                                          collatorSlot,
+                                          _cq.getExpCtx()->allowDiskUse,
+                                          std::move(mergingExprs),
+                                          planNodeId,
+                                          memoryBudget);
+
+    // Assemble the output documents, with the group key in the _id field followed by the values of
+    // the accumulators in the order they were specified.
+    auto fieldExprs = sbe::makeEs(makeConstant("_id"_sd), makeVariable(groupBySlot));
+    auto&& accumulatedFields = groupStage.getAccumulatedFields();
+    for (size_t idx = 0; idx < accumulatedFields.size(); ++idx) {
+        fieldExprs.push_back(makeConstant(accumulatedFields[idx].fieldName));
+        fieldExprs.push_back(buildFinalize(accumulatedFields[idx], aggSlotsByAccumulator[idx]));
+    }
+
+    PlanStageSlots groupOutputs;
+    groupOutputs.set(kResult, _slotIdGenerator.generate());
+    stage = sbe::makeProjectStage(std::move(stage),
+                                  planNodeId,
+                                  groupOutputs.get(kResult),
+                                  sbe::makeE<sbe::EFunction>("newObj", std::move(fieldExprs)));
+
+    if (degreeOfParallelism > 1) {
+        // Gather the groups aggregated by all the threads.
+        invariant(_exchangeThreadReservation);
+        stage = sbe::makeS<sbe::ExchangeConsumer>(std::move(stage),
+                                                  degreeOfParallelism,
+                                                  sbe::makeSV(groupOutputs.get(kResult)),
+                                                  sbe::ExchangePolicy::roundrobin,
+                                                  nullptr /* partition */,
+                                                  nullptr /* orderLess */,
+                                                  planNodeId,
+                                                  std::move(_exchangeThreadReservation));
+    }
+
+    return {std::move(stage), std::move(groupOutputs)};
+}
+
+std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder::buildLookup(
+    std::unique_ptr<sbe::PlanStage> stage,
+    const PlanStageSlots& outputs,
+    const DocumentSourceLookUp& lookupStage,
+    const LookupPlan& lookupPlan,
+    PlanNodeId planNodeId) {
+    auto rootSlot = outputs.get(kResult);
+    auto collatorSlot = _data.env->getSlotIfExists("collator"_sd);
+    auto foreignUuid = lookupPlan.foreignCollectionUuid;
+    auto foreignField = lookupStage.getForeignField()->fullPath();
+
+    auto localKeySlot = _slotIdGenerator.generate();
+    stage = sbe::makeProjectStage(
+        std::move(stage),
+        planNodeId,
+        localKeySlot,
+        makeFunction("getField"_sd,
+                     makeVariable(rootSlot),
+                     makeConstant(lookupStage.getLocalField()->fullPath())));
+
+    // The foreign documents, along with the value of their foreign field.
+    auto foreignResultSlot = _slotIdGenerator.generate();
+    auto foreignKeySlot = _slotIdGenerator.generate();
+    auto lookupResultSlot = _slotIdGenerator.generate();
+
+    if (lookupPlan.strategy == LookupStrategy::kHashJoin) {
+        auto foreignStage =
+            sbe::makeS<sbe::ScanStage>(foreignUuid,
+                                       foreignResultSlot,
+                                       boost::none /* recordIdSlot */,
+                                       boost::none /* snapshotIdSlot */,
+                                       boost::none /* indexIdSlot */,
+                                       boost::none /* indexKeySlot */,
+                                       boost::none /* keyPatternSlot */,
+                                       boost::none /* oplogTsSlot */,
+                                       std::vector<std::string>{foreignField},
+                                       sbe::makeSV(foreignKeySlot),
+                                       boost::none /* seekKeySlot */,
+                                       true /* forward */,
+                                       _yieldPolicy,
+                                       planNodeId,
+                                       sbe::ScanCallbacks(_lockAcquisitionCallback));
+
+        stage = sbe::makeS<sbe::HashLookupStage>(std::move(stage),
+                                                 std::move(foreignStage),
+                                                 localKeySlot,
+                                                 foreignKeySlot,
+                                                 foreignResultSlot,
+                                                 lookupResultSlot,
+                                                 collatorSlot,
+                                                 planNodeId);
+    } else {
+        // For every local key, look up the index keys equal to it. An array nested in the local
+        // field can match a foreign array as a whole, which is not indexed under the array
+        // itself, so it scans the whole index instead. The candidates found this way are then
+        // matched precisely by a HashLookupStage built over just them.
+        auto keySlot = _slotIdGenerator.generate();
+        auto keyIndexSlot = _slotIdGenerator.generate();
+        auto seekValueSlot = _slotIdGenerator.generate();
+        auto lowKeySlot = _slotIdGenerator.generate();
+        auto highKeySlot = _slotIdGenerator.generate();
+        auto foreignRecordIdSlot = _slotIdGenerator.generate();
+
+        auto keysStage = sbe::makeS<sbe::UnwindStage>(makeLimitCoScanTree(planNodeId),
+                                                      localKeySlot,
+                                                      keySlot,
+                                                      keyIndexSlot,
+                                                      true /* preserveNullAndEmptyArrays */,
+                                                      planNodeId);
+        keysStage = sbe::makeProjectStage(std::move(keysStage),
+                                          planNodeId,
+                                          seekValueSlot,
+                                          makeFillEmptyNull(makeVariable(keySlot)));
+
+        auto makeSeekKey = [&](sbe::value::TypeTags boundTag, KeyString::Discriminator discrim) {
+            auto scansWholeIndex = sbe::makeE<sbe::ETypeMatch>(makeVariable(seekValueSlot),
+                                                               getBSONTypeMask(BSONType::Array));
+            return makeFunction(
+                "ksFromValue"_sd,
+                makeConstant(sbe::value::TypeTags::NumberInt64,
+                             static_cast<int64_t>(lookupPlan.indexKeyStringVersion)),
+                makeConstant(sbe::value::TypeTags::NumberInt32, 0),
+                sbe::makeE<sbe::EIf>(std::move(scansWholeIndex),
+                                     makeConstant(boundTag, 0),
+                                     makeVariable(seekValueSlot)),
+                makeConstant(sbe::value::TypeTags::NumberInt64, static_cast<int64_t>(discrim)));
+        };
+        keysStage = sbe::makeProjectStage(
+            std::move(keysStage),
+            planNodeId,
+            lowKeySlot,
+            makeSeekKey(sbe::value::TypeTags::MinKey, KeyString::Discriminator::kExclusiveBefore),
+            highKeySlot,
+            makeSeekKey(sbe::value::TypeTags::MaxKey, KeyString::Discriminator::kExclusiveAfter));
+
+        auto indexScan = sbe::makeS<sbe::IndexScanStage>(foreignUuid,
+                                                         lookupPlan.indexName,
+                                                         true /* forward */,
+                                                         boost::none /* recordSlot */,
+                                                         foreignRecordIdSlot,
+                                                         boost::none /* snapshotIdSlot */,
+                                                         sbe::IndexKeysInclusionSet{},
+                                                         sbe::makeSV(),
+                                                         lowKeySlot,
+                                                         highKeySlot,
+                                                         _yieldPolicy,
+                                                         planNodeId,
+                                                         _lockAcquisitionCallback);
+
+        std::unique_ptr<sbe::PlanStage> foreignStage =
+            sbe::makeS<sbe::LoopJoinStage>(std::move(keysStage),
+                                           std::move(indexScan),
+                                           sbe::makeSV(),
+                                           sbe::makeSV(lowKeySlot, highKeySlot),
+                                           nullptr,
+                                           planNodeId);
+
+        // Overlapping seeks can find the same foreign document more than once.
+        foreignStage = sbe::makeS<sbe::UniqueStage>(
+            std::move(foreignStage), sbe::makeSV(foreignRecordIdSlot), planNodeId);
+
+        auto fetchStage = sbe::makeS<sbe::ScanStage>(foreignUuid,
+                                                     foreignResultSlot,
+                                                     boost::none /* recordIdSlot */,
+                                                     boost::none /* snapshotIdSlot */,
+                                                     boost::none /* indexIdSlot */,
+                                                     boost::none /* indexKeySlot */,
+                                                     boost::none /* keyPatternSlot */,
+                                                     boost::none /* oplogTsSlot */,
+                                                     std::vector<std::string>{foreignField},
+                                                     sbe::makeSV(foreignKeySlot),
+                                                     foreignRecordIdSlot,
+                                                     true /* forward */,
+                                                     nullptr /* yieldPolicy */,
+                                                     planNodeId,
+                                                     sbe::ScanCallbacks(_lockAcquisitionCallback));
+        foreignStage =
+            sbe::makeS<sbe::LoopJoinStage>(std::move(foreignStage),
+                                           makeLimitTree(std::move(fetchStage), planNodeId),
+                                           sbe::makeSV(),
+                                           sbe::makeSV(foreignRecordIdSlot),
+                                           nullptr,
+                                           planNodeId);
+
+        auto innerStage = sbe::makeS<sbe::HashLookupStage>(makeLimitCoScanTree(planNodeId),
+                                                            std::move(foreignStage),
+                                                            localKeySlot,
+                                                            foreignKeySlot,
+                                                            foreignResultSlot,
+                                                            lookupResultSlot,
+                                                            collatorSlot,
+                                                            planNodeId);
+
+        stage = sbe::makeS<sbe::LoopJoinStage>(std::move(stage),
+                                               std::move(innerStage),
+                                               sbe::makeSV(rootSlot),
+                                               sbe::makeSV(localKeySlot),
+                                               nullptr,
+                                               planNodeId);
+    }
+
+    // Store the matching foreign documents in the 'as' field of the local document. As in the
+    // classic $lookup, an existing 'as' field is overwritten in place, since it is a projected
+    // field of the stage rather than a dropped one, and a missing one is appended.
+    PlanStageSlots lookupOutputs;
+    lookupOutputs.set(kResult, _slotIdGenerator.generate());
+    stage = sbe::makeS<sbe::MakeBsonObjStage>(std::move(stage),
+                                              lookupOutputs.get(kResult),
+                                              rootSlot,
+                                              sbe::MakeBsonObjStage::FieldBehavior::drop,
+                                              std::vector<std::string>{},
+                                              std::vector<std::string>{
+                                                  lookupStage.getAsField().fullPath()},
+                                              sbe::makeSV(lookupResultSlot),
+                                              false /* forceNewObject */,
+                                              false /* returnOldObject */,
+                                              planNodeId);
+
+    return {std::move(stage), std::move(lookupOutputs)};
+}
+
 // Returns a non-null pointer to the root of a plan tree, or a non-OK status if the PlanStage tree
 // could not be constructed.
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> SlotBasedStageBuilder::build(
@@ -31,6 +31,7 @@
 
 #include "mongo/db/exec/sbe/expressions/expression.h"
 #include "mongo/db/exec/sbe/stages/collection_helpers.h"
+#include "mongo/db/exec/sbe/stages/exchange.h"
 #include "mongo/db/exec/sbe/values/slot.h"
 #include "mongo/db/exec/sbe/values/value.h"
 #include "mongo/db/exec/trial_period_utils.h"
@@ -38,6 +39,11 @@
 #include "mongo/db/query/shard_filterer_factory_interface.h"
 #include "mongo/db/query/stage_builder.h"
 
+namespace mongo {
+class DocumentSourceGroup;
+class DocumentSourceLookUp;
+}  // namespace mongo
+
 namespace mongo::stage_builder {
 /**
  * Creates a new compilation environment and registers global values within the
@@ -48,6 +54,7 @@ std::unique_ptr<sbe::RuntimeEnvironment> makeRuntimeEnvironment(
     OperationContext* opCtx,
     sbe::value::SlotIdGenerator* slotIdGenerator);
 
+struct LookupPlan;
 class PlanStageReqs;
 
 /**
@@ -364,6 +371,34 @@ private:
         const QuerySolutionNode* child,
         PlanStageReqs childReqs);
 
+    /**
+     * Lowers a $group stage which was pushed down from an aggregation pipeline into a HashAggStage
+     * on top of 'stage', which produces the documents to group in the 'kResult' slot of 'outputs'.
+     *
+     * If 'degreeOfParallelism' is greater than one, 'stage' is executed by as many threads, whose
+     * rows are partitioned by group key between as many HashAggStages. The aggregated groups are
+     * then gathered through another exchange, which holds on to the threads reserved for the plan.
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> buildGroup(
+        std::unique_ptr<sbe::PlanStage> stage,
+        const PlanStageSlots& outputs,
+        const DocumentSourceGroup& groupStage,
+        size_t degreeOfParallelism,
+        PlanNodeId planNodeId);
+
+    /**
+     * Lowers a $lookup stage which was pushed down from an aggregation pipeline on top of 'stage',
+     * which produces the local documents in the 'kResult' slot of 'outputs'. Depending on the
+     * indexes of the foreign collection, the join is either an indexed nested loop join or a hash
+     * join, as chosen by 'planLookup()' when the stage was pushed down and passed in 'lookupPlan'.
+     */
+    std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> buildLookup(
+        std::unique_ptr<sbe::PlanStage> stage,
+        const PlanStageSlots& outputs,
+        const DocumentSourceLookUp& lookupStage,
+        const LookupPlan& lookupPlan,
+        PlanNodeId planNodeId);
+
     sbe::value::SlotIdGenerator _slotIdGenerator;
     sbe::value::FrameIdGenerator _frameIdGenerator;
     sbe::value::SpoolIdGenerator _spoolIdGenerator;
@@ -377,6 +412,13 @@ private:
     bool _buildHasStarted{false};
     bool _shouldProduceRecordIdSlot{true};
 
+    // The number of threads scanning the collection when the plan is executed in parallel, or one.
+    size_t _degreeOfParallelism{1};
+
+    // The threads of the parallel execution pool set aside for a parallel plan, until they are
+    // handed over to the plan.
+    std::unique_ptr<sbe::ExchangeThreadReservation> _exchangeThreadReservation;
+
     // A factory to construct shard filters.
     ShardFiltererFactoryInterface* _shardFiltererFactory;
 
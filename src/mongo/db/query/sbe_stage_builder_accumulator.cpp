@@ -0,0 +1,185 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/sbe_stage_builder_accumulator.h"
+
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/query/sbe_stage_builder_helpers.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo::stage_builder {
+namespace {
+// The names of the accumulators as reported by AccumulatorState::getOpName().
+constexpr auto kAccumulatorSum = "$sum"_sd;
+constexpr auto kAccumulatorAvg = "$avg"_sd;
+constexpr auto kAccumulatorMin = "$min"_sd;
+constexpr auto kAccumulatorMax = "$max"_sd;
+constexpr auto kAccumulatorFirst = "$first"_sd;
+constexpr auto kAccumulatorLast = "$last"_sd;
+
+std::unique_ptr<sbe::EExpression> makeNothing() {
+    return makeConstant(sbe::value::TypeTags::Nothing, 0);
+}
+
+std::unique_ptr<sbe::EExpression> makeMinMax(StringData name,
+                                             std::unique_ptr<sbe::EExpression> arg,
+                                             boost::optional<sbe::value::SlotId> collatorSlot) {
+    if (collatorSlot) {
+        return makeFunction(name == "min"_sd ? "collMin"_sd : "collMax"_sd,
+                            makeVariable(*collatorSlot),
+                            std::move(arg));
+    }
+    return makeFunction(name, std::move(arg));
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildAccumulatorSum(sbe::value::SlotId argSlot) {
+    // The sum is kept with the same precision and type widening as the classic $sum accumulator.
+    return sbe::makeEs(makeFunction("aggDoubleDoubleSum", makeVariable(argSlot)));
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildAccumulatorAvg(sbe::value::SlotId argSlot) {
+    // The sum and the count of the numeric inputs are accumulated separately.
+    return sbe::makeEs(
+        makeFunction("aggDoubleDoubleSum", makeVariable(argSlot)),
+        makeFunction("sum",
+                     sbe::makeE<sbe::EIf>(makeFunction("isNumber", makeVariable(argSlot)),
+                                          makeConstant(sbe::value::TypeTags::NumberInt64,
+                                                       sbe::value::bitcastFrom<int64_t>(1)),
+                                          makeNothing())));
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildAccumulatorMinMax(
+    StringData name, sbe::value::SlotId argSlot, boost::optional<sbe::value::SlotId> collatorSlot) {
+    // Like the classic accumulator, nullish values (null, undefined and missing) do not take part
+    // in the comparison.
+    auto arg = sbe::makeE<sbe::EIf>(
+        sbe::makeE<sbe::ETypeMatch>(makeVariable(argSlot),
+                                    getBSONTypeMask(BSONType::jstNULL) |
+                                        getBSONTypeMask(BSONType::Undefined)),
+        makeNothing(),
+        makeVariable(argSlot));
+    return sbe::makeEs(makeMinMax(name, std::move(arg), collatorSlot));
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildAccumulatorFirstLast(
+    StringData name, sbe::value::SlotId argSlot) {
+    // Unlike the other accumulators, $first and $last take missing values into account.
+    return sbe::makeEs(makeFunction(name, makeFillEmptyNull(makeVariable(argSlot))));
+}
+}  // namespace
+
+bool isAccumulatorSbeCompatible(const AccumulationStatement& acc) {
+    static const StringDataSet kSupportedAccumulators = {kAccumulatorSum,
+                                                         kAccumulatorAvg,
+                                                         kAccumulatorMin,
+                                                         kAccumulatorMax,
+                                                         kAccumulatorFirst,
+                                                         kAccumulatorLast};
+    return kSupportedAccumulators.count(acc.makeAccumulator()->getOpName()) > 0;
+}
+
+bool isAccumulatorOrderSensitive(const AccumulationStatement& acc) {
+    auto accName = StringData{acc.makeAccumulator()->getOpName()};
+    return accName == kAccumulatorFirst || accName == kAccumulatorLast;
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildAccumulator(
+    const AccumulationStatement& acc,
+    sbe::value::SlotId argSlot,
+    boost::optional<sbe::value::SlotId> collatorSlot) {
+    auto accName = StringData{acc.makeAccumulator()->getOpName()};
+    if (accName == kAccumulatorSum) {
+        return buildAccumulatorSum(argSlot);
+    } else if (accName == kAccumulatorAvg) {
+        return buildAccumulatorAvg(argSlot);
+    } else if (accName == kAccumulatorMin) {
+        return buildAccumulatorMinMax("min"_sd, argSlot, collatorSlot);
+    } else if (accName == kAccumulatorMax) {
+        return buildAccumulatorMinMax("max"_sd, argSlot, collatorSlot);
+    } else if (accName == kAccumulatorFirst) {
+        return buildAccumulatorFirstLast("first"_sd, argSlot);
+    } else if (accName == kAccumulatorLast) {
+        return buildAccumulatorFirstLast("last"_sd, argSlot);
+    }
+    tasserted(5843130, str::stream() << "Unsupported accumulator in SBE: " << accName);
+}
+
+std::vector<std::unique_ptr<sbe::EExpression>> buildAccumulatorMerge(
+    const AccumulationStatement& acc,
+    const sbe::value::SlotVector& inputSlots,
+    boost::optional<sbe::value::SlotId> collatorSlot) {
+    auto accName = StringData{acc.makeAccumulator()->getOpName()};
+    std::vector<std::unique_ptr<sbe::EExpression>> exprs;
+    for (auto slot : inputSlots) {
+        if (accName == kAccumulatorSum) {
+            exprs.push_back(makeFunction("aggMergeDoubleDoubleSums", makeVariable(slot)));
+        } else if (accName == kAccumulatorAvg) {
+            // The first slot holds the partial sum and the second one the count.
+            exprs.push_back(exprs.empty()
+                                ? makeFunction("aggMergeDoubleDoubleSums", makeVariable(slot))
+                                : makeFunction("sum", makeVariable(slot)));
+        } else if (accName == kAccumulatorMin) {
+            exprs.push_back(makeMinMax("min"_sd, makeVariable(slot), collatorSlot));
+        } else if (accName == kAccumulatorMax) {
+            exprs.push_back(makeMinMax("max"_sd, makeVariable(slot), collatorSlot));
+        } else if (accName == kAccumulatorFirst) {
+            exprs.push_back(makeFunction("first", makeVariable(slot)));
+        } else if (accName == kAccumulatorLast) {
+            exprs.push_back(makeFunction("last", makeVariable(slot)));
+        } else {
+            tasserted(5843131, str::stream() << "Unsupported accumulator in SBE: " << accName);
+        }
+    }
+    return exprs;
+}
+
+std::unique_ptr<sbe::EExpression> buildFinalize(const AccumulationStatement& acc,
+                                                const sbe::value::SlotVector& aggSlots) {
+    auto accName = StringData{acc.makeAccumulator()->getOpName()};
+    if (accName == kAccumulatorSum) {
+        // The sum of no numeric values is 0.
+        return sbe::makeE<sbe::EFunction>(
+            "fillEmpty",
+            sbe::makeEs(makeFunction("doubleDoubleSumFinalize", makeVariable(aggSlots[0])),
+                        makeConstant(sbe::value::TypeTags::NumberInt32,
+                                     sbe::value::bitcastFrom<int32_t>(0))));
+    } else if (accName == kAccumulatorAvg) {
+        // The average of no numeric values is null.
+        return makeFillEmptyNull(makeFunction(
+            "doubleDoubleAvgFinalize", makeVariable(aggSlots[0]), makeVariable(aggSlots[1])));
+    }
+
+    // The accumulators computed by a single aggregate function produce null if all of their inputs
+    // were skipped.
+    return makeFillEmptyNull(makeVariable(aggSlots[0]));
+}
+}  // namespace mongo::stage_builder
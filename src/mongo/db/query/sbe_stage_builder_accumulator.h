@@ -0,0 +1,77 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include "mongo/db/exec/sbe/expressions/expression.h"
+#include "mongo/db/exec/sbe/values/slot.h"
+#include "mongo/db/pipeline/accumulation_statement.h"
+
+namespace mongo::stage_builder {
+/**
+ * Returns true if the accumulator used by 'acc' can be translated into SBE aggregate functions by
+ * 'buildAccumulator()'.
+ */
+bool isAccumulatorSbeCompatible(const AccumulationStatement& acc);
+
+/**
+ * Returns true if the value of the accumulator used by 'acc' depends on the order in which it
+ * receives its inputs, so that it cannot be computed over a parallel scan.
+ */
+bool isAccumulatorOrderSensitive(const AccumulationStatement& acc);
+
+/**
+ * Translates the accumulator used by 'acc' into one or more aggregate expressions of a
+ * HashAggStage, which accumulate the value held in 'argSlot'. Each of the expressions needs an
+ * output slot of its own; the partial results held in these slots are turned into the value of
+ * the accumulator by the expression returned from 'buildFinalize()'.
+ */
+std::vector<std::unique_ptr<sbe::EExpression>> buildAccumulator(
+    const AccumulationStatement& acc,
+    sbe::value::SlotId argSlot,
+    boost::optional<sbe::value::SlotId> collatorSlot);
+
+/**
+ * Builds the aggregate expressions which combine the partial results of the accumulator used by
+ * 'acc', read back from disk into 'inputSlots', when a HashAggStage has spilled. The expressions
+ * correspond one to one to those returned by 'buildAccumulator()'.
+ */
+std::vector<std::unique_ptr<sbe::EExpression>> buildAccumulatorMerge(
+    const AccumulationStatement& acc,
+    const sbe::value::SlotVector& inputSlots,
+    boost::optional<sbe::value::SlotId> collatorSlot);
+
+/**
+ * Builds an expression which computes the final value of the accumulator used by 'acc' from the
+ * partial results held in 'aggSlots'.
+ */
+std::unique_ptr<sbe::EExpression> buildFinalize(const AccumulationStatement& acc,
+                                                const sbe::value::SlotVector& aggSlots);
+}  // namespace mongo::stage_builder
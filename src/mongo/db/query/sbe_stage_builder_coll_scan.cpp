@@ -421,6 +421,9 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateOptimizedOplo
  *  - Else if 'isTailableResumeBranch' is true, the scan will start from a RecordId contained in
  * slot "resumeRecordId".
  *  - Otherwise the scan will start from the beginning of the collection.
+ *
+ * If 'parallelScan' is true, the collection is scanned with a "pscan" stage instead, which splits
+ * the collection into RecordId ranges shared by all of its clones.
  */
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollScan(
     OperationContext* opCtx,
@@ -431,6 +434,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
     PlanYieldPolicy* yieldPolicy,
     sbe::RuntimeEnvironment* env,
     bool isTailableResumeBranch,
+    bool parallelScan,
     sbe::LockAcquisitionCallback lockAcquisitionCallback) {
     const auto forward = csn->direction == CollectionScanParams::FORWARD;
 
@@ -459,21 +463,42 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateGenericCollSc
 
     sbe::ScanCallbacks callbacks(
         lockAcquisitionCallback, {}, {}, makeOpenCallbackIfNeeded(collection, csn));
-    auto stage = sbe::makeS<sbe::ScanStage>(collection->uuid(),
-                                            resultSlot,
-                                            recordIdSlot,
-                                            boost::none /* snapshotIdSlot */,
-                                            boost::none /* indexIdSlot */,
-                                            boost::none /* indexKeySlot */,
-                                            boost::none /* keyPatternSlot */,
-                                            tsSlot,
-                                            std::move(fields),
-                                            std::move(slots),
-                                            seekRecordIdSlot,
-                                            forward,
-                                            yieldPolicy,
-                                            csn->nodeId(),
-                                            std::move(callbacks));
+    std::unique_ptr<sbe::PlanStage> stage;
+    if (parallelScan) {
+        invariant(forward && !seekRecordIdSlot && !tsSlot);
+
+        // The clones of a parallel scan run on the threads of an exchange under their own
+        // operation contexts, so they cannot yield on behalf of the query. The exchange producers
+        // running them yield instead.
+        stage = sbe::makeS<sbe::ParallelScanStage>(collection->uuid(),
+                                                   resultSlot,
+                                                   recordIdSlot,
+                                                   boost::none /* snapshotIdSlot */,
+                                                   boost::none /* indexIdSlot */,
+                                                   boost::none /* indexKeySlot */,
+                                                   boost::none /* keyPatternSlot */,
+                                                   std::move(fields),
+                                                   std::move(slots),
+                                                   nullptr /* yieldPolicy */,
+                                                   csn->nodeId(),
+                                                   std::move(callbacks));
+    } else {
+        stage = sbe::makeS<sbe::ScanStage>(collection->uuid(),
+                                           resultSlot,
+                                           recordIdSlot,
+                                           boost::none /* snapshotIdSlot */,
+                                           boost::none /* indexIdSlot */,
+                                           boost::none /* indexKeySlot */,
+                                           boost::none /* keyPatternSlot */,
+                                           tsSlot,
+                                           std::move(fields),
+                                           std::move(slots),
+                                           seekRecordIdSlot,
+                                           forward,
+                                           yieldPolicy,
+                                           csn->nodeId(),
+                                           std::move(callbacks));
+    }
 
     // Check if the scan should be started after the provided resume RecordId and construct a nested
     // loop join sub-tree to project out the resume RecordId as a seekRecordIdSlot and feed it to
@@ -599,8 +624,10 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
     PlanYieldPolicy* yieldPolicy,
     sbe::RuntimeEnvironment* env,
     bool isTailableResumeBranch,
+    bool parallelScan,
     sbe::LockAcquisitionCallback lockAcquisitionCallback) {
     if (csn->minRecord || csn->maxRecord) {
+        invariant(!parallelScan);
         return generateOptimizedOplogScan(opCtx,
                                           collection,
                                           csn,
@@ -619,6 +646,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
                                        yieldPolicy,
                                        env,
                                        isTailableResumeBranch,
+                                       parallelScan,
                                        std::move(lockAcquisitionCallback));
     }
 }
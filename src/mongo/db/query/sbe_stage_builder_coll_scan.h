@@ -49,6 +49,9 @@ class PlanStageSlots;
  *     were requested to track this data.
  *   * A generated PlanStage sub-tree.
  *
+ * If 'parallelScan' is true, the generated sub-tree is meant to be cloned across the producers of
+ * an exchange, which then share the scan of the collection.
+ *
  * In cases of an error, throws.
  */
 std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
@@ -60,6 +63,7 @@ std::pair<std::unique_ptr<sbe::PlanStage>, PlanStageSlots> generateCollScan(
     PlanYieldPolicy* yieldPolicy,
     sbe::RuntimeEnvironment* env,
     bool isTailableResumeBranch,
+    bool parallelScan,
     sbe::LockAcquisitionCallback lockAcquisitionCallback);
 
 }  // namespace mongo::stage_builder
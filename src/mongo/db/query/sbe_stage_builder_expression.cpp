@@ -1132,6 +1132,8 @@ public:
                                           sbe::makeSV(),
                                           sbe::makeEM(groupSlot, std::move(addToArrayExpr)),
                                           collatorSlot,
+                                          false,
+                                          sbe::HashAggStage::MergingExprMap{},
                                           _context->planNodeId);
         EvalStage groupEvalStage = {std::move(groupStage), sbe::makeSV(groupSlot)};
 
@@ -1161,6 +1163,8 @@ public:
             sbe::makeSV(),
             sbe::makeEM(finalGroupSlot, std::move(finalAddToArrayExpr)),
             collatorSlot,
+            false,
+            sbe::HashAggStage::MergingExprMap{},
             _context->planNodeId);
 
         // Create a branch stage to select between the branch that produces one null if any elements
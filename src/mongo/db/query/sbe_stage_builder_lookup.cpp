@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/sbe_stage_builder_lookup.h"
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_catalog.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/query/query_knobs_gen.h"
+
+namespace mongo::stage_builder {
+namespace {
+/**
+ * Returns true if the keys of 'entry' can be looked up to find all the documents of the foreign
+ * collection whose 'foreignField' may match a given value.
+ */
+bool isIndexSuitableForLookup(const IndexCatalogEntry* entry,
+                              StringData foreignField,
+                              const CollatorInterface* collator) {
+    auto desc = entry->descriptor();
+    if (desc->getIndexType() != INDEX_BTREE || desc->hidden() || desc->isSparse() ||
+        desc->isPartial()) {
+        return false;
+    }
+
+    // The seek keys are built from the local values as they are, so they cannot be compared with
+    // collation-aware index keys.
+    if (collator || !desc->collation().isEmpty()) {
+        return false;
+    }
+
+    auto firstKey = desc->keyPattern().firstElement();
+    return firstKey.fieldNameStringData() == foreignField && firstKey.isNumber() &&
+        firstKey.number() > 0;
+}
+}  // namespace
+
+boost::optional<LookupPlan> planLookup(OperationContext* opCtx,
+                                       const DocumentSourceLookUp& lookupStage,
+                                       const CollatorInterface* collator) {
+    if (!lookupStage.hasLocalFieldForeignFieldJoin() || lookupStage.hasPipeline() ||
+        !lookupStage.getLetVariables().empty() || lookupStage.hasAbsorbedStages() ||
+        lookupStage.isFromNsView()) {
+        return boost::none;
+    }
+
+    auto localField = lookupStage.getLocalField();
+    auto foreignField = lookupStage.getForeignField();
+    if (localField->getPathLength() != 1 || foreignField->getPathLength() != 1 ||
+        lookupStage.getAsField().getPathLength() != 1) {
+        return boost::none;
+    }
+
+    auto foreignColl = CollectionCatalog::get(opCtx)->lookupCollectionByNamespaceForRead(
+        opCtx, lookupStage.getFromNs());
+    if (!foreignColl) {
+        return boost::none;
+    }
+
+    LookupPlan plan{LookupStrategy::kHashJoin, foreignColl->uuid()};
+
+    auto it =
+        foreignColl->getIndexCatalog()->getIndexIterator(opCtx, false /* includeUnfinished */);
+    while (it->more()) {
+        auto entry = it->next();
+        if (isIndexSuitableForLookup(entry, foreignField->fullPath(), collator)) {
+            plan.strategy = LookupStrategy::kIndexedLoopJoin;
+            plan.indexName = entry->descriptor()->indexName();
+            plan.indexKeyStringVersion =
+                entry->accessMethod()->getSortedDataInterface()->getKeyStringVersion();
+            return plan;
+        }
+    }
+
+    if (foreignColl->dataSize(opCtx) >
+        internalQuerySBELookupHashJoinMaxForeignCollectionBytes.load()) {
+        return boost::none;
+    }
+    return plan;
+}
+}  // namespace mongo::stage_builder
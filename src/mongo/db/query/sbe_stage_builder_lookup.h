@@ -0,0 +1,106 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <string>
+
+#include "mongo/db/pipeline/document_source_lookup.h"
+#include "mongo/db/pipeline/inner_pipeline_stage_interface.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+class CollatorInterface;
+class OperationContext;
+
+namespace stage_builder {
+/**
+ * The join algorithms which the SBE stage builder can use to execute a $lookup.
+ */
+enum class LookupStrategy {
+    // Every local document looks its keys up in an index on the foreign field.
+    kIndexedLoopJoin,
+    // The foreign collection is loaded into a hash table which every local document probes.
+    kHashJoin,
+};
+
+struct LookupPlan {
+    LookupStrategy strategy;
+    CollectionUUID foreignCollectionUuid;
+
+    // The index to use, only set for 'kIndexedLoopJoin'.
+    std::string indexName;
+    KeyString::Version indexKeyStringVersion{KeyString::Version::kLatestVersion};
+};
+
+/**
+ * Chooses how 'lookupStage' can be executed as part of an SBE plan, or returns boost::none if it
+ * has to be executed by the pipeline. Only the localField/foreignField form of $lookup on top-level
+ * fields of an existing foreign collection, which is not a view, is supported. An indexed nested
+ * loop join is chosen if the foreign collection has a suitable index on the foreign field, and a
+ * hash join otherwise, provided that the foreign collection is no larger than
+ * 'internalQuerySBELookupHashJoinMaxForeignCollectionBytes'.
+ *
+ * The caller is responsible for checking that the foreign collection is not sharded.
+ */
+boost::optional<LookupPlan> planLookup(OperationContext* opCtx,
+                                       const DocumentSourceLookUp& lookupStage,
+                                       const CollatorInterface* collator);
+
+/**
+ * A $lookup stage pushed down into the query, along with the plan which 'planLookup()' chose for it
+ * at that time. The stage builder lowers the stage according to this plan, so that the checks made
+ * when pushing the stage down also hold for the plan which is built.
+ */
+class InnerPipelineLookupStage final : public InnerPipelineStageInterface {
+public:
+    InnerPipelineLookupStage(boost::intrusive_ptr<DocumentSourceLookUp> lookupStage,
+                             LookupPlan plan)
+        : _lookupStage(std::move(lookupStage)), _plan(std::move(plan)) {}
+
+    DocumentSource* documentSource() const final {
+        return _lookupStage.get();
+    }
+
+    const DocumentSourceLookUp& lookupStage() const {
+        return *_lookupStage;
+    }
+
+    const LookupPlan& plan() const {
+        return _plan;
+    }
+
+private:
+    boost::intrusive_ptr<DocumentSourceLookUp> _lookupStage;
+    LookupPlan _plan;
+};
+}  // namespace stage_builder
+}  // namespace mongo
@@ -0,0 +1,293 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+/**
+ * This file contains tests for the lowering of $lookup stages into SBE plans.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+
+#include "mongo/db/catalog/catalog_test_fixture.h"
+#include "mongo/db/exec/sbe/values/bson.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/query/sbe_stage_builder.h"
+#include "mongo/db/query/sbe_stage_builder_lookup.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo::stage_builder {
+namespace {
+const NamespaceString kLocalNss{"test.local"};
+const NamespaceString kForeignNss{"test.foreign"};
+
+class SbeLookupTest : public CatalogTestFixture {
+protected:
+    void setUp() override {
+        CatalogTestFixture::setUp();
+        _expCtx = make_intrusive<ExpressionContextForTest>(operationContext(), kLocalNss);
+        _expCtx->setResolvedNamespaces(StringMap<ExpressionContext::ResolvedNamespace>{
+            {kForeignNss.coll().toString(), {kForeignNss, std::vector<BSONObj>()}}});
+    }
+
+    void createForeignCollection(const std::vector<BSONObj>& indexSpecs = {}) {
+        ASSERT_OK(storageInterface()->createCollection(
+            operationContext(), kForeignNss, CollectionOptions()));
+        if (!indexSpecs.empty()) {
+            ASSERT_OK(storageInterface()->createIndexesOnEmptyCollection(
+                operationContext(), kForeignNss, indexSpecs));
+        }
+    }
+
+    void insertForeignDocuments(const std::vector<BSONObj>& docs) {
+        std::vector<InsertStatement> inserts(docs.begin(), docs.end());
+        ASSERT_OK(storageInterface()->insertDocuments(operationContext(), kForeignNss, inserts));
+    }
+
+    static BSONObj makeIndexSpec(const BSONObj& keyPattern,
+                                 StringData name,
+                                 const BSONObj& options = {}) {
+        BSONObjBuilder bob;
+        bob.append("v", 2);
+        bob.append("key", keyPattern);
+        bob.append("name", name);
+        bob.appendElements(options);
+        return bob.obj();
+    }
+
+    boost::intrusive_ptr<DocumentSourceLookUp> makeLookup(StringData localField,
+                                                          StringData foreignField) {
+        auto lookupSpec = BSON("$lookup" << BSON("from" << kForeignNss.coll() << "localField"
+                                                        << localField << "foreignField"
+                                                        << foreignField << "as"
+                                                        << "out"));
+        auto lookup = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), _expCtx);
+        return static_cast<DocumentSourceLookUp*>(lookup.get());
+    }
+
+    boost::optional<LookupPlan> plan(const DocumentSourceLookUp& lookup,
+                                     const CollatorInterface* collator = nullptr) {
+        return planLookup(operationContext(), lookup, collator);
+    }
+
+    /**
+     * Runs 'lookup' over 'localDocs' as part of an SBE plan, using the strategy chosen by
+     * 'planLookup()', and returns the resulting documents.
+     */
+    std::vector<BSONObj> runLookup(const std::vector<BSONObj>& localDocs,
+                                   boost::intrusive_ptr<DocumentSourceLookUp> lookup,
+                                   LookupStrategy expectedStrategy) {
+        auto opCtx = operationContext();
+        auto lookupPlan = plan(*lookup);
+        ASSERT(lookupPlan);
+        ASSERT(lookupPlan->strategy == expectedStrategy);
+
+        std::vector<BSONArray> docs;
+        for (auto&& doc : localDocs) {
+            docs.push_back(BSON_ARRAY(doc));
+        }
+        QuerySolution querySolution{QueryPlannerParams::Options::DEFAULT};
+        querySolution.setRoot(
+            std::make_unique<VirtualScanNode>(docs, VirtualScanNode::ScanType::kCollScan, false));
+
+        auto cq = unittest::assertGet(CanonicalQuery::canonicalize(
+            opCtx, std::make_unique<FindCommandRequest>(kLocalNss), false, _expCtx));
+        std::vector<std::unique_ptr<InnerPipelineStageInterface>> pipeline;
+        pipeline.push_back(
+            std::make_unique<InnerPipelineLookupStage>(lookup, std::move(*lookupPlan)));
+        cq->setPipeline(std::move(pipeline));
+
+        SlotBasedStageBuilder builder{opCtx,
+                                      CollectionPtr::null,
+                                      *cq,
+                                      querySolution,
+                                      nullptr /* yieldPolicy */,
+                                      nullptr /* shardFilterer */};
+        auto stage = builder.build(querySolution.root());
+        auto data = builder.getPlanStageData();
+
+        stage->attachToOperationContext(opCtx);
+        stage->prepare(data.ctx);
+        auto resultAccessor =
+            stage->getAccessor(data.ctx, data.outputs.get(PlanStageSlots::kResult));
+        stage->open(false);
+
+        std::vector<BSONObj> results;
+        for (auto st = stage->getNext(); st == sbe::PlanState::ADVANCED; st = stage->getNext()) {
+            auto [tag, val] = resultAccessor->getViewOfValue();
+            if (tag == sbe::value::TypeTags::bsonObject) {
+                results.push_back(BSONObj(sbe::value::bitcastTo<const char*>(val)).getOwned());
+            } else {
+                ASSERT_TRUE(tag == sbe::value::TypeTags::Object);
+                BSONObjBuilder bob;
+                sbe::bson::convertToBsonObj(bob, sbe::value::getObjectView(val));
+                results.push_back(bob.obj());
+            }
+        }
+        stage->close();
+        return results;
+    }
+
+    /**
+     * Returns the sorted _id values of the documents in the 'out' array of 'doc'.
+     */
+    static std::vector<int> joinedIds(const BSONObj& doc) {
+        std::vector<int> ids;
+        for (auto&& joined : doc["out"].Array()) {
+            ids.push_back(joined.Obj()["_id"].numberInt());
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    /**
+     * Checks that the join produces the same matches as {foreignField: {$in: <local values>}}, and
+     * that an existing 'as' field keeps its position.
+     */
+    void runMatchSemanticsTest(LookupStrategy strategy) {
+        insertForeignDocuments({BSON("_id" << 0 << "b" << 1),
+                                BSON("_id" << 1 << "b" << BSON_ARRAY(1 << 2)),
+                                BSON("_id" << 2 << "b" << BSONNULL),
+                                BSON("_id" << 3),
+                                BSON("_id" << 4 << "b"
+                                           << "xyz"),
+                                BSON("_id" << 5 << "b" << BSONRegEx("^x")),
+                                BSON("_id" << 6 << "b" << BSON_ARRAY(BSON_ARRAY(1 << 2))),
+                                BSON("_id" << 7 << "b" << 1.0)});
+
+        auto results = runLookup({BSON("_id" << 0 << "a" << 1),
+                                  BSON("_id" << 1 << "a" << BSON_ARRAY(2 << 3)),
+                                  BSON("_id" << 2),
+                                  BSON("_id" << 3 << "a" << BSONRegEx("^x")),
+                                  BSON("_id" << 4 << "a" << BSON_ARRAY(BSON_ARRAY(1 << 2))),
+                                  BSON("_id" << 5 << "a" << 4),
+                                  BSON("_id" << 6 << "out"
+                                             << "old"
+                                             << "a" << 2 << "c" << 1)},
+                                 makeLookup("a", "b"),
+                                 strategy);
+
+        ASSERT_EQ(results.size(), 7u);
+        ASSERT(joinedIds(results[0]) == std::vector<int>({0, 1, 7}));
+        ASSERT(joinedIds(results[1]) == std::vector<int>({1}));
+        ASSERT(joinedIds(results[2]) == std::vector<int>({2, 3}));
+        // A regular expression only matches an identical regular expression.
+        ASSERT(joinedIds(results[3]) == std::vector<int>({5}));
+        ASSERT(joinedIds(results[4]) == std::vector<int>({1, 6}));
+        ASSERT(joinedIds(results[5]).empty());
+        ASSERT(joinedIds(results[6]) == std::vector<int>({1}));
+
+        std::vector<std::string> fieldNames;
+        for (auto&& field : results[6]) {
+            fieldNames.push_back(field.fieldName());
+        }
+        ASSERT(fieldNames == std::vector<std::string>({"_id", "out", "a", "c"}));
+        // A new 'as' field is appended to the document.
+        fieldNames.clear();
+        for (auto&& field : results[0]) {
+            fieldNames.push_back(field.fieldName());
+        }
+        ASSERT(fieldNames == std::vector<std::string>({"_id", "a", "out"}));
+    }
+
+    boost::intrusive_ptr<ExpressionContextForTest> _expCtx;
+};
+
+TEST_F(SbeLookupTest, PlansHashJoinWithoutIndex) {
+    createForeignCollection();
+    auto lookupPlan = plan(*makeLookup("a", "b"));
+    ASSERT(lookupPlan);
+    ASSERT(lookupPlan->strategy == LookupStrategy::kHashJoin);
+}
+
+TEST_F(SbeLookupTest, PlansIndexedLoopJoinWithAscendingIndex) {
+    createForeignCollection({makeIndexSpec(BSON("b" << 1 << "c" << 1), "b_1_c_1")});
+    auto lookupPlan = plan(*makeLookup("a", "b"));
+    ASSERT(lookupPlan);
+    ASSERT(lookupPlan->strategy == LookupStrategy::kIndexedLoopJoin);
+    ASSERT_EQ(lookupPlan->indexName, "b_1_c_1");
+}
+
+TEST_F(SbeLookupTest, IgnoresUnsuitableIndexes) {
+    createForeignCollection({makeIndexSpec(BSON("b" << -1), "b_-1"),
+                             makeIndexSpec(BSON("c" << 1 << "b" << 1), "c_1_b_1"),
+                             makeIndexSpec(BSON("b" << 1), "b_1_sparse", BSON("sparse" << true)),
+                             makeIndexSpec(BSON("b" << 1),
+                                           "b_1_partial",
+                                           BSON("partialFilterExpression" << BSON("c" << 1))),
+                             makeIndexSpec(BSON("b"
+                                                << "hashed"),
+                                           "b_hashed")});
+    auto lookupPlan = plan(*makeLookup("a", "b"));
+    ASSERT(lookupPlan);
+    ASSERT(lookupPlan->strategy == LookupStrategy::kHashJoin);
+}
+
+TEST_F(SbeLookupTest, DoesNotUseIndexWithCollation) {
+    createForeignCollection({makeIndexSpec(BSON("b" << 1), "b_1")});
+    CollatorInterfaceMock collator{CollatorInterfaceMock::MockType::kToLowerString};
+    auto lookupPlan = plan(*makeLookup("a", "b"), &collator);
+    ASSERT(lookupPlan);
+    ASSERT(lookupPlan->strategy == LookupStrategy::kHashJoin);
+}
+
+TEST_F(SbeLookupTest, RejectsLargeForeignCollectionWithoutIndex) {
+    createForeignCollection();
+    insertForeignDocuments({BSON("_id" << 0 << "b" << 1)});
+    RAIIServerParameterControllerForTest maxBytes(
+        "internalQuerySBELookupHashJoinMaxForeignCollectionBytes", 0);
+    ASSERT_FALSE(plan(*makeLookup("a", "b")));
+}
+
+TEST_F(SbeLookupTest, RejectsMissingForeignCollection) {
+    ASSERT_FALSE(plan(*makeLookup("a", "b")));
+}
+
+TEST_F(SbeLookupTest, RejectsDottedPaths) {
+    createForeignCollection();
+    ASSERT_FALSE(plan(*makeLookup("a.x", "b")));
+    ASSERT_FALSE(plan(*makeLookup("a", "b.x")));
+}
+
+TEST_F(SbeLookupTest, HashJoinMatchesLikeClassicLookup) {
+    createForeignCollection();
+    runMatchSemanticsTest(LookupStrategy::kHashJoin);
+}
+
+TEST_F(SbeLookupTest, IndexedLoopJoinMatchesLikeClassicLookup) {
+    createForeignCollection({makeIndexSpec(BSON("b" << 1), "b_1")});
+    runMatchSemanticsTest(LookupStrategy::kIndexedLoopJoin);
+}
+}  // namespace
+}  // namespace mongo::stage_builder
@@ -29,7 +29,13 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/db/exec/document_value/document_value_test_util.h"
+#include "mongo/db/exec/sbe/values/bson.h"
 #include "mongo/db/exec/shard_filterer_mock.h"
+#include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/pipeline/inner_pipeline_stage_impl.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/sbe_stage_builder_test_fixture.h"
 #include "mongo/db/query/shard_filterer_factory_mock.h"
@@ -216,4 +222,155 @@ TEST_F(SbeStageBuilderTest, VirtualIndexScanWithoutRecordId) {
     }
     ASSERT_EQ(index, 3);
 }
+/**
+ * Runs a $group stage pushed down into SBE over 'docs' and returns the groups indexed by the string
+ * form of their _id.
+ */
+class SbeGroupPushdownTest : public SbeStageBuilderTest {
+protected:
+    BSONObj runGroup(const std::vector<BSONArray>& docs, const BSONObj& groupSpec) {
+        auto virtScan =
+            std::make_unique<VirtualScanNode>(docs, VirtualScanNode::ScanType::kCollScan, false);
+        auto querySolution = makeQuerySolution(std::move(virtScan));
+
+        auto expCtx = make_intrusive<ExpressionContextForTest>();
+        std::vector<std::unique_ptr<InnerPipelineStageInterface>> pipeline;
+        pipeline.push_back(std::make_unique<InnerPipelineStageImpl>(
+            DocumentSourceGroup::createFromBson(groupSpec.firstElement(), expCtx)));
+
+        auto shardFiltererInterface = makeAlwaysPassShardFiltererInterface();
+        auto [resultSlots, stage, data] = buildPlanStage(std::move(querySolution),
+                                                         false,
+                                                         std::move(shardFiltererInterface),
+                                                         std::move(pipeline));
+        auto resultAccessors = prepareTree(&data.ctx, stage.get(), resultSlots);
+        ASSERT_EQ(resultAccessors.size(), 1u);
+
+        // The groups are returned in hash order, so index them by their key.
+        BSONObjBuilder resultsBob;
+        for (auto st = stage->getNext(); st == sbe::PlanState::ADVANCED; st = stage->getNext()) {
+            auto [tag, val] = resultAccessors[0]->getViewOfValue();
+            ASSERT_TRUE(tag == sbe::value::TypeTags::Object);
+            BSONObjBuilder bob;
+            sbe::bson::convertToBsonObj(bob, sbe::value::getObjectView(val));
+            auto group = bob.obj();
+            resultsBob.append(group["_id"].toString(false), group);
+        }
+        return resultsBob.obj();
+    }
+};
+
+TEST_F(SbeGroupPushdownTest, GroupPushedDownFromPipeline) {
+    auto docs = std::vector<BSONArray>{BSON_ARRAY(BSON("a" << 1 << "b" << 1)),
+                                       BSON_ARRAY(BSON("a" << 2 << "b" << 5)),
+                                       BSON_ARRAY(BSON("a" << 1 << "b" << 3)),
+                                       BSON_ARRAY(BSON("a" << 2 << "b"
+                                                           << "x")),
+                                       BSON_ARRAY(BSON("b" << 7))};
+
+    // Build a $group stage using every accumulator which can be lowered into SBE.
+    auto results = runGroup(
+        docs,
+        fromjson("{$group: {_id: '$a', sum: {$sum: '$b'}, avg: {$avg: '$b'}, min: {$min: '$b'}, "
+                 "max: {$max: '$b'}, first: {$first: '$b'}, last: {$last: '$b'}, "
+                 "count: {$count: {}}}}"));
+
+    ASSERT_EQ(results.nFields(), 3);
+    ASSERT_BSONOBJ_EQ(results["1"].Obj(),
+                      fromjson("{_id: 1, sum: 4, avg: 2.0, min: 1, max: 3, first: 1, last: 3, "
+                               "count: 2}"));
+    ASSERT_BSONOBJ_EQ(results["2"].Obj(),
+                      fromjson("{_id: 2, sum: 5, avg: 5.0, min: 5, max: 'x', first: 5, last: 'x', "
+                               "count: 2}"));
+    ASSERT_BSONOBJ_EQ(results["null"].Obj(),
+                      fromjson("{_id: null, sum: 7, avg: 7.0, min: 7, max: 7, first: 7, last: 7, "
+                               "count: 1}"));
+    ASSERT_EQ(results["1"]["sum"].type(), NumberInt);
+    ASSERT_EQ(results["1"]["avg"].type(), NumberDouble);
+}
+
+TEST_F(SbeGroupPushdownTest, SumWidensTypeOnOverflowLikeClassicSum) {
+    const auto kIntMax = std::numeric_limits<int>::max();
+    const auto kLongMax = std::numeric_limits<long long>::max();
+    auto docs = std::vector<BSONArray>{BSON_ARRAY(BSON("a" << 1 << "b" << kIntMax)),
+                                       BSON_ARRAY(BSON("a" << 1 << "b" << 1)),
+                                       BSON_ARRAY(BSON("a" << 2 << "b" << kLongMax)),
+                                       BSON_ARRAY(BSON("a" << 2 << "b" << 1LL))};
+
+    auto results =
+        runGroup(docs, fromjson("{$group: {_id: '$a', sum: {$sum: '$b'}, avg: {$avg: '$b'}}}"));
+
+    // An int overflow is promoted to a long.
+    ASSERT_EQ(results["1"]["sum"].type(), NumberLong);
+    ASSERT_EQ(results["1"]["sum"].numberLong(), static_cast<long long>(kIntMax) + 1);
+
+    // A long overflow is promoted to a double, not to a decimal.
+    ASSERT_EQ(results["2"]["sum"].type(), NumberDouble);
+    ASSERT_EQ(results["2"]["sum"].numberDouble(), 9223372036854775808.0);
+    ASSERT_EQ(results["2"]["avg"].type(), NumberDouble);
+    ASSERT_EQ(results["2"]["avg"].numberDouble(), 4611686018427387904.0);
+}
+
+TEST_F(SbeGroupPushdownTest, SumAndAvgUseDoubleDoublePrecision) {
+    // Adding 1.0 to 2**53 in plain double arithmetic rounds it away, while the classic
+    // accumulators keep both units.
+    const auto kTwoToThe53 = 9007199254740992.0;
+    auto docs = std::vector<BSONArray>{BSON_ARRAY(BSON("b" << kTwoToThe53)),
+                                       BSON_ARRAY(BSON("b" << 1.0)),
+                                       BSON_ARRAY(BSON("b" << 1.0))};
+
+    auto results =
+        runGroup(docs, fromjson("{$group: {_id: null, sum: {$sum: '$b'}, avg: {$avg: '$b'}}}"));
+
+    ASSERT_EQ(results["null"]["sum"].type(), NumberDouble);
+    ASSERT_EQ(results["null"]["sum"].numberDouble(), kTwoToThe53 + 2.0);
+    ASSERT_EQ(results["null"]["avg"].numberDouble(), (kTwoToThe53 + 2.0) / 3);
+}
+
+TEST_F(SbeGroupPushdownTest, SumAndAvgOfDecimalsAreDecimals) {
+    auto docs = std::vector<BSONArray>{BSON_ARRAY(BSON("b" << Decimal128("0.1"))),
+                                       BSON_ARRAY(BSON("b" << 2)),
+                                       BSON_ARRAY(BSON("b" << 0.5))};
+
+    auto results =
+        runGroup(docs, fromjson("{$group: {_id: null, sum: {$sum: '$b'}, avg: {$avg: '$b'}}}"));
+
+    ASSERT_EQ(results["null"]["sum"].type(), NumberDecimal);
+    ASSERT_TRUE(results["null"]["sum"].numberDecimal().isEqual(Decimal128("2.6")));
+    ASSERT_EQ(results["null"]["avg"].type(), NumberDecimal);
+    ASSERT_TRUE(results["null"]["avg"].numberDecimal().isEqual(
+        Decimal128("2.6").divide(Decimal128(3))));
+}
+
+TEST_F(SbeGroupPushdownTest, MinMaxSkipNullishValuesLikeClassicMinMax) {
+    auto docs = std::vector<BSONArray>{BSON_ARRAY(BSON("a" << 1 << "b" << BSONUndefined)),
+                                       BSON_ARRAY(BSON("a" << 1 << "b" << 3)),
+                                       BSON_ARRAY(BSON("a" << 1 << "b" << BSONNULL)),
+                                       BSON_ARRAY(BSON("a" << 2 << "b" << BSONUndefined)),
+                                       BSON_ARRAY(BSON("a" << 2 << "b" << BSONNULL)),
+                                       BSON_ARRAY(BSON("a" << 2))};
+
+    auto results =
+        runGroup(docs, fromjson("{$group: {_id: '$a', min: {$min: '$b'}, max: {$max: '$b'}}}"));
+
+    // Feed the same values to the classic accumulators and compare the results.
+    ExpressionContextForTest expCtx;
+    auto assertMatchesClassic = [&](StringData group, const std::vector<Value>& values) {
+        AccumulatorMin classicMin(&expCtx);
+        AccumulatorMax classicMax(&expCtx);
+        for (auto&& value : values) {
+            classicMin.process(value, false);
+            classicMax.process(value, false);
+        }
+        ASSERT_VALUE_EQ(Value(results[group]["min"]), classicMin.getValue(false));
+        ASSERT_EQ(results[group]["min"].type(), classicMin.getValue(false).getType());
+        ASSERT_VALUE_EQ(Value(results[group]["max"]), classicMax.getValue(false));
+        ASSERT_EQ(results[group]["max"].type(), classicMax.getValue(false).getType());
+    };
+    assertMatchesClassic("1"_sd, {Value(BSONUndefined), Value(3), Value(BSONNULL)});
+    assertMatchesClassic("2"_sd, {Value(BSONUndefined), Value(BSONNULL), Value()});
+
+    ASSERT_EQ(results["1"]["min"].numberInt(), 3);
+    ASSERT_EQ(results["2"]["min"].type(), jstNULL);
+}
 }  // namespace mongo
@@ -48,12 +48,14 @@ std::tuple<sbe::value::SlotVector, std::unique_ptr<sbe::PlanStage>, stage_builde
 SbeStageBuilderTestFixture::buildPlanStage(
     std::unique_ptr<QuerySolution> querySolution,
     bool hasRecordId,
-    std::unique_ptr<ShardFiltererFactoryInterface> shardFiltererInterface) {
+    std::unique_ptr<ShardFiltererFactoryInterface> shardFiltererInterface,
+    std::vector<std::unique_ptr<InnerPipelineStageInterface>> pipeline) {
     auto findCommand = std::make_unique<FindCommandRequest>(_nss);
     const boost::intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest(_nss));
     auto statusWithCQ =
         CanonicalQuery::canonicalize(opCtx(), std::move(findCommand), false, expCtx);
     ASSERT_OK(statusWithCQ.getStatus());
+    statusWithCQ.getValue()->setPipeline(std::move(pipeline));
 
     stage_builder::SlotBasedStageBuilder builder{opCtx(),
                                                  CollectionPtr::null,
@@ -33,6 +33,7 @@
 #include "mongo/db/exec/sbe/stages/stages.h"
 #include "mongo/db/exec/sbe/values/slot.h"
 #include "mongo/db/exec/sbe/values/value.h"
+#include "mongo/db/pipeline/inner_pipeline_stage_interface.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/shard_filterer_factory_interface.h"
 #include "mongo/unittest/unittest.h"
@@ -69,14 +70,16 @@ public:
      * the 1st position. Otherwise, if hasRecordId is 'false', the SlotVector will contain a single
      * SlotId for the BSONObj representation of the document. A real or mock
      * ShardFiltererFactoryInterface must be provided so the sbe SlotBasedStageBuilder can build and
-     * utilize a ShardFilterer instance during translation of a ShardingFilterNode.
+     * utilize a ShardFilterer instance during translation of a ShardingFilterNode. Any aggregation
+     * pipeline stages in 'pipeline' are pushed down into the query and built on top of the plan.
      */
     std::tuple<sbe::value::SlotVector,
                std::unique_ptr<sbe::PlanStage>,
                stage_builder::PlanStageData>
     buildPlanStage(std::unique_ptr<QuerySolution> querySolution,
                    bool hasRecordId,
-                   std::unique_ptr<ShardFiltererFactoryInterface> shardFiltererFactoryInterface);
+                   std::unique_ptr<ShardFiltererFactoryInterface> shardFiltererFactoryInterface,
+                   std::vector<std::unique_ptr<InnerPipelineStageInterface>> pipeline = {});
 
 private:
     const NamespaceString _nss = NamespaceString{"testdb.sbe_stage_builder"};
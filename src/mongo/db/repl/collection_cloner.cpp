@@ -32,6 +32,9 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/simple_bsonelement_comparator.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands/list_collections_filter.h"
 #include "mongo/db/index_build_entry_helpers.h"
 #include "mongo/db/index_builds_coordinator.h"
@@ -39,14 +42,27 @@
 #include "mongo/db/repl/collection_cloner.h"
 #include "mongo/db/repl/database_cloner_gen.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
+#include "mongo/db/repl/replication_auth.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/logv2/log.h"
 #include "mongo/rpc/get_status_from_command_result.h"
 
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 namespace repl {
+namespace {
+
+// The number of _id values sampled per range when splitting a collection for a parallel clone.
+// Oversampling keeps the ranges close to equal in size.
+constexpr int kSamplesPerCloneRange = 16;
+
+// How long a range query of a parallel clone waits before reconnecting after a transient error.
+constexpr Milliseconds kCloneRangeRetryDelay{100};
+
+}  // namespace
 
 // Failpoint which causes initial sync to hang when it has cloned 'numDocsToClone' documents to
 // collection 'namespace'.
@@ -96,6 +112,7 @@ CollectionCloner::CollectionCloner(const NamespaceString& sourceNss,
           _dbWorkTaskRunner.schedule(std::move(task));
           return executor::TaskExecutor::CallbackHandle();
       }),
+      _createClientFn([] { return std::make_unique<DBClientConnection>(); }),
       _dbWorkTaskRunner(dbPool) {
     invariant(sourceNss.isValid());
     invariant(collectionOptions.uuid);
@@ -236,7 +253,12 @@ BaseCloner::AfterStageBehavior CollectionCloner::createCollectionStage() {
 }
 
 BaseCloner::AfterStageBehavior CollectionCloner::queryStage() {
-    runQuery();
+    auto ranges = planCloneRanges();
+    if (ranges.empty()) {
+        runQuery();
+    } else {
+        runParallelQuery(ranges);
+    }
     waitForDatabaseWorkToComplete();
     // We want to free the _collLoader regardless of whether the commit succeeds.
     std::unique_ptr<CollectionBulkLoader> loader = std::move(_collLoader);
@@ -371,6 +393,265 @@ void CollectionCloner::runQuery() {
     }
 }
 
+std::vector<CollectionCloner::CloneRange> CollectionCloner::planCloneRanges() {
+    const int parallelism = collectionClonerParallelism;
+    long long bytesToCopy;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        bytesToCopy = _stats.bytesToCopy;
+    }
+
+    // Ranges are bounded by _id index keys, which only match the _id values themselves when the
+    // index uses the simple collation. Capped and clustered collections are cloned in natural
+    // order, and a query that has already made progress must be resumed rather than re-split.
+    if (parallelism <= 1 || !_resumeSupported || _resumeToken || _idIndexSpec.isEmpty() ||
+        _collectionOptions.capped || _collectionOptions.clusteredIndex ||
+        !_collectionOptions.collation.isEmpty() ||
+        bytesToCopy < collectionClonerParallelismMinBytes) {
+        return {};
+    }
+
+    const int sampleSize = parallelism * kSamplesPerCloneRange;
+    BSONObj res;
+    Status status = Status::OK();
+    try {
+        getClient()->runCommand(
+            _sourceNss.db().toString(),
+            BSON("aggregate" << _sourceNss.coll()
+                             << "pipeline"
+                             << BSON_ARRAY(BSON("$sample" << BSON("size" << sampleSize))
+                                           << BSON("$project" << BSON("_id" << 1)))
+                             << "cursor" << BSON("batchSize" << sampleSize)),
+            res,
+            QueryOption_SecondaryOk);
+        status = getStatusFromCommandResult(res);
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+    if (!status.isOK()) {
+        LOGV2_DEBUG(5843191,
+                    1,
+                    "Cloning collection through a single query because sampling _id values on the "
+                    "sync source failed",
+                    "namespace"_attr = _sourceNss,
+                    "error"_attr = status);
+        return {};
+    }
+
+    std::vector<BSONObj> samples;
+    for (auto&& elem : res.getObjectField("cursor").getObjectField("firstBatch")) {
+        if (elem.type() == BSONType::Object && elem.Obj().hasField("_id")) {
+            samples.push_back(elem.Obj().getOwned());
+        }
+    }
+    if (samples.size() < static_cast<size_t>(parallelism)) {
+        return {};
+    }
+
+    const auto& comparator = SimpleBSONObjComparator::kInstance;
+    std::sort(samples.begin(), samples.end(), comparator.makeLessThan());
+
+    std::vector<CloneRange> ranges;
+    BSONObj min;
+    for (int i = 1; i < parallelism; ++i) {
+        const auto& split = samples[i * samples.size() / parallelism];
+        if (!min.isEmpty() && comparator.evaluate(split == min)) {
+            continue;
+        }
+        ranges.push_back({min, split});
+        min = split;
+    }
+    if (ranges.empty()) {
+        return {};
+    }
+    ranges.push_back({min, BSONObj()});
+    return ranges;
+}
+
+void CollectionCloner::runParallelQuery(const std::vector<CloneRange>& ranges) {
+    LOGV2(5843192,
+          "Cloning collection in parallel _id ranges",
+          "namespace"_attr = _sourceNss,
+          "numRanges"_attr = ranges.size());
+
+    ThreadPool::Options options;
+    options.poolName = "CollectionClonerRangeQuery";
+    options.minThreads = 0;
+    options.maxThreads = ranges.size();
+    options.onCreateThread = [](const std::string& threadName) {
+        Client::initThread(threadName.c_str());
+    };
+    ThreadPool pool(options);
+    pool.startup();
+
+    for (const auto& range : ranges) {
+        pool.schedule([this, range](Status status) {
+            if (status.isOK()) {
+                try {
+                    runRangeQuery(range);
+                } catch (const DBException& ex) {
+                    status = ex.toStatus();
+                }
+            }
+            if (!status.isOK()) {
+                stdx::lock_guard<Latch> lk(_mutex);
+                if (_rangeQueryStatus.isOK()) {
+                    _rangeQueryStatus = status;
+                }
+            }
+        });
+    }
+    pool.shutdown();
+    pool.join();
+
+    Status status = Status::OK();
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        status = std::exchange(_rangeQueryStatus, Status::OK());
+    }
+
+    // If the collection was dropped, we can just move on to the next cloner.
+    if (status == ErrorCodes::NamespaceNotFound) {
+        uassertStatusOK(status);
+    }
+
+    // Transient errors have already been retried within each range. The documents of the other
+    // ranges are already in the bulk loader, so the clone as a whole cannot be retried.
+    if (!status.isOK()) {
+        LOGV2(5843193,
+              "Error during parallel collection clone",
+              "namespace"_attr = _sourceNss,
+              "error"_attr = status);
+        uasserted(ErrorCodes::InitialSyncFailure,
+                  str::stream() << "Parallel collection clone failed and is not resumable. nss: "
+                                << _sourceNss << ": " << status.reason());
+    }
+}
+
+void CollectionCloner::runRangeQuery(CloneRange range) {
+    InitialSyncSharedData::RetryableOperation retryableOp;
+    while (true) {
+        auto conn = _createClientFn();
+        {
+            stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+            uassert(ErrorCodes::CallbackCanceled,
+                    str::stream() << "Collection cloning cancelled due to initial sync failure: "
+                                  << getSharedData()->getStatus(lk),
+                    getSharedData()->registerAdditionalClient(lk, conn.get()));
+        }
+        ON_BLOCK_EXIT([&] {
+            stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+            getSharedData()->unregisterAdditionalClient(lk, conn.get());
+        });
+
+        try {
+            uassertStatusOK(conn->connect(getSource(), StringData(), boost::none));
+            uassertStatusOK(replAuthenticate(conn.get())
+                                .withContext(str::stream()
+                                             << "Failed to authenticate to " << getSource()));
+            if (retryableOp) {
+                // The sync source may have rolled back or been resynced during the outage, in
+                // which case the documents already loaded cannot be trusted.
+                uassertStatusOK(checkSyncSourceIsStillValid(conn.get()));
+            }
+
+            Query query;
+            query.hint(BSON("_id" << 1));
+            if (!range.min.isEmpty()) {
+                query.minKey(range.min);
+            }
+            if (!range.max.isEmpty()) {
+                query.maxKey(range.max);
+            }
+
+            conn->query(
+                [&](DBClientCursorBatchIterator& iter) { handleNextRangeBatch(iter, &range); },
+                _sourceDbAndUuid,
+                query,
+                nullptr /* fieldsToReturn */,
+                QueryOption_NoCursorTimeout | QueryOption_SecondaryOk |
+                    (collectionClonerUsesExhaust ? QueryOption_Exhaust : 0),
+                _collectionClonerBatchSize,
+                ReadConcernArgs::kImplicitDefault);
+            return;
+        } catch (const DBException& ex) {
+            auto status = ex.toStatus();
+            if (status == ErrorCodes::NamespaceNotFound || !_queryStage.isTransientError(status)) {
+                throw;
+            }
+
+            bool shouldRetry = [&] {
+                stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+                return getSharedData()->shouldRetryOperation(lk, &retryableOp);
+            }();
+            if (!shouldRetry) {
+                uassertStatusOK(status.withContext(
+                    str::stream() << ": Exceeded initialSyncTransientErrorRetryPeriodSeconds "
+                                  << getSharedData()->getAllowedOutageDuration(
+                                         stdx::lock_guard<InitialSyncSharedData>(
+                                             *getSharedData()))));
+            }
+            LOGV2(5843201,
+                  "Retrying range of parallel collection clone after transient error",
+                  "namespace"_attr = _sourceNss,
+                  "resumeAfter"_attr = range.min,
+                  "error"_attr = status);
+            sleepmillis(kCloneRangeRetryDelay.count());
+        }
+    }
+}
+
+void CollectionCloner::handleNextRangeBatch(DBClientCursorBatchIterator& iter,
+                                            CloneRange* range) {
+    {
+        stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+        if (!getSharedData()->getStatus(lk).isOK()) {
+            uasserted(ErrorCodes::CallbackCanceled,
+                      str::stream() << "Collection cloning cancelled due to initial sync failure: "
+                                    << getSharedData()->getStatus(lk));
+        }
+    }
+
+    std::vector<BSONObj> docs;
+    while (iter.moreInCurrentBatch()) {
+        auto doc = iter.nextSafe();
+        // A resumed range starts at the last document inserted before the error, so skip it.
+        if (std::exchange(range->minExclusive, false) &&
+            SimpleBSONElementComparator::kInstance.evaluate(doc["_id"] ==
+                                                            range->min.firstElement())) {
+            continue;
+        }
+        docs.emplace_back(std::move(doc));
+    }
+
+    size_t documentsCopied;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        uassert(ErrorCodes::CallbackCanceled,
+                "Collection cloning cancelled because another range failed",
+                _rangeQueryStatus.isOK());
+
+        _stats.receivedBatches++;
+        _stats.fetchedBatches++;
+        if (!docs.empty()) {
+            _stats.documentsCopied += docs.size();
+            _stats.approxBytesCopied = ((long)_stats.documentsCopied) * _stats.avgObjSize;
+            _progressMeter.hit(int(docs.size()));
+            invariant(_collLoader);
+            uassertStatusOK(_collLoader->insertDocuments(docs.cbegin(), docs.cend()));
+        }
+        documentsCopied = _stats.documentsCopied;
+    }
+
+    if (!docs.empty()) {
+        range->min = BSON("_id" << docs.back()["_id"]);
+        range->minExclusive = true;
+    }
+
+    hangAfterHandlingBatchResponseIfNeeded();
+    hangDuringCollectionCloneIfNeeded(documentsCopied);
+}
+
 void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
     {
         stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
@@ -421,6 +702,10 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
         _resumeToken = iter.getPostBatchResumeToken();
     }
 
+    hangAfterHandlingBatchResponseIfNeeded();
+}
+
+void CollectionCloner::hangAfterHandlingBatchResponseIfNeeded() {
     initialSyncHangCollectionClonerAfterHandlingBatchResponse.executeIf(
         [&](const BSONObj&) {
             while (MONGO_unlikely(
@@ -442,9 +727,27 @@ void CollectionCloner::handleNextBatch(DBClientCursorBatchIterator& iter) {
         });
 }
 
+void CollectionCloner::hangDuringCollectionCloneIfNeeded(size_t documentsCopied) {
+    initialSyncHangDuringCollectionClone.executeIf(
+        [&](const BSONObj&) {
+            LOGV2(21138,
+                  "initial sync - initialSyncHangDuringCollectionClone fail point "
+                  "enabled. Blocking until fail point is disabled");
+            while (MONGO_unlikely(initialSyncHangDuringCollectionClone.shouldFail()) &&
+                   !mustExit()) {
+                mongo::sleepsecs(1);
+            }
+        },
+        [&](const BSONObj& data) {
+            return data["namespace"].String() == _sourceNss.ns() &&
+                static_cast<int>(documentsCopied) >= data["numDocsToClone"].numberInt();
+        });
+}
+
 void CollectionCloner::insertDocumentsCallback(const executor::TaskExecutor::CallbackArgs& cbd) {
     uassertStatusOK(cbd.status);
 
+    size_t documentsCopied;
     {
         stdx::lock_guard<Latch> lk(_mutex);
         std::vector<BSONObj> docs;
@@ -467,22 +770,10 @@ void CollectionCloner::insertDocumentsCallback(const executor::TaskExecutor::Cal
         // The insert must be done within the lock, because CollectionBulkLoader is not
         // thread safe.
         uassertStatusOK(_collLoader->insertDocuments(docs.cbegin(), docs.cend()));
+        documentsCopied = _stats.documentsCopied;
     }
 
-    initialSyncHangDuringCollectionClone.executeIf(
-        [&](const BSONObj&) {
-            LOGV2(21138,
-                  "initial sync - initialSyncHangDuringCollectionClone fail point "
-                  "enabled. Blocking until fail point is disabled");
-            while (MONGO_unlikely(initialSyncHangDuringCollectionClone.shouldFail()) &&
-                   !mustExit()) {
-                mongo::sleepsecs(1);
-            }
-        },
-        [&](const BSONObj& data) {
-            return data["namespace"].String() == _sourceNss.ns() &&
-                static_cast<int>(_stats.documentsCopied) >= data["numDocsToClone"].numberInt();
-        });
+    hangDuringCollectionCloneIfNeeded(documentsCopied);
 }
 
 bool CollectionCloner::isMyFailPoint(const BSONObj& data) const {
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -77,6 +78,11 @@ public:
     using ScheduleDbWorkFn = unique_function<StatusWith<executor::TaskExecutor::CallbackHandle>(
         executor::TaskExecutor::CallbackFn)>;
 
+    /**
+     * Type of function to create the connections used by the range queries of a parallel clone.
+     */
+    using CreateClientFn = std::function<std::unique_ptr<DBClientConnection>()>;
+
     CollectionCloner(const NamespaceString& ns,
                      const CollectionOptions& collectionOptions,
                      InitialSyncSharedData* sharedData,
@@ -122,6 +128,15 @@ public:
         _scheduleDbWorkFn = std::move(scheduleDbWorkFn);
     }
 
+    /**
+     * Overrides how the connections for the range queries of a parallel clone are created.
+     *
+     * For testing only.
+     */
+    void setCreateClientFn_forTest(const CreateClientFn& createClientFn) {
+        _createClientFn = createClientFn;
+    }
+
 protected:
     ClonerStages getStages() final;
 
@@ -161,6 +176,18 @@ private:
         }
     };
 
+    /**
+     * A range of the source collection's _id index, fetched by one query of a parallel clone.
+     */
+    struct CloneRange {
+        BSONObj min;  // Inclusive lower bound, or empty to start at the beginning of the index.
+        BSONObj max;  // Exclusive upper bound, or empty to run to the end of the index.
+
+        // Set once documents have been received, when 'min' is the _id of the last document
+        // inserted and is itself excluded from the range.
+        bool minExclusive = false;
+    };
+
     std::string describeForFuzzer(BaseClonerStage* stage) const final {
         return _sourceNss.db() + " db: { " + stage->getName() + ": UUID(\"" +
             _sourceDbAndUuid.uuid()->toString() + "\") coll: " + _sourceNss.coll() + " }";
@@ -232,6 +259,49 @@ private:
      */
     void abortNonResumableClone(const Status& status);
 
+    /**
+     * Splits the collection into at most 'collectionClonerParallelism' _id ranges of roughly equal
+     * size, using a random sample of _id values taken on the sync source. Returns an empty vector
+     * if the collection should be cloned through a single query, either because it is too small,
+     * its _id order cannot be used for range bounds, or the sample could not be taken.
+     */
+    std::vector<CloneRange> planCloneRanges();
+
+    /**
+     * Fetches each of 'ranges' concurrently on its own connection to the sync source, inserting
+     * the documents into the collection bulk loader as they arrive. Any non-transient failure
+     * other than the collection being dropped fails the clone, since the documents of the other
+     * ranges are already loaded. Throws.
+     */
+    void runParallelQuery(const std::vector<CloneRange>& ranges);
+
+    /**
+     * Runs the query for a single range of a parallel clone on its own connection, which is
+     * registered with the shared data so that canceling the attempt interrupts it. On a transient
+     * error, reconnects and resumes the range after the last _id inserted, for as long as the
+     * shared data allows the operation to be retried. Throws.
+     */
+    void runRangeQuery(CloneRange range);
+
+    /**
+     * Inserts a batch of documents received by a range query and advances 'range' past them. The
+     * ranges take turns inserting into the bulk loader, which is not thread safe, while the other
+     * ranges keep fetching.
+     */
+    void handleNextRangeBatch(DBClientCursorBatchIterator& iter, CloneRange* range);
+
+    /**
+     * Blocks while the initialSyncHangCollectionClonerAfterHandlingBatchResponse fail point is
+     * enabled for this collection.
+     */
+    void hangAfterHandlingBatchResponseIfNeeded();
+
+    /**
+     * Blocks while the initialSyncHangDuringCollectionClone fail point is enabled for this
+     * collection, once 'documentsCopied' has reached the fail point's document count.
+     */
+    void hangDuringCollectionCloneIfNeeded(size_t documentsCopied);
+
     // All member variables are labeled with one of the following codes indicating the
     // synchronization rules for accessing them.
     //
@@ -259,6 +329,8 @@ private:
     std::unique_ptr<CollectionBulkLoader> _collLoader;  // (X)
     //  Function for scheduling database work using the executor.
     ScheduleDbWorkFn _scheduleDbWorkFn;  // (R)
+    // Function for creating the connections used by range queries.
+    CreateClientFn _createClientFn;  // (R)
     // Documents read from source to insert.
     std::vector<BSONObj> _documentsToInsert;  // (M)
     Stats _stats;                             // (M)
@@ -278,6 +350,9 @@ private:
     // If true, it means we are starting a new query or resuming an interrupted one.
     bool _firstBatchOfQueryRound = true;  // (X)
 
+    // The first error encountered by a range query of a parallel clone.
+    Status _rangeQueryStatus = Status::OK();  // (M)
+
     // Only set during non-resumable (4.2) queries.
     // Signifies that there were changes to the collection on the sync source that resulted in
     // our remote cursor getting killed.
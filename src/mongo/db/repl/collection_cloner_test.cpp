@@ -123,6 +123,39 @@ protected:
         return cloner->_idIndexSpec;
     }
 
+    std::vector<std::pair<BSONObj, BSONObj>> planCloneRanges(CollectionCloner* cloner) {
+        std::vector<std::pair<BSONObj, BSONObj>> ranges;
+        for (auto&& range : cloner->planCloneRanges()) {
+            ranges.emplace_back(range.min, range.max);
+        }
+        return ranges;
+    }
+
+    /**
+     * Sets up a collection large enough to be cloned in 'collectionClonerParallelism' ranges, and
+     * makes the range queries use mock connections to the mock server.
+     */
+    std::unique_ptr<CollectionCloner> makeParallelCollectionCloner(int numDocs) {
+        setMockServerReplies(BSON("size" << collectionClonerParallelismMinBytes),
+                             createCountResponse(numDocs),
+                             createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+        BSONArrayBuilder samples;
+        for (int i = 0; i < numDocs; ++i) {
+            _mockServer->insert(_nss.ns(), BSON("_id" << i));
+            samples.append(BSON("_id" << i));
+        }
+        _mockServer->setCommandReply("aggregate", createCursorResponse(_nss.ns(), samples.arr()));
+
+        auto cloner = makeCollectionCloner();
+        cloner->setCreateClientFn_forTest([this] {
+            auto client = std::make_unique<MockDBClientConnection>(_mockServer.get());
+            client->setWireVersions(WireVersion::RESUMABLE_INITIAL_SYNC,
+                                    WireVersion::RESUMABLE_INITIAL_SYNC);
+            return client;
+        });
+        return cloner;
+    }
+
     std::shared_ptr<CollectionMockStats> _collectionStats;  // Used by the _loader.
     StorageInterfaceMock::CreateCollectionForBulkFn _standardCreateCollectionFn;
     CollectionBulkLoaderMock* _loader = nullptr;  // Owned by CollectionCloner.
@@ -1229,5 +1262,161 @@ TEST_F(CollectionClonerTestNonResumable, NonResumableCursorErrorThenSuccessEqual
     clonerThread.join();
 }
 
+TEST_F(CollectionClonerTestResumable, PlanCloneRangesSplitsLargeCollection) {
+    auto parallelismDefault = collectionClonerParallelism;
+    collectionClonerParallelism = 4;
+    ON_BLOCK_EXIT([&]() { collectionClonerParallelism = parallelismDefault; });
+
+    auto cloner = makeCollectionCloner();
+    cloner->setStopAfterStage_forTest("listIndexes");
+    setMockServerReplies(BSON("size" << collectionClonerParallelismMinBytes),
+                         createCountResponse(64),
+                         createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+    ASSERT_OK(cloner->run());
+
+    // Return the sampled _id values out of order.
+    BSONArrayBuilder samples;
+    for (int i = 0; i < 64; ++i) {
+        samples.append(BSON("_id" << (i * 37) % 64));
+    }
+    _mockServer->setCommandReply("aggregate", createCursorResponse(_nss.ns(), samples.arr()));
+
+    auto ranges = planCloneRanges(cloner.get());
+    ASSERT_EQ(4U, ranges.size());
+    ASSERT_BSONOBJ_EQ(BSONObj(), ranges[0].first);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 16), ranges[0].second);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 16), ranges[1].first);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 32), ranges[1].second);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 32), ranges[2].first);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 48), ranges[2].second);
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 48), ranges[3].first);
+    ASSERT_BSONOBJ_EQ(BSONObj(), ranges[3].second);
+}
+
+TEST_F(CollectionClonerTestResumable, PlanCloneRangesDoesNotSplitSmallCollection) {
+    auto parallelismDefault = collectionClonerParallelism;
+    collectionClonerParallelism = 4;
+    ON_BLOCK_EXIT([&]() { collectionClonerParallelism = parallelismDefault; });
+
+    auto cloner = makeCollectionCloner();
+    cloner->setStopAfterStage_forTest("listIndexes");
+    setMockServerReplies(BSON("size" << collectionClonerParallelismMinBytes - 1),
+                         createCountResponse(64),
+                         createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+    ASSERT_OK(cloner->run());
+
+    ASSERT(planCloneRanges(cloner.get()).empty());
+}
+
+TEST_F(CollectionClonerTestResumable, PlanCloneRangesFallsBackWhenSamplingFails) {
+    auto parallelismDefault = collectionClonerParallelism;
+    collectionClonerParallelism = 4;
+    ON_BLOCK_EXIT([&]() { collectionClonerParallelism = parallelismDefault; });
+
+    auto cloner = makeCollectionCloner();
+    cloner->setStopAfterStage_forTest("listIndexes");
+    setMockServerReplies(BSON("size" << collectionClonerParallelismMinBytes),
+                         createCountResponse(64),
+                         createCursorResponse(_nss.ns(), BSON_ARRAY(_idIndexSpec)));
+    ASSERT_OK(cloner->run());
+
+    _mockServer->setCommandReply("aggregate", Status(ErrorCodes::OperationFailed, ""));
+    ASSERT(planCloneRanges(cloner.get()).empty());
+}
+
+TEST_F(CollectionClonerTestResumable, ParallelCloneCopiesEveryRange) {
+    auto parallelismDefault = collectionClonerParallelism;
+    collectionClonerParallelism = 4;
+    ON_BLOCK_EXIT([&]() { collectionClonerParallelism = parallelismDefault; });
+
+    auto cloner = makeParallelCollectionCloner(64);
+    ASSERT_OK(cloner->run());
+
+    ASSERT_EQUALS(64, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    ASSERT_EQUALS(64u, cloner->getStats().documentsCopied);
+}
+
+TEST_F(CollectionClonerTestResumable, ParallelCloneResumesRangeAfterTransientError) {
+    auto parallelismDefault = collectionClonerParallelism;
+    collectionClonerParallelism = 4;
+    ON_BLOCK_EXIT([&]() { collectionClonerParallelism = parallelismDefault; });
+
+    auto afterBatchFailpoint =
+        globalFailPointRegistry().find("initialSyncHangCollectionClonerAfterHandlingBatchResponse");
+    auto timesEnteredAfterBatch = afterBatchFailpoint->setMode(FailPoint::alwaysOn, 0);
+
+    auto cloner = makeParallelCollectionCloner(64);
+    cloner->setBatchSize_forTest(2);
+
+    stdx::thread clonerThread([&] {
+        Client::initThread("ClonerRunner");
+        ASSERT_OK(cloner->run());
+    });
+
+    // Wait for a range to process its first batch, then fail the next batch of a range once.
+    afterBatchFailpoint->waitForTimesEntered(timesEnteredAfterBatch + 1);
+    auto failNextBatch = globalFailPointRegistry().find("mockCursorThrowErrorOnGetMore");
+    failNextBatch->setMode(FailPoint::nTimes, 1, fromjson("{errorType: 'HostUnreachable'}"));
+
+    afterBatchFailpoint->setMode(FailPoint::off, 0);
+    clonerThread.join();
+
+    // CollectionMockStats does not de-duplicate inserts, so an insertCount of 64 shows that the
+    // failed range resumed after its last document rather than restarting from its lower bound.
+    ASSERT_EQUALS(64, _collectionStats->insertCount);
+    ASSERT_TRUE(_collectionStats->commitCalled);
+    ASSERT_EQUALS(64u, cloner->getStats().documentsCopied);
+}
+
+TEST_F(CollectionClonerTestResumable, ParallelCloneNonTransientErrorFailsClone) {
+    auto parallelismDefault = collectionClonerParallelism;
+    collectionClonerParallelism = 4;
+    ON_BLOCK_EXIT([&]() { collectionClonerParallelism = parallelismDefault; });
+
+    auto cloner = makeParallelCollectionCloner(64);
+    cloner->setBatchSize_forTest(2);
+
+    auto failNextBatch = globalFailPointRegistry().find("mockCursorThrowErrorOnGetMore");
+    failNextBatch->setMode(FailPoint::nTimes, 1, fromjson("{errorType: 'UnknownError'}"));
+
+    ASSERT_EQUALS(ErrorCodes::InitialSyncFailure, cloner->run());
+    ASSERT_FALSE(_collectionStats->commitCalled);
+}
+
+TEST_F(CollectionClonerTestResumable, ParallelCloneStopsWhenInitialSyncIsCanceled) {
+    auto parallelismDefault = collectionClonerParallelism;
+    collectionClonerParallelism = 4;
+    ON_BLOCK_EXIT([&]() { collectionClonerParallelism = parallelismDefault; });
+
+    auto afterBatchFailpoint =
+        globalFailPointRegistry().find("initialSyncHangCollectionClonerAfterHandlingBatchResponse");
+    auto timesEnteredAfterBatch = afterBatchFailpoint->setMode(FailPoint::alwaysOn, 0);
+
+    auto cloner = makeParallelCollectionCloner(64);
+    cloner->setBatchSize_forTest(2);
+
+    stdx::thread clonerThread([&] {
+        Client::initThread("ClonerRunner");
+        ASSERT_NOT_OK(cloner->run());
+    });
+
+    afterBatchFailpoint->waitForTimesEntered(timesEnteredAfterBatch + 1);
+
+    // This is what InitialSyncer does when it cancels the remaining work.
+    {
+        stdx::lock_guard<InitialSyncSharedData> lk(*getSharedData());
+        getSharedData()->setStatusIfOK(
+            lk, Status(ErrorCodes::CallbackCanceled, "Initial sync attempt canceled"));
+        getSharedData()->shutdownAdditionalClients(lk);
+    }
+
+    afterBatchFailpoint->setMode(FailPoint::off, 0);
+    clonerThread.join();
+
+    ASSERT_LT(_collectionStats->insertCount, 64);
+    ASSERT_FALSE(_collectionStats->commitCalled);
+}
+
 }  // namespace repl
 }  // namespace mongo
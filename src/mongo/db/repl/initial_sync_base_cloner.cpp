@@ -95,7 +95,7 @@ void InitialSyncBaseCloner::handleStageAttemptFailed(BaseClonerStage* stage, Sta
     if (stage->checkSyncSourceValidityOnRetry()) {
         // If checkSyncSourceIsStillValid fails without throwing, it means a network
         // error occurred and it's safe to continue (which will cause another retry).
-        if (!checkSyncSourceIsStillValid().isOK())
+        if (!checkSyncSourceIsStillValid(getClient()).isOK())
             return;
         // After successfully checking the sync source validity, the client should
         // always be OK.
@@ -103,7 +103,7 @@ void InitialSyncBaseCloner::handleStageAttemptFailed(BaseClonerStage* stage, Sta
     }
 }
 
-Status InitialSyncBaseCloner::checkSyncSourceIsStillValid() {
+Status InitialSyncBaseCloner::checkSyncSourceIsStillValid(DBClientConnection* client) {
 
     WireVersion wireVersion;
     {
@@ -114,20 +114,20 @@ Status InitialSyncBaseCloner::checkSyncSourceIsStillValid() {
         wireVersion = *wireVersionOpt;
     }
     if (wireVersion >= WireVersion::RESUMABLE_INITIAL_SYNC) {
-        auto status = checkInitialSyncIdIsUnchanged();
+        auto status = checkInitialSyncIdIsUnchanged(client);
         if (!status.isOK())
             return status;
     }
-    return checkRollBackIdIsUnchanged();
+    return checkRollBackIdIsUnchanged(client);
 }
 
-Status InitialSyncBaseCloner::checkInitialSyncIdIsUnchanged() {
+Status InitialSyncBaseCloner::checkInitialSyncIdIsUnchanged(DBClientConnection* client) {
     uassert(ErrorCodes::InitialSyncFailure,
             "Sync source was downgraded and no longer supports resumable initial sync",
-            getClient()->getMaxWireVersion() >= WireVersion::RESUMABLE_INITIAL_SYNC);
+            client->getMaxWireVersion() >= WireVersion::RESUMABLE_INITIAL_SYNC);
     BSONObj initialSyncId;
     try {
-        initialSyncId = getClient()->findOne(
+        initialSyncId = client->findOne(
             ReplicationConsistencyMarkersImpl::kDefaultInitialSyncIdNamespace.toString(), Query());
     } catch (DBException& e) {
         if (ErrorCodes::isRetriableError(e)) {
@@ -152,10 +152,10 @@ Status InitialSyncBaseCloner::checkInitialSyncIdIsUnchanged() {
     return Status::OK();
 }
 
-Status InitialSyncBaseCloner::checkRollBackIdIsUnchanged() {
+Status InitialSyncBaseCloner::checkRollBackIdIsUnchanged(DBClientConnection* client) {
     BSONObj info;
     try {
-        getClient()->simpleCommand("admin", &info, "replSetGetRBID");
+        client->simpleCommand("admin", &info, "replSetGetRBID");
     } catch (DBException& e) {
         if (ErrorCodes::isRetriableError(e)) {
             static constexpr char errorMsg[] =
@@ -51,25 +51,25 @@ protected:
         return checked_cast<InitialSyncSharedData*>(BaseCloner::getSharedData());
     }
 
+    /**
+     * Does validity checks on the sync source over 'client'.  If the sync source is now no longer
+     * usable, throws an exception. Returns a not-OK status if a network error occurs or if the
+     * sync source is temporarily unusable (e.g. restarting).
+     */
+    Status checkSyncSourceIsStillValid(DBClientConnection* client);
+
 private:
     /**
      * Make sure the initial sync ID on the sync source has not changed.  Throws an exception
      * if it has.  Returns a not-OK status if a network error occurs.
      */
-    Status checkInitialSyncIdIsUnchanged();
+    Status checkInitialSyncIdIsUnchanged(DBClientConnection* client);
 
     /**
      * Make sure the rollback ID has not changed.  Throws an exception if it has.  Returns
      * a not-OK status if a network error occurs.
      */
-    Status checkRollBackIdIsUnchanged();
-
-    /**
-     * Does validity checks on the sync source.  If the sync source is now no longer usable,
-     * throws an exception. Returns a not-OK status if a network error occurs or if the sync
-     * source is temporarily unusable (e.g. restarting).
-     */
-    Status checkSyncSourceIsStillValid();
+    Status checkRollBackIdIsUnchanged(DBClientConnection* client);
 
     /**
      * Clears _retryableOp.
@@ -31,6 +31,8 @@
 
 #include "mongo/db/repl/initial_sync_shared_data.h"
 
+#include "mongo/client/dbclient_connection.h"
+
 namespace mongo {
 namespace repl {
 int InitialSyncSharedData::incrementRetryingOperations(WithLock lk) {
@@ -76,5 +78,24 @@ Milliseconds InitialSyncSharedData::getCurrentOutageDuration(WithLock lk) {
                                            : Milliseconds::min());
 }
 
+bool InitialSyncSharedData::registerAdditionalClient(WithLock lk, DBClientConnection* client) {
+    if (_additionalClientsShutDown || !getStatus(lk).isOK()) {
+        return false;
+    }
+    invariant(_additionalClients.insert(client).second);
+    return true;
+}
+
+void InitialSyncSharedData::unregisterAdditionalClient(WithLock lk, DBClientConnection* client) {
+    invariant(_additionalClients.erase(client) == 1);
+}
+
+void InitialSyncSharedData::shutdownAdditionalClients(WithLock lk) {
+    _additionalClientsShutDown = true;
+    for (auto client : _additionalClients) {
+        client->shutdownAndDisallowReconnect();
+    }
+}
+
 }  // namespace repl
 }  // namespace mongo
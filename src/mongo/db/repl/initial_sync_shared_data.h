@@ -33,8 +33,12 @@
 
 #include "mongo/db/repl/repl_sync_shared_data.h"
 #include "mongo/db/server_options.h"
+#include "mongo/stdx/unordered_set.h"
 
 namespace mongo {
+
+class DBClientConnection;
+
 namespace repl {
 class InitialSyncSharedData final : public ReplSyncSharedData {
 private:
@@ -128,6 +132,22 @@ public:
         _allowedOutageDuration = allowedOutageDuration;
     }
 
+    /**
+     * Registers a connection to the sync source that a cloner opened in addition to the initial
+     * syncer's own, so that canceling the attempt can interrupt it. Returns false without
+     * registering the connection if the attempt has already failed or its connections have been
+     * shut down. A registered connection must be unregistered before it is destroyed.
+     */
+    bool registerAdditionalClient(WithLock lk, DBClientConnection* client);
+
+    void unregisterAdditionalClient(WithLock lk, DBClientConnection* client);
+
+    /**
+     * Shuts down every registered connection, failing any operation in progress on it, and
+     * refuses any further registrations.
+     */
+    void shutdownAdditionalClients(WithLock lk);
+
 private:
     class RetryingOperation {
     public:
@@ -214,6 +234,11 @@ private:
 
     // The initial sync ID on the source at the start of data cloning.
     boost::optional<UUID> _initialSyncSourceId;
+
+    // Connections to the sync source opened by cloners, which are shut down when the attempt is
+    // canceled.
+    stdx::unordered_set<DBClientConnection*> _additionalClients;
+    bool _additionalClientsShutDown = false;
 };
 }  // namespace repl
 }  // namespace mongo
@@ -30,6 +30,8 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/repl/initial_sync_shared_data.h"
+#include "mongo/dbtests/mock/mock_dbclient_connection.h"
+#include "mongo/dbtests/mock/mock_remote_db_server.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
 
@@ -231,5 +233,43 @@ TEST(InitialSyncSharedDataTest, OperationTimesOut) {
     ASSERT_EQ(Milliseconds::min(), data.getCurrentOutageDuration(lk));
 }
 
+TEST(InitialSyncSharedDataTest, ShutdownAdditionalClients) {
+    Days timeout(1);
+    ClockSourceMock clock;
+    InitialSyncSharedData data(1 /* rollBackId */, timeout, &clock);
+
+    MockRemoteDBServer server("test");
+    MockDBClientConnection client1(&server), client2(&server);
+    ASSERT_OK(client1.connect(HostAndPort("test"), StringData(), boost::none));
+    ASSERT_OK(client2.connect(HostAndPort("test"), StringData(), boost::none));
+
+    stdx::unique_lock<InitialSyncSharedData> lk(data);
+    ASSERT_TRUE(data.registerAdditionalClient(lk, &client1));
+    ASSERT_TRUE(data.registerAdditionalClient(lk, &client2));
+
+    // Unregistered clients are left alone.
+    data.unregisterAdditionalClient(lk, &client2);
+    data.shutdownAdditionalClients(lk);
+    ASSERT_TRUE(client1.isFailed());
+    ASSERT_FALSE(client2.isFailed());
+    data.unregisterAdditionalClient(lk, &client1);
+
+    // No clients may be registered once they have been shut down.
+    ASSERT_FALSE(data.registerAdditionalClient(lk, &client2));
+}
+
+TEST(InitialSyncSharedDataTest, RegisterAdditionalClientAfterFailure) {
+    Days timeout(1);
+    ClockSourceMock clock;
+    InitialSyncSharedData data(1 /* rollBackId */, timeout, &clock);
+
+    MockRemoteDBServer server("test");
+    MockDBClientConnection client(&server);
+
+    stdx::unique_lock<InitialSyncSharedData> lk(data);
+    data.setStatusIfOK(lk, Status(ErrorCodes::CallbackCanceled, "Initial sync attempt canceled"));
+    ASSERT_FALSE(data.registerAdditionalClient(lk, &client));
+}
+
 }  // namespace repl
 }  // namespace mongo
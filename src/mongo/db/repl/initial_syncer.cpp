@@ -337,6 +337,7 @@ void InitialSyncer::_cancelRemainingWork_inlock() {
         stdx::lock_guard<InitialSyncSharedData> lock(*_sharedData);
         _sharedData->setStatusIfOK(
             lock, Status{ErrorCodes::CallbackCanceled, "Initial sync attempt canceled"});
+        _sharedData->shutdownAdditionalClients(lock);
     }
     if (_client) {
         _client->shutdownAndDisallowReconnect();
@@ -72,6 +72,14 @@ ServerStatusMetricField<Counter64> displayOplogApplicationBatchSize("repl.apply.
 // Number and time of each ApplyOps worker pool round
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
+// Number of hash buckets per writer thread that a batch is partitioned into before the buckets are
+// spread across the writer threads.
+constexpr size_t kWriterBucketsPerWriter = 8;
+
+// Number of batches partitioned across the writer threads while the previous batch was applied
+Counter64 pipelinedBatches;
+ServerStatusMetricField<Counter64> displayPipelinedBatches("repl.apply.pipelinedBatches",
+                                                           &pipelinedBatches);
 
 /**
  * Used for logging a report of ops that take longer than "slowMS" to apply. This is called
@@ -265,6 +273,12 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
             ? new ApplyBatchFinalizerForJournal(_replCoord)
             : new ApplyBatchFinalizer(_replCoord)};
 
+    // The batch following the one being applied, if it was taken from the batcher while the
+    // previous batch was still being applied. 'nextPreparedBatch' holds a batch whose writer
+    // vectors were filled at that time, and 'nextBatch' anything else the batcher returned.
+    boost::optional<OplogBatch> nextBatch;
+    boost::optional<PreparedOplogBatch> nextPreparedBatch;
+
     while (true) {  // Exits on message from OplogBatcher.
         // Use a new operation context each iteration, as otherwise we may appear to use a single
         // collection name to refer to collections with different UUIDs.
@@ -287,27 +301,37 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
         // Transition to SECONDARY state, if possible.
         _replCoord->finishRecoveryIfEligible(&opCtx);
 
-        // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't become
-        // ready in time, we'll loop again so we can do the above checks periodically.
-        OplogBatch ops = _oplogBatcher->getNextBatch(Seconds(1));
-        if (ops.empty()) {
-            if (ops.mustShutdown()) {
-                // Shut down and exit oplog application loop.
-                return;
-            }
-            if (MONGO_unlikely(rsSyncApplyStop.shouldFail())) {
-                continue;
-            }
-            if (ops.termWhenExhausted()) {
-                // Signal drain complete if we're in Draining state and the buffer is empty.
-                // Since we check the states of batcher and oplog buffer without synchronization,
-                // they can be stale. We make sure the applier is still draining in the given term
-                // before and after the check, so that if the oplog buffer was exhausted, then
-                // it still will be.
-                _replCoord->signalDrainComplete(&opCtx, *ops.termWhenExhausted());
+        PreparedOplogBatch batch;
+        if (nextPreparedBatch) {
+            batch = std::move(*nextPreparedBatch);
+            nextPreparedBatch.reset();
+        } else {
+            // Blocks up to a second waiting for a batch to be ready to apply. If one doesn't
+            // become ready in time, we'll loop again so we can do the above checks periodically.
+            OplogBatch ops =
+                nextBatch ? std::move(*nextBatch) : _oplogBatcher->getNextBatch(Seconds(1));
+            nextBatch.reset();
+            if (ops.empty()) {
+                if (ops.mustShutdown()) {
+                    // Shut down and exit oplog application loop.
+                    return;
+                }
+                if (MONGO_unlikely(rsSyncApplyStop.shouldFail())) {
+                    continue;
+                }
+                if (ops.termWhenExhausted()) {
+                    // Signal drain complete if we're in Draining state and the buffer is empty.
+                    // Since we check the states of batcher and oplog buffer without
+                    // synchronization, they can be stale. We make sure the applier is still
+                    // draining in the given term before and after the check, so that if the oplog
+                    // buffer was exhausted, then it still will be.
+                    _replCoord->signalDrainComplete(&opCtx, *ops.termWhenExhausted());
+                }
+                continue;  // Try again.
             }
-            continue;  // Try again.
+            batch.ops = ops.releaseBatch();
         }
+        const auto& ops = batch.ops;
 
         // Extract some info from ops that we'll need after releasing the batch below.
         const auto firstOpTimeInBatch = ops.front().getOpTime();
@@ -329,9 +353,31 @@ void OplogApplierImpl::_run(OplogBuffer* oplogBuffer) {
         // Don't allow the fsync+lock thread to see intermediate states of batch application.
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
+        // While the writer threads apply this batch, take the next batch from the batcher and
+        // partition it across the writer threads, so that it is ready to be applied as soon as
+        // this one completes. The next batch is still applied on its own once this batch
+        // completes, so batch boundaries are unaffected.
+        const bool canPrepareNextBatch =
+            oplogApplierPipelineBatches.load() && canPrepareNextBatchWhileApplying(ops);
+        auto prepareNextBatch = [&] {
+            if (!canPrepareNextBatch) {
+                return;
+            }
+            OplogBatch next = _oplogBatcher->getNextBatch(Seconds(0));
+            if (next.empty() || !canPrepareWhileApplyingPreviousBatch(next.getBatch())) {
+                nextBatch.emplace(std::move(next));
+                return;
+            }
+            nextPreparedBatch.emplace();
+            nextPreparedBatch->ops = next.releaseBatch();
+            _prepareOplogBatch(&opCtx, &*nextPreparedBatch);
+            pipelinedBatches.increment();
+        };
+
         // Apply the operations in this batch. '_applyOplogBatch' returns the optime of the
         // last op that was applied, which should be the last optime in the batch.
-        auto swLastOpTimeAppliedInBatch = _applyOplogBatch(&opCtx, ops.releaseBatch());
+        auto swLastOpTimeAppliedInBatch =
+            _applyOplogBatch(&opCtx, std::move(batch), prepareNextBatch);
         if (swLastOpTimeAppliedInBatch.getStatus().code() == ErrorCodes::InterruptedAtShutdown) {
             // If an operation was interrupted at shutdown, fail the batch without advancing
             // appliedThrough as if this were an unclean shutdown. This ensures the stable timestamp
@@ -431,6 +477,14 @@ void scheduleWritesToOplog(OperationContext* opCtx,
 
 StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                                                       std::vector<OplogEntry> ops) {
+    return _applyOplogBatch(opCtx, PreparedOplogBatch{std::move(ops)}, {});
+}
+
+StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(
+    OperationContext* opCtx,
+    PreparedOplogBatch batch,
+    const std::function<void()>& whileApplying) {
+    auto& ops = batch.ops;
     invariant(!ops.empty());
 
     LOGV2_DEBUG(21230,
@@ -469,18 +523,12 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
             scheduleWritesToOplog(opCtx, _storageInterface, _writerPool, ops);
         }
 
-        // Holds 'pseudo operations' generated by secondaries to aid in replication.
-        // Keep in scope until all operations in 'ops' and 'derivedOps' have been applied.
-        // Pseudo operations include:
-        // - applyOps operations expanded to individual ops.
-        // - ops to update config.transactions. Normal writes to config.transactions in the
-        //   primary don't create an oplog entry, so extract info from writes with transactions
-        //   and create a pseudo oplog.
-        std::vector<std::vector<OplogEntry>> derivedOps;
-
-        std::vector<std::vector<const OplogEntry*>> writerVectors(
-            _writerPool->getStats().options.maxThreads);
-        fillWriterVectors(opCtx, &ops, &writerVectors, &derivedOps);
+        // A batch prepared while the previous batch was being applied arrives with its writer
+        // vectors already filled.
+        if (batch.writerVectors.empty()) {
+            _prepareOplogBatch(opCtx, &batch);
+        }
+        auto& writerVectors = batch.writerVectors;
 
         // Wait for writes to finish before applying ops.
         _writerPool->waitForIdle();
@@ -531,6 +579,10 @@ StatusWith<OpTime> OplogApplierImpl::_applyOplogBatch(OperationContext* opCtx,
                     });
             }
 
+            if (whileApplying) {
+                whileApplying();
+            }
+
             _writerPool->waitForIdle();
 
             // If any of the statuses is not ok, return error.
@@ -724,15 +776,62 @@ void OplogApplierImpl::fillWriterVectors(
     std::vector<std::vector<const OplogEntry*>>* writerVectors,
     std::vector<std::vector<OplogEntry>>* derivedOps) noexcept {
 
+    // Operations are first hashed into several times as many buckets as there are writers.
+    // Operations which must be applied in order relative to each other, such as those on the
+    // same document or on the same capped collection, always land in the same bucket. The buckets
+    // are then spread across the writers by size, so that a few hot documents or collections
+    // whose hashes happen to collide do not leave most of the writers idle.
+    std::vector<std::vector<const OplogEntry*>> buckets(writerVectors->size() *
+                                                        kWriterBucketsPerWriter);
+
     SessionUpdateTracker sessionUpdateTracker;
-    _deriveOpsAndFillWriterVectors(opCtx, ops, writerVectors, derivedOps, &sessionUpdateTracker);
+    _deriveOpsAndFillWriterVectors(opCtx, ops, &buckets, derivedOps, &sessionUpdateTracker);
 
     auto newOplogWrites = sessionUpdateTracker.flushAll();
     if (!newOplogWrites.empty()) {
         derivedOps->emplace_back(std::move(newOplogWrites));
-        _deriveOpsAndFillWriterVectors(
-            opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+        _deriveOpsAndFillWriterVectors(opCtx, &derivedOps->back(), &buckets, derivedOps, nullptr);
+    }
+
+    OplogApplierUtils::assignBucketsToWriters(&buckets, writerVectors);
+}
+
+void OplogApplierImpl::_prepareOplogBatch(OperationContext* opCtx,
+                                          PreparedOplogBatch* batch) noexcept {
+    // Holds 'pseudo operations' generated by secondaries to aid in replication. The batch keeps
+    // them alive until all operations in 'ops' and 'derivedOps' have been applied.
+    // Pseudo operations include:
+    // - applyOps operations expanded to individual ops.
+    // - ops to update config.transactions. Normal writes to config.transactions in the
+    //   primary don't create an oplog entry, so extract info from writes with transactions
+    //   and create a pseudo oplog.
+    batch->writerVectors.resize(_writerPool->getStats().options.maxThreads);
+    fillWriterVectors(opCtx, &batch->ops, &batch->writerVectors, &batch->derivedOps);
+}
+
+bool OplogApplierImpl::canPrepareNextBatchWhileApplying(const std::vector<OplogEntry>& ops) {
+    return !OplogBatcher::mustProcessIndividually(ops.front());
+}
+
+bool OplogApplierImpl::canPrepareWhileApplyingPreviousBatch(const std::vector<OplogEntry>& ops) {
+    return std::none_of(ops.begin(), ops.end(), [](const OplogEntry& op) {
+        return op.isPartialTransaction() || op.isPreparedCommit() ||
+            (op.isTerminalApplyOps() && op.getTxnNumber());
+    });
+}
+
+StatusWith<OpTime> OplogApplierImpl::applyPipelinedOplogBatches_forTest(
+    OperationContext* opCtx, std::vector<OplogEntry> ops, std::vector<OplogEntry> nextOps) {
+    invariant(canPrepareNextBatchWhileApplying(ops));
+    invariant(canPrepareWhileApplyingPreviousBatch(nextOps));
+    PreparedOplogBatch nextBatch{std::move(nextOps)};
+    auto status = _applyOplogBatch(
+        opCtx, PreparedOplogBatch{std::move(ops)}, [&] { _prepareOplogBatch(opCtx, &nextBatch); });
+    if (!status.isOK()) {
+        return status;
     }
+    invariant(!nextBatch.writerVectors.empty());
+    return _applyOplogBatch(opCtx, std::move(nextBatch), {});
 }
 
 void OplogApplierImpl::fillWriterVectors_forTest(
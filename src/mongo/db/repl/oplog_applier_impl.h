@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "mongo/db/commands/fsync.h"
 #include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/replication_state_transition_lock_guard.h"
@@ -74,6 +76,28 @@ public:
                      const Options& options,
                      ThreadPool* writerPool);
 
+    /**
+     * Returns whether the next batch may be partitioned across the writer threads while 'ops' is
+     * being applied. Commands are applied in batches of their own and may change the collection
+     * properties that the partitioning depends on, so only a batch of CRUD operations qualifies.
+     */
+    static bool canPrepareNextBatchWhileApplying(const std::vector<OplogEntry>& ops);
+
+    /**
+     * Returns whether the writer vectors for 'ops' can be filled while the preceding batch of CRUD
+     * operations is still being applied. Committing a transaction may read the transaction's
+     * earlier entries back from the oplog, which must wait until the preceding batch is complete.
+     */
+    static bool canPrepareWhileApplyingPreviousBatch(const std::vector<OplogEntry>& ops);
+
+    /**
+     * Applies 'ops' and then 'nextOps' the way steady state replication pipelines them: the
+     * writer vectors of 'nextOps' are filled while 'ops' is being applied.
+     */
+    StatusWith<OpTime> applyPipelinedOplogBatches_forTest(OperationContext* opCtx,
+                                                          std::vector<OplogEntry> ops,
+                                                          std::vector<OplogEntry> nextOps);
+
     void fillWriterVectors_forTest(OperationContext* opCtx,
                                    std::vector<OplogEntry>* ops,
                                    std::vector<std::vector<const OplogEntry*>>* writerVectors,
@@ -102,6 +126,32 @@ private:
      */
     StatusWith<OpTime> _applyOplogBatch(OperationContext* opCtx, std::vector<OplogEntry> ops);
 
+    /**
+     * A batch of operations and its partitioning across the writer threads. The writer vectors
+     * point into 'ops' and 'derivedOps', so the three must be kept together. 'writerVectors' is
+     * empty until the batch has been prepared.
+     */
+    struct PreparedOplogBatch {
+        std::vector<OplogEntry> ops;
+        std::vector<std::vector<OplogEntry>> derivedOps;
+        std::vector<std::vector<const OplogEntry*>> writerVectors;
+    };
+
+    /**
+     * Same as above, but accepts a batch which may already have been prepared. Once the writer
+     * threads have been handed the batch, 'whileApplying' is run on this thread so that the
+     * caller can get the next batch ready in the meantime. It runs while the parallel batch
+     * writer mode lock is held, and must not apply or write anything.
+     */
+    StatusWith<OpTime> _applyOplogBatch(OperationContext* opCtx,
+                                        PreparedOplogBatch batch,
+                                        const std::function<void()>& whileApplying);
+
+    /**
+     * Fills the writer vectors and derived operations of 'batch'.
+     */
+    void _prepareOplogBatch(OperationContext* opCtx, PreparedOplogBatch* batch) noexcept;
+
     void _deriveOpsAndFillWriterVectors(OperationContext* opCtx,
                                         std::vector<OplogEntry>* ops,
                                         std::vector<std::vector<const OplogEntry*>>* writerVectors,
@@ -30,6 +30,7 @@
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
+#include <map>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -56,6 +57,7 @@
 #include "mongo/db/repl/idempotency_test_fixture.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/oplog_applier.h"
+#include "mongo/db/repl/oplog_applier_utils.h"
 #include "mongo/db/repl/oplog_entry_test_helpers.h"
 #include "mongo/db/repl/repl_server_parameters_gen.h"
 #include "mongo/db/repl/replication_coordinator.h"
@@ -535,6 +537,141 @@ TEST_F(OplogApplierImplTest,
                   secondDerivedOp.getObject()["lastWriteOpTime"]["ts"].timestamp());
 }
 
+TEST_F(OplogApplierImplTest, FillWriterVectorsKeepsOperationsOnSameDocumentOnOneWriterInOrder) {
+    const NamespaceString nss("test", "foo");
+    std::vector<OplogEntry> ops;
+    for (int i = 0; i < 100; ++i) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i + 1), 1LL}, nss, BSON("_id" << i % 10 << "i" << i)));
+    }
+
+    auto writerPool = makeReplWriterPool();
+    NoopOplogApplierObserver observer;
+    OplogApplierImpl oplogApplier(
+        nullptr,  // executor
+        nullptr,  // oplogBuffer
+        &observer,
+        ReplicationCoordinator::get(_opCtx.get()),
+        getConsistencyMarkers(),
+        getStorageInterface(),
+        repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+        writerPool.get());
+
+    std::vector<std::vector<const OplogEntry*>> writerVectors(
+        writerPool->getStats().options.maxThreads);
+    std::vector<std::vector<OplogEntry>> derivedOps;
+    oplogApplier.fillWriterVectors_forTest(_opCtx.get(), &ops, &writerVectors, &derivedOps);
+
+    size_t numOps = 0;
+    size_t numUsedWriters = 0;
+    std::map<int, size_t> writerForId;
+    for (size_t writerId = 0; writerId < writerVectors.size(); ++writerId) {
+        std::map<int, int> lastSeenForId;
+        numOps += writerVectors[writerId].size();
+        numUsedWriters += writerVectors[writerId].empty() ? 0 : 1;
+        for (auto op : writerVectors[writerId]) {
+            auto id = op->getObject()["_id"].numberInt();
+            auto i = op->getObject()["i"].numberInt();
+            auto it = writerForId.emplace(id, writerId).first;
+            ASSERT_EQ(writerId, it->second);
+            auto lastSeen = lastSeenForId.find(id);
+            if (lastSeen != lastSeenForId.end()) {
+                ASSERT_LT(lastSeen->second, i);
+            }
+            lastSeenForId[id] = i;
+        }
+    }
+    ASSERT_EQ(ops.size(), numOps);
+    ASSERT_EQ(10U, writerForId.size());
+    ASSERT_GT(numUsedWriters, 1U);
+}
+
+TEST(OplogApplierUtilsTest, AssignBucketsToWritersBalancesOperations) {
+    const NamespaceString nss("test", "foo");
+    std::vector<OplogEntry> ops;
+    for (int i = 0; i < 12; ++i) {
+        ops.push_back(makeInsertDocumentOplogEntry(
+            {Timestamp(Seconds(1), i + 1), 1LL}, nss, BSON("_id" << i)));
+    }
+
+    // One large bucket and several small ones, as when a single hot document dominates a batch.
+    std::vector<std::vector<const OplogEntry*>> buckets(8);
+    for (int i = 0; i < 6; ++i) {
+        buckets[0].push_back(&ops[i]);
+    }
+    buckets[2] = {&ops[6], &ops[7]};
+    buckets[3] = {&ops[8]};
+    buckets[4] = {&ops[9]};
+    buckets[6] = {&ops[10]};
+    buckets[7] = {&ops[11]};
+    const auto largestBucket = buckets[0];
+    const auto secondLargestBucket = buckets[2];
+
+    std::vector<std::vector<const OplogEntry*>> writerVectors(2);
+    OplogApplierUtils::assignBucketsToWriters(&buckets, &writerVectors);
+
+    // The large bucket is kept whole on one writer and everything else goes to the other.
+    ASSERT_EQ(6U, writerVectors[0].size());
+    ASSERT_EQ(6U, writerVectors[1].size());
+    ASSERT(writerVectors[0] == largestBucket);
+    ASSERT(std::equal(secondLargestBucket.begin(),
+                      secondLargestBucket.end(),
+                      writerVectors[1].begin()));
+}
+
+TEST_F(OplogApplierImplTest, PipelineBoundariesForCrudAndCommandBatches) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    auto createOp = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
+    auto insertOp =
+        makeInsertDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL}, nss, BSON("_id" << 1));
+    auto deleteOp =
+        makeDeleteDocumentOplogEntry({Timestamp(Seconds(3), 0), 1LL}, nss, BSON("_id" << 1));
+
+    // The next batch may only be partitioned early while a batch of CRUD operations is applied.
+    ASSERT_TRUE(OplogApplierImpl::canPrepareNextBatchWhileApplying({insertOp, deleteOp}));
+    ASSERT_FALSE(OplogApplierImpl::canPrepareNextBatchWhileApplying({createOp}));
+
+    // Any batch outside of a transaction may itself be partitioned early.
+    ASSERT_TRUE(OplogApplierImpl::canPrepareWhileApplyingPreviousBatch({insertOp, deleteOp}));
+    ASSERT_TRUE(OplogApplierImpl::canPrepareWhileApplyingPreviousBatch({createOp}));
+}
+
+TEST_F(OplogApplierImplTest, MultiApplyPipelinedCrudBatches) {
+    NamespaceString nss("test." + _agent.getSuiteName() + "_" + _agent.getTestName());
+    createCollection(_opCtx.get(), nss, CollectionOptions());
+
+    auto doc1 = BSON("_id" << 1);
+    auto doc2 = BSON("_id" << 2);
+    auto doc3 = BSON("_id" << 3);
+    auto insertOp1 = makeInsertDocumentOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss, doc1);
+    auto insertOp2 = makeInsertDocumentOplogEntry({Timestamp(Seconds(2), 0), 1LL}, nss, doc2);
+    auto deleteOp = makeDeleteDocumentOplogEntry({Timestamp(Seconds(3), 0), 1LL}, nss, doc1);
+    auto insertOp3 = makeInsertDocumentOplogEntry({Timestamp(Seconds(4), 0), 1LL}, nss, doc3);
+
+    auto writerPool = makeReplWriterPool();
+    NoopOplogApplierObserver observer;
+    OplogApplierImpl oplogApplier(
+        nullptr,  // executor
+        nullptr,  // oplogBuffer
+        &observer,
+        ReplicationCoordinator::get(_opCtx.get()),
+        getConsistencyMarkers(),
+        getStorageInterface(),
+        repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+        writerPool.get());
+
+    // The second batch deletes a document inserted by the first, so it must only be applied once
+    // the first batch is complete even though it was partitioned while the first was applied.
+    auto lastOpTime = unittest::assertGet(oplogApplier.applyPipelinedOplogBatches_forTest(
+        _opCtx.get(), {insertOp1, insertOp2}, {deleteOp, insertOp3}));
+    ASSERT_EQUALS(insertOp3.getOpTime(), lastOpTime);
+
+    CollectionReader collectionReader(_opCtx.get(), nss);
+    ASSERT_BSONOBJ_EQ(doc2, unittest::assertGet(collectionReader.next()));
+    ASSERT_BSONOBJ_EQ(doc3, unittest::assertGet(collectionReader.next()));
+    ASSERT_EQUALS(ErrorCodes::CollectionIsEmpty, collectionReader.next().getStatus());
+}
+
 class MultiOplogEntryOplogApplierImplTest : public OplogApplierImplTest {
 public:
     MultiOplogEntryOplogApplierImplTest()
@@ -1071,6 +1208,64 @@ TEST_F(MultiOplogEntryPreparedTransactionTest, MultiApplyPreparedTransactionStea
                   DurableTxnStateEnum::kCommitted);
 }
 
+TEST_F(MultiOplogEntryPreparedTransactionTest, PipelineBoundariesForTransactionEntries) {
+    // Partial transaction entries are batched with CRUD operations, while prepare and the
+    // commit or abort of a transaction are applied in batches of their own.
+    ASSERT_TRUE(OplogApplierImpl::canPrepareNextBatchWhileApplying({*_insertOp1, *_insertOp2}));
+    ASSERT_FALSE(OplogApplierImpl::canPrepareNextBatchWhileApplying({*_prepareWithPrevOp}));
+    ASSERT_FALSE(OplogApplierImpl::canPrepareNextBatchWhileApplying({*_commitOp}));
+    ASSERT_FALSE(OplogApplierImpl::canPrepareNextBatchWhileApplying({*_commitPrepareWithPrevOp}));
+    ASSERT_FALSE(OplogApplierImpl::canPrepareNextBatchWhileApplying({*_abortPrepareWithPrevOp}));
+
+    // Partitioning a commit may read the transaction's earlier entries back from the oplog, so
+    // neither the commit nor the entries leading up to it are partitioned early.
+    ASSERT_FALSE(OplogApplierImpl::canPrepareWhileApplyingPreviousBatch({*_insertOp1}));
+    ASSERT_FALSE(OplogApplierImpl::canPrepareWhileApplyingPreviousBatch({*_commitOp}));
+    ASSERT_FALSE(
+        OplogApplierImpl::canPrepareWhileApplyingPreviousBatch({*_commitPrepareWithPrevOp}));
+
+    // A prepare only reads the transaction's earlier entries once it is applied.
+    ASSERT_TRUE(OplogApplierImpl::canPrepareWhileApplyingPreviousBatch({*_prepareWithPrevOp}));
+}
+
+TEST_F(MultiOplogEntryPreparedTransactionTest, MultiApplyPreparedTransactionPipelined) {
+    NoopOplogApplierObserver observer;
+    OplogApplierImpl oplogApplier(
+        nullptr,  // executor
+        nullptr,  // oplogBuffer
+        &observer,
+        ReplicationCoordinator::get(_opCtx.get()),
+        getConsistencyMarkers(),
+        getStorageInterface(),
+        repl::OplogApplier::Options(repl::OplogApplication::Mode::kSecondary),
+        _writerPool.get());
+
+    // Partition the prepare while the batch with the earlier entries of the transaction is being
+    // applied. The outcome must match applying the two batches one after the other.
+    const auto expectedStartOpTime = _insertOp1->getOpTime();
+    ASSERT_OK(oplogApplier.applyPipelinedOplogBatches_forTest(
+        _opCtx.get(), {*_insertOp1, *_insertOp2}, {*_prepareWithPrevOp}));
+    ASSERT_EQ(3U, oplogDocs().size());
+    ASSERT_BSONOBJ_EQ(_prepareWithPrevOp->getEntry().toBSON(), oplogDocs().back());
+    ASSERT_EQ(1U, _insertedDocs[_nss1].size());
+    ASSERT_EQ(2U, _insertedDocs[_nss2].size());
+    checkTxnTable(_lsid,
+                  _txnNum,
+                  _prepareWithPrevOp->getOpTime(),
+                  _prepareWithPrevOp->getWallClockTime(),
+                  expectedStartOpTime,
+                  DurableTxnStateEnum::kPrepared);
+
+    ASSERT_OK(oplogApplier.applyOplogBatch(_opCtx.get(), {*_commitPrepareWithPrevOp}));
+    ASSERT_BSONOBJ_EQ(_commitPrepareWithPrevOp->getEntry().toBSON(), oplogDocs().back());
+    checkTxnTable(_lsid,
+                  _txnNum,
+                  _commitPrepareWithPrevOp->getOpTime(),
+                  _commitPrepareWithPrevOp->getWallClockTime(),
+                  boost::none,
+                  DurableTxnStateEnum::kCommitted);
+}
+
 TEST_F(MultiOplogEntryPreparedTransactionTest, MultiApplyAbortPreparedTransactionCheckTxnTable) {
     NoopOplogApplierObserver observer;
     OplogApplierImpl oplogApplier(
@@ -31,6 +31,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include <numeric>
+#include <queue>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/collection_catalog.h"
 #include "mongo/db/catalog/document_validation.h"
@@ -161,6 +164,42 @@ void OplogApplierUtils::addDerivedOps(OperationContext* opCtx,
     }
 }
 
+void OplogApplierUtils::assignBucketsToWriters(
+    std::vector<std::vector<const OplogEntry*>>* buckets,
+    std::vector<std::vector<const OplogEntry*>>* writerVectors) {
+    invariant(!writerVectors->empty());
+
+    std::vector<size_t> bucketOrder(buckets->size());
+    std::iota(bucketOrder.begin(), bucketOrder.end(), 0);
+    std::stable_sort(bucketOrder.begin(), bucketOrder.end(), [&](size_t l, size_t r) {
+        return (*buckets)[l].size() > (*buckets)[r].size();
+    });
+
+    // Pairs of (number of operations, writer id), least loaded writer on top.
+    using WriterLoad = std::pair<size_t, size_t>;
+    std::priority_queue<WriterLoad, std::vector<WriterLoad>, std::greater<WriterLoad>> writers;
+    for (size_t writerId = 0; writerId < writerVectors->size(); ++writerId) {
+        writers.emplace((*writerVectors)[writerId].size(), writerId);
+    }
+
+    for (auto bucketId : bucketOrder) {
+        auto& bucket = (*buckets)[bucketId];
+        if (bucket.empty()) {
+            break;
+        }
+        auto writerId = writers.top().second;
+        writers.pop();
+
+        auto& writer = (*writerVectors)[writerId];
+        if (writer.empty()) {
+            writer = std::move(bucket);
+        } else {
+            writer.insert(writer.end(), bucket.begin(), bucket.end());
+        }
+        writers.emplace(writer.size(), writerId);
+    }
+}
+
 NamespaceString OplogApplierUtils::parseUUIDOrNs(OperationContext* opCtx,
                                                  const OplogEntry& oplogEntry) {
     auto optionalUuid = oplogEntry.getUuid();
@@ -103,6 +103,15 @@ public:
                               CachedCollectionProperties* collPropertiesCache,
                               bool serial);
 
+    /**
+     * Moves the operations in 'buckets' into 'writerVectors', keeping each bucket together and in
+     * order on a single writer. Buckets are handed out largest first, each to the writer with the
+     * fewest operations so far, so that a batch whose work is concentrated in a few buckets is
+     * still spread evenly across the writers. Leaves 'buckets' in an unspecified state.
+     */
+    static void assignBucketsToWriters(std::vector<std::vector<const OplogEntry*>>* buckets,
+                                       std::vector<std::vector<const OplogEntry*>>* writerVectors);
+
     /**
      * Returns the namespace string for this oplogEntry; if it has a UUID it looks up the
      * corresponding namespace and returns it, otherwise it returns the oplog entry 'nss'.  If there
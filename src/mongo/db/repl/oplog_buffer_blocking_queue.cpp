@@ -47,8 +47,7 @@ size_t getDocumentSize(const BSONObj& o) {
 }  // namespace
 
 OplogBufferBlockingQueue::OplogBufferBlockingQueue() : OplogBufferBlockingQueue(nullptr) {}
-OplogBufferBlockingQueue::OplogBufferBlockingQueue(Counters* counters)
-    : _counters(counters), _queue(kOplogBufferSize, &getDocumentSize) {}
+OplogBufferBlockingQueue::OplogBufferBlockingQueue(Counters* counters) : _counters(counters) {}
 
 void OplogBufferBlockingQueue::startup(OperationContext*) {
     // Update server status metric to reflect the current oplog buffer's max size.
@@ -64,9 +63,25 @@ void OplogBufferBlockingQueue::shutdown(OperationContext* opCtx) {
 void OplogBufferBlockingQueue::push(OperationContext*,
                                     Batch::const_iterator begin,
                                     Batch::const_iterator end) {
-    invariant(!_drainMode);
-    _queue.pushAllBlocking(begin, end);
-    _notEmptyCv.notify_one();
+    if (begin == end) {
+        return;
+    }
+
+    size_t size = 0;
+    for (auto i = begin; i != end; ++i) {
+        size += getDocumentSize(*i);
+    }
+
+    {
+        stdx::unique_lock<Latch> lk(_mutex);
+        invariant(!_drainMode);
+        _notFullCv.wait(lk, [&] { return _size + size <= kOplogBufferSize; });
+
+        _blocks.emplace_back(begin, end);
+        _count += _blocks.back().size();
+        _size += size;
+        _notEmptyCv.notify_one();
+    }
 
     if (_counters) {
         for (auto i = begin; i != end; ++i) {
@@ -76,11 +91,17 @@ void OplogBufferBlockingQueue::push(OperationContext*,
 }
 
 void OplogBufferBlockingQueue::waitForSpace(OperationContext*, std::size_t size) {
-    _queue.waitForSpace(size);
+    stdx::unique_lock<Latch> lk(_mutex);
+    _notFullCv.wait(lk, [&] { return _size + size <= kOplogBufferSize; });
 }
 
 bool OplogBufferBlockingQueue::isEmpty() const {
-    return _queue.empty();
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _isEmpty_inlock();
+}
+
+bool OplogBufferBlockingQueue::_isEmpty_inlock() const {
+    return _count == 0;
 }
 
 std::size_t OplogBufferBlockingQueue::getMaxSize() const {
@@ -88,23 +109,45 @@ std::size_t OplogBufferBlockingQueue::getMaxSize() const {
 }
 
 std::size_t OplogBufferBlockingQueue::getSize() const {
-    return _queue.size();
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _size;
 }
 
 std::size_t OplogBufferBlockingQueue::getCount() const {
-    return _queue.count();
+    stdx::lock_guard<Latch> lk(_mutex);
+    return _count;
 }
 
 void OplogBufferBlockingQueue::clear(OperationContext*) {
-    _queue.clear();
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        _blocks.clear();
+        _frontPos = 0;
+        _count = 0;
+        _size = 0;
+        _notFullCv.notify_all();
+    }
     if (_counters) {
         _counters->clear();
     }
 }
 
 bool OplogBufferBlockingQueue::tryPop(OperationContext*, Value* value) {
-    if (!_queue.tryPop(*value)) {
-        return false;
+    {
+        stdx::lock_guard<Latch> lk(_mutex);
+        if (_isEmpty_inlock()) {
+            return false;
+        }
+
+        auto& front = _blocks.front();
+        *value = std::move(front[_frontPos]);
+        if (++_frontPos == front.size()) {
+            _blocks.pop_front();
+            _frontPos = 0;
+        }
+        _count--;
+        _size -= getDocumentSize(*value);
+        _notFullCv.notify_one();
     }
     if (_counters) {
         _counters->decrement(*value);
@@ -113,30 +156,38 @@ bool OplogBufferBlockingQueue::tryPop(OperationContext*, Value* value) {
 }
 
 bool OplogBufferBlockingQueue::waitForData(Seconds waitDuration) {
-    Value ignored;
-    stdx::unique_lock<Latch> lk(_notEmptyMutex);
+    stdx::unique_lock<Latch> lk(_mutex);
     _notEmptyCv.wait_for(
-        lk, waitDuration.toSystemDuration(), [&] { return _drainMode || _queue.peek(ignored); });
-    return _queue.peek(ignored);
+        lk, waitDuration.toSystemDuration(), [&] { return _drainMode || !_isEmpty_inlock(); });
+    return !_isEmpty_inlock();
 }
 
 bool OplogBufferBlockingQueue::peek(OperationContext*, Value* value) {
-    return _queue.peek(*value);
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_isEmpty_inlock()) {
+        return false;
+    }
+    *value = _blocks.front()[_frontPos];
+    return true;
 }
 
 boost::optional<OplogBuffer::Value> OplogBufferBlockingQueue::lastObjectPushed(
     OperationContext*) const {
-    return _queue.lastObjectPushed();
+    stdx::lock_guard<Latch> lk(_mutex);
+    if (_isEmpty_inlock()) {
+        return boost::none;
+    }
+    return _blocks.back().back();
 }
 
 void OplogBufferBlockingQueue::enterDrainMode() {
-    stdx::lock_guard<Latch> lk(_notEmptyMutex);
+    stdx::lock_guard<Latch> lk(_mutex);
     _drainMode = true;
     _notEmptyCv.notify_one();
 }
 
 void OplogBufferBlockingQueue::exitDrainMode() {
-    stdx::lock_guard<Latch> lk(_notEmptyMutex);
+    stdx::lock_guard<Latch> lk(_mutex);
     _drainMode = false;
 }
 
@@ -29,14 +29,23 @@
 
 #pragma once
 
+#include <deque>
+#include <vector>
+
 #include "mongo/db/repl/oplog_buffer.h"
-#include "mongo/util/queue.h"
+#include "mongo/platform/mutex.h"
+#include "mongo/stdx/condition_variable.h"
 
 namespace mongo {
 namespace repl {
 
 /**
- * Oplog buffer backed by in memory blocking queue of BSONObj.
+ * Oplog buffer backed by an in memory blocking queue of BSONObj.
+ *
+ * Each push() is stored as a single block holding the whole range of entries, and entries are
+ * consumed from the front block in order. The entries pushed by the oplog fetcher share ownership
+ * of the reply buffer they were received in, so buffering a fetched batch costs one allocation
+ * for the block rather than one queue node per entry, and the entries themselves are not copied.
  */
 class OplogBufferBlockingQueue final : public OplogBuffer {
 public:
@@ -65,11 +74,23 @@ public:
     void exitDrainMode() final;
 
 private:
-    Mutex _notEmptyMutex = MONGO_MAKE_LATCH("OplogBufferBlockingQueue::mutex");
+    bool _isEmpty_inlock() const;
+
+    // Guards all of the members below.
+    mutable Mutex _mutex = MONGO_MAKE_LATCH("OplogBufferBlockingQueue::mutex");
     stdx::condition_variable _notEmptyCv;
+    stdx::condition_variable _notFullCv;
     bool _drainMode = false;
     Counters* const _counters;
-    BlockingQueue<BSONObj> _queue;
+
+    // Blocks of entries in the order they were pushed. The entries of the front block before
+    // '_frontPos' have already been popped.
+    std::deque<std::vector<BSONObj>> _blocks;
+    std::size_t _frontPos = 0;
+
+    // Number of entries in the buffer and their total size as measured by BSONObj::objsize().
+    std::size_t _count = 0;
+    std::size_t _size = 0;
 };
 
 }  // namespace repl
@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/repl/oplog_buffer_blocking_queue.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+/**
+ * Returns a batch of 'count' documents with _id values starting at 'first', all sharing ownership
+ * of one buffer in the way the documents of a fetched cursor batch do.
+ */
+OplogBuffer::Batch makeBatch(int first, int count) {
+    BSONArrayBuilder arr;
+    for (int i = first; i < first + count; ++i) {
+        arr.append(BSON("_id" << i));
+    }
+    auto owner = BSON("batch" << arr.arr());
+
+    OplogBuffer::Batch batch;
+    for (auto&& elem : owner["batch"].Obj()) {
+        batch.push_back(elem.Obj());
+        batch.back().shareOwnershipWith(owner.sharedBuffer());
+    }
+    return batch;
+}
+
+TEST(OplogBufferBlockingQueueTest, PopsEntriesInOrderAcrossBatches) {
+    OplogBufferBlockingQueue buffer;
+    ASSERT_TRUE(buffer.isEmpty());
+
+    auto first = makeBatch(0, 3);
+    auto second = makeBatch(3, 1);
+    auto third = makeBatch(4, 2);
+    buffer.push(nullptr, first.cbegin(), first.cend());
+    buffer.push(nullptr, second.cbegin(), second.cend());
+    buffer.push(nullptr, third.cbegin(), third.cend());
+
+    ASSERT_EQ(6U, buffer.getCount());
+    ASSERT_EQ(6U * static_cast<size_t>(first[0].objsize()), buffer.getSize());
+    ASSERT_BSONOBJ_EQ(BSON("_id" << 5), *buffer.lastObjectPushed(nullptr));
+
+    for (int i = 0; i < 6; ++i) {
+        OplogBuffer::Value peeked;
+        ASSERT_TRUE(buffer.peek(nullptr, &peeked));
+        ASSERT_BSONOBJ_EQ(BSON("_id" << i), peeked);
+
+        OplogBuffer::Value popped;
+        ASSERT_TRUE(buffer.tryPop(nullptr, &popped));
+        ASSERT_BSONOBJ_EQ(BSON("_id" << i), popped);
+        ASSERT_EQ(static_cast<size_t>(5 - i), buffer.getCount());
+    }
+
+    OplogBuffer::Value value;
+    ASSERT_TRUE(buffer.isEmpty());
+    ASSERT_EQ(0U, buffer.getSize());
+    ASSERT_FALSE(buffer.peek(nullptr, &value));
+    ASSERT_FALSE(buffer.tryPop(nullptr, &value));
+    ASSERT_FALSE(buffer.lastObjectPushed(nullptr));
+}
+
+TEST(OplogBufferBlockingQueueTest, EntriesShareTheBufferTheyWerePushedIn) {
+    OplogBufferBlockingQueue buffer;
+    auto batch = makeBatch(0, 2);
+    buffer.push(nullptr, batch.cbegin(), batch.cend());
+
+    OplogBuffer::Value value;
+    ASSERT_TRUE(buffer.tryPop(nullptr, &value));
+    ASSERT_EQ(batch[0].objdata(), value.objdata());
+}
+
+TEST(OplogBufferBlockingQueueTest, UpdatesCounters) {
+    OplogBuffer::Counters counters;
+    OplogBufferBlockingQueue buffer(&counters);
+    buffer.startup(nullptr);
+    ASSERT_EQ(static_cast<long long>(buffer.getMaxSize()), counters.maxSize.get());
+
+    auto batch = makeBatch(0, 4);
+    buffer.push(nullptr, batch.cbegin(), batch.cend());
+    ASSERT_EQ(4, counters.count.get());
+    ASSERT_EQ(static_cast<long long>(buffer.getSize()), counters.size.get());
+
+    OplogBuffer::Value value;
+    ASSERT_TRUE(buffer.tryPop(nullptr, &value));
+    ASSERT_EQ(3, counters.count.get());
+    ASSERT_EQ(static_cast<long long>(buffer.getSize()), counters.size.get());
+
+    buffer.clear(nullptr);
+    ASSERT_TRUE(buffer.isEmpty());
+    ASSERT_EQ(0U, buffer.getCount());
+    ASSERT_EQ(0, counters.count.get());
+    ASSERT_EQ(0, counters.size.get());
+}
+
+TEST(OplogBufferBlockingQueueTest, WaitForDataReturnsInDrainMode) {
+    OplogBufferBlockingQueue buffer;
+    ASSERT_FALSE(buffer.waitForData(Seconds(0)));
+
+    buffer.enterDrainMode();
+    ASSERT_FALSE(buffer.waitForData(Seconds(60)));
+    buffer.exitDrainMode();
+
+    auto batch = makeBatch(0, 1);
+    buffer.push(nullptr, batch.cbegin(), batch.cend());
+    ASSERT_TRUE(buffer.waitForData(Seconds(60)));
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
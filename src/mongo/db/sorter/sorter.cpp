@@ -59,10 +59,14 @@
 #include "mongo/db/storage/encryption_hooks.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/mutex.h"
 #include "mongo/platform/overflow_arithmetic.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool_interface.h"
 #include "mongo/util/destructor_guard.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/str.h"
 
 namespace mongo {
@@ -542,6 +546,135 @@ private:
     STLComparator _greater;                      // named so calls make sense
 };
 
+/**
+ * Merges a group of sorted inputs on a thread pool, and hands the merged data to the thread
+ * iterating over it in batches. A MergeIterator over several of these merges many spilled ranges
+ * in parallel, since it only has to merge the output of each group.
+ */
+template <typename Key, typename Value, typename Comparator>
+class AsyncMergeIterator : public SortIteratorInterface<Key, Value> {
+public:
+    typedef SortIteratorInterface<Key, Value> Input;
+    typedef std::pair<Key, Value> Data;
+
+    AsyncMergeIterator(std::vector<std::shared_ptr<Input>> inputs,
+                       const SortOptions& opts,
+                       const Comparator& comp)
+        : _inputs(std::move(inputs)), _opts(opts), _comp(comp) {
+        invariant(_opts.threadPool);
+        invariant(_opts.limit == 0);
+    }
+
+    ~AsyncMergeIterator() {
+        closeSource();
+    }
+
+    void openSource() {
+        if (std::exchange(_started, true)) {
+            return;
+        }
+        _opts.threadPool->schedule([this](Status status) { produce(status); });
+    }
+
+    void closeSource() {
+        if (!_started) {
+            return;
+        }
+        stdx::unique_lock<Latch> lk(_mutex);
+        _cancelled = true;
+        _cv.notify_all();
+        _cv.wait(lk, [&] { return _producerDone; });
+    }
+
+    bool more() {
+        if (_position < _batch.size()) {
+            return true;
+        }
+
+        stdx::unique_lock<Latch> lk(_mutex);
+        _cv.wait(lk, [&] { return !_batches.empty() || _producerDone; });
+        if (_batches.empty()) {
+            uassertStatusOK(_status);
+            return false;
+        }
+        _batch = std::move(_batches.front());
+        _batches.pop_front();
+        _position = 0;
+        _cv.notify_all();
+        return true;
+    }
+
+    Data next() {
+        verify(more());
+        return std::move(_batch[_position++]);
+    }
+
+private:
+    static constexpr size_t kBatchSize = 1024;
+    static constexpr size_t kMaxQueuedBatches = 4;
+
+    /**
+     * Runs on the thread pool, merging the inputs until they are exhausted or the iterator is
+     * closed.
+     */
+    void produce(Status status) {
+        ON_BLOCK_EXIT([&] {
+            stdx::lock_guard<Latch> lk(_mutex);
+            _producerDone = true;
+            _cv.notify_all();
+        });
+
+        try {
+            uassertStatusOK(status);
+            std::unique_ptr<Input> merged(Input::merge(_inputs, _opts, _comp));
+            std::vector<Data> batch;
+            while (merged->more()) {
+                batch.push_back(merged->next());
+                if (batch.size() == kBatchSize && !push(std::exchange(batch, {}))) {
+                    return;
+                }
+            }
+            if (!batch.empty()) {
+                push(std::move(batch));
+            }
+        } catch (const DBException& ex) {
+            stdx::lock_guard<Latch> lk(_mutex);
+            _status = ex.toStatus();
+        }
+    }
+
+    /**
+     * Queues a batch for the iterating thread, waiting while the queue is full. Returns false if
+     * the iterator was closed.
+     */
+    bool push(std::vector<Data> batch) {
+        stdx::unique_lock<Latch> lk(_mutex);
+        _cv.wait(lk, [&] { return _cancelled || _batches.size() < kMaxQueuedBatches; });
+        if (_cancelled) {
+            return false;
+        }
+        _batches.push_back(std::move(batch));
+        _cv.notify_all();
+        return true;
+    }
+
+    const std::vector<std::shared_ptr<Input>> _inputs;
+    const SortOptions _opts;
+    const Comparator _comp;
+    bool _started = false;
+
+    // Only accessed by the iterating thread.
+    std::vector<Data> _batch;
+    size_t _position = 0;
+
+    Mutex _mutex = MONGO_MAKE_LATCH("AsyncMergeIterator::_mutex");
+    stdx::condition_variable _cv;
+    std::deque<std::vector<Data>> _batches;
+    bool _cancelled = false;
+    bool _producerDone = false;
+    Status _status = Status::OK();
+};
+
 template <typename Key, typename Value, typename Comparator>
 class NoLimitSorter : public Sorter<Key, Value> {
 public:
@@ -585,6 +718,9 @@ public:
     }
 
     ~NoLimitSorter() {
+        // Background spills write to the file and refer to this Sorter.
+        DESTRUCTOR_GUARD(waitForPendingSpills());
+
         // This Sorter is responsible for file deletion, even if done() was called.
         if (!this->_shouldKeepFilesOnDestruction) {
             DESTRUCTOR_GUARD(boost::filesystem::remove(this->_fileFullPath));
@@ -600,7 +736,7 @@ public:
         _memUsed += memUsage;
         this->_totalDataSizeSorted += memUsage;
 
-        if (_memUsed > this->_opts.maxMemoryUsageBytes)
+        if (_memUsed > maxRunMemoryUsageBytes())
             spill();
     }
 
@@ -613,7 +749,7 @@ public:
 
         _data.emplace_back(std::move(key), std::move(val));
 
-        if (_memUsed > this->_opts.maxMemoryUsageBytes)
+        if (_memUsed > maxRunMemoryUsageBytes())
             spill();
     }
 
@@ -626,6 +762,11 @@ public:
         }
 
         spill();
+        waitForPendingSpills();
+
+        if (spillsInBackground() && this->_iters.size() > this->_opts.parallelism) {
+            return mergeInParallel();
+        }
         return Iterator::merge(this->_iters, this->_opts, _comp);
     }
 
@@ -648,6 +789,96 @@ private:
         this->_numSorted += _data.size();
     }
 
+    bool spillsInBackground() const {
+        return this->_opts.extSortAllowed && this->_opts.threadPool && this->_opts.parallelism > 1;
+    }
+
+    /**
+     * When spilling in the background, the run being filled and the runs being sorted share the
+     * memory limit.
+     */
+    size_t maxRunMemoryUsageBytes() const {
+        return spillsInBackground() ? this->_opts.maxMemoryUsageBytes / this->_opts.parallelism
+                                    : this->_opts.maxMemoryUsageBytes;
+    }
+
+    void waitForPendingSpills() override {
+        stdx::unique_lock<Latch> lk(_spillMutex);
+        _spillFinished.wait(lk, [&] { return _numPendingSpills == 0; });
+        uassertStatusOK(_spillStatus);
+    }
+
+    /**
+     * Sorts the in-memory data on the thread pool and appends it to the file as a new range. The
+     * range's position in '_iters' is reserved up front, so that ties between ranges are still
+     * broken in insertion order when merging.
+     */
+    void spillInBackground() {
+        auto data = std::make_shared<std::deque<Data>>();
+        size_t index;
+        {
+            stdx::unique_lock<Latch> lk(_spillMutex);
+            _spillFinished.wait(
+                lk, [&] { return _numPendingSpills < this->_opts.parallelism - 1; });
+            uassertStatusOK(_spillStatus);
+
+            index = this->_iters.size();
+            this->_iters.emplace_back();
+            ++_numPendingSpills;
+        }
+
+        data->swap(_data);
+        this->_numSorted += data->size();
+        _memUsed = 0;
+
+        this->_opts.threadPool->schedule([this, data, index](Status status) {
+            Status result = Status::OK();
+            std::shared_ptr<Iterator> iterator;
+            try {
+                uassertStatusOK(status);
+                STLComparator less(_comp);
+                std::stable_sort(data->begin(), data->end(), less);
+
+                // Ranges are appended to the shared file one at a time.
+                stdx::lock_guard<Latch> fileLk(_fileMutex);
+                SortedFileWriter<Key, Value> writer(
+                    this->_opts, this->_fileFullPath, _nextSortedFileWriterOffset, _settings);
+                for (; !data->empty(); data->pop_front()) {
+                    writer.addAlreadySorted(data->front().first, data->front().second);
+                }
+                iterator.reset(writer.done());
+                _nextSortedFileWriterOffset = writer.getFileEndOffset();
+            } catch (const DBException& ex) {
+                result = ex.toStatus();
+            }
+
+            stdx::lock_guard<Latch> lk(_spillMutex);
+            if (result.isOK()) {
+                this->_iters[index] = std::move(iterator);
+            } else if (_spillStatus.isOK()) {
+                _spillStatus = result;
+            }
+            --_numPendingSpills;
+            _spillFinished.notify_all();
+        });
+    }
+
+    /**
+     * Splits the spilled ranges into one contiguous group per thread, merges each group on the
+     * thread pool and returns an iterator merging the groups' output.
+     */
+    Iterator* mergeInParallel() {
+        const auto numGroups = this->_opts.parallelism;
+        std::vector<std::shared_ptr<Iterator>> groups;
+        for (size_t i = 0; i < numGroups; ++i) {
+            auto begin = this->_iters.begin() + i * this->_iters.size() / numGroups;
+            auto end = this->_iters.begin() + (i + 1) * this->_iters.size() / numGroups;
+            groups.push_back(std::make_shared<AsyncMergeIterator<Key, Value, Comparator>>(
+                std::vector<std::shared_ptr<Iterator>>(begin, end), this->_opts, _comp));
+        }
+        return Iterator::merge(groups, this->_opts, _comp);
+    }
+
     void spill() {
         this->_numSpills++;
         if (_data.empty())
@@ -664,6 +895,11 @@ private:
                           << " bytes, but did not opt in to external sorting.");
         }
 
+        if (spillsInBackground()) {
+            spillInBackground();
+            return;
+        }
+
         sort();
 
         SortedFileWriter<Key, Value> writer(
@@ -685,6 +921,16 @@ private:
     bool _done = false;
     size_t _memUsed = 0;
     std::deque<Data> _data;  // Data that has not been spilled.
+
+    // Serializes the background spills' writes to the file, and '_nextSortedFileWriterOffset'.
+    Mutex _fileMutex = MONGO_MAKE_LATCH("NoLimitSorter::_fileMutex");
+
+    // Guards the state of the spills running in the background, and the slots they fill in
+    // '_iters'.
+    Mutex _spillMutex = MONGO_MAKE_LATCH("NoLimitSorter::_spillMutex");
+    stdx::condition_variable _spillFinished;
+    size_t _numPendingSpills = 0;
+    Status _spillStatus = Status::OK();
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -1010,6 +1256,7 @@ Sorter<Key, Value>::Sorter(const SortOptions& opts, const std::string& fileName)
 template <typename Key, typename Value>
 typename Sorter<Key, Value>::PersistedState Sorter<Key, Value>::persistDataForShutdown() {
     spill();
+    waitForPendingSpills();
     _shouldKeepFilesOnDestruction = true;
 
     std::vector<SorterRange> ranges;
@@ -90,6 +90,8 @@
 
 namespace mongo {
 
+class ThreadPoolInterface;
+
 /**
  * Runtime options that control the Sorter's behavior
  */
@@ -114,7 +116,21 @@ struct SortOptions {
     // extSortAllowed is true.
     std::string tempDir;
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    // If set, and extSortAllowed is true, a sort without a limit sorts and spills its in-memory
+    // runs on this thread pool while data is still being added, and merges the spilled runs in
+    // parallel. The pool must outlive the Sorter.
+    ThreadPoolInterface* threadPool;
+
+    // The number of threads from 'threadPool' the sort may use at once. The runs being sorted
+    // concurrently share maxMemoryUsageBytes between them. Sorts on the calling thread if 1.
+    size_t parallelism;
+
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          threadPool(nullptr),
+          parallelism(1) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -142,6 +158,12 @@ struct SortOptions {
         dbName = std::move(newDbName);
         return *this;
     }
+
+    SortOptions& Parallelism(ThreadPoolInterface* newThreadPool, size_t newParallelism) {
+        threadPool = newThreadPool;
+        parallelism = newParallelism;
+        return *this;
+    }
 };
 
 /**
@@ -288,6 +310,11 @@ protected:
 
     virtual void spill() = 0;
 
+    /**
+     * Waits for any spills running on SortOptions::threadPool to finish.
+     */
+    virtual void waitForPendingSpills() {}
+
     size_t _numSpills = 0;  // Keeps track of the number of times data was spilled to disk.
     size_t _numSorted = 0;  // Keeps track of the number of keys sorted.
     uint64_t _totalDataSizeSorted = 0;  // Keeps track of the total size of data sorted.
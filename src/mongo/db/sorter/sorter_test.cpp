@@ -45,6 +45,7 @@
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 
 namespace mongo {
@@ -623,6 +624,41 @@ public:
     PseudoRandom _random;
 };
 
+template <bool Random = true>
+class LotsOfDataLittleMemoryParallel : public LotsOfDataLittleMemory<Random> {
+    typedef LotsOfDataLittleMemory<Random> Parent;
+
+public:
+    LotsOfDataLittleMemoryParallel() : _threadPool(makeThreadPoolOptions()) {
+        _threadPool.startup();
+    }
+
+    ~LotsOfDataLittleMemoryParallel() {
+        _threadPool.shutdown();
+        _threadPool.join();
+    }
+
+    SortOptions adjustSortOptions(SortOptions opts) override {
+        return Parent::adjustSortOptions(opts).Parallelism(&_threadPool, kParallelism);
+    }
+
+    size_t correctNumRanges() const override {
+        // Each run only gets its share of the memory limit.
+        return Parent::NUM_ITEMS * sizeof(IWPair) / (Parent::MEM_LIMIT / kParallelism) + 1;
+    }
+
+private:
+    static ThreadPool::Options makeThreadPoolOptions() {
+        // Several sorters may merge at once, each needing a thread per group of ranges.
+        ThreadPool::Options options;
+        options.minThreads = 0;
+        options.maxThreads = ThreadPool::Options::kUnlimited;
+        return options;
+    }
+
+    static constexpr size_t kParallelism = 4;
+    ThreadPool _threadPool;
+};
 
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
@@ -670,6 +706,8 @@ public:
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallel</*random=*/false>>();
+        add<SorterTests::LotsOfDataLittleMemoryParallel</*random=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
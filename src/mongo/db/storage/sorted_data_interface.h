@@ -93,6 +93,38 @@ public:
                           const KeyString::Value& keyString,
                           bool dupsAllowed) = 0;
 
+    /**
+     * Insert a batch of entries into the index, each as insert() would. The KeyStrings must be
+     * sorted in ascending order, which allows implementations to insert them with a single cursor
+     * in key order rather than repositioning from the root for each entry.
+     *
+     * If 'timestamps' is not empty, it holds the timestamp to write each entry at, in the same
+     * order as 'keyStrings', and the recovery unit's timestamp is changed between entries as
+     * needed. Otherwise all entries are written at the recovery unit's current timestamp.
+     *
+     * Stops at and returns the first non-OK Status, in which case the entries before the failing
+     * one have been inserted.
+     */
+    virtual Status insertBatch(OperationContext* opCtx,
+                               const std::vector<KeyString::Value>& keyStrings,
+                               bool dupsAllowed,
+                               const std::vector<Timestamp>& timestamps = {}) {
+        invariant(timestamps.empty() || timestamps.size() == keyStrings.size());
+        for (size_t i = 0; i < keyStrings.size(); ++i) {
+            if (!timestamps.empty() && (i == 0 || timestamps[i] != timestamps[i - 1])) {
+                auto status = opCtx->recoveryUnit()->setTimestamp(timestamps[i]);
+                if (!status.isOK()) {
+                    return status;
+                }
+            }
+            auto status = insert(opCtx, keyStrings[i], dupsAllowed);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        return Status::OK();
+    }
+
     /**
      * Remove the entry from the index with the specified KeyString, which must have a RecordId
      * appended to the end.
@@ -717,5 +717,65 @@ TEST(SortedDataInterface, InsertReservedRecordId) {
     ASSERT_EQUALS(1, sorted->numEntries(opCtx.get()));
 }
 
+// Insert a sorted batch of keys and verify that they can all be found in order.
+TEST(SortedDataInterface, InsertBatch) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(
+        harnessHelper->newSortedDataInterface(/*unique=*/false, /*partial=*/false));
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_OK(sorted->insertBatch(opCtx.get(),
+                                          {makeKeyString(sorted.get(), key1, loc1),
+                                           makeKeyString(sorted.get(), key1, loc2),
+                                           makeKeyString(sorted.get(), key2, loc1),
+                                           makeKeyString(sorted.get(), key3, loc3)},
+                                          true));
+            uow.commit();
+        }
+    }
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(4, sorted->numEntries(opCtx.get()));
+
+        const std::unique_ptr<SortedDataInterface::Cursor> cursor(sorted->newCursor(opCtx.get()));
+        ASSERT_EQ(cursor->seek(makeKeyStringForSeek(sorted.get(), key1, true, true)),
+                  IndexKeyEntry(key1, loc1));
+        ASSERT_EQ(cursor->next(), IndexKeyEntry(key1, loc2));
+        ASSERT_EQ(cursor->next(), IndexKeyEntry(key2, loc1));
+        ASSERT_EQ(cursor->next(), IndexKeyEntry(key3, loc3));
+        ASSERT_EQ(cursor->next(), boost::none);
+    }
+}
+
+// Insert a batch into a unique index where two entries share a key, and verify that the batch
+// stops at the duplicate.
+TEST(SortedDataInterface, InsertBatchUniqueDuplicate) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(
+        harnessHelper->newSortedDataInterface(/*unique=*/true, /*partial=*/false));
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            ASSERT_EQUALS(ErrorCodes::DuplicateKey,
+                          sorted->insertBatch(opCtx.get(),
+                                              {makeKeyString(sorted.get(), key1, loc1),
+                                               makeKeyString(sorted.get(), key2, loc1),
+                                               makeKeyString(sorted.get(), key2, loc2)},
+                                              false));
+        }
+    }
+
+    {
+        const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT(sorted->isEmpty(opCtx.get()));
+    }
+}
+
 }  // namespace
 }  // namespace mongo
@@ -33,6 +33,7 @@
 
 #include "mongo/db/storage/wiredtiger/wiredtiger_index.h"
 
+#include <algorithm>
 #include <memory>
 #include <set>
 
@@ -287,6 +288,43 @@ Status WiredTigerIndex::insert(OperationContext* opCtx,
     return _insert(opCtx, c, keyString, dupsAllowed);
 }
 
+Status WiredTigerIndex::insertBatch(OperationContext* opCtx,
+                                    const std::vector<KeyString::Value>& keyStrings,
+                                    bool dupsAllowed,
+                                    const std::vector<Timestamp>& timestamps) {
+    dassert(opCtx->lockState()->isWriteLocked());
+    dassert(std::is_sorted(keyStrings.begin(), keyStrings.end()));
+    invariant(timestamps.empty() || timestamps.size() == keyStrings.size());
+
+    // A single cursor is used for the whole batch. Because the keys arrive in order, each insert
+    // lands on or next to the page touched by the previous one.
+    WiredTigerCursor curwrap(_uri, _tableId, false, opCtx);
+    curwrap.assertInActiveTxn();
+    WT_CURSOR* c = curwrap.get();
+
+    for (size_t i = 0; i < keyStrings.size(); ++i) {
+        const auto& keyString = keyStrings[i];
+        dassertRecordIdAtEnd(keyString, _rsKeyFormat);
+
+        // WiredTiger applies the transaction's current commit timestamp to each update, so the
+        // timestamp can change between entries while the cursor stays open.
+        if (!timestamps.empty() && (i == 0 || timestamps[i] != timestamps[i - 1])) {
+            auto status = opCtx->recoveryUnit()->setTimestamp(timestamps[i]);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+
+        LOGV2_TRACE_INDEX(5843190, "KeyString: {keyString}", "keyString"_attr = keyString);
+
+        auto status = _insert(opCtx, c, keyString, dupsAllowed);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    return Status::OK();
+}
+
 void WiredTigerIndex::unindex(OperationContext* opCtx,
                               const KeyString::Value& keyString,
                               bool dupsAllowed) {
@@ -103,6 +103,11 @@ public:
                           const KeyString::Value& keyString,
                           bool dupsAllowed);
 
+    virtual Status insertBatch(OperationContext* opCtx,
+                               const std::vector<KeyString::Value>& keyStrings,
+                               bool dupsAllowed,
+                               const std::vector<Timestamp>& timestamps);
+
     virtual void unindex(OperationContext* opCtx,
                          const KeyString::Value& keyString,
                          bool dupsAllowed);
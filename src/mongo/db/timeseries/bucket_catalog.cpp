@@ -38,6 +38,8 @@
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/storage/storage_parameters_gen.h"
 #include "mongo/db/views/view_catalog.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/fail_point.h"
@@ -317,6 +319,7 @@ void BucketCatalog::finish(std::shared_ptr<WriteBatch> batch, const CommitInfo&
                 stdx::lock_guard statesLk{_statesMutex};
                 _bucketStates.erase(ptr->_id);
             }
+            _recordClosedBucket(ptr);
             _allBuckets.erase(ptr);
         } else {
             _markBucketIdle(bucket);
@@ -376,12 +379,28 @@ void BucketCatalog::clear(const NamespaceString& ns) {
 
         it = nextIt;
     }
+
+    stdx::lock_guard closedLk{_closedMutex};
+    _closedBuckets.erase(std::remove_if(_closedBuckets.begin(),
+                                        _closedBuckets.end(),
+                                        [&](const ClosedBucket& closed) {
+                                            return shouldClear(closed.ns);
+                                        }),
+                         _closedBuckets.end());
 }
 
 void BucketCatalog::clear(StringData dbName) {
     clear(NamespaceString(dbName, ""));
 }
 
+std::vector<BucketCatalog::ClosedBucket> BucketCatalog::takeClosedBuckets() {
+    std::vector<ClosedBucket> taken;
+
+    stdx::lock_guard lk{_closedMutex};
+    taken.swap(_closedBuckets);
+    return taken;
+}
+
 void BucketCatalog::appendExecutionStats(const NamespaceString& ns, BSONObjBuilder* builder) const {
     const auto stats = _getExecutionStats(ns);
 
@@ -480,6 +499,18 @@ void BucketCatalog::_removeNonNormalizedKeysForBucket(Bucket* bucket) {
     }
 }
 
+void BucketCatalog::_recordClosedBucket(Bucket* bucket) {
+    // Closed buckets are only consumed for compression, so don't accumulate them otherwise.
+    if (bucket->_numCommittedMeasurements == 0 ||
+        !feature_flags::gTimeseriesBucketCompression.isEnabled(
+            serverGlobalParams.featureCompatibility)) {
+        return;
+    }
+
+    stdx::lock_guard lk{_closedMutex};
+    _closedBuckets.push_back({bucket->_id, bucket->_ns});
+}
+
 void BucketCatalog::_abort(stdx::unique_lock<Mutex>& lk,
                            Bucket* bucket,
                            std::shared_ptr<WriteBatch> batch,
@@ -539,6 +570,7 @@ void BucketCatalog::_expireIdleBuckets(ExecutionStats* stats) {
                static_cast<std::uint64_t>(gTimeseriesIdleBucketExpiryMemoryUsageThreshold)) {
         Bucket* bucket = _idleBuckets.back();
         _verifyBucketIsUnused(bucket);
+        _recordClosedBucket(bucket);
         if (_removeBucket(bucket, true /* expiringBuckets */)) {
             stats->numBucketsClosedDueToMemoryThreshold.fetchAndAddRelaxed(1);
         }
@@ -966,6 +998,7 @@ void BucketCatalog::BucketAccess::rollover(const std::function<bool(BucketAccess
             // remove it now. Otherwise, we must keep the bucket around until it is committed.
             oldBucket = _bucket;
             release();
+            _catalog->_recordClosedBucket(oldBucket);
             bool removed = _catalog->_removeBucket(oldBucket, false /* expiringBuckets */);
             invariant(removed);
         } else {
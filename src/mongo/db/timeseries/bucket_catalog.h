@@ -64,6 +64,15 @@ public:
         boost::optional<OID> electionId;
     };
 
+    /**
+     * Identifies a bucket which has been closed with all of its measurements committed, and which
+     * will therefore not be written to through the catalog again.
+     */
+    struct ClosedBucket {
+        OID bucketId;
+        NamespaceString ns;
+    };
+
     /**
      * The basic unit of work for a bucket. Each insert will return a shared_ptr to a WriteBatch.
      * When a writer is finished with all their insertions, they should then take steps to ensure
@@ -231,6 +240,12 @@ public:
      */
     void clear(StringData dbName);
 
+    /**
+     * Returns and forgets the buckets, of any namespace, that have been closed since the last call,
+     * so that the caller can perform any final processing of the bucket documents.
+     */
+    std::vector<ClosedBucket> takeClosedBuckets();
+
     /**
      * Appends the execution stats for the given namespace to the builder.
      */
@@ -778,6 +793,11 @@ private:
      */
     void _removeNonNormalizedKeysForBucket(Bucket* bucket);
 
+    /**
+     * Records that the given bucket has been closed, if it has any committed measurements.
+     */
+    void _recordClosedBucket(Bucket* bucket);
+
     /**
      * Aborts any batches it can for the given bucket, then removes the bucket. If batch is
      * non-null, it is assumed that the caller has commit rights for that batch.
@@ -866,6 +886,12 @@ private:
     // Buckets that do not have any writers.
     IdleList _idleBuckets;
 
+    // This mutex protects access to _closedBuckets
+    mutable Mutex _closedMutex = MONGO_MAKE_LATCH("BucketCatalog::_closedMutex");
+
+    // Buckets that have been closed but not yet returned by takeClosedBuckets.
+    std::vector<ClosedBucket> _closedBuckets;
+
     /**
      * This mutex protects access to the _executionStats map. Once you complete your lookup, you
      * can keep the shared_ptr to an individual namespace's stats object and release the lock. The
@@ -35,6 +35,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/timeseries/bucket_catalog.h"
 #include "mongo/db/views/view_catalog.h"
+#include "mongo/idl/server_parameter_test_util.h"
 #include "mongo/stdx/future.h"
 #include "mongo/unittest/bson_test_util.h"
 #include "mongo/unittest/death_test.h"
@@ -331,6 +332,25 @@ TEST_F(BucketCatalogTest, ClearDatabaseBuckets) {
     _insertOneAndCommit(_ns3, 1);
 }
 
+TEST_F(BucketCatalogTest, TakeClosedBucketsAfterRollover) {
+    RAIIServerParameterControllerForTest controller{"featureFlagTimeseriesBucketCompression",
+                                                    true};
+
+    for (auto i = 0; i < gTimeseriesBucketMaxCount; ++i) {
+        _insertOneAndCommit(_ns1, i);
+    }
+    ASSERT(_bucketCatalog->takeClosedBuckets().empty());
+
+    // The next insert rolls the full bucket over, closing it.
+    _insertOneAndCommit(_ns1, 0);
+    _insertOneAndCommit(_ns2, 0);
+
+    auto closed = _bucketCatalog->takeClosedBuckets();
+    ASSERT_EQ(closed.size(), 1U);
+    ASSERT_EQ(closed[0].ns, _ns1);
+    ASSERT(_bucketCatalog->takeClosedBuckets().empty());
+}
+
 TEST_F(BucketCatalogTest, InsertBetweenPrepareAndFinish) {
     auto batch1 = _bucketCatalog
                       ->insert(_opCtx,
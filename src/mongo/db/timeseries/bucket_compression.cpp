@@ -0,0 +1,486 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/bucket_compression.h"
+
+#include <cmath>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/timeseries/timeseries_field_names.h"
+#include "mongo/util/decimal_counter.h"
+
+namespace mongo {
+
+namespace timeseries {
+
+namespace {
+
+// The first byte of every compressed column, identifying the encoding of the rest of the column.
+constexpr char kColumnFormat = 1;
+
+// The largest magnitude up to which every integral double is exactly representable.
+constexpr double kMaxExactDouble = static_cast<double>(1LL << 53);
+
+/**
+ * A compressed column is a sequence of the following operations, each of which produces zero or
+ * more consecutive rows of the column, starting from row 0.
+ */
+enum ColumnOp : char {
+    // Followed by the next value, as a BSON element with an empty field name.
+    kLiteral = 1,
+    // Followed by the varint number of rows missing from the column.
+    kSkip = 2,
+    // Followed by the varint number of rows repeating the previous value.
+    kRepeat = 3,
+    // Followed by the zigzag varint difference between the next value and the previous value.
+    kDelta = 4,
+    // Followed by the zigzag varint difference between the next delta and the previous delta.
+    kDeltaOfDelta = 5,
+    // Followed by the varint number of rows adding the previous delta to the previous value.
+    kDeltaRepeat = 6,
+};
+
+uint64_t zigZagEncode(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+int64_t zigZagDecode(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+size_t varintSize(uint64_t value) {
+    size_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        ++size;
+    }
+    return size;
+}
+
+void appendVarint(BufBuilder& buf, uint64_t value) {
+    while (value >= 0x80) {
+        buf.appendUChar(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    buf.appendUChar(static_cast<unsigned char>(value));
+}
+
+/**
+ * Wrapping arithmetic on the 64-bit integers the delta encoded values are represented with.
+ */
+int64_t wrappingSubtract(int64_t lhs, int64_t rhs) {
+    return static_cast<int64_t>(static_cast<uint64_t>(lhs) - static_cast<uint64_t>(rhs));
+}
+
+int64_t wrappingAdd(int64_t lhs, int64_t rhs) {
+    return static_cast<int64_t>(static_cast<uint64_t>(lhs) + static_cast<uint64_t>(rhs));
+}
+
+/**
+ * Returns the value of 'elem' as a 64-bit integer if it is of a type that can be delta encoded.
+ */
+boost::optional<int64_t> deltaEncodableValue(const BSONElement& elem) {
+    switch (elem.type()) {
+        case NumberInt:
+            return elem._numberInt();
+        case NumberLong:
+            return elem._numberLong();
+        case Date:
+            return elem.date().toMillisSinceEpoch();
+        case bsonTimestamp:
+            return static_cast<int64_t>(elem.timestamp().asULL());
+        case NumberDouble: {
+            // Negative zero would come back as positive zero.
+            auto value = elem._numberDouble();
+            if (std::trunc(value) == value && std::abs(value) <= kMaxExactDouble &&
+                !(value == 0 && std::signbit(value))) {
+                return static_cast<int64_t>(value);
+            }
+            return boost::none;
+        }
+        default:
+            return boost::none;
+    }
+}
+
+/**
+ * Appends the delta encoded 'value' of type 'type' to 'builder'.
+ */
+void appendDeltaEncodedValue(BSONObjBuilder* builder,
+                             StringData fieldName,
+                             BSONType type,
+                             int64_t value) {
+    switch (type) {
+        case NumberInt:
+            builder->append(fieldName, static_cast<int32_t>(value));
+            break;
+        case NumberLong:
+            builder->append(fieldName, static_cast<long long>(value));
+            break;
+        case Date:
+            builder->appendDate(fieldName, Date_t::fromMillisSinceEpoch(value));
+            break;
+        case bsonTimestamp:
+            builder->append(fieldName, Timestamp(static_cast<unsigned long long>(value)));
+            break;
+        case NumberDouble:
+            builder->append(fieldName, static_cast<double>(value));
+            break;
+        default:
+            MONGO_UNREACHABLE;
+    }
+}
+
+/**
+ * Returns the row index stored in the field name of a column of an uncompressed bucket, or
+ * boost::none if it is not the canonical decimal representation of a row index.
+ */
+boost::optional<uint32_t> parseRowIndex(StringData fieldName) {
+    if (fieldName.empty() || (fieldName.size() > 1 && fieldName[0] == '0')) {
+        return boost::none;
+    }
+
+    uint64_t row = 0;
+    for (auto c : fieldName) {
+        if (c < '0' || c > '9') {
+            return boost::none;
+        }
+        row = row * 10 + (c - '0');
+        if (row > std::numeric_limits<uint32_t>::max()) {
+            return boost::none;
+        }
+    }
+    return static_cast<uint32_t>(row);
+}
+
+/**
+ * Encodes the values of a column, which must be appended in increasing row order.
+ */
+class ColumnEncoder {
+public:
+    explicit ColumnEncoder(BufBuilder* buf) : _buf(buf) {
+        _buf->appendChar(kColumnFormat);
+    }
+
+    /**
+     * Appends the value 'elem' of row 'row'. Returns false if the row does not come after the
+     * previously appended one.
+     */
+    bool append(uint32_t row, const BSONElement& elem) {
+        if (row < _nextRow) {
+            return false;
+        }
+        if (row > _nextRow) {
+            _flushRun();
+            _buf->appendChar(kSkip);
+            appendVarint(*_buf, row - _nextRow);
+        }
+
+        auto value = deltaEncodableValue(elem);
+        if (_last && _last.binaryEqualValues(elem)) {
+            _extendRun(kRepeat);
+        } else if (_lastValue && value && _last.type() == elem.type()) {
+            auto delta = wrappingSubtract(*value, *_lastValue);
+            if (_lastDelta && delta == *_lastDelta) {
+                _extendRun(kDeltaRepeat);
+            } else {
+                _flushRun();
+                auto encodedDelta = zigZagEncode(delta);
+                auto encodedDeltaOfDelta =
+                    _lastDelta ? zigZagEncode(wrappingSubtract(delta, *_lastDelta)) : encodedDelta;
+                if (varintSize(encodedDeltaOfDelta) < varintSize(encodedDelta)) {
+                    _buf->appendChar(kDeltaOfDelta);
+                    appendVarint(*_buf, encodedDeltaOfDelta);
+                } else {
+                    _buf->appendChar(kDelta);
+                    appendVarint(*_buf, encodedDelta);
+                }
+                _lastDelta = delta;
+            }
+        } else {
+            _flushRun();
+            _buf->appendChar(kLiteral);
+            _buf->appendChar(elem.type());
+            _buf->appendChar('\0');
+            _buf->appendBuf(elem.value(), elem.valuesize());
+            _lastDelta = boost::none;
+        }
+
+        _last = elem;
+        _lastValue = value;
+        _nextRow = row + 1;
+        return true;
+    }
+
+    void finish() {
+        _flushRun();
+    }
+
+private:
+    void _extendRun(ColumnOp op) {
+        if (_runLength > 0 && _runOp != op) {
+            _flushRun();
+        }
+        _runOp = op;
+        ++_runLength;
+    }
+
+    void _flushRun() {
+        if (_runLength > 0) {
+            _buf->appendChar(_runOp);
+            appendVarint(*_buf, _runLength);
+            _runLength = 0;
+        }
+    }
+
+    BufBuilder* const _buf;
+
+    uint32_t _nextRow = 0;
+
+    // The previous value of the column, and its representation if it could be delta encoded.
+    BSONElement _last;
+    boost::optional<int64_t> _lastValue;
+
+    // The delta the previous value was encoded with, if any.
+    boost::optional<int64_t> _lastDelta;
+
+    // The pending run of 'kRepeat' or 'kDeltaRepeat' rows.
+    ColumnOp _runOp = kRepeat;
+    uint64_t _runLength = 0;
+};
+
+/**
+ * Decodes the compressed 'column' into 'builder', as fields named after the row indexes.
+ */
+void decodeColumn(const char* column, size_t length, BSONObjBuilder* builder) {
+    const char* pos = column;
+    const char* const end = column + length;
+
+    auto readByte = [&] {
+        uassert(5843160, "Compressed time-series column is truncated", pos < end);
+        return *pos++;
+    };
+    auto readVarint = [&] {
+        uint64_t value = 0;
+        for (int shift = 0;; shift += 7) {
+            uassert(5843161, "Invalid varint in compressed time-series column", shift < 64);
+            auto byte = static_cast<unsigned char>(readByte());
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+    };
+
+    uassert(5843162, "Unknown compressed time-series column format", readByte() == kColumnFormat);
+
+    DecimalCounter<uint32_t> row;
+    auto advanceRows = [&](uint64_t count) {
+        uassert(5843163,
+                "Too many rows in compressed time-series column",
+                count <= std::numeric_limits<uint32_t>::max() - static_cast<uint32_t>(row));
+        row = DecimalCounter<uint32_t>(static_cast<uint32_t>(row) + count);
+    };
+
+    // The previous value, either as a literal or as a delta encoded value of type 'lastType'.
+    BSONElement lastLiteral;
+    BSONType lastType = EOO;
+    boost::optional<int64_t> lastValue;
+    boost::optional<int64_t> lastDelta;
+
+    auto appendDelta = [&](int64_t delta) {
+        uassert(5843164, "Invalid delta in compressed time-series column", lastValue);
+        lastValue = wrappingAdd(*lastValue, delta);
+        lastDelta = delta;
+        lastLiteral = BSONElement();
+        appendDeltaEncodedValue(builder, row, lastType, *lastValue);
+        ++row;
+    };
+
+    while (pos < end) {
+        switch (readByte()) {
+            case kLiteral: {
+                uassert(5843165, "Compressed time-series column is truncated", end - pos >= 2);
+                lastLiteral = BSONElement(pos);
+                uassert(5843166,
+                        "Compressed time-series column is truncated",
+                        lastLiteral.size() <= end - pos);
+                pos += lastLiteral.size();
+
+                lastType = lastLiteral.type();
+                lastValue = deltaEncodableValue(lastLiteral);
+                lastDelta = boost::none;
+                builder->appendAs(lastLiteral, row);
+                ++row;
+                break;
+            }
+            case kSkip:
+                advanceRows(readVarint());
+                break;
+            case kRepeat: {
+                uassert(5843167,
+                        "Invalid repeat in compressed time-series column",
+                        lastLiteral || lastValue);
+                auto count = readVarint();
+                for (uint64_t i = 0; i < count; ++i) {
+                    if (lastLiteral) {
+                        builder->appendAs(lastLiteral, row);
+                    } else {
+                        appendDeltaEncodedValue(builder, row, lastType, *lastValue);
+                    }
+                    ++row;
+                }
+                break;
+            }
+            case kDelta:
+                appendDelta(zigZagDecode(readVarint()));
+                break;
+            case kDeltaOfDelta:
+                uassert(5843168, "Invalid delta in compressed time-series column", lastDelta);
+                appendDelta(wrappingAdd(*lastDelta, zigZagDecode(readVarint())));
+                break;
+            case kDeltaRepeat: {
+                uassert(5843169, "Invalid delta in compressed time-series column", lastDelta);
+                auto count = readVarint();
+                for (uint64_t i = 0; i < count; ++i) {
+                    appendDelta(*lastDelta);
+                }
+                break;
+            }
+            default:
+                uasserted(5843170, "Unknown operation in compressed time-series column");
+        }
+    }
+}
+
+/**
+ * Appends the control region of a bucket to 'builder' with its version replaced by 'version'.
+ */
+void appendControlWithVersion(const BSONElement& control, int version, BSONObjBuilder* builder) {
+    BSONObjBuilder controlBuilder(builder->subobjStart(control.fieldNameStringData()));
+    for (auto&& elem : control.Obj()) {
+        if (elem.fieldNameStringData() == kBucketControlVersionFieldName) {
+            controlBuilder.append(kBucketControlVersionFieldName, version);
+        } else {
+            controlBuilder.append(elem);
+        }
+    }
+}
+
+}  // namespace
+
+boost::optional<BSONObj> compressBucket(const BSONObj& bucketDoc) {
+    auto control = bucketDoc[kBucketControlFieldName];
+    auto data = bucketDoc[kBucketDataFieldName];
+    if (control.type() != Object || data.type() != Object ||
+        control.Obj()[kBucketControlVersionFieldName].numberInt() !=
+            kTimeseriesControlDefaultVersion) {
+        return boost::none;
+    }
+
+    BSONObjBuilder builder;
+    for (auto&& elem : bucketDoc) {
+        auto fieldName = elem.fieldNameStringData();
+        if (fieldName == kBucketControlFieldName) {
+            appendControlWithVersion(elem, kTimeseriesControlCompressedVersion, &builder);
+        } else if (fieldName == kBucketDataFieldName) {
+            BSONObjBuilder dataBuilder(builder.subobjStart(fieldName));
+            for (auto&& column : elem.Obj()) {
+                if (column.type() != Object) {
+                    return boost::none;
+                }
+
+                BufBuilder buf;
+                ColumnEncoder encoder(&buf);
+                for (auto&& cell : column.Obj()) {
+                    auto row = parseRowIndex(cell.fieldNameStringData());
+                    if (!row || !encoder.append(*row, cell)) {
+                        return boost::none;
+                    }
+                }
+                encoder.finish();
+
+                dataBuilder.appendBinData(
+                    column.fieldNameStringData(), buf.len(), BinDataGeneral, buf.buf());
+            }
+        } else {
+            builder.append(elem);
+        }
+    }
+
+    auto compressed = builder.obj();
+    if (compressed.objsize() >= bucketDoc.objsize()) {
+        return boost::none;
+    }
+    return compressed;
+}
+
+BSONObj decompressBucket(const BSONObj& bucketDoc) {
+    uassert(5843171, "The time-series bucket is not compressed", isCompressedBucket(bucketDoc));
+
+    BSONObjBuilder builder;
+    for (auto&& elem : bucketDoc) {
+        auto fieldName = elem.fieldNameStringData();
+        if (fieldName == kBucketControlFieldName) {
+            appendControlWithVersion(elem, kTimeseriesControlDefaultVersion, &builder);
+        } else if (fieldName == kBucketDataFieldName) {
+            uassert(5843172,
+                    "The data region of a compressed time-series bucket must be an object",
+                    elem.type() == Object);
+
+            BSONObjBuilder dataBuilder(builder.subobjStart(fieldName));
+            for (auto&& column : elem.Obj()) {
+                uassert(5843173,
+                        "The columns of a compressed time-series bucket must be BinData",
+                        column.type() == BinData && column.binDataType() == BinDataGeneral);
+
+                int length = 0;
+                auto bytes = column.binData(length);
+                BSONObjBuilder columnBuilder(dataBuilder.subobjStart(column.fieldNameStringData()));
+                decodeColumn(bytes, length, &columnBuilder);
+            }
+        } else {
+            builder.append(elem);
+        }
+    }
+    return builder.obj();
+}
+
+bool isCompressedBucket(const BSONObj& bucketDoc) {
+    auto control = bucketDoc[kBucketControlFieldName];
+    return control.type() == Object &&
+        control.Obj()[kBucketControlVersionFieldName].numberInt() ==
+        kTimeseriesControlCompressedVersion;
+}
+
+}  // namespace timeseries
+}  // namespace mongo
@@ -0,0 +1,77 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+/**
+ * Namespace for helper functions related to time-series collections.
+ */
+namespace timeseries {
+
+// The 'control.version' of buckets whose 'data' columns are plain objects keyed by row index.
+static constexpr int kTimeseriesControlDefaultVersion = 1;
+
+// The 'control.version' of buckets whose 'data' columns are compressed (see compressBucket()).
+static constexpr int kTimeseriesControlCompressedVersion = 2;
+
+/**
+ * Returns a copy of 'bucketDoc' in which every column of the data region is compressed into a
+ * BinData value, and 'control.version' is set to 'kTimeseriesControlCompressedVersion'.
+ *
+ * The values of a column are encoded in row order. Runs of missing rows and of repeated values are
+ * run-length encoded. Consecutive 32-bit and 64-bit integers, dates, timestamps and integral
+ * doubles of the same type are delta encoded, or delta-of-delta encoded when that is shorter, and
+ * runs of equal deltas are run-length encoded. Any other value is stored as is.
+ *
+ * Returns boost::none if the bucket is already compressed, is not a well-formed uncompressed
+ * bucket, or would not get any smaller.
+ */
+boost::optional<BSONObj> compressBucket(const BSONObj& bucketDoc);
+
+/**
+ * Returns a copy of the compressed 'bucketDoc' with its data region decompressed back into plain
+ * objects keyed by row index, and with 'control.version' set to 'kTimeseriesControlDefaultVersion'.
+ * Throws if the bucket is not compressed or its data is corrupt.
+ */
+BSONObj decompressBucket(const BSONObj& bucketDoc);
+
+/**
+ * Returns whether 'bucketDoc' has been compressed by compressBucket().
+ */
+bool isCompressedBucket(const BSONObj& bucketDoc);
+
+}  // namespace timeseries
+}  // namespace mongo
@@ -0,0 +1,174 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/bucket_compression.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/json.h"
+#include "mongo/db/timeseries/timeseries_field_names.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Builds an uncompressed bucket with 'count' measurements at one second intervals, with a constant
+ * field 'a', an incrementing field 'b' and a field 'c' present only on every third measurement.
+ */
+BSONObj makeBucket(int count) {
+    BSONObjBuilder builder;
+    builder.append("_id", OID::gen());
+    {
+        BSONObjBuilder control(builder.subobjStart(timeseries::kBucketControlFieldName));
+        control.append(timeseries::kBucketControlVersionFieldName,
+                       timeseries::kTimeseriesControlDefaultVersion);
+    }
+    builder.append(timeseries::kBucketMetaFieldName, "sensor");
+    {
+        BSONObjBuilder data(builder.subobjStart(timeseries::kBucketDataFieldName));
+        BSONObjBuilder time(data.subobjStart("time"));
+        for (int i = 0; i < count; ++i) {
+            time.appendDate(std::to_string(i), Date_t::fromMillisSinceEpoch(1000000 + i * 1000));
+        }
+        time.done();
+
+        BSONObjBuilder a(data.subobjStart("a"));
+        for (int i = 0; i < count; ++i) {
+            a.append(std::to_string(i), "constant");
+        }
+        a.done();
+
+        BSONObjBuilder b(data.subobjStart("b"));
+        for (int i = 0; i < count; ++i) {
+            b.append(std::to_string(i), static_cast<long long>(i * i));
+        }
+        b.done();
+
+        BSONObjBuilder c(data.subobjStart("c"));
+        for (int i = 0; i < count; i += 3) {
+            c.append(std::to_string(i), i * 0.5);
+        }
+    }
+    return builder.obj();
+}
+
+void assertRoundTrips(const BSONObj& bucket) {
+    auto compressed = timeseries::compressBucket(bucket);
+    ASSERT(compressed);
+    ASSERT(timeseries::isCompressedBucket(*compressed));
+    ASSERT_FALSE(timeseries::isCompressedBucket(bucket));
+    ASSERT_LT(compressed->objsize(), bucket.objsize());
+
+    auto decompressed = timeseries::decompressBucket(*compressed);
+    ASSERT_FALSE(timeseries::isCompressedBucket(decompressed));
+    ASSERT_BSONOBJ_BINARY_EQ(decompressed, bucket);
+}
+
+TEST(BucketCompressionTest, RoundTripsBucket) {
+    assertRoundTrips(makeBucket(1000));
+}
+
+TEST(BucketCompressionTest, CompressesRegularColumns) {
+    auto bucket = makeBucket(1000);
+    auto compressed = timeseries::compressBucket(bucket);
+    ASSERT(compressed);
+
+    // The time and constant columns collapse into a handful of bytes each.
+    auto data = compressed->getObjectField(timeseries::kBucketDataFieldName);
+    int length = 0;
+    data["time"].binData(length);
+    ASSERT_LT(length, 32);
+    data["a"].binData(length);
+    ASSERT_LT(length, 32);
+    ASSERT_LT(compressed->objsize(), bucket.objsize() / 4);
+}
+
+TEST(BucketCompressionTest, RoundTripsMixedTypes) {
+    assertRoundTrips(fromjson(
+        "{_id: 1, control: {version: 1, min: {a: 1}, max: {a: 'z'}}, data: {"
+        "a: {'0': 1, '1': 2, '2': 3, '3': {$numberLong: '4'}, '4': 5.0, '5': 5.5, '6': -0.0, "
+        "'7': 0.0, '8': 'z', '9': 'z', '10': null, '11': {x: 1}, '12': [1, 2], '13': 13, "
+        "'14': {$numberLong: '9223372036854775807'}, '15': {$numberLong: '-9223372036854775808'}, "
+        "'16': {$numberLong: '9223372036854775807'}, '17': {$date: 0}, '18': {$date: 1000}, "
+        "'19': {$timestamp: {t: 1, i: 1}}, '20': {$timestamp: {t: 1, i: 2}}, '21': 21, '22': 22, "
+        "'23': 23, '24': 24, '25': 25}}}"));
+}
+
+TEST(BucketCompressionTest, RoundTripsSparseColumns) {
+    assertRoundTrips(fromjson(
+        "{_id: 1, control: {version: 1}, data: {"
+        "time: {'0': 0, '1': 1, '2': 2, '3': 3, '4': 4, '5': 5, '6': 6, '7': 7, '8': 8, '9': 9, "
+        "'10': 10, '11': 11}, "
+        "a: {'2': 1, '3': 1, '7': 1, '11': 1}, b: {'11': 'last'}, "
+        "c: {'0': 0, '5': 5, '10': 10}}}"));
+}
+
+TEST(BucketCompressionTest, DoesNotCompressCompressedBucket) {
+    auto compressed = timeseries::compressBucket(makeBucket(10));
+    ASSERT(compressed);
+    ASSERT_FALSE(timeseries::compressBucket(*compressed));
+}
+
+TEST(BucketCompressionTest, DoesNotCompressNonCanonicalRowKeys) {
+    ASSERT_FALSE(timeseries::compressBucket(fromjson(
+        "{_id: 1, control: {version: 1}, data: {a: {'0': 1, '01': 1, '2': 1, '3': 1}}}")));
+    ASSERT_FALSE(timeseries::compressBucket(
+        fromjson("{_id: 1, control: {version: 1}, data: {a: {'1': 1, '0': 1, '2': 1, '3': 1}}}")));
+}
+
+TEST(BucketCompressionTest, DecompressRejectsUncompressedBucket) {
+    ASSERT_THROWS_CODE(timeseries::decompressBucket(makeBucket(10)), AssertionException, 5843171);
+}
+
+TEST(BucketCompressionTest, DecompressRejectsCorruptColumn) {
+    auto compressed = timeseries::compressBucket(makeBucket(100));
+    ASSERT(compressed);
+
+    // Drop the final byte of the time column.
+    BSONObjBuilder builder;
+    for (auto&& elem : *compressed) {
+        if (elem.fieldNameStringData() != timeseries::kBucketDataFieldName) {
+            builder.append(elem);
+            continue;
+        }
+        BSONObjBuilder data(builder.subobjStart(timeseries::kBucketDataFieldName));
+        for (auto&& column : elem.Obj()) {
+            int length = 0;
+            auto bytes = column.binData(length);
+            data.appendBinData(column.fieldNameStringData(), length - 1, BinDataGeneral, bytes);
+        }
+    }
+    ASSERT_THROWS(timeseries::decompressBucket(builder.obj()), AssertionException);
+}
+
+}  // namespace
+}  // namespace mongo
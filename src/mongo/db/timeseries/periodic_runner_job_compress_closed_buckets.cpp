@@ -0,0 +1,202 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOGV2_DEFAULT_COMPONENT ::mongo::logv2::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/timeseries/periodic_runner_job_compress_closed_buckets.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/ops/write_ops.h"
+#include "mongo/db/ops/write_ops_exec.h"
+#include "mongo/db/server_options.h"
+#include "mongo/db/storage/storage_parameters_gen.h"
+#include "mongo/db/timeseries/bucket_catalog.h"
+#include "mongo/db/timeseries/bucket_compression.h"
+#include "mongo/db/timeseries/timeseries_field_names.h"
+#include "mongo/logv2/log.h"
+#include "mongo/util/periodic_runner.h"
+
+namespace mongo {
+
+namespace {
+
+/**
+ * Replaces the bucket 'closedBucket' with its compressed form, unless the bucket has been removed
+ * or modified since it was closed. Returns false if compression is no longer enabled by the FCV.
+ * Throws if the rewrite fails.
+ */
+bool compressClosedBucket(OperationContext* opCtx,
+                          const BucketCatalog::ClosedBucket& closedBucket) {
+    // Hold the global lock across the check of the FCV and the rewrite, so that a downgrade which
+    // decompresses the buckets after its global lock barrier cannot miss this one.
+    Lock::GlobalLock lk(opCtx, MODE_IX);
+    if (!feature_flags::gTimeseriesBucketCompression.isEnabled(
+            serverGlobalParams.featureCompatibility)) {
+        return false;
+    }
+
+    auto bucketsNs = closedBucket.ns.makeTimeseriesBucketsNamespace();
+    BSONObj bucketDoc;
+    {
+        AutoGetCollectionForRead coll(opCtx, bucketsNs);
+        if (!coll ||
+            !Helpers::findOne(opCtx,
+                              coll.getCollection(),
+                              BSON("_id" << closedBucket.bucketId),
+                              bucketDoc,
+                              true /* requireIndex */)) {
+            return true;
+        }
+        bucketDoc = bucketDoc.getOwned();
+    }
+
+    auto compressed = timeseries::compressBucket(bucketDoc);
+    if (!compressed) {
+        return true;
+    }
+
+    // Only replace the bucket if it has not been modified since it was read.
+    write_ops::UpdateOpEntry update(
+        BSON("_id" << closedBucket.bucketId << timeseries::kBucketControlFieldName
+                   << bucketDoc[timeseries::kBucketControlFieldName].Obj()),
+        write_ops::UpdateModification::parseFromClassicUpdate(*compressed));
+    write_ops::UpdateCommandRequest op(bucketsNs, {update});
+
+    // The schema validation configured in the bucket collection is intended for direct operations
+    // by end users and is not applicable here.
+    write_ops::WriteCommandRequestBase base;
+    base.setBypassDocumentValidation(true);
+    op.setWriteCommandRequestBase(std::move(base));
+
+    auto result = write_ops_exec::performUpdates(opCtx, op, OperationSource::kTimeseries);
+    invariant(result.results.size() == 1,
+              str::stream() << "Unexpected number of results (" << result.results.size()
+                            << ") for update of time-series bucket " << closedBucket.bucketId);
+    const auto& updateResult = uassertStatusOK(result.results.front());
+    if (updateResult.getNModified() == 0) {
+        LOGV2_DEBUG(5640104,
+                    2,
+                    "Time-series bucket was modified or removed before it could be compressed",
+                    "bucketId"_attr = closedBucket.bucketId,
+                    "namespace"_attr = closedBucket.ns);
+    }
+    return true;
+}
+
+/**
+ * Compresses the buckets closed since the last run. Compression is best-effort: a bucket which
+ * cannot be read or rewritten is left uncompressed, which readers handle transparently.
+ */
+void compressClosedBuckets(OperationContext* opCtx) {
+    if (!feature_flags::gTimeseriesBucketCompression.isEnabled(
+            serverGlobalParams.featureCompatibility)) {
+        return;
+    }
+
+    for (auto&& closedBucket : BucketCatalog::get(opCtx).takeClosedBuckets()) {
+        try {
+            if (!compressClosedBucket(opCtx, closedBucket)) {
+                return;
+            }
+        } catch (const ExceptionForCat<ErrorCategory::Interruption>&) {
+            throw;
+        } catch (const ExceptionForCat<ErrorCategory::NotPrimaryError>&) {
+            // The buckets can only be rewritten on the primary, which will also have closed them.
+            return;
+        } catch (const DBException& ex) {
+            LOGV2_DEBUG(5640100,
+                        2,
+                        "Failed to compress time-series bucket",
+                        "bucketId"_attr = closedBucket.bucketId,
+                        "namespace"_attr = closedBucket.ns,
+                        "error"_attr = ex.toStatus());
+        }
+    }
+}
+
+}  // namespace
+
+auto PeriodicThreadToCompressClosedBuckets::get(ServiceContext* serviceContext)
+    -> PeriodicThreadToCompressClosedBuckets& {
+    auto& jobContainer = _serviceDecoration(serviceContext);
+    jobContainer._init(serviceContext);
+
+    return jobContainer;
+}
+
+auto PeriodicThreadToCompressClosedBuckets::operator*() const noexcept -> PeriodicJobAnchor& {
+    stdx::lock_guard lk(_mutex);
+    return *_anchor;
+}
+
+auto PeriodicThreadToCompressClosedBuckets::operator-> () const noexcept -> PeriodicJobAnchor* {
+    stdx::lock_guard lk(_mutex);
+    return _anchor.get();
+}
+
+void PeriodicThreadToCompressClosedBuckets::_init(ServiceContext* serviceContext) {
+    stdx::lock_guard lk(_mutex);
+    if (_anchor) {
+        return;
+    }
+
+    auto periodicRunner = serviceContext->getPeriodicRunner();
+    invariant(periodicRunner);
+
+    PeriodicRunner::PeriodicJob job(
+        "compressClosedTimeseriesBuckets",
+        [](Client* client) {
+            {
+                stdx::lock_guard<Client> lk(*client);
+                client->setSystemOperationKillableByStepdown(lk);
+            }
+
+            // The opCtx destructor handles unsetting itself from the Client. (The PeriodicRunner's
+            // Client must be reset before returning.)
+            auto opCtx = client->makeOperationContext();
+
+            try {
+                compressClosedBuckets(opCtx.get());
+            } catch (ExceptionForCat<ErrorCategory::Interruption>& ex) {
+                // The remaining buckets of this run are left uncompressed.
+                LOGV2_DEBUG(5640101, 2, "Periodic job interrupted", "reason"_attr = ex.reason());
+            }
+        },
+        Seconds(1));
+
+    _anchor = std::make_shared<PeriodicJobAnchor>(periodicRunner->makeJob(std::move(job)));
+}
+
+}  // namespace mongo
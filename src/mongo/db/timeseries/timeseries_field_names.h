@@ -39,6 +39,7 @@ static constexpr StringData kBucketIdFieldName = "_id"_sd;
 static constexpr StringData kBucketDataFieldName = "data"_sd;
 static constexpr StringData kBucketMetaFieldName = "meta"_sd;
 static constexpr StringData kBucketControlFieldName = "control"_sd;
+static constexpr StringData kBucketControlVersionFieldName = "version"_sd;
 static constexpr StringData kControlMaxFieldNamePrefix = "control.max."_sd;
 static constexpr StringData kControlMinFieldNamePrefix = "control.min."_sd;
 
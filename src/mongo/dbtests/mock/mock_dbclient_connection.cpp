@@ -137,6 +137,26 @@ std::unique_ptr<mongo::DBClientCursor> MockDBClientConnection::query(
             provideResumeToken = true;
         }
 
+        // A simple mock implementation of index bounds, where we drop the documents that fall
+        // outside of the inclusive '$min' and exclusive '$max' keys.
+        if (queryBson.hasField("$min") || queryBson.hasField("$max")) {
+            auto compareToBound = [](const BSONObj& doc, const BSONElement& bound) {
+                return doc.extractFieldsUndotted(bound.Obj()).woCompare(bound.Obj(), {}, false);
+            };
+            auto min = queryBson["$min"];
+            auto max = queryBson["$max"];
+            BSONArrayBuilder builder;
+            for (auto&& elem : result) {
+                auto doc = elem.Obj();
+                if ((min.isABSONObj() && compareToBound(doc, min) < 0) ||
+                    (max.isABSONObj() && compareToBound(doc, max) >= 0)) {
+                    continue;
+                }
+                builder.append(doc);
+            }
+            result = BSONArray(builder.obj());
+        }
+
         // Resume query.
         if (nToSkip != 0) {
             BSONObjIterator iter(result);
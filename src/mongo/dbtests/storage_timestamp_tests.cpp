@@ -815,6 +815,106 @@ public:
     }
 };
 
+class SecondaryArrayInsertIndexKeyTimes : public StorageTimestampTest {
+public:
+    void run() {
+        // In order for oplog application to assign timestamps, we must be in non-replicated mode
+        // and disable document validation.
+        repl::UnreplicatedWritesBlock uwb(_opCtx);
+        DisableDocumentValidation validationDisabler(_opCtx);
+
+        // Create a new collection.
+        NamespaceString nss("unittests.timestampedIndexKeys");
+        reset(nss);
+
+        auto indexName = "a_1";
+        auto indexSpec = BSON("name" << indexName << "key" << BSON("a" << 1) << "v"
+                                     << static_cast<int>(kIndexVersion));
+        ASSERT_OK(dbtests::createIndexFromSpec(_opCtx, nss.ns(), indexSpec));
+
+        AutoGetCollection autoColl(_opCtx, nss, LockMode::MODE_IX);
+
+        // The index keys are generated in the reverse order of the documents, so inserting them in
+        // key order moves the write timestamp backwards and forwards across the batch.
+        const std::int32_t docsToInsert = 10;
+        const LogicalTime firstInsertTime = _clock->tickClusterTime(docsToInsert);
+
+        std::vector<repl::OplogEntry> oplogEntries;
+        oplogEntries.reserve(docsToInsert);
+        std::vector<const repl::OplogEntry*> opPtrs;
+        for (std::int32_t idx = 0; idx < docsToInsert; ++idx) {
+            oplogEntries.push_back(repl::OplogEntry(
+                BSON("ts" << firstInsertTime.addTicks(idx).asTimestamp() << "t" << 1LL << "v" << 2
+                          << "op"
+                          << "i"
+                          << "ns" << nss.ns() << "ui" << autoColl.getCollection()->uuid()
+                          << "wall" << Date_t() << "o"
+                          << BSON("_id" << idx << "a" << docsToInsert - idx))));
+            opPtrs.push_back(&(oplogEntries.back()));
+        }
+
+        repl::OplogEntryOrGroupedInserts groupedInserts(opPtrs.cbegin(), opPtrs.cend());
+        ASSERT_OK(repl::applyOplogEntryOrGroupedInserts(
+            _opCtx, groupedInserts, repl::OplogApplication::Mode::kSecondary));
+
+        auto indexDescriptor =
+            autoColl.getCollection()->getIndexCatalog()->findIndexByName(_opCtx, indexName);
+        const IndexAccessMethod* indexAccessMethod =
+            autoColl.getCollection()->getIndexCatalog()->getEntry(indexDescriptor)->accessMethod();
+
+        // Each document's key must become visible at that document's timestamp and no earlier.
+        for (std::int32_t idx = 0; idx < docsToInsert; ++idx) {
+            OneOffRead oor(_opCtx, firstInsertTime.addTicks(idx).asTimestamp());
+            ASSERT_EQ(idx + 1, indexAccessMethod->getSortedDataInterface()->numEntries(_opCtx))
+                << " idx is " << idx;
+        }
+    }
+};
+
+class MixedTimestampBatchIndexInsert : public StorageTimestampTest {
+public:
+    void run() {
+        repl::UnreplicatedWritesBlock uwb(_opCtx);
+
+        // Create a new collection.
+        NamespaceString nss("unittests.mixedTimestampBatchIndexInsert");
+        reset(nss);
+
+        auto indexName = "a_1";
+        auto indexSpec = BSON("name" << indexName << "key" << BSON("a" << 1) << "v"
+                                     << static_cast<int>(kIndexVersion));
+        ASSERT_OK(dbtests::createIndexFromSpec(_opCtx, nss.ns(), indexSpec));
+
+        AutoGetCollection autoColl(_opCtx, nss, LockMode::MODE_IX);
+        const CollectionPtr& coll = autoColl.getCollection();
+        const Timestamp insertTime = _clock->tickClusterTime(1).asTimestamp();
+
+        // Only the first and last documents of the batch carry a timestamp.
+        const std::vector<BSONObj> docs{BSON("_id" << 1 << "a" << 3),
+                                        BSON("_id" << 2 << "a" << 2),
+                                        BSON("_id" << 3 << "a" << 1)};
+        std::vector<BsonRecord> bsonRecords{{RecordId(1), insertTime, &docs[0]},
+                                            {RecordId(2), Timestamp(), &docs[1]},
+                                            {RecordId(3), insertTime, &docs[2]}};
+
+        auto indexDescriptor = coll->getIndexCatalog()->findIndexByName(_opCtx, indexName);
+        auto iam = const_cast<IndexAccessMethod*>(
+            coll->getIndexCatalog()->getEntry(indexDescriptor)->accessMethod());
+
+        {
+            WriteUnitOfWork wuow(_opCtx);
+            InsertDeleteOptions options;
+            options.dupsAllowed = true;
+            int64_t numInserted = 0;
+            ASSERT_OK(iam->insert(_opCtx, coll, bsonRecords, options, &numInserted));
+            ASSERT_EQ(3, numInserted);
+            wuow.commit();
+        }
+
+        ASSERT_EQ(3, iam->getSortedDataInterface()->numEntries(_opCtx));
+    }
+};
+
 class SecondaryDeleteTimes : public StorageTimestampTest {
 public:
     void run() {
@@ -4186,6 +4286,8 @@ public:
     void setupTests() {
         addIf<SecondaryInsertTimes>();
         addIf<SecondaryArrayInsertTimes>();
+        addIf<SecondaryArrayInsertIndexKeyTimes>();
+        addIf<MixedTimestampBatchIndexInsert>();
         addIf<SecondaryDeleteTimes>();
         addIf<SecondaryUpdateTimes>();
         addIf<SecondaryInsertToUpsert>();
@@ -115,12 +115,66 @@ std::vector<std::shared_ptr<ChunkInfo>> flatten(const std::vector<ChunkType>& ch
 
 ShardVersionMap ChunkMap::constructShardVersionMap() const {
     ShardVersionMap shardVersions;
-    ChunkVector::const_iterator current = _chunkMap.cbegin();
+    const ChunkBlock* previousBlock = nullptr;
+
+    for (const auto& block : _chunkBlocks) {
+        boost::optional<ChunkBlockSummary> unsealedSummary;
+        if (!block->summary) {
+            unsealedSummary = _summarize(*block);
+        }
+        const auto& summary = block->summary ? *block->summary : *unsealedSummary;
+
+        // Bounds which are not binary equal may still compare equal, so let the walk over all the
+        // chunks decide whether there really is a gap or an overlap.
+        if (!summary.contiguous ||
+            (previousBlock &&
+             !previousBlock->chunks.back()->getMax().binaryEqual(
+                 block->chunks.front()->getMin()))) {
+            return _constructShardVersionMapFromAllChunks();
+        }
+
+        for (const auto& [shardId, version] : summary.shardVersions) {
+            auto shardVersionIt = shardVersions.find(shardId);
+            if (shardVersionIt == shardVersions.end()) {
+                shardVersionIt = shardVersions
+                                     .emplace(std::piecewise_construct,
+                                              std::forward_as_tuple(shardId),
+                                              std::forward_as_tuple(
+                                                  _collectionVersion.epoch(),
+                                                  _collectionVersion.getTimestamp()))
+                                     .first;
+            }
+
+            auto& maxShardVersion = shardVersionIt->second.shardVersion;
+            if (maxShardVersion.isOlderThan(version))
+                maxShardVersion = version;
+
+            // If a shard has chunks it must have a shard version, otherwise we have an invalid
+            // chunk somewhere, which should have been caught at chunk load time
+            invariant(maxShardVersion.isSet());
+        }
+
+        previousBlock = block.get();
+    }
+
+    if (!_chunkBlocks.empty()) {
+        invariant(!shardVersions.empty());
+
+        checkAllElementsAreOfType(MinKey, _chunkBlocks.front()->chunks.front()->getMin());
+        checkAllElementsAreOfType(MaxKey, _back()->getMax());
+    }
+
+    return shardVersions;
+}
+
+ShardVersionMap ChunkMap::_constructShardVersionMapFromAllChunks() const {
+    ShardVersionMap shardVersions;
+    auto current = _begin();
 
     boost::optional<BSONObj> firstMin = boost::none;
     boost::optional<BSONObj> lastMax = boost::none;
 
-    while (current != _chunkMap.cend()) {
+    while (current != _end()) {
         const auto& firstChunkInRange = *current;
         const auto& currentRangeShardId = firstChunkInRange->getShardIdAt(boost::none);
 
@@ -136,21 +190,21 @@ ShardVersionMap ChunkMap::constructShardVersionMap() const {
         }
 
         auto& maxShardVersion = shardVersionIt->second.shardVersion;
+        std::shared_ptr<ChunkInfo> rangeLast;
 
-        current =
-            std::find_if(current,
-                         _chunkMap.cend(),
-                         [&currentRangeShardId, &maxShardVersion](const auto& currentChunk) {
-                             if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
-                                 return true;
-
-                             if (maxShardVersion.isOlderThan(currentChunk->getLastmod()))
-                                 maxShardVersion = currentChunk->getLastmod();
+        current = std::find_if(
+            current,
+            _end(),
+            [&currentRangeShardId, &maxShardVersion, &rangeLast](const auto& currentChunk) {
+                if (currentChunk->getShardIdAt(boost::none) != currentRangeShardId)
+                    return true;
 
-                             return false;
-                         });
+                if (maxShardVersion.isOlderThan(currentChunk->getLastmod()))
+                    maxShardVersion = currentChunk->getLastmod();
 
-        const auto rangeLast = *std::prev(current);
+                rangeLast = currentChunk;
+                return false;
+            });
 
         const auto& rangeMin = firstChunkInRange->getMin();
         const auto& rangeMax = rangeLast->getMax();
@@ -179,7 +233,7 @@ ShardVersionMap ChunkMap::constructShardVersionMap() const {
         invariant(maxShardVersion.isSet());
     }
 
-    if (!_chunkMap.empty()) {
+    if (!_chunkBlocks.empty()) {
         invariant(!shardVersions.empty());
         invariant(firstMin.is_initialized());
         invariant(lastMax.is_initialized());
@@ -191,22 +245,124 @@ ShardVersionMap ChunkMap::constructShardVersionMap() const {
     return shardVersions;
 }
 
+ChunkMap::ChunkBlockSummary ChunkMap::_summarize(const ChunkBlock& block) {
+    ChunkBlockSummary summary;
+    stdx::unordered_map<ShardId, ChunkVersion, ShardId::Hasher> shardVersions;
+
+    const ChunkInfo* previousChunk = nullptr;
+    ChunkVersion* maxShardVersion = nullptr;
+    for (const auto& chunk : block.chunks) {
+        const auto& shardId = chunk->getShardIdAt(boost::none);
+        if (!previousChunk || previousChunk->getShardIdAt(boost::none) != shardId) {
+            maxShardVersion = &shardVersions.emplace(shardId, chunk->getLastmod()).first->second;
+        }
+
+        if (maxShardVersion->isOlderThan(chunk->getLastmod()))
+            *maxShardVersion = chunk->getLastmod();
+
+        if (previousChunk && !previousChunk->getMax().binaryEqual(chunk->getMin()))
+            summary.contiguous = false;
+
+        previousChunk = chunk.get();
+    }
+
+    summary.shardVersions.assign(shardVersions.begin(), shardVersions.end());
+    return summary;
+}
+
+void ChunkMap::_sealLastBlock() {
+    if (!_chunkBlocks.empty() && !_chunkBlocks.back()->summary) {
+        _chunkBlocks.back()->summary = _summarize(*_chunkBlocks.back());
+    }
+}
+
 void ChunkMap::appendChunk(const std::shared_ptr<ChunkInfo>& chunk) {
-    appendChunkTo(_chunkMap, chunk);
+    if (!_chunkBlocks.empty() && chunk->getRange().overlaps(_back()->getRange())) {
+        if (_back()->getLastmod().isOlderThan(chunk->getLastmod())) {
+            // Sealed blocks may be shared with other maps, so copy the block before replacing its
+            // last chunk.
+            if (_chunkBlocks.back()->summary) {
+                auto block = std::make_shared<ChunkBlock>();
+                block->chunks = _chunkBlocks.back()->chunks;
+                block->maxKeyStrings = _chunkBlocks.back()->maxKeyStrings;
+                _chunkBlocks.back() = std::move(block);
+            }
+            _chunkBlocks.back()->chunks.back() = chunk;
+            _chunkBlocks.back()->maxKeyStrings.back() = chunk->getMaxKeyString();
+            _blockMaxKeyStrings.back() = chunk->getMaxKeyString();
+        }
+    } else {
+        if (_chunkBlocks.empty() || _chunkBlocks.back()->summary ||
+            _chunkBlocks.back()->chunks.size() >= kMaxChunksPerBlock) {
+            _sealLastBlock();
+            _chunkBlocks.push_back(std::make_shared<ChunkBlock>());
+            _chunkBlocks.back()->chunks.reserve(kMaxChunksPerBlock);
+            _chunkBlocks.back()->maxKeyStrings.reserve(kMaxChunksPerBlock);
+            _blockMaxKeyStrings.emplace_back();
+        }
+        _chunkBlocks.back()->chunks.push_back(chunk);
+        _chunkBlocks.back()->maxKeyStrings.push_back(chunk->getMaxKeyString());
+        _blockMaxKeyStrings.back() = chunk->getMaxKeyString();
+        ++_size;
+    }
 
     if (_collectionVersion.isOlderThan(chunk->getLastmod()))
         _collectionVersion = chunk->getLastmod();
 }
 
+void ChunkMap::_appendBlock(const std::shared_ptr<ChunkBlock>& block) {
+    invariant(block->summary);
+    _sealLastBlock();
+    _chunkBlocks.push_back(block);
+    _blockMaxKeyStrings.push_back(block->maxKeyStrings.back());
+    _size += block->chunks.size();
+
+    for (const auto& [shardId, version] : block->summary->shardVersions) {
+        if (_collectionVersion.isOlderThan(version))
+            _collectionVersion = version;
+    }
+}
+
 std::shared_ptr<ChunkInfo> ChunkMap::findIntersectingChunk(const BSONObj& shardKey) const {
     const auto it = _findIntersectingChunk(shardKey);
 
-    if (it != _chunkMap.end())
+    if (it != _end())
         return *it;
 
     return std::shared_ptr<ChunkInfo>();
 }
 
+std::shared_ptr<ChunkInfo> ChunkMap::findContainingChunk(const std::string& shardKeyString) const {
+    const auto it = _findIntersectingChunk(shardKeyString, true /* isMaxInclusive */);
+    if (it == _end())
+        return std::shared_ptr<ChunkInfo>();
+
+    // The lookup guarantees that the shard key sorts before the max of the chunk, so it remains to
+    // check that it does not sort before its min. That min is normally the max of the previous
+    // chunk, whose key string is already known.
+    const auto& chunk = *it;
+    const auto& block = *_chunkBlocks[it._blockIndex];
+    const ChunkBlock* previousBlock = nullptr;
+    size_t previousIndex = 0;
+    if (it._chunkIndex > 0) {
+        previousBlock = &block;
+        previousIndex = it._chunkIndex - 1;
+    } else if (it._blockIndex > 0) {
+        previousBlock = _chunkBlocks[it._blockIndex - 1].get();
+        previousIndex = previousBlock->chunks.size() - 1;
+    }
+
+    if (previousBlock &&
+        previousBlock->chunks[previousIndex]->getMax().binaryEqual(chunk->getMin())) {
+        if (shardKeyString < previousBlock->maxKeyStrings[previousIndex])
+            return std::shared_ptr<ChunkInfo>();
+    } else if (shardKeyString < ShardKeyPattern::toKeyString(chunk->getMin())) {
+        return std::shared_ptr<ChunkInfo>();
+    }
+
+    return chunk;
+}
+
 void validateChunk(const std::shared_ptr<ChunkInfo>& chunk, const ChunkVersion& version) {
     uassert(ErrorCodes::ConflictingOperationInProgress,
             str::stream() << "Changed chunk " << chunk->toString()
@@ -218,41 +374,60 @@ void validateChunk(const std::shared_ptr<ChunkInfo>& chunk, const ChunkVersion&
 
 ChunkMap ChunkMap::createMerged(
     const std::vector<std::shared_ptr<ChunkInfo>>& changedChunks) const {
-    size_t chunkMapIndex = 0;
     size_t changedChunkIndex = 0;
 
     ChunkMap updatedChunkMap(
-        getVersion().epoch(), getVersion().getTimestamp(), _chunkMap.size() + changedChunks.size());
-
-    while (chunkMapIndex < _chunkMap.size() || changedChunkIndex < changedChunks.size()) {
-        if (chunkMapIndex >= _chunkMap.size()) {
-            validateChunk(changedChunks[changedChunkIndex], getVersion());
-            updatedChunkMap.appendChunk(changedChunks[changedChunkIndex++]);
+        getVersion().epoch(), getVersion().getTimestamp(), _size + changedChunks.size());
+
+    for (const auto& block : _chunkBlocks) {
+        const auto& chunks = block->chunks;
+
+        // A sealed block can be shared as a whole if neither the next changed chunk nor the last
+        // chunk of the merged map overlaps it, since the chunks of the block would then all be
+        // appended unchanged.
+        const auto overlapsBlock = [&](const ChunkInfo& chunk) {
+            return chunk.getMin().woCompare(chunks.back()->getMax()) < 0 &&
+                chunk.getMax().woCompare(chunks.front()->getMin()) > 0;
+        };
+        if (block->summary && chunks.size() >= kMinChunksPerSharedBlock &&
+            (changedChunkIndex >= changedChunks.size() ||
+             !overlapsBlock(*changedChunks[changedChunkIndex])) &&
+            (updatedChunkMap._chunkBlocks.empty() || !overlapsBlock(*updatedChunkMap._back()))) {
+            updatedChunkMap._appendBlock(block);
             continue;
         }
 
-        if (changedChunkIndex >= changedChunks.size()) {
-            updatedChunkMap.appendChunk(_chunkMap[chunkMapIndex++]);
-            continue;
-        }
+        size_t chunkIndex = 0;
+        while (chunkIndex < chunks.size()) {
+            if (changedChunkIndex >= changedChunks.size()) {
+                updatedChunkMap.appendChunk(chunks[chunkIndex++]);
+                continue;
+            }
 
-        auto overlap = _chunkMap[chunkMapIndex]->getRange().overlaps(
-            changedChunks[changedChunkIndex]->getRange());
+            auto overlap = chunks[chunkIndex]->getRange().overlaps(
+                changedChunks[changedChunkIndex]->getRange());
 
-        if (overlap) {
-            auto& changedChunk = changedChunks[changedChunkIndex++];
-            auto& chunkInfo = _chunkMap[chunkMapIndex];
+            if (overlap) {
+                auto& changedChunk = changedChunks[changedChunkIndex++];
+                auto& chunkInfo = chunks[chunkIndex];
 
-            auto bytesInReplacedChunk = chunkInfo->getWritesTracker()->getBytesWritten();
-            changedChunk->getWritesTracker()->addBytesWritten(bytesInReplacedChunk);
+                auto bytesInReplacedChunk = chunkInfo->getWritesTracker()->getBytesWritten();
+                changedChunk->getWritesTracker()->addBytesWritten(bytesInReplacedChunk);
 
-            validateChunk(changedChunk, getVersion());
-            updatedChunkMap.appendChunk(changedChunk);
-        } else {
-            updatedChunkMap.appendChunk(_chunkMap[chunkMapIndex++]);
+                validateChunk(changedChunk, getVersion());
+                updatedChunkMap.appendChunk(changedChunk);
+            } else {
+                updatedChunkMap.appendChunk(chunks[chunkIndex++]);
+            }
         }
     }
 
+    while (changedChunkIndex < changedChunks.size()) {
+        validateChunk(changedChunks[changedChunkIndex], getVersion());
+        updatedChunkMap.appendChunk(changedChunks[changedChunkIndex++]);
+    }
+
+    updatedChunkMap._sealLastBlock();
     return updatedChunkMap;
 }
 
@@ -260,45 +435,50 @@ BSONObj ChunkMap::toBSON() const {
     BSONObjBuilder builder;
 
     builder.append("startingVersion"_sd, getVersion().toBSON());
-    builder.append("chunkCount", static_cast<int64_t>(_chunkMap.size()));
+    builder.append("chunkCount", static_cast<int64_t>(_size));
 
     {
         BSONArrayBuilder arrayBuilder(builder.subarrayStart("chunks"_sd));
-        for (const auto& chunk : _chunkMap) {
-            arrayBuilder.append(chunk->toString());
+        for (auto it = _begin(); it != _end(); ++it) {
+            arrayBuilder.append((*it)->toString());
         }
     }
 
     return builder.obj();
 }
 
-ChunkMap::ChunkVector::const_iterator ChunkMap::_findIntersectingChunk(const BSONObj& shardKey,
-                                                                       bool isMaxInclusive) const {
-    auto shardKeyString = ShardKeyPattern::toKeyString(shardKey);
+ChunkMap::ConstIterator ChunkMap::_findIntersectingChunk(const BSONObj& shardKey,
+                                                         bool isMaxInclusive) const {
+    return _findIntersectingChunk(ShardKeyPattern::toKeyString(shardKey), isMaxInclusive);
+}
 
-    if (!isMaxInclusive) {
-        return std::lower_bound(_chunkMap.begin(),
-                                _chunkMap.end(),
-                                shardKey,
-                                [&shardKeyString](const auto& chunkInfo, const BSONObj& shardKey) {
-                                    return chunkInfo->getMaxKeyString() < shardKeyString;
-                                });
-    } else {
-        return std::upper_bound(_chunkMap.begin(),
-                                _chunkMap.end(),
-                                shardKey,
-                                [&shardKeyString](const BSONObj& shardKey, const auto& chunkInfo) {
-                                    return shardKeyString < chunkInfo->getMaxKeyString();
-                                });
+ChunkMap::ConstIterator ChunkMap::_findIntersectingChunk(const std::string& shardKeyString,
+                                                         bool isMaxInclusive) const {
+    // Chunks are ordered by max key, so the chunks which end before the shard key form a prefix of
+    // the map, both across blocks and within a block.
+    const auto endsBeforeShardKey = [&](const std::string& maxKeyString) {
+        return isMaxInclusive ? !(shardKeyString < maxKeyString) : maxKeyString < shardKeyString;
+    };
+
+    const auto blockIt = std::partition_point(
+        _blockMaxKeyStrings.begin(), _blockMaxKeyStrings.end(), endsBeforeShardKey);
+    if (blockIt == _blockMaxKeyStrings.end()) {
+        return _end();
     }
+
+    const auto blockIndex = static_cast<size_t>(blockIt - _blockMaxKeyStrings.begin());
+    const auto& maxKeyStrings = _chunkBlocks[blockIndex]->maxKeyStrings;
+    const auto chunkIt =
+        std::partition_point(maxKeyStrings.begin(), maxKeyStrings.end(), endsBeforeShardKey);
+    return {&_chunkBlocks, blockIndex, static_cast<size_t>(chunkIt - maxKeyStrings.begin())};
 }
 
-std::pair<ChunkMap::ChunkVector::const_iterator, ChunkMap::ChunkVector::const_iterator>
-ChunkMap::_overlappingBounds(const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const {
+std::pair<ChunkMap::ConstIterator, ChunkMap::ConstIterator> ChunkMap::_overlappingBounds(
+    const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const {
     const auto itMin = _findIntersectingChunk(min);
     const auto itMax = [&]() {
         auto it = _findIntersectingChunk(max, isMaxInclusive);
-        return it == _chunkMap.end() ? it : ++it;
+        return it == _end() ? it : ++it;
     }();
 
     return {itMin, itMax};
@@ -369,6 +549,15 @@ Chunk ChunkManager::findIntersectingChunk(const BSONObj& shardKey, const BSONObj
     return Chunk(*chunkInfo, _clusterTime);
 }
 
+boost::optional<Chunk> ChunkManager::findContainingChunkWithSimpleCollation(
+    const std::string& shardKeyString) const {
+    auto chunkInfo = _rt->optRt->findContainingChunk(shardKeyString);
+    if (!chunkInfo)
+        return boost::none;
+
+    return Chunk(*chunkInfo, _clusterTime);
+}
+
 bool ChunkManager::keyBelongsToShard(const BSONObj& shardKey, const ShardId& shardId) const {
     if (shardKey.isEmpty())
         return false;
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <iterator>
 #include <set>
 #include <string>
 #include <vector>
@@ -73,19 +74,98 @@ using ShardVersionMap = stdx::unordered_map<ShardId, ShardVersionTargetingInfo,
  * underlying implementation.
  */
 class ChunkMap {
+    // The last block of a map may still be appended to, so it must not be shared by copying.
+    ChunkMap(const ChunkMap&) = delete;
+    ChunkMap& operator=(const ChunkMap&) = delete;
+
     // Vector of chunks ordered by max key.
     using ChunkVector = std::vector<std::shared_ptr<ChunkInfo>>;
 
+    // Max chunk version of each shard owning chunks in a block, along with whether the chunks of
+    // the block are contiguous.
+    struct ChunkBlockSummary {
+        std::vector<std::pair<ShardId, ChunkVersion>> shardVersions;
+        bool contiguous = true;
+    };
+
+    // A run of consecutive chunks of the map. Once its summary is computed the block is sealed,
+    // after which it is immutable and may be shared between ChunkMap instances.
+    struct ChunkBlock {
+        ChunkVector chunks;
+
+        // The max key strings of 'chunks', stored contiguously for the targeting lookups.
+        std::vector<std::string> maxKeyStrings;
+
+        boost::optional<ChunkBlockSummary> summary;
+    };
+
+    using ChunkBlockVector = std::vector<std::shared_ptr<ChunkBlock>>;
+
+    // Forward iterator over the chunks of a ChunkBlockVector, in ascending order of max key.
+    class ConstIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::shared_ptr<ChunkInfo>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        ConstIterator(const ChunkBlockVector* blocks, size_t blockIndex, size_t chunkIndex)
+            : _blocks(blocks), _blockIndex(blockIndex), _chunkIndex(chunkIndex) {}
+
+        reference operator*() const {
+            return (*_blocks)[_blockIndex]->chunks[_chunkIndex];
+        }
+
+        pointer operator->() const {
+            return &**this;
+        }
+
+        ConstIterator& operator++() {
+            if (++_chunkIndex == (*_blocks)[_blockIndex]->chunks.size()) {
+                ++_blockIndex;
+                _chunkIndex = 0;
+            }
+            return *this;
+        }
+
+        bool operator==(const ConstIterator& other) const {
+            return _blockIndex == other._blockIndex && _chunkIndex == other._chunkIndex;
+        }
+
+        bool operator!=(const ConstIterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class ChunkMap;
+
+        const ChunkBlockVector* _blocks;
+        size_t _blockIndex;
+        size_t _chunkIndex;
+    };
+
 public:
+    ChunkMap(ChunkMap&&) = default;
+    ChunkMap& operator=(ChunkMap&&) = default;
+
+    // Maximum number of chunks held by a single block.
+    static constexpr size_t kMaxChunksPerBlock = 512;
+
+    // Blocks smaller than this are not shared by createMerged(), but copied into the merged map,
+    // so that incremental refreshes do not fragment the map into many small blocks.
+    static constexpr size_t kMinChunksPerSharedBlock = kMaxChunksPerBlock / 4;
+
     explicit ChunkMap(OID epoch,
                       const boost::optional<Timestamp>& timestamp,
                       size_t initialCapacity = 0)
         : _collectionVersion(0, 0, epoch, timestamp) {
-        _chunkMap.reserve(initialCapacity);
+        _chunkBlocks.reserve(initialCapacity / kMaxChunksPerBlock + 1);
+        _blockMaxKeyStrings.reserve(initialCapacity / kMaxChunksPerBlock + 1);
     }
 
     size_t size() const {
-        return _chunkMap.size();
+        return _size;
     }
 
     ChunkVersion getVersion() const {
@@ -94,9 +174,9 @@ public:
 
     template <typename Callable>
     void forEach(Callable&& handler, const BSONObj& shardKey = BSONObj()) const {
-        auto it = shardKey.isEmpty() ? _chunkMap.begin() : _findIntersectingChunk(shardKey);
+        auto it = shardKey.isEmpty() ? _begin() : _findIntersectingChunk(shardKey);
 
-        for (; it != _chunkMap.end(); ++it) {
+        for (; it != _end(); ++it) {
             if (!handler(*it))
                 break;
         }
@@ -118,19 +198,66 @@ public:
     ShardVersionMap constructShardVersionMap() const;
     std::shared_ptr<ChunkInfo> findIntersectingChunk(const BSONObj& shardKey) const;
 
+    /**
+     * Returns the chunk which contains the shard key encoded as 'shardKeyString' by
+     * ShardKeyPattern::toKeyString(), or nullptr if there is no such chunk.
+     */
+    std::shared_ptr<ChunkInfo> findContainingChunk(const std::string& shardKeyString) const;
+
     void appendChunk(const std::shared_ptr<ChunkInfo>& chunk);
 
+    /**
+     * Returns a new map with the chunks in "changedChunks" merged into this one. Sealed blocks of
+     * this map which none of the changed chunks overlap are shared with the new map rather than
+     * copied, so the cost is proportional to the number of blocks and to the size of the blocks
+     * touched by the changes.
+     */
     ChunkMap createMerged(const std::vector<std::shared_ptr<ChunkInfo>>& changedChunks) const;
 
     BSONObj toBSON() const;
 
 private:
-    ChunkVector::const_iterator _findIntersectingChunk(const BSONObj& shardKey,
-                                                       bool isMaxInclusive = true) const;
-    std::pair<ChunkVector::const_iterator, ChunkVector::const_iterator> _overlappingBounds(
-        const BSONObj& min, const BSONObj& max, bool isMaxInclusive) const;
+    ConstIterator _begin() const {
+        return {&_chunkBlocks, 0, 0};
+    }
+
+    ConstIterator _end() const {
+        return {&_chunkBlocks, _chunkBlocks.size(), 0};
+    }
+
+    const std::shared_ptr<ChunkInfo>& _back() const {
+        return _chunkBlocks.back()->chunks.back();
+    }
+
+    ConstIterator _findIntersectingChunk(const BSONObj& shardKey,
+                                         bool isMaxInclusive = true) const;
+    ConstIterator _findIntersectingChunk(const std::string& shardKeyString,
+                                         bool isMaxInclusive) const;
+    std::pair<ConstIterator, ConstIterator> _overlappingBounds(const BSONObj& min,
+                                                               const BSONObj& max,
+                                                               bool isMaxInclusive) const;
 
-    ChunkVector _chunkMap;
+    // Appends the sealed block 'block' to the map as a whole.
+    void _appendBlock(const std::shared_ptr<ChunkBlock>& block);
+
+    // Seals the last block of the map, if it is not sealed yet.
+    void _sealLastBlock();
+
+    // Returns the summary of 'block', computing it if the block is not sealed yet.
+    static ChunkBlockSummary _summarize(const ChunkBlock& block);
+
+    // Builds the shard version map by walking every chunk of the map. Used when the chunks are not
+    // known to be contiguous, in order to report where a gap or an overlap exists.
+    ShardVersionMap _constructShardVersionMapFromAllChunks() const;
+
+    // Never contains empty blocks. All blocks except for the last one are sealed.
+    ChunkBlockVector _chunkBlocks;
+
+    // The max key string of the last chunk of each block in '_chunkBlocks'.
+    std::vector<std::string> _blockMaxKeyStrings;
+
+    // Total number of chunks across '_chunkBlocks'.
+    size_t _size = 0;
 
     // Max version across all chunks
     ChunkVersion _collectionVersion;
@@ -266,6 +393,10 @@ public:
         return _chunkMap.findIntersectingChunk(shardKey);
     }
 
+    std::shared_ptr<ChunkInfo> findContainingChunk(const std::string& shardKeyString) const {
+        return _chunkMap.findContainingChunk(shardKeyString);
+    }
+
     /**
      * Returns the ids of all shards on which the collection has any chunks.
      */
@@ -618,6 +749,14 @@ public:
         return findIntersectingChunk(shardKey, CollationSpec::kSimpleSpec);
     }
 
+    /**
+     * Same as findIntersectingChunkWithSimpleCollation, but takes the shard key encoded by
+     * ShardKeyPattern::toKeyString() and returns boost::none rather than throwing if no chunk
+     * contains the key.
+     */
+    boost::optional<Chunk> findContainingChunkWithSimpleCollation(
+        const std::string& shardKeyString) const;
+
     /**
      * Finds the shard id of the shard that owns the chunk minKey belongs to, assuming the simple
      * collation because shard keys do not support non-simple collations.
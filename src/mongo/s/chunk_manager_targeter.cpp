@@ -358,14 +358,24 @@ ShardEndpoint ChunkManagerTargeter::targetInsert(OperationContext* opCtx,
     BSONObj shardKey;
 
     if (_cm->isSharded()) {
-        shardKey = _cm->getShardKeyPattern().extractShardKeyFromDoc(doc);
-        // The shard key would only be empty after extraction if we encountered an error case, such
-        // as the shard key possessing an array value or array descendants. If the shard key
+        // Encode the shard key straight from the document and look it up by its KeyString, which
+        // avoids building the shard key BSONObj for every inserted document.
+        const auto shardKeyString = _cm->getShardKeyPattern().extractShardKeyStringFromDoc(doc);
+        // The shard key would only be missing after extraction if we encountered an error case,
+        // such as the shard key possessing an array value or array descendants. If the shard key
         // presented to the targeter was empty, we would emplace the missing fields, and the
-        // extracted key here would *not* be empty.
+        // extracted key here would *not* be missing.
         uassert(ErrorCodes::ShardKeyNotFound,
                 "Shard key cannot contain array values or array descendants.",
-                !shardKey.isEmpty());
+                shardKeyString);
+
+        if (auto chunk = _cm->findContainingChunkWithSimpleCollation(*shardKeyString)) {
+            return ShardEndpoint(
+                chunk->getShardId(), _cm->getVersion(chunk->getShardId()), boost::none);
+        }
+
+        // Go through the regular targeting path, which reports the error.
+        shardKey = _cm->getShardKeyPattern().extractShardKeyFromDoc(doc);
     }
 
     // Target the shard key or database primary
@@ -49,6 +49,27 @@ private:
     KeyPattern _shardKeyPattern{BSON("a" << 1)};
 };
 
+/**
+ * Returns 'numChunks' contiguous chunks covering the whole key space, where chunk 'i' has the range
+ * [10 * (i - 1), 10 * i) apart from the first and last chunks, which extend to MinKey and MaxKey.
+ * Runs of 100 consecutive chunks are owned by alternating shards.
+ */
+std::vector<std::shared_ptr<ChunkInfo>> makeChunks(const KeyPattern& shardKeyPattern,
+                                                   const ChunkVersion& version,
+                                                   int numChunks) {
+    std::vector<std::shared_ptr<ChunkInfo>> chunks;
+    for (int i = 0; i < numChunks; ++i) {
+        auto min = i == 0 ? shardKeyPattern.globalMin() : BSON("a" << 10 * (i - 1));
+        auto max = i == numChunks - 1 ? shardKeyPattern.globalMax() : BSON("a" << 10 * i);
+        chunks.push_back(std::make_shared<ChunkInfo>(
+            ChunkType{kNss,
+                      ChunkRange{min, max},
+                      version,
+                      ShardId(str::stream() << "shard" << (i / 100) % 2)}));
+    }
+    return chunks;
+}
+
 }  // namespace
 
 TEST_F(ChunkMapTest, TestAddChunk) {
@@ -165,4 +186,130 @@ TEST_F(ChunkMapTest, TestEnumerateOverlappingChunks) {
     ASSERT_EQ(count, 3);
 }
 
+TEST_F(ChunkMapTest, TestIncrementalMergeAcrossBlocks) {
+    const OID epoch = OID::gen();
+    ChunkVersion version{1, 0, epoch, boost::none /* timestamp */};
+    const int numChunks = 3 * ChunkMap::kMaxChunksPerBlock + 10;
+    auto chunks = makeChunks(getShardKeyPattern(), version, numChunks);
+
+    auto chunkMap = ChunkMap{epoch, boost::none /* timestamp */}.createMerged(chunks);
+    ASSERT_EQ(chunkMap.size(), numChunks);
+
+    // Split a chunk in the middle of the second block and move one half to another shard.
+    const int splitChunk = ChunkMap::kMaxChunksPerBlock + 20;
+    ChunkVersion splitVersion{2, 0, epoch, boost::none /* timestamp */};
+    ChunkVersion movedVersion{2, 1, epoch, boost::none /* timestamp */};
+    const auto& original = chunks[splitChunk];
+    const auto splitPoint = BSON("a" << 10 * (splitChunk - 1) + 5);
+    auto updatedChunkMap = chunkMap.createMerged(
+        {std::make_shared<ChunkInfo>(ChunkType{
+             kNss, ChunkRange{original->getMin(), splitPoint}, splitVersion, ShardId("shard2")}),
+         std::make_shared<ChunkInfo>(ChunkType{kNss,
+                                               ChunkRange{splitPoint, original->getMax()},
+                                               movedVersion,
+                                               original->getShardId()})});
+
+    ASSERT_EQ(updatedChunkMap.size(), numChunks + 1);
+    ASSERT_EQ(updatedChunkMap.getVersion(), movedVersion);
+    ASSERT_EQ(chunkMap.size(), numChunks);
+    ASSERT_EQ(chunkMap.getVersion(), version);
+
+    // The unchanged chunks are the same instances as in the original map, in the same order.
+    int index = 0;
+    auto lastMax = getShardKeyPattern().globalMin();
+    updatedChunkMap.forEach([&](const auto& chunkInfo) {
+        ASSERT_BSONOBJ_EQ(chunkInfo->getMin(), lastMax);
+        lastMax = chunkInfo->getMax();
+
+        if (index < splitChunk) {
+            ASSERT_EQ(chunkInfo, chunks[index]);
+        } else if (index > splitChunk + 1) {
+            ASSERT_EQ(chunkInfo, chunks[index - 1]);
+        }
+        ++index;
+        return true;
+    });
+    ASSERT_EQ(index, numChunks + 1);
+    ASSERT_BSONOBJ_EQ(lastMax, getShardKeyPattern().globalMax());
+
+    ASSERT_EQ(updatedChunkMap.findIntersectingChunk(BSON("a" << 10 * (splitChunk - 1) + 7))
+                  ->getLastmod(),
+              movedVersion);
+    ASSERT_EQ(updatedChunkMap.findIntersectingChunk(BSON("a" << 10 * (splitChunk - 1) + 2))
+                  ->getShardId(),
+              ShardId("shard2"));
+
+    auto shardVersions = updatedChunkMap.constructShardVersionMap();
+    ASSERT_EQ(shardVersions.size(), 3U);
+    ASSERT_EQ(shardVersions.at(ShardId("shard2")).shardVersion, splitVersion);
+    ASSERT_EQ(shardVersions.at(original->getShardId()).shardVersion, movedVersion);
+}
+
+TEST_F(ChunkMapTest, TestFindIntersectingChunkAtBlockBoundaries) {
+    const OID epoch = OID::gen();
+    ChunkVersion version{1, 0, epoch, boost::none /* timestamp */};
+    const int numChunks = 2 * ChunkMap::kMaxChunksPerBlock + 1;
+    auto chunks = makeChunks(getShardKeyPattern(), version, numChunks);
+    auto chunkMap = ChunkMap{epoch, boost::none /* timestamp */}.createMerged(chunks);
+
+    for (int i : {int(ChunkMap::kMaxChunksPerBlock) - 1,
+                  int(ChunkMap::kMaxChunksPerBlock),
+                  int(ChunkMap::kMaxChunksPerBlock) + 1,
+                  2 * int(ChunkMap::kMaxChunksPerBlock)}) {
+        ASSERT_EQ(chunkMap.findIntersectingChunk(chunks[i]->getMin()), chunks[i]);
+    }
+
+    int count = 0;
+    chunkMap.forEachOverlappingChunk(chunks[ChunkMap::kMaxChunksPerBlock - 2]->getMin(),
+                                     chunks[ChunkMap::kMaxChunksPerBlock + 1]->getMin(),
+                                     false,
+                                     [&](const auto& chunk) {
+                                         count++;
+                                         return true;
+                                     });
+    ASSERT_EQ(count, 3);
+}
+
+TEST_F(ChunkMapTest, TestFindContainingChunkByKeyString) {
+    const OID epoch = OID::gen();
+    ChunkVersion version{1, 0, epoch, boost::none /* timestamp */};
+    const int numChunks = 2 * ChunkMap::kMaxChunksPerBlock + 1;
+    auto chunks = makeChunks(getShardKeyPattern(), version, numChunks);
+
+    // Leave a gap in place of the first chunk of the second block.
+    const int missingChunk = ChunkMap::kMaxChunksPerBlock;
+    auto missingRange = chunks[missingChunk]->getRange();
+    chunks.erase(chunks.begin() + missingChunk);
+    auto chunkMap = ChunkMap{epoch, boost::none /* timestamp */}.createMerged(chunks);
+
+    auto findContainingChunk = [&](const BSONObj& shardKey) {
+        return chunkMap.findContainingChunk(ShardKeyPattern::toKeyString(shardKey));
+    };
+
+    ASSERT_EQ(findContainingChunk(BSON("a" << MINKEY)), chunks.front());
+    ASSERT_EQ(findContainingChunk(BSON("a" << -1000)), chunks.front());
+    ASSERT_EQ(findContainingChunk(BSON("a" << 0)), chunks[1]);
+    ASSERT_EQ(findContainingChunk(BSON("a" << 5.5)), chunks[1]);
+    ASSERT_EQ(findContainingChunk(chunks[missingChunk - 1]->getMin()), chunks[missingChunk - 1]);
+    ASSERT_EQ(findContainingChunk(chunks[missingChunk]->getMin()), chunks[missingChunk]);
+    ASSERT_EQ(findContainingChunk(BSON("a" << 1000000)), chunks.back());
+
+    ASSERT_FALSE(findContainingChunk(missingRange.getMin()));
+    ASSERT_FALSE(findContainingChunk(BSON("a" << missingRange.getMin()["a"].numberInt() + 5)));
+}
+
+TEST_F(ChunkMapTest, TestGapBetweenShardRangesIsDetected) {
+    const OID epoch = OID::gen();
+    ChunkVersion version{1, 0, epoch, boost::none /* timestamp */};
+    auto chunks = makeChunks(getShardKeyPattern(), version, 2 * ChunkMap::kMaxChunksPerBlock);
+
+    // Remove the first chunk of a shard range in the second block.
+    chunks.erase(chunks.begin() + 600);
+
+    auto chunkMap = ChunkMap{epoch, boost::none /* timestamp */}.createMerged(chunks);
+    ASSERT_THROWS_CODE(chunkMap.constructShardVersionMap(),
+                       DBException,
+                       ErrorCodes::ConflictingOperationInProgress);
+}
+
 }  // namespace mongo
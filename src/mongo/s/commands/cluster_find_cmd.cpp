@@ -252,6 +252,7 @@ public:
                     options.atClusterTime =
                         repl::ReadConcernArgs::get(opCtx).getArgsAtClusterTime();
                 }
+                reserveReplyBytesForBatch(batch, result);
                 CursorResponseBuilder firstBatch(result, options);
                 for (const auto& obj : batch) {
                     firstBatch.append(obj);
@@ -102,8 +102,9 @@ public:
         void run(OperationContext* opCtx, rpc::ReplyBuilderInterface* reply) override {
             // Counted as a getMore, not as a command.
             globalOpCounters.gotGetMore();
-            auto bob = reply->getBodyBuilder();
             auto response = uassertStatusOK(ClusterFind::runGetMore(opCtx, _cmd));
+            reserveReplyBytesForBatch(response.getBatch(), reply);
+            auto bob = reply->getBodyBuilder();
             response.addToBSON(CursorResponse::ResponseType::SubsequentResponse, &bob);
 
             if (getTestCommandsEnabled()) {
@@ -105,8 +105,7 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
       // since that is not supported we treat boost::none (unspecified) to mean 'kNormal'.
       _tailableMode(params.getTailableMode().value_or(TailableModeEnum::kNormal)),
       _params(std::move(params)),
-      _mergeQueue(MergingComparator(
-          _remotes, _params.getSort().value_or(BSONObj()), _params.getCompareWholeSortKey())),
+      _mergeTree(_params.getSort().value_or(BSONObj())),
       _promisedMinSortKeys(PromisedMinSortKeyComparator(_params.getSort().value_or(BSONObj()))) {
     if (params.getTxnNumber()) {
         invariant(params.getSessionId());
@@ -121,6 +120,7 @@ AsyncResultsMerger::AsyncResultsMerger(OperationContext* opCtx,
 
         // A remote cannot be flagged as 'partialResultsReturned' if 'allowPartialResults' is false.
         invariant(!(_remotes.back().partialResultsReturned && !_params.getAllowPartialResults()));
+        _mergeTree.resize(_remotes.size());
 
         // We don't check the return value of _addBatchToBuffer here; if there was an error,
         // it will be stored in the remote and the first call to ready() will return true.
@@ -219,6 +219,7 @@ void AsyncResultsMerger::addNewShardCursors(std::vector<RemoteCursor>&& newCurso
                               remote.getCursorResponse().getNSS(),
                               remote.getCursorResponse().getCursorId(),
                               remote.getCursorResponse().getPartialResultsReturned());
+        _mergeTree.resize(_remotes.size());
         _addBatchToBuffer(lk, newIndex, remote.getCursorResponse());
     }
 }
@@ -307,12 +308,12 @@ bool AsyncResultsMerger::_readySorted(WithLock lk) {
 }
 
 bool AsyncResultsMerger::_readySortedTailable(WithLock lk) {
-    if (_mergeQueue.empty()) {
+    auto smallestRemote = _mergeTree.top();
+    if (!smallestRemote) {
         return false;
     }
 
-    auto smallestRemote = _mergeQueue.top();
-    auto smallestResult = _remotes[smallestRemote].docBuffer.front();
+    auto smallestResult = _remotes[*smallestRemote].docBuffer.front();
     auto keyWeWantToReturn =
         extractSortKey(*smallestResult.getResult(), _params.getCompareWholeSortKey());
     // We should always have a minPromisedSortKey from every shard in the sorted tailable case.
@@ -359,12 +360,12 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     // Tailable non-awaitData cursors cannot have a sort.
     invariant(_tailableMode != TailableModeEnum::kTailable);
 
-    if (_mergeQueue.empty()) {
+    auto top = _mergeTree.top();
+    if (!top) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    size_t smallestRemote = *top;
 
     invariant(!_remotes[smallestRemote].docBuffer.empty());
     invariant(_remotes[smallestRemote].status.isOK());
@@ -372,10 +373,13 @@ ClusterQueryResult AsyncResultsMerger::_nextReadySorted(WithLock) {
     ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
     _remotes[smallestRemote].docBuffer.pop();
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
+    // Replay the merge tree with the next result from 'smallestRemote', if it has a next result.
     if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
+        _mergeTree.update(smallestRemote,
+                          extractSortKey(*_remotes[smallestRemote].docBuffer.front().getResult(),
+                                         _params.getCompareWholeSortKey()));
+    } else {
+        _mergeTree.remove(smallestRemote);
     }
 
     // For sorted tailable awaitData cursors, update the high water mark to the document's sort key.
@@ -709,6 +713,7 @@ void AsyncResultsMerger::_cleanUpFailedBatch(WithLock lk, Status status, size_t
         remote.partialResultsReturned = (remote.status != ErrorCodes::ExchangePassthrough);
         std::queue<ClusterQueryResult> emptyBuffer;
         std::swap(remote.docBuffer, emptyBuffer);
+        _mergeTree.remove(remoteIndex);
         remote.status = Status::OK();
         remote.cursorId = 0;
     }
@@ -789,9 +794,11 @@ bool AsyncResultsMerger::_addBatchToBuffer(WithLock lk,
     }
 
     // If we're doing a sorted merge, then we have to make sure to put this remote onto the merge
-    // queue.
+    // tree.
     if (_params.getSort() && !response.getBatch().empty()) {
-        _mergeQueue.push(remoteIndex);
+        _mergeTree.update(remoteIndex,
+                          extractSortKey(*remote.docBuffer.front().getResult(),
+                                         _params.getCompareWholeSortKey()));
     }
     return true;
 }
@@ -893,19 +900,6 @@ bool AsyncResultsMerger::RemoteCursorData::exhausted() const {
     return cursorId == 0;
 }
 
-//
-// AsyncResultsMerger::MergingComparator
-//
-
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
-    const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
-    const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
-
-    return compareSortKeys(extractSortKey(*leftDoc.getResult(), _compareWholeSortKey),
-                           extractSortKey(*rightDoc.getResult(), _compareWholeSortKey),
-                           _sort) > 0;
-}
-
 bool AsyncResultsMerger::PromisedMinSortKeyComparator::operator()(
     const MinSortKeyRemoteIdPair& lhs, const MinSortKeyRemoteIdPair& rhs) const {
     auto sortKeyComp = compareSortKeys(lhs.first, rhs.first, _sort);
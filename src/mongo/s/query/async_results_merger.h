@@ -40,6 +40,7 @@
 #include "mongo/platform/mutex.h"
 #include "mongo/s/query/async_results_merger_params_gen.h"
 #include "mongo/s/query/cluster_query_result.h"
+#include "mongo/s/query/sort_key_loser_tree.h"
 #include "mongo/stdx/future.h"
 #include "mongo/util/concurrency/with_lock.h"
 #include "mongo/util/net/hostandport.h"
@@ -318,26 +319,6 @@ private:
         long long fetchedCount = 0;
     };
 
-    class MergingComparator {
-    public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes,
-                          const BSONObj& sort,
-                          bool compareWholeSortKey)
-            : _remotes(remotes), _sort(sort), _compareWholeSortKey(compareWholeSortKey) {}
-
-        bool operator()(const size_t& lhs, const size_t& rhs);
-
-    private:
-        const std::vector<RemoteCursorData>& _remotes;
-
-        const BSONObj _sort;
-
-        // When '_compareWholeSortKey' is true, $sortKey is a scalar value, rather than an object.
-        // We extract the sort key {$sortKey: <value>}. The sort key pattern '_sort' is verified to
-        // be {$sortKey: 1}.
-        const bool _compareWholeSortKey;
-    };
-
     using MinSortKeyRemoteIdPair = std::pair<BSONObj, size_t>;
 
     class PromisedMinSortKeyComparator {
@@ -484,9 +465,10 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // Holds the sort key of the front document buffered for each remote. The top of this tree is
+    // the index into '_remotes' for the remote host that has the next document to return, according
+    // to the sort order. Used only if there is a sort.
+    SortKeyLoserTree _mergeTree;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
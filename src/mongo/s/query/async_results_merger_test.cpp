@@ -440,6 +440,52 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortKeyWithMoreFieldsThanAnOrdering) {
+    // Only the last field, which is descending, differs between the sort keys.
+    const int numFields = Ordering::kMaxCompoundIndexKeys + 1;
+    BSONObjBuilder sortPattern;
+    for (int i = 0; i < numFields; ++i) {
+        sortPattern.append(str::stream() << "f" << i, i == numFields - 1 ? -1 : 1);
+    }
+    auto makeResult = [&](int last) {
+        BSONArrayBuilder sortKey;
+        for (int i = 0; i < numFields - 1; ++i) {
+            sortKey.append(0);
+        }
+        sortKey.append(last);
+        return BSON("$sortKey" << sortKey.arr());
+    };
+
+    BSONObj findCmd = BSON("find"
+                           << "testcoll"
+                           << "sort" << sortPattern.obj());
+    std::vector<RemoteCursor> cursors;
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[0], kTestShardHosts[0], CursorResponse(kTestNss, 5, {})));
+    cursors.push_back(
+        makeRemoteCursor(kTestShardIds[1], kTestShardHosts[1], CursorResponse(kTestNss, 6, {})));
+    auto arm = makeARMFromExistingCursors(std::move(cursors), findCmd);
+
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch1 = {makeResult(9), makeResult(4), makeResult(1)};
+    responses.emplace_back(kTestNss, CursorId(0), batch1);
+    std::vector<BSONObj> batch2 = {makeResult(7), makeResult(5), makeResult(2)};
+    responses.emplace_back(kTestNss, CursorId(0), batch2);
+    scheduleNetworkResponses(std::move(responses));
+    executor()->waitForEvent(readyEvent);
+
+    for (int expected : {9, 7, 5, 4, 2, 1}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(makeResult(expected),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<RemoteCursor> cursors;
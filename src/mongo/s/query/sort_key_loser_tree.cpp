@@ -0,0 +1,187 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/sort_key_loser_tree.h"
+
+#include <algorithm>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+boost::optional<Ordering> makeOrdering(const BSONObj& sortPattern) {
+    if (sortPattern.nFields() > static_cast<int>(Ordering::kMaxCompoundIndexKeys)) {
+        return boost::none;
+    }
+    return Ordering::make(sortPattern);
+}
+
+}  // namespace
+
+SortKeyLoserTree::SortKeyLoserTree(const BSONObj& sortPattern)
+    : _sortPattern(sortPattern.getOwned()), _ordering(makeOrdering(_sortPattern)) {}
+
+void SortKeyLoserTree::resize(size_t numStreams) {
+    invariant(numStreams >= _keys.size());
+    if (numStreams == _keys.size()) {
+        return;
+    }
+
+    _flushPendingRemoval();
+    _keys.reserve(numStreams);
+    _keys.resize(numStreams);
+    _tree.resize(numStreams);
+    _needsRebuild = true;
+}
+
+void SortKeyLoserTree::update(size_t stream, const BSONObj& sortKey) {
+    invariant(stream < _keys.size());
+
+    // A stream whose removal as the winner is still pending occupies the winner's path, so
+    // refilling it can be replayed as a winner update.
+    if (_pendingWinnerRemoval && _tree[0] == stream) {
+        _pendingWinnerRemoval = false;
+    } else {
+        _flushPendingRemoval();
+    }
+
+    auto& streamKey = _keys[stream];
+    if (!_ordering) {
+        streamKey.sortKey = sortKey.getOwned();
+    } else if (streamKey.key) {
+        streamKey.key->resetToKey(sortKey, *_ordering);
+    } else {
+        streamKey.key.emplace(KeyString::Version::kLatestVersion, sortKey, *_ordering);
+    }
+    streamKey.present = true;
+
+    if (!_needsRebuild && _tree[0] == stream) {
+        _replay(stream);
+    } else {
+        _needsRebuild = true;
+    }
+}
+
+void SortKeyLoserTree::remove(size_t stream) {
+    invariant(stream < _keys.size());
+    _flushPendingRemoval();
+
+    auto& streamKey = _keys[stream];
+    if (!streamKey.present) {
+        return;
+    }
+    streamKey.present = false;
+
+    if (!_needsRebuild && _tree[0] == stream) {
+        _pendingWinnerRemoval = true;
+    } else {
+        _needsRebuild = true;
+    }
+}
+
+boost::optional<size_t> SortKeyLoserTree::top() {
+    _flushPendingRemoval();
+    if (_needsRebuild) {
+        _rebuild();
+    }
+
+    if (_keys.empty() || !_keys[_tree[0]].present) {
+        return boost::none;
+    }
+    return _tree[0];
+}
+
+bool SortKeyLoserTree::_beats(size_t lhs, size_t rhs) const {
+    const auto& left = _keys[lhs];
+    const auto& right = _keys[rhs];
+    if (left.present != right.present) {
+        return left.present;
+    }
+    if (left.present) {
+        // Sort keys do not need to be compared with a collator, since mongod has already mapped
+        // strings to their ICU comparison keys as part of the $sortKey meta projection.
+        const int cmp = _ordering
+            ? KeyString::compare(left.key->getBuffer(),
+                                 right.key->getBuffer(),
+                                 left.key->getSize(),
+                                 right.key->getSize())
+            : left.sortKey.woCompare(right.sortKey, _sortPattern, BSONObj::ComparisonRulesSet(0));
+        if (cmp != 0) {
+            return cmp < 0;
+        }
+    }
+    return lhs < rhs;
+}
+
+void SortKeyLoserTree::_replay(size_t stream) {
+    size_t winner = stream;
+    for (size_t node = (_keys.size() + stream) / 2; node > 0; node /= 2) {
+        if (_beats(_tree[node], winner)) {
+            std::swap(_tree[node], winner);
+        }
+    }
+    _tree[0] = winner;
+}
+
+void SortKeyLoserTree::_rebuild() {
+    _needsRebuild = false;
+    if (_keys.empty()) {
+        return;
+    }
+    _tree[0] = _keys.size() == 1 ? 0 : _play(1);
+}
+
+size_t SortKeyLoserTree::_play(size_t node) {
+    const size_t numStreams = _keys.size();
+    auto winnerOf = [&](size_t child) {
+        return child >= numStreams ? child - numStreams : _play(child);
+    };
+
+    size_t winner = winnerOf(2 * node);
+    size_t loser = winnerOf(2 * node + 1);
+    if (_beats(loser, winner)) {
+        std::swap(winner, loser);
+    }
+    _tree[node] = loser;
+    return winner;
+}
+
+void SortKeyLoserTree::_flushPendingRemoval() {
+    if (_pendingWinnerRemoval) {
+        _pendingWinnerRemoval = false;
+        _replay(_tree[0]);
+    }
+}
+
+}  // namespace mongo
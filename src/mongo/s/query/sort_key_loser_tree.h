@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
+#include "mongo/db/storage/key_string.h"
+
+namespace mongo {
+
+/**
+ * A tournament tree of losers used to perform a k-way merge over a set of sorted input streams,
+ * such as the remote cursors of an AsyncResultsMerger. Each stream is identified by its index and
+ * is represented by the sort key of the document at its front, if any.
+ *
+ * Sort keys are encoded once as KeyStrings according to the sort pattern when they are supplied, so
+ * every comparison performed by the tree is a memcmp. Replacing the sort key of the stream which is
+ * currently at the top of the tree, as is done after consuming its front document, costs log(k)
+ * comparisons. Any other change marks the tree for a full rebuild, which costs k comparisons and
+ * is deferred until the next call to top(). Streams with equal sort keys are ordered by index.
+ *
+ * A KeyString Ordering describes at most Ordering::kMaxCompoundIndexKeys fields. The sort keys of
+ * a longer sort pattern are kept as BSON and compared with BSONObj::woCompare() instead.
+ *
+ * Not thread-safe.
+ */
+class SortKeyLoserTree {
+public:
+    /**
+     * Constructs an empty tree which orders sort keys according to 'sortPattern', in the same way
+     * as BSONObj::woCompare() with 'sortPattern' as the key pattern.
+     */
+    explicit SortKeyLoserTree(const BSONObj& sortPattern);
+
+    /**
+     * Grows the tree to 'numStreams' streams. New streams have no front sort key.
+     */
+    void resize(size_t numStreams);
+
+    size_t size() const {
+        return _keys.size();
+    }
+
+    /**
+     * Sets 'sortKey' as the front sort key of the stream 'stream'.
+     */
+    void update(size_t stream, const BSONObj& sortKey);
+
+    /**
+     * Marks the stream 'stream' as having no front sort key.
+     */
+    void remove(size_t stream);
+
+    /**
+     * Returns the index of the stream with the smallest front sort key, or boost::none if no stream
+     * has a front sort key.
+     */
+    boost::optional<size_t> top();
+
+    bool empty() {
+        return !top();
+    }
+
+private:
+    struct StreamKey {
+        // The encoded sort key, if the sort pattern has an Ordering. Otherwise 'sortKey' holds
+        // the sort key itself.
+        boost::optional<KeyString::HeapBuilder> key;
+        BSONObj sortKey;
+        bool present = false;
+    };
+
+    // Returns true if the stream 'lhs' must be returned before the stream 'rhs'.
+    bool _beats(size_t lhs, size_t rhs) const;
+
+    // Replays the matches on the path from the leaf of 'stream' to the root. Only valid when
+    // 'stream' is the winner of the tree.
+    void _replay(size_t stream);
+
+    // Rebuilds all matches bottom-up.
+    void _rebuild();
+
+    // Plays the match at internal node 'node' and returns its winner, recording its loser in
+    // '_tree'. Used only by _rebuild().
+    size_t _play(size_t node);
+
+    // Applies a removal of the winner that was deferred by remove().
+    void _flushPendingRemoval();
+
+    const BSONObj _sortPattern;
+
+    // Unset when '_sortPattern' has too many fields to be described by an Ordering.
+    const boost::optional<Ordering> _ordering;
+
+    std::vector<StreamKey> _keys;
+
+    // '_tree[0]' holds the overall winner, and '_tree[i]' for 0 < i < size() holds the loser of
+    // the match played at internal node 'i'. The leaf of stream 's' is the implicit node
+    // 'size() + s', and the parent of node 'i' is 'i / 2'.
+    std::vector<size_t> _tree;
+
+    // Set when the matches recorded in '_tree' no longer reflect '_keys'.
+    bool _needsRebuild = false;
+
+    // Set when the winner was removed but the matches on its path have not been replayed yet. A
+    // stream which runs out of buffered documents is usually refilled before anything else
+    // happens, and deferring the removal allows the refill to be replayed as a winner update.
+    bool _pendingWinnerRemoval = false;
+};
+
+}  // namespace mongo
@@ -0,0 +1,146 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <benchmark/benchmark.h>
+#include <queue>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/query/sort_key_loser_tree.h"
+
+namespace mongo {
+namespace {
+
+const int kDocsPerStream = 1000;
+
+/**
+ * Generates 'nStreams' sorted streams of sort keys, in the {"": <value>, ...} form in which the
+ * AsyncResultsMerger extracts them from $sortKey. Compound keys have an integer and a string
+ * component.
+ */
+std::vector<std::vector<BSONObj>> makeStreams(int nStreams,
+                                              bool compound,
+                                              const BSONObj& sortPattern) {
+    PseudoRandom random(1);
+    std::vector<std::vector<BSONObj>> streams(nStreams);
+    for (auto& stream : streams) {
+        for (int i = 0; i < kDocsPerStream; ++i) {
+            BSONObjBuilder builder;
+            builder.append("", random.nextInt32(1000000));
+            if (compound) {
+                builder.append("", "val" + std::to_string(random.nextInt32(100)));
+            }
+            stream.push_back(builder.obj());
+        }
+        std::sort(stream.begin(), stream.end(), [&](const BSONObj& lhs, const BSONObj& rhs) {
+            return lhs.woCompare(rhs, sortPattern) < 0;
+        });
+    }
+    return streams;
+}
+
+/**
+ * The merge previously used by the AsyncResultsMerger: a binary heap of stream indexes whose
+ * comparator compares the BSON sort keys at the front of each stream.
+ */
+void BM_PriorityQueueMerge(benchmark::State& state) {
+    const auto sortPattern = state.range(1) ? BSON("a" << 1 << "b" << -1) : BSON("a" << 1);
+    const auto streams = makeStreams(state.range(0), state.range(1), sortPattern);
+
+    for (auto keepRunning : state) {
+        std::vector<size_t> positions(streams.size(), 0);
+        auto comparator = [&](size_t lhs, size_t rhs) {
+            return streams[lhs][positions[lhs]].woCompare(streams[rhs][positions[rhs]],
+                                                          sortPattern) > 0;
+        };
+        std::priority_queue<size_t, std::vector<size_t>, decltype(comparator)> queue(comparator);
+        for (size_t i = 0; i < streams.size(); ++i) {
+            queue.push(i);
+        }
+
+        while (!queue.empty()) {
+            auto smallest = queue.top();
+            queue.pop();
+            benchmark::DoNotOptimize(streams[smallest][positions[smallest]]);
+            if (++positions[smallest] < streams[smallest].size()) {
+                queue.push(smallest);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * kDocsPerStream);
+}
+
+void BM_LoserTreeMerge(benchmark::State& state) {
+    const auto sortPattern = state.range(1) ? BSON("a" << 1 << "b" << -1) : BSON("a" << 1);
+    const auto streams = makeStreams(state.range(0), state.range(1), sortPattern);
+
+    for (auto keepRunning : state) {
+        std::vector<size_t> positions(streams.size(), 0);
+        SortKeyLoserTree tree(sortPattern);
+        tree.resize(streams.size());
+        for (size_t i = 0; i < streams.size(); ++i) {
+            tree.update(i, streams[i].front());
+        }
+
+        while (auto top = tree.top()) {
+            auto smallest = *top;
+            benchmark::DoNotOptimize(streams[smallest][positions[smallest]]);
+            if (++positions[smallest] < streams[smallest].size()) {
+                tree.update(smallest, streams[smallest][positions[smallest]]);
+            } else {
+                tree.remove(smallest);
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * kDocsPerStream);
+}
+
+BENCHMARK(BM_PriorityQueueMerge)
+    ->Args({2, 0})
+    ->Args({16, 0})
+    ->Args({128, 0})
+    ->Args({2, 1})
+    ->Args({16, 1})
+    ->Args({128, 1});
+
+BENCHMARK(BM_LoserTreeMerge)
+    ->Args({2, 0})
+    ->Args({16, 0})
+    ->Args({128, 0})
+    ->Args({2, 1})
+    ->Args({16, 1})
+    ->Args({128, 1});
+
+}  // namespace
+}  // namespace mongo
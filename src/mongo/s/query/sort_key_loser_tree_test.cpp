@@ -0,0 +1,231 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/sort_key_loser_tree.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Merges 'streams' of sort keys through a SortKeyLoserTree, returning the sort keys in the order
+ * they were produced.
+ */
+std::vector<BSONObj> merge(const BSONObj& sortPattern,
+                           const std::vector<std::vector<BSONObj>>& streams) {
+    SortKeyLoserTree tree(sortPattern);
+    tree.resize(streams.size());
+
+    std::vector<size_t> positions(streams.size(), 0);
+    for (size_t i = 0; i < streams.size(); ++i) {
+        if (!streams[i].empty()) {
+            tree.update(i, streams[i].front());
+        }
+    }
+
+    std::vector<BSONObj> merged;
+    while (auto top = tree.top()) {
+        merged.push_back(streams[*top][positions[*top]]);
+        if (++positions[*top] < streams[*top].size()) {
+            tree.update(*top, streams[*top][positions[*top]]);
+        } else {
+            tree.remove(*top);
+        }
+    }
+    return merged;
+}
+
+void assertMergedInOrder(const BSONObj& sortPattern,
+                         const std::vector<std::vector<BSONObj>>& streams) {
+    auto merged = merge(sortPattern, streams);
+
+    size_t expectedCount = 0;
+    for (const auto& stream : streams) {
+        expectedCount += stream.size();
+    }
+    ASSERT_EQ(merged.size(), expectedCount);
+
+    for (size_t i = 1; i < merged.size(); ++i) {
+        ASSERT_LTE(merged[i - 1].woCompare(merged[i], sortPattern), 0)
+            << merged[i - 1] << " was returned before " << merged[i];
+    }
+}
+
+TEST(SortKeyLoserTreeTest, EmptyTreeHasNoTop) {
+    SortKeyLoserTree tree(BSON("a" << 1));
+    ASSERT_FALSE(tree.top());
+    ASSERT_TRUE(tree.empty());
+
+    tree.resize(3);
+    ASSERT_EQ(tree.size(), 3U);
+    ASSERT_FALSE(tree.top());
+}
+
+TEST(SortKeyLoserTreeTest, SingleStream) {
+    SortKeyLoserTree tree(BSON("a" << 1));
+    tree.resize(1);
+    tree.update(0, BSON("" << 1));
+    ASSERT_EQ(*tree.top(), 0U);
+    tree.remove(0);
+    ASSERT_FALSE(tree.top());
+}
+
+TEST(SortKeyLoserTreeTest, MergesAscendingStreams) {
+    assertMergedInOrder(BSON("a" << 1),
+                        {{BSON("" << 1), BSON("" << 4), BSON("" << 7)},
+                         {BSON("" << 2), BSON("" << 5)},
+                         {},
+                         {BSON("" << 3), BSON("" << 6), BSON("" << 8), BSON("" << 9)},
+                         {BSON("" << 0)}});
+}
+
+TEST(SortKeyLoserTreeTest, MergesCompoundSortWithDescendingComponent) {
+    assertMergedInOrder(
+        BSON("a" << 1 << "b" << -1),
+        {{BSON("" << 1 << "" << "z"), BSON("" << 1 << "" << "a"), BSON("" << 3 << "" << "m")},
+         {BSON("" << 1 << "" << "q"), BSON("" << 2 << "" << "b")},
+         {BSON("" << 0 << "" << "c"), BSON("" << 2 << "" << "x"), BSON("" << 3 << "" << "a")}});
+}
+
+TEST(SortKeyLoserTreeTest, ComparesNumbersOfDifferentTypesByValue) {
+    assertMergedInOrder(BSON("a" << 1),
+                        {{BSON("" << 1), BSON("" << 2.5), BSON("" << 4LL)},
+                         {BSON("" << 1.5), BSON("" << 3LL), BSON("" << 3.5)},
+                         {BSON("" << -1.5), BSON("" << 2), BSON("" << 5.0)}});
+}
+
+TEST(SortKeyLoserTreeTest, ComparesMixedTypesInCanonicalOrder) {
+    assertMergedInOrder(
+        BSON("a" << 1),
+        {{BSON("" << MINKEY), BSON("" << 5), BSON("" << BSON("x" << 1))},
+         {BSON("" << BSONNULL), BSON("" << "str"), BSON("" << MAXKEY)},
+         {BSON("" << 10), BSON("" << BSON("x" << 1 << "y" << 2)), BSON("" << BSON_ARRAY(1))}});
+}
+
+TEST(SortKeyLoserTreeTest, MergesSortPatternWithMoreFieldsThanAnOrdering) {
+    // Only the last field, which is descending, differs between the sort keys.
+    const int numFields = Ordering::kMaxCompoundIndexKeys + 1;
+    BSONObjBuilder sortPattern;
+    for (int i = 0; i < numFields; ++i) {
+        sortPattern.append(str::stream() << "f" << i, i == numFields - 1 ? -1 : 1);
+    }
+    auto makeSortKey = [&](int last) {
+        BSONObjBuilder sortKey;
+        for (int i = 0; i < numFields - 1; ++i) {
+            sortKey.append("", 0);
+        }
+        sortKey.append("", last);
+        return sortKey.obj();
+    };
+
+    assertMergedInOrder(sortPattern.obj(),
+                        {{makeSortKey(9), makeSortKey(4), makeSortKey(1)},
+                         {makeSortKey(8), makeSortKey(5)},
+                         {makeSortKey(7), makeSortKey(6), makeSortKey(0)}});
+}
+
+TEST(SortKeyLoserTreeTest, OrdersEqualKeysByStreamIndex) {
+    SortKeyLoserTree tree(BSON("a" << 1));
+    tree.resize(4);
+    tree.update(2, BSON("" << 1));
+    tree.update(3, BSON("" << 1));
+    tree.update(1, BSON("" << 1));
+    ASSERT_EQ(*tree.top(), 1U);
+
+    tree.remove(1);
+    ASSERT_EQ(*tree.top(), 2U);
+
+    tree.update(0, BSON("" << 1.0));
+    ASSERT_EQ(*tree.top(), 0U);
+}
+
+TEST(SortKeyLoserTreeTest, RefillsWinnerAfterRemoval) {
+    SortKeyLoserTree tree(BSON("a" << 1));
+    tree.resize(3);
+    tree.update(0, BSON("" << 1));
+    tree.update(1, BSON("" << 2));
+    tree.update(2, BSON("" << 3));
+    ASSERT_EQ(*tree.top(), 0U);
+
+    // Stream 0 runs out of buffered results and is refilled with a larger key.
+    tree.remove(0);
+    tree.update(0, BSON("" << 4));
+    ASSERT_EQ(*tree.top(), 1U);
+
+    // Stream 1 is refilled with a key smaller than any other.
+    tree.remove(1);
+    tree.update(1, BSON("" << 0));
+    ASSERT_EQ(*tree.top(), 1U);
+}
+
+TEST(SortKeyLoserTreeTest, ResizeKeepsExistingStreams) {
+    SortKeyLoserTree tree(BSON("a" << 1));
+    tree.resize(2);
+    tree.update(0, BSON("" << 5));
+    tree.update(1, BSON("" << 3));
+    ASSERT_EQ(*tree.top(), 1U);
+
+    tree.resize(5);
+    ASSERT_EQ(*tree.top(), 1U);
+    tree.update(4, BSON("" << 1));
+    ASSERT_EQ(*tree.top(), 4U);
+}
+
+TEST(SortKeyLoserTreeTest, MatchesBSONComparisonForRandomStreams) {
+    PseudoRandom random(SecureRandom().nextInt64());
+    const auto sortPattern = BSON("a" << -1 << "b" << 1);
+
+    for (int iteration = 0; iteration < 20; ++iteration) {
+        std::vector<std::vector<BSONObj>> streams(1 + random.nextInt32(40));
+        for (auto& stream : streams) {
+            std::vector<BSONObj> keys;
+            const auto numKeys = random.nextInt32(30);
+            for (int i = 0; i < numKeys; ++i) {
+                keys.push_back(BSON("" << random.nextInt32(10) << "" << random.nextInt32(10)));
+            }
+            std::sort(keys.begin(), keys.end(), [&](const BSONObj& lhs, const BSONObj& rhs) {
+                return lhs.woCompare(rhs, sortPattern) < 0;
+            });
+            stream = std::move(keys);
+        }
+        assertMergedInOrder(sortPattern, streams);
+    }
+}
+
+}  // namespace
+}  // namespace mongo
@@ -345,8 +345,10 @@ BSONObj ShardKeyPattern::extractShardKeyFromIndexKeyData(
 
 BSONObj ShardKeyPattern::extractShardKeyFromDoc(const BSONObj& doc) const {
     BSONObjBuilder keyBuilder;
+    auto pathIt = _keyPatternPaths.begin();
     for (auto&& patternEl : _keyPattern.toBSON()) {
-        BSONElement matchEl = extractKeyElementFromDoc(doc, patternEl.fieldNameStringData());
+        size_t idxPath;
+        BSONElement matchEl = getFieldDottedOrArray(doc, **pathIt++, &idxPath);
 
         if (matchEl.eoo()) {
             matchEl = kNullObj.firstElement();
@@ -371,6 +373,34 @@ BSONObj ShardKeyPattern::extractShardKeyFromDoc(const BSONObj& doc) const {
     return keyBuilder.obj();
 }
 
+boost::optional<std::string> ShardKeyPattern::extractShardKeyStringFromDoc(
+    const BSONObj& doc) const {
+    KeyString::Builder ks(KeyString::Version::V1, Ordering::allAscending());
+
+    auto pathIt = _keyPatternPaths.begin();
+    for (auto&& patternEl : _keyPattern.toBSON()) {
+        size_t idxPath;
+        BSONElement matchEl = getFieldDottedOrArray(doc, **pathIt++, &idxPath);
+
+        if (matchEl.eoo()) {
+            matchEl = kNullObj.firstElement();
+        }
+
+        if (!isValidShardKeyElementForExtractionFromDocument(matchEl)) {
+            return boost::none;
+        }
+
+        if (isHashedPatternEl(patternEl)) {
+            ks.appendNumberLong(
+                BSONElementHasher::hash64(matchEl, BSONElementHasher::DEFAULT_HASH_SEED));
+        } else {
+            ks.appendBSONElement(matchEl);
+        }
+    }
+
+    return std::string(ks.getBuffer(), ks.getSize());
+}
+
 BSONObj ShardKeyPattern::extractShardKeyFromDocThrows(const BSONObj& doc) const {
     auto shardKey = extractShardKeyFromDoc(doc);
 
@@ -187,6 +187,13 @@ public:
     BSONObj extractShardKeyFromDoc(const BSONObj& doc) const;
     BSONObj extractShardKeyFromDocThrows(const BSONObj& doc) const;
 
+    /**
+     * Equivalent to toKeyString(extractShardKeyFromDoc(doc)), but encodes the shard key values
+     * found in the document directly into the KeyString, without building the shard key BSONObj.
+     * Returns boost::none if extractShardKeyFromDoc() would return an empty shard key.
+     */
+    boost::optional<std::string> extractShardKeyStringFromDoc(const BSONObj& doc) const;
+
     /**
      * Returns the document with missing shard key values set to null.
      */
@@ -301,6 +301,42 @@ TEST_F(ShardKeyPatternTest, ExtractDocShardKeyHashed) {
     ASSERT_BSONOBJ_EQ(docKey(pattern, BSON("a" << BSON_ARRAY(BSON("b" << value)))), BSONObj());
 }
 
+static void assertDocKeyStringMatchesDocKey(const ShardKeyPattern& pattern, const BSONObj& doc) {
+    auto shardKey = pattern.extractShardKeyFromDoc(doc);
+    auto shardKeyString = pattern.extractShardKeyStringFromDoc(doc);
+    if (shardKey.isEmpty()) {
+        ASSERT_FALSE(shardKeyString) << doc;
+    } else {
+        ASSERT(shardKeyString) << doc;
+        ASSERT_EQ(*shardKeyString, ShardKeyPattern::toKeyString(shardKey)) << doc;
+    }
+}
+
+TEST_F(ShardKeyPatternTest, ExtractDocShardKeyString) {
+    const std::vector<BSONObj> docs{fromjson("{a: 10, b: 'x', c: {d: 1.5}}"),
+                                    fromjson("{a: {b: 'hi'}, c: {d: [1, 2]}}"),
+                                    fromjson("{a: [1, 2], b: 'x'}"),
+                                    fromjson("{b: {$numberDecimal: '3.0'}, c: {d: null}}"),
+                                    fromjson("{c: {d: {e: 'nested'}}, a: {$minKey: 1}}"),
+                                    fromjson("{a: {$numberLong: '9007199254740993'}}"),
+                                    fromjson("{}")};
+
+    const std::vector<BSONObj> patterns{BSON("a" << 1),
+                                        BSON("a" << 1 << "b" << 1),
+                                        BSON("c.d" << 1 << "a" << 1),
+                                        BSON("a"
+                                             << "hashed"),
+                                        BSON("b" << 1 << "c.d"
+                                                 << "hashed")};
+
+    for (const auto& patternObj : patterns) {
+        ShardKeyPattern pattern(patternObj);
+        for (const auto& doc : docs) {
+            assertDocKeyStringMatchesDocKey(pattern, doc);
+        }
+    }
+}
+
 TEST_F(ShardKeyPatternTest, ExtractQueryShardKeySingle) {
     //
     // Single field ShardKeyPatterns
@@ -126,6 +126,13 @@ protected:
         : _id{static_cast<MessageCompressorId>(id)},
           _name{getMessageCompressorName(id).toString()} {}
 
+    /*
+     * This is called by variants of a compressor, which produce its wire format and share its ID,
+     * but are negotiated under a name of their own.
+     */
+    MessageCompressorBase(MessageCompressor id, StringData name)
+        : _id{static_cast<MessageCompressorId>(id)}, _name{name.toString()} {}
+
     /*
      * Called by sub-classes to bump their bytesIn/bytesOut counters for compression
      */
@@ -33,12 +33,16 @@
 
 #include "mongo/transport/message_compressor_manager.h"
 
+#include <algorithm>
+
 #include "mongo/base/data_range_cursor.h"
 #include "mongo/base/data_type_endian.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/logv2/log.h"
+#include "mongo/platform/bits.h"
 #include "mongo/rpc/message.h"
+#include "mongo/transport/message_compressor_gen.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/session.h"
 
@@ -87,7 +91,12 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
 
     MessageCompressorBase* compressor = nullptr;
     if (compressorId) {
-        compressor = _registry->getCompressor(*compressorId);
+        // Prefer a compressor negotiated for this connection, which may be a variant of the
+        // compressor registered under the ID, such as zstd primed with a dictionary.
+        auto it = std::find_if(_negotiated.begin(), _negotiated.end(), [&](auto&& negotiated) {
+            return negotiated->getId() == *compressorId;
+        });
+        compressor = it != _negotiated.end() ? *it : _registry->getCompressor(*compressorId);
         invariant(compressor);
     } else if (!_negotiated.empty()) {
         compressor = _negotiated[0];
@@ -95,6 +104,17 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
         return {msg};
     }
 
+    // Only replies adapt: the ServiceStateMachine compresses a reply only when its request was
+    // compressed, so a client skipping compression would turn compression off for the replies.
+    // Replies back off separately for each size class, so that small replies which do not compress
+    // never hold back the compression of large ones.
+    const bool adaptive = compressorId && gAdaptiveMessageCompression.load();
+    BackOff* backOff = adaptive ? _getBackOff(msg.size()) : nullptr;
+    if (backOff && backOff->messagesToSkip > 0) {
+        --backOff->messagesToSkip;
+        return {msg};
+    }
+
     LOGV2_DEBUG(22925,
                 3,
                 "Compressing message with {compressor}",
@@ -137,11 +157,45 @@ StatusWith<Message> MessageCompressorManager::compressMessage(
         return sws.getStatus();
 
     auto realCompressedSize = sws.getValue();
-    outMessage.setLen(realCompressedSize + CompressionHeader::size() + MsgData::MsgDataHeaderSize);
+    const auto compressedMessageSize =
+        realCompressedSize + CompressionHeader::size() + MsgData::MsgDataHeaderSize;
+
+    if (adaptive && compressedMessageSize >= static_cast<size_t>(msg.size())) {
+        // Compression did not pay for itself, so send the original. Replies of the same size class
+        // are probed again later, backing off further each time they still do not compress.
+        if (backOff) {
+            backOff->skipInterval =
+                std::min(std::max(backOff->skipInterval * 2, 1), kMaxSkipInterval);
+            backOff->messagesToSkip = backOff->skipInterval;
+        }
+        LOGV2_DEBUG(5843200,
+                    3,
+                    "Message did not compress, sending it uncompressed",
+                    "compressor"_attr = compressor->getName(),
+                    "messageSize"_attr = msg.size(),
+                    "messagesToSkip"_attr = backOff ? backOff->messagesToSkip : 0);
+        return {msg};
+    }
+    if (backOff) {
+        backOff->skipInterval = 0;
+    }
+
+    outMessage.setLen(compressedMessageSize);
 
     return {Message(outputMessageBuffer)};
 }
 
+MessageCompressorManager::BackOff* MessageCompressorManager::_getBackOff(int messageSize) {
+    if (messageSize >= kMaxBackOffMessageSize) {
+        return nullptr;
+    }
+
+    const int floorLog2Size = 63 - countLeadingZeros64(static_cast<uint64_t>(messageSize) | 1);
+    const auto sizeClass = std::max(floorLog2Size - (kMinSizeClassBits - 1), 0);
+    static_assert(kMaxBackOffMessageSize == 1 << (kMinSizeClassBits + kNumSizeClasses - 1));
+    return &_backOffs[sizeClass];
+}
+
 StatusWith<Message> MessageCompressorManager::decompressMessage(const Message& msg,
                                                                 MessageCompressorId* compressorId) {
     auto inputHeader = msg.header();
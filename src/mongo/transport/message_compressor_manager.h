@@ -33,6 +33,7 @@
 #include "mongo/transport/message_compressor_base.h"
 #include "mongo/transport/session.h"
 
+#include <array>
 #include <vector>
 
 namespace mongo {
@@ -89,12 +90,16 @@ public:
 
     /*
      * Returns a new Message containing the compressed contentx of 'msg'. If compressorId is null,
-     * then it selects the first negotiated compressor. Otherwise, it uses the compressor with the
-     * given identifier. It is intended that this value echo back a value returned as the out
-     * parameter value for compressorId from a call to decompressMessage.
+     * then it selects the first negotiated compressor. Otherwise, it uses the first negotiated
+     * compressor with the given identifier, or else the one registered under it. It is intended
+     * that this value echo back a value returned as the out parameter value for compressorId from
+     * a call to decompressMessage.
      *
      * If _negotiated is empty (meaning compression was not negotiated or is not supported), then
-     * it will return a ref-count bumped copy of the input message.
+     * it will return a ref-count bumped copy of the input message. The same holds for a reply
+     * (compressorId is non-null) when the adaptiveMessageCompression server parameter is set and
+     * compressing 'msg' would not make it smaller, or while backing off after such a reply of a
+     * similar size.
      *
      * If an error occurs in the compressor, it will return a Status error.
      */
@@ -124,8 +129,36 @@ public:
     static MessageCompressorManager& forSession(const transport::SessionHandle& session);
 
 private:
+    // Adaptive compression state for the replies of one size class. After a reply that does not
+    // compress, the next 'skipInterval' replies of the class are sent as is; the interval doubles
+    // with every further reply that does not compress and resets once one does.
+    struct BackOff {
+        int skipInterval = 0;
+        int messagesToSkip = 0;
+    };
+
+    // Upper bound on the number of replies sent uncompressed between two attempts to compress.
+    static constexpr int kMaxSkipInterval = 64;
+
+    // Replies of at least this size never back off: one attempt to compress them costs little next
+    // to the bandwidth it saves when they do compress.
+    static constexpr int kMaxBackOffMessageSize = 16 * 1024;
+
+    // Replies smaller than 2^kMinSizeClassBits bytes share a size class. Each larger power of two
+    // up to kMaxBackOffMessageSize has a class of its own.
+    static constexpr int kMinSizeClassBits = 6;
+    static constexpr size_t kNumSizeClasses = 9;
+
+    /**
+     * Returns the back off state of the size class of a reply of 'messageSize' bytes, or nullptr if
+     * replies of that size never back off.
+     */
+    BackOff* _getBackOff(int messageSize);
+
     std::vector<MessageCompressorBase*> _negotiated;
     MessageCompressorRegistry* _registry;
+
+    std::array<BackOff, kNumSizeClasses> _backOffs;
 };
 
 }  // namespace mongo
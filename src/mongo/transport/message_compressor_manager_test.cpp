@@ -31,11 +31,15 @@
 
 #include "mongo/platform/basic.h"
 
+#include <array>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/idl/server_parameter_test_util.h"
+#include "mongo/logv2/log.h"
+#include "mongo/platform/random.h"
 #include "mongo/rpc/message.h"
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/message_compressor_noop.h"
@@ -43,7 +47,9 @@
 #include "mongo/transport/message_compressor_snappy.h"
 #include "mongo/transport/message_compressor_zlib.h"
 #include "mongo/transport/message_compressor_zstd.h"
+#include "mongo/transport/message_compressor_zstd_oplog_dictionary.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/uuid.h"
 
 namespace mongo {
 namespace {
@@ -261,6 +267,153 @@ TEST(ZstdMessageCompressor, Fidelity) {
     checkFidelity(testMessage, std::make_unique<ZstdMessageCompressor>());
 }
 
+TEST(ZstdOplogDictionaryMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    checkFidelity(testMessage, std::make_unique<ZstdOplogDictionaryMessageCompressor>());
+}
+
+/**
+ * Returns the 'count'th of a series of ObjectIds which, like those generated by one process, share
+ * their timestamp and process id and differ in their counter.
+ */
+OID makeOID(const std::array<unsigned char, OID::kOIDSize>& base, int count) {
+    auto bytes = base;
+    const int counter = (bytes[9] << 16 | bytes[10] << 8 | bytes[11]) + count;
+    bytes[9] = static_cast<unsigned char>(counter >> 16);
+    bytes[10] = static_cast<unsigned char>(counter >> 8);
+    bytes[11] = static_cast<unsigned char>(counter);
+    return OID::from(bytes.data());
+}
+
+/**
+ * Builds a getMore reply of the oplog holding 'numEntries' inserts, updates and deletes, as a
+ * secondary receives it from its sync source. All of its contents are derived from 'random', so
+ * that the same seed always produces the same reply.
+ */
+BSONObj buildOplogGetMoreReply(PseudoRandom& random, int numEntries) {
+    std::array<unsigned char, UUID::kNumBytes> uuidBytes;
+    random.fill(uuidBytes.data(), uuidBytes.size());
+    const auto ui = UUID::fromCDR(uuidBytes);
+    std::array<unsigned char, OID::kOIDSize> oidBase;
+    random.fill(oidBase.data(), oidBase.size());
+    std::array<unsigned char, OID::kOIDSize> replicaSetIdBytes;
+    random.fill(replicaSetIdBytes.data(), replicaSetIdBytes.size());
+    const auto replicaSetId = OID::from(replicaSetIdBytes.data());
+    const auto term = 1LL + random.nextInt32(50);
+    const auto secs = 1600000000U + random.nextInt32(10000000);
+    const auto wall = Date_t::fromMillisSinceEpoch(secs * 1000LL);
+
+    BSONArrayBuilder batch;
+    for (int i = 0; i < numEntries; ++i) {
+        const auto id = makeOID(oidBase, i);
+        const auto qty = random.nextInt32(1000);
+        BSONObjBuilder entry;
+        switch (random.nextInt32(3)) {
+            case 0:
+                entry << "op"
+                      << "i"
+                      << "ns"
+                      << "test.orders"
+                      << "ui" << ui << "o" << BSON("_id" << id << "qty" << qty);
+                break;
+            case 1:
+                entry << "op"
+                      << "u"
+                      << "ns"
+                      << "test.orders"
+                      << "ui" << ui << "o"
+                      << BSON("$v" << 2 << "diff" << BSON("u" << BSON("qty" << qty))) << "o2"
+                      << BSON("_id" << id);
+                break;
+            default:
+                entry << "op"
+                      << "d"
+                      << "ns"
+                      << "test.orders"
+                      << "ui" << ui << "o" << BSON("_id" << id);
+                break;
+        }
+        entry << "ts" << Timestamp(secs, i + 1) << "t" << term << "v" << 2LL << "wall"
+              << wall + Milliseconds(i);
+        batch.append(entry.obj());
+    }
+
+    const auto opTime = BSON("ts" << Timestamp(secs, numEntries) << "t" << term);
+    const auto replData = BSON("term" << term << "lastOpCommitted" << opTime << "lastCommittedWall"
+                                      << wall << "lastOpVisible" << opTime << "configVersion" << 1
+                                      << "configTerm" << term << "replicaSetId" << replicaSetId
+                                      << "syncSourceIndex" << -1 << "syncSourceHost"
+                                      << ""
+                                      << "primaryIndex" << 0);
+    const auto cursorId = static_cast<long long>(random.nextInt64());
+    return BSON("$replData" << replData << "$oplogQueryData" << replData << "ok" << 1.0
+                            << "operationTime" << Timestamp(secs, numEntries) << "cursor"
+                            << BSON("nextBatch" << batch.arr() << "id" << cursorId << "ns"
+                                                << "local.oplog.rs"));
+}
+
+TEST(ZstdOplogDictionaryMessageCompressor, SharesTheZstdId) {
+    ASSERT_EQ(ZstdOplogDictionaryMessageCompressor().getId(), ZstdMessageCompressor().getId());
+    ASSERT_EQ(ZstdOplogDictionaryMessageCompressor().getName(), "zstd-oplog-v1");
+}
+
+TEST(ZstdOplogDictionaryMessageCompressor, ZstdDecompressesDictionaryFrames) {
+    PseudoRandom random(1);
+    const auto reply = buildOplogGetMoreReply(random, 3);
+    ConstDataRange input(reply.objdata(), reply.objsize());
+
+    ZstdOplogDictionaryMessageCompressor dictionaryCompressor;
+    std::vector<char> compressed(dictionaryCompressor.getMaxCompressedSize(input.length()));
+    const auto compressedSize = assertOk(dictionaryCompressor.compressData(
+        input, DataRange(compressed.data(), compressed.size())));
+
+    std::vector<char> decompressed(input.length());
+    DataRange output(decompressed.data(), decompressed.size());
+    const auto decompressedSize = assertOk(ZstdMessageCompressor().decompressData(
+        ConstDataRange(compressed.data(), compressedSize), output));
+    ASSERT_EQ(decompressedSize, input.length());
+    ASSERT_EQ(memcmp(decompressed.data(), input.data(), input.length()), 0);
+}
+
+TEST(ZstdOplogDictionaryMessageCompressor, CompressesSmallOplogBatchesBetterThanZstd) {
+    PseudoRandom random(1);
+    ZstdMessageCompressor zstdCompressor;
+    ZstdOplogDictionaryMessageCompressor dictionaryCompressor;
+
+    auto compressedSize = [](MessageCompressorBase& compressor, ConstDataRange input) {
+        std::vector<char> buffer(compressor.getMaxCompressedSize(input.length()));
+        return assertOk(compressor.compressData(input, DataRange(buffer.data(), buffer.size())));
+    };
+
+    for (int numEntries : {1, 2, 5, 10, 50, 200}) {
+        size_t uncompressedBytes = 0;
+        size_t zstdBytes = 0;
+        size_t dictionaryBytes = 0;
+        for (int i = 0; i < 100; ++i) {
+            const auto reply = buildOplogGetMoreReply(random, numEntries);
+            ConstDataRange input(reply.objdata(), reply.objsize());
+            uncompressedBytes += input.length();
+            zstdBytes += compressedSize(zstdCompressor, input);
+            dictionaryBytes += compressedSize(dictionaryCompressor, input);
+        }
+        LOGV2(5843210,
+              "Compressed oplog getMore replies",
+              "numEntries"_attr = numEntries,
+              "uncompressedBytes"_attr = uncompressedBytes,
+              "zstdBytes"_attr = zstdBytes,
+              "dictionaryBytes"_attr = dictionaryBytes);
+
+        // The dictionary pays off the most on the small batches of a secondary that keeps up with
+        // its sync source: they should compress to at most two thirds of their plain zstd size.
+        // Larger batches gain less, as they repeat their field names within the message, and the
+        // largest ones are compressed without the dictionary.
+        if (numEntries <= 10) {
+            ASSERT_LT(dictionaryBytes * 3, zstdBytes * 2);
+        }
+        ASSERT_LTE(dictionaryBytes, zstdBytes);
+    }
+}
+
 TEST(SnappyMessageCompressor, Overflow) {
     checkOverflow(std::make_unique<SnappyMessageCompressor>());
 }
@@ -273,6 +426,10 @@ TEST(ZstdMessageCompressor, Overflow) {
     checkOverflow(std::make_unique<ZstdMessageCompressor>());
 }
 
+TEST(ZstdOplogDictionaryMessageCompressor, Overflow) {
+    checkOverflow(std::make_unique<ZstdOplogDictionaryMessageCompressor>());
+}
+
 TEST(MessageCompressorManager, SERVER_28008) {
 
     // Create a client and server that will negotiate the same compressors,
@@ -343,6 +500,159 @@ TEST(MessageCompressorManager, SERVER_28008) {
     ASSERT_EQ(compressorId, zstdId);
 }
 
+Message buildMessageWithData(const std::string& data) {
+    const auto bufferSize = MsgData::MsgDataHeaderSize + data.size();
+    auto buf = SharedBuffer::allocate(bufferSize);
+    MsgData::View view(buf.get());
+    view.setId(1);
+    view.setResponseToMsgId(0);
+    view.setOperation(dbQuery);
+    view.setLen(bufferSize);
+    memcpy(view.data(), data.data(), data.size());
+    return Message{buf};
+}
+
+std::string makeIncompressibleData(size_t size) {
+    PseudoRandom random(1);
+    std::string data(size, '\0');
+    random.fill(data.data(), data.size());
+    return data;
+}
+
+TEST(MessageCompressorManager, AdaptiveCompressionSkipsIncompressibleMessages) {
+    RAIIServerParameterControllerForTest controller("adaptiveMessageCompression", true);
+
+    MessageCompressorRegistry registry;
+    auto compressor = std::make_unique<ZstdMessageCompressor>();
+    const auto compressorName = compressor->getName();
+    const auto compressorId = compressor->getId();
+    registry.setSupportedCompressors({compressorName});
+    registry.registerImplementation(std::move(compressor));
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    MessageCompressorManager mgr(&registry);
+    BSONObjBuilder negotiatorOut;
+    mgr.serverNegotiate(std::vector<StringData>{compressorName}, &negotiatorOut);
+
+    auto bytesIn = [&] {
+        return registry.getCompressor(compressorName)->getCompressorBytesIn();
+    };
+    auto sendReply = [&](const Message& msg) {
+        return assertOk(mgr.compressMessage(msg, &compressorId));
+    };
+
+    // Both messages are between 2KB and 4KB, so they are in the same size class.
+    const auto incompressible = buildMessageWithData(makeIncompressibleData(3500));
+    const auto compressible = buildMessageWithData(std::string(3000, 'x'));
+
+    // A request is always compressed, so that the server keeps compressing its replies.
+    auto sent = assertOk(mgr.compressMessage(incompressible));
+    ASSERT_EQ(sent.operation(), dbCompressed);
+
+    // A reply that does not shrink is sent as is.
+    sent = sendReply(incompressible);
+    ASSERT_EQ(sent.operation(), incompressible.operation());
+
+    // The next reply of the same size class is sent without even trying to compress it.
+    auto bytesInBefore = bytesIn();
+    sent = sendReply(compressible);
+    ASSERT_EQ(sent.operation(), compressible.operation());
+    ASSERT_EQ(bytesIn(), bytesInBefore);
+
+    // Replies of other size classes are still compressed.
+    const auto largerCompressible = buildMessageWithData(std::string(6000, 'x'));
+    sent = sendReply(largerCompressible);
+    ASSERT_EQ(sent.operation(), dbCompressed);
+
+    // The following one is probed again and, still not shrinking, doubles the back off.
+    sent = sendReply(incompressible);
+    ASSERT_EQ(sent.operation(), incompressible.operation());
+    bytesInBefore = bytesIn();
+    for (int i = 0; i < 2; ++i) {
+        sent = sendReply(compressible);
+        ASSERT_EQ(sent.operation(), compressible.operation());
+    }
+    ASSERT_EQ(bytesIn(), bytesInBefore);
+
+    // A compressible reply is compressed once the back off has elapsed.
+    sent = sendReply(compressible);
+    ASSERT_EQ(sent.operation(), dbCompressed);
+    ASSERT_LT(sent.size(), compressible.size());
+}
+
+TEST(MessageCompressorManager, AdaptiveCompressionAlwaysTriesLargeMessages) {
+    RAIIServerParameterControllerForTest controller("adaptiveMessageCompression", true);
+
+    MessageCompressorRegistry registry;
+    auto compressor = std::make_unique<ZstdMessageCompressor>();
+    const auto compressorName = compressor->getName();
+    const auto compressorId = compressor->getId();
+    registry.setSupportedCompressors({compressorName});
+    registry.registerImplementation(std::move(compressor));
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    MessageCompressorManager mgr(&registry);
+    BSONObjBuilder negotiatorOut;
+    mgr.serverNegotiate(std::vector<StringData>{compressorName}, &negotiatorOut);
+
+    // An empty reply which does not compress, such as an awaitData getMore that timed out, does
+    // not keep the following large batch from being compressed.
+    const auto smallIncompressible = buildMessage();
+    auto sent = assertOk(mgr.compressMessage(smallIncompressible, &compressorId));
+    ASSERT_EQ(sent.operation(), smallIncompressible.operation());
+
+    const auto largeCompressible = buildMessageWithData(std::string(64 * 1024, 'x'));
+    sent = assertOk(mgr.compressMessage(largeCompressible, &compressorId));
+    ASSERT_EQ(sent.operation(), dbCompressed);
+
+    // Large replies are tried every time, even right after one that did not compress.
+    const auto largeIncompressible = buildMessageWithData(makeIncompressibleData(64 * 1024));
+    sent = assertOk(mgr.compressMessage(largeIncompressible, &compressorId));
+    ASSERT_EQ(sent.operation(), largeIncompressible.operation());
+    sent = assertOk(mgr.compressMessage(largeCompressible, &compressorId));
+    ASSERT_EQ(sent.operation(), dbCompressed);
+}
+
+TEST(MessageCompressorManager, RepliesWithNegotiatedCompressorVariant) {
+    MessageCompressorRegistry registry;
+    registry.setSupportedCompressors({"zstd", "zstd-oplog-v1"});
+    registry.registerImplementation(std::make_unique<ZstdMessageCompressor>());
+    registry.registerImplementation(std::make_unique<ZstdOplogDictionaryMessageCompressor>());
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    MessageCompressorManager clientManager(&registry);
+    MessageCompressorManager serverManager(&registry);
+    BSONObjBuilder serverOutput;
+    serverManager.serverNegotiate(std::vector<StringData>{"zstd-oplog-v1", "zstd"}, &serverOutput);
+    auto serverObj = serverOutput.done();
+    checkNegotiationResult(serverObj, {"zstd-oplog-v1", "zstd"});
+    clientManager.clientFinish(serverObj);
+
+    auto dictionaryBytesIn = [&] {
+        return registry.getCompressor("zstd-oplog-v1")->getCompressorBytesIn();
+    };
+
+    // The request goes out with the zstd id.
+    PseudoRandom random(1);
+    const auto reply = buildOplogGetMoreReply(random, 1);
+    const auto msg = buildMessageWithData(std::string(reply.objdata(), reply.objsize()));
+    auto bytesInBefore = dictionaryBytesIn();
+    const auto request = assertOk(clientManager.compressMessage(msg));
+    ASSERT_GT(dictionaryBytesIn(), bytesInBefore);
+
+    MessageCompressorId compressorId;
+    const auto decompressed = assertOk(serverManager.decompressMessage(request, &compressorId));
+    ASSERT_EQ(compressorId, static_cast<MessageCompressorId>(MessageCompressor::kZstd));
+    ASSERT_EQ(decompressed.size(), msg.size());
+
+    // The reply echoes the request's id, and is compressed with the negotiated dictionary.
+    bytesInBefore = dictionaryBytesIn();
+    const auto compressedReply = assertOk(serverManager.compressMessage(msg, &compressorId));
+    ASSERT_EQ(compressedReply.operation(), dbCompressed);
+    ASSERT_GT(dictionaryBytesIn(), bytesInBefore);
+    ASSERT_EQ(assertOk(clientManager.decompressMessage(compressedReply)).size(), msg.size());
+}
+
 TEST(MessageCompressorManager, MessageSizeTooLarge) {
     auto registry = buildRegistry();
     MessageCompressorManager compManager(&registry);
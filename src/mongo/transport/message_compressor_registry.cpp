@@ -70,18 +70,24 @@ MessageCompressorRegistry& MessageCompressorRegistry::get() {
 
 void MessageCompressorRegistry::registerImplementation(
     std::unique_ptr<MessageCompressorBase> impl) {
-    // It's an error to register a compressor that's already been registered
-    fassert(40270,
-            _compressorsByName.find(impl->getName()) == _compressorsByName.end() &&
-                _compressorsByIds[impl->getId()] == nullptr);
+    // It's an error to register a compressor that's already been registered. Only the name needs
+    // checking: a compressor's ID determines its name, unless it is a variant of that compressor.
+    fassert(40270, _compressorsByName.find(impl->getName()) == _compressorsByName.end());
 
     // Check to see if this compressor is allowed by configuration
     auto it = std::find(_compressorNames.begin(), _compressorNames.end(), impl->getName());
     if (it == _compressorNames.end())
         return;
 
+    // Messages carrying an ID are decompressed by the compressor registered under it, or by one of
+    // its variants when only those are configured. Variants decompress the same wire format.
+    const bool isVariant = impl->getName() !=
+        getMessageCompressorName(static_cast<MessageCompressor>(impl->getId()));
+    if (!isVariant || _compressorsByIds[impl->getId()] == nullptr) {
+        _compressorsByIds[impl->getId()] = impl.get();
+    }
     _compressorsByName[impl->getName()] = impl.get();
-    _compressorsByIds[impl->getId()] = std::move(impl);
+    _compressors.push_back(std::move(impl));
 }
 
 Status MessageCompressorRegistry::finalizeSupportedCompressors() {
@@ -100,7 +106,7 @@ const std::vector<std::string>& MessageCompressorRegistry::getCompressorNames()
 }
 
 MessageCompressorBase* MessageCompressorRegistry::getCompressor(MessageCompressorId id) const {
-    return _compressorsByIds.at(id).get();
+    return _compressorsByIds.at(id);
 }
 
 MessageCompressorBase* MessageCompressorRegistry::getCompressor(StringData name) const {
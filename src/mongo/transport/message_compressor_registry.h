@@ -70,7 +70,7 @@ public:
     /*
      * Registers a new implementation of a MessageCompressor with the registry. This only gets
      * called during startup. It is an error to call this twice with compressors with the same name
-     * or ID numbers.
+     * or ID numbers, except for variants of a compressor, which share its ID under another name.
      *
      * This method is not thread-safe and should only be called from a single-threaded context
      * (a MONGO_INITIALIZER).
@@ -111,10 +111,10 @@ public:
     Status finalizeSupportedCompressors();
 
 private:
+    std::vector<std::unique_ptr<MessageCompressorBase>> _compressors;
     StringMap<MessageCompressorBase*> _compressorsByName;
-    std::array<std::unique_ptr<MessageCompressorBase>,
-               std::numeric_limits<MessageCompressorId>::max() + 1>
-        _compressorsByIds;
+    std::array<MessageCompressorBase*, std::numeric_limits<MessageCompressorId>::max() + 1>
+        _compressorsByIds{};
     std::vector<std::string> _compressorNames;
 };
 
@@ -33,6 +33,8 @@
 
 #include "mongo/transport/message_compressor_noop.h"
 #include "mongo/transport/message_compressor_registry.h"
+#include "mongo/transport/message_compressor_zstd.h"
+#include "mongo/transport/message_compressor_zstd_oplog_dictionary.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 
@@ -87,5 +89,44 @@ TEST(MessageCompressorRegistry, SetSupported) {
     ASSERT_NULL(registry.getCompressor(compressorId));
     ASSERT_NULL(registry.getCompressor(compressorName));
 }
+
+TEST(MessageCompressorRegistry, VariantSharesId) {
+    for (bool variantFirst : {false, true}) {
+        MessageCompressorRegistry registry;
+        auto compressor = std::make_unique<ZstdMessageCompressor>();
+        auto compressorPtr = compressor.get();
+        auto variant = std::make_unique<ZstdOplogDictionaryMessageCompressor>();
+        auto variantPtr = variant.get();
+
+        registry.setSupportedCompressors({compressorPtr->getName(), variantPtr->getName()});
+        if (variantFirst) {
+            registry.registerImplementation(std::move(variant));
+            registry.registerImplementation(std::move(compressor));
+        } else {
+            registry.registerImplementation(std::move(compressor));
+            registry.registerImplementation(std::move(variant));
+        }
+        ASSERT_OK(registry.finalizeSupportedCompressors());
+
+        // Both are found by name, but the ID belongs to the compressor the variant is based on.
+        ASSERT_EQ(registry.getCompressor(compressorPtr->getName()), compressorPtr);
+        ASSERT_EQ(registry.getCompressor(variantPtr->getName()), variantPtr);
+        ASSERT_EQ(registry.getCompressor(compressorPtr->getId()), compressorPtr);
+    }
+}
+
+TEST(MessageCompressorRegistry, VariantAloneTakesId) {
+    MessageCompressorRegistry registry;
+    auto variant = std::make_unique<ZstdOplogDictionaryMessageCompressor>();
+    auto variantPtr = variant.get();
+
+    registry.setSupportedCompressors({variantPtr->getName()});
+    registry.registerImplementation(std::make_unique<ZstdMessageCompressor>());
+    registry.registerImplementation(std::move(variant));
+    ASSERT_OK(registry.finalizeSupportedCompressors());
+
+    ASSERT_NULL(registry.getCompressor("zstd"));
+    ASSERT_EQ(registry.getCompressor(variantPtr->getId()), variantPtr);
+}
 }  // namespace
 }  // namespace mongo
@@ -36,6 +36,7 @@
 #include "mongo/base/init.h"
 #include "mongo/transport/message_compressor_registry.h"
 #include "mongo/transport/message_compressor_zstd.h"
+#include "mongo/transport/message_compressor_zstd_oplog_dictionary.h"
 
 namespace mongo {
 
@@ -63,8 +64,9 @@ StatusWith<std::size_t> ZstdMessageCompressor::compressData(ConstDataRange input
 
 StatusWith<std::size_t> ZstdMessageCompressor::decompressData(ConstDataRange input,
                                                               DataRange output) {
-    size_t ret = ZSTD_decompress(
-        const_cast<char*>(output.data()), output.length(), input.data(), input.length());
+    // Peers which negotiated zstd-oplog-v1 send frames compressed with its dictionary under this
+    // compressor's ID.
+    size_t ret = ZstdOplogDictionaryMessageCompressor::decompressFrame(input, output);
 
     if (ZSTD_isError(ret)) {
         return Status{ErrorCodes::BadValue,
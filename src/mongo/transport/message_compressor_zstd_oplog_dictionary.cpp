@@ -0,0 +1,283 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compressor_zstd_oplog_dictionary.h"
+
+#include <memory>
+
+#include <zstd.h>
+
+#include "mongo/base/init.h"
+#include "mongo/transport/message_compressor_registry.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * The id stored in the header of the dictionary below, and in every frame compressed with it. zstd
+ * leaves ids from 32768 to 2^31 - 1 free for private dictionaries.
+ */
+constexpr unsigned kOplogDictionaryV1Id = 0x6f706c01;
+
+/**
+ * Version 1 of the oplog dictionary, in zstd dictionary format. Its content is a getMore reply of
+ * the oplog holding a noop, a retryable insert, a delete, an update and an insert, with constant
+ * values throughout, ordered so that the oplog entries sit at the end of the dictionary where zstd
+ * finds matches at the shortest distances. The entropy tables in front of it were computed by
+ * ZDICT_finalizeDictionary() at compression level 3 over synthetic replies of 1 to 10 entries.
+ *
+ * These bytes must never change: a new dictionary needs a new compressor name and dictionary id.
+ */
+const unsigned char kOplogDictionaryV1[] = {
+    0x37, 0xa4, 0x30, 0xec, 0x01, 0x6c, 0x70, 0x6f, 0x38, 0x10, 0x78, 0xad, 0xc6, 0xcc, 0x88, 0xcf,
+    0xf3, 0xc0, 0x33, 0xa0, 0xb0, 0xd8, 0x83, 0xd8, 0x2b, 0xce, 0xee, 0xe7, 0xb2, 0x12, 0xc6, 0x05,
+    0x63, 0xe4, 0xc0, 0x28, 0x29, 0x9a, 0x1d, 0x1d, 0xb5, 0x24, 0x3b, 0x21, 0xdf, 0x2a, 0x64, 0x08,
+    0xe9, 0xba, 0xae, 0xbb, 0xd5, 0x24, 0x00, 0x00, 0x40, 0x01, 0x90, 0x48, 0x62, 0x6b, 0x25, 0x6d,
+    0x0a, 0x83, 0x09, 0x0c, 0x00, 0x30, 0x34, 0x0c, 0x14, 0x7d, 0x09, 0x00, 0x04, 0xc0, 0x45, 0x8b,
+    0x8d, 0x11, 0x10, 0x0b, 0x8a, 0x0a, 0x0a, 0x81, 0x04, 0x08, 0x41, 0x08, 0x03, 0x52, 0x01, 0x00,
+    0x10, 0x03, 0x40, 0x04, 0x01, 0x00, 0x00, 0x20, 0x01, 0x92, 0x08, 0x30, 0x06, 0x67, 0x14, 0x84,
+    0x94, 0x24, 0x00, 0x00, 0x00, 0x44, 0x0a, 0xf4, 0x84, 0x58, 0x2c, 0x14, 0x87, 0x64, 0x00, 0x00,
+    0x6f, 0x10, 0x82, 0x29, 0x10, 0x08, 0x12, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x04,
+    0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x3e, 0x06, 0x00, 0x00, 0x03, 0x24, 0x72, 0x65, 0x70,
+    0x6c, 0x44, 0x61, 0x74, 0x61, 0x00, 0xff, 0x00, 0x00, 0x00, 0x12, 0x74, 0x65, 0x72, 0x6d, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6c, 0x61, 0x73, 0x74, 0x4f, 0x70, 0x43,
+    0x6f, 0x6d, 0x6d, 0x69, 0x74, 0x74, 0x65, 0x64, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x11, 0x74, 0x73,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x12, 0x74, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x6c, 0x61, 0x73, 0x74, 0x43, 0x6f, 0x6d, 0x6d, 0x69, 0x74,
+    0x74, 0x65, 0x64, 0x57, 0x61, 0x6c, 0x6c, 0x00, 0x00, 0x80, 0x6e, 0x87, 0x74, 0x01, 0x00, 0x00,
+    0x03, 0x6c, 0x61, 0x73, 0x74, 0x4f, 0x70, 0x56, 0x69, 0x73, 0x69, 0x62, 0x6c, 0x65, 0x00, 0x1c,
+    0x00, 0x00, 0x00, 0x11, 0x74, 0x73, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x12,
+    0x74, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x63, 0x6f, 0x6e, 0x66,
+    0x69, 0x67, 0x56, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x63,
+    0x6f, 0x6e, 0x66, 0x69, 0x67, 0x54, 0x65, 0x72, 0x6d, 0x00, 0x01, 0x00, 0x00, 0x00, 0x07, 0x72,
+    0x65, 0x70, 0x6c, 0x69, 0x63, 0x61, 0x53, 0x65, 0x74, 0x49, 0x64, 0x00, 0x5f, 0x5e, 0x10, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x73, 0x79, 0x6e, 0x63, 0x53, 0x6f, 0x75,
+    0x72, 0x63, 0x65, 0x49, 0x6e, 0x64, 0x65, 0x78, 0x00, 0xff, 0xff, 0xff, 0xff, 0x02, 0x73, 0x79,
+    0x6e, 0x63, 0x53, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x48, 0x6f, 0x73, 0x74, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x10, 0x70, 0x72, 0x69, 0x6d, 0x61, 0x72, 0x79, 0x49, 0x6e, 0x64, 0x65, 0x78, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x24, 0x6f, 0x70, 0x6c, 0x6f, 0x67, 0x51, 0x75, 0x65, 0x72,
+    0x79, 0x44, 0x61, 0x74, 0x61, 0x00, 0xff, 0x00, 0x00, 0x00, 0x12, 0x74, 0x65, 0x72, 0x6d, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6c, 0x61, 0x73, 0x74, 0x4f, 0x70, 0x43,
+    0x6f, 0x6d, 0x6d, 0x69, 0x74, 0x74, 0x65, 0x64, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x11, 0x74, 0x73,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x12, 0x74, 0x00, 0x01, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x6c, 0x61, 0x73, 0x74, 0x43, 0x6f, 0x6d, 0x6d, 0x69, 0x74,
+    0x74, 0x65, 0x64, 0x57, 0x61, 0x6c, 0x6c, 0x00, 0x00, 0x80, 0x6e, 0x87, 0x74, 0x01, 0x00, 0x00,
+    0x03, 0x6c, 0x61, 0x73, 0x74, 0x4f, 0x70, 0x56, 0x69, 0x73, 0x69, 0x62, 0x6c, 0x65, 0x00, 0x1c,
+    0x00, 0x00, 0x00, 0x11, 0x74, 0x73, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x12,
+    0x74, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x63, 0x6f, 0x6e, 0x66,
+    0x69, 0x67, 0x56, 0x65, 0x72, 0x73, 0x69, 0x6f, 0x6e, 0x00, 0x01, 0x00, 0x00, 0x00, 0x10, 0x63,
+    0x6f, 0x6e, 0x66, 0x69, 0x67, 0x54, 0x65, 0x72, 0x6d, 0x00, 0x01, 0x00, 0x00, 0x00, 0x07, 0x72,
+    0x65, 0x70, 0x6c, 0x69, 0x63, 0x61, 0x53, 0x65, 0x74, 0x49, 0x64, 0x00, 0x5f, 0x5e, 0x10, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x10, 0x73, 0x79, 0x6e, 0x63, 0x53, 0x6f, 0x75,
+    0x72, 0x63, 0x65, 0x49, 0x6e, 0x64, 0x65, 0x78, 0x00, 0xff, 0xff, 0xff, 0xff, 0x02, 0x73, 0x79,
+    0x6e, 0x63, 0x53, 0x6f, 0x75, 0x72, 0x63, 0x65, 0x48, 0x6f, 0x73, 0x74, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x10, 0x70, 0x72, 0x69, 0x6d, 0x61, 0x72, 0x79, 0x49, 0x6e, 0x64, 0x65, 0x78, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x6f, 0x6b, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xf0,
+    0x3f, 0x03, 0x24, 0x63, 0x6c, 0x75, 0x73, 0x74, 0x65, 0x72, 0x54, 0x69, 0x6d, 0x65, 0x00, 0x58,
+    0x00, 0x00, 0x00, 0x11, 0x63, 0x6c, 0x75, 0x73, 0x74, 0x65, 0x72, 0x54, 0x69, 0x6d, 0x65, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x03, 0x73, 0x69, 0x67, 0x6e, 0x61, 0x74, 0x75,
+    0x72, 0x65, 0x00, 0x33, 0x00, 0x00, 0x00, 0x05, 0x68, 0x61, 0x73, 0x68, 0x00, 0x14, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x6b, 0x65, 0x79, 0x49, 0x64, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x6f, 0x70, 0x65, 0x72, 0x61, 0x74, 0x69, 0x6f,
+    0x6e, 0x54, 0x69, 0x6d, 0x65, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x03, 0x63,
+    0x75, 0x72, 0x73, 0x6f, 0x72, 0x00, 0x8e, 0x03, 0x00, 0x00, 0x12, 0x69, 0x64, 0x00, 0x01, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x6e, 0x73, 0x00, 0x0f, 0x00, 0x00, 0x00, 0x6c, 0x6f,
+    0x63, 0x61, 0x6c, 0x2e, 0x6f, 0x70, 0x6c, 0x6f, 0x67, 0x2e, 0x72, 0x73, 0x00, 0x04, 0x6e, 0x65,
+    0x78, 0x74, 0x42, 0x61, 0x74, 0x63, 0x68, 0x00, 0x5b, 0x03, 0x00, 0x00, 0x03, 0x30, 0x00, 0x67,
+    0x00, 0x00, 0x00, 0x02, 0x6f, 0x70, 0x00, 0x02, 0x00, 0x00, 0x00, 0x6e, 0x00, 0x02, 0x6e, 0x73,
+    0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6f, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x02, 0x6d, 0x73,
+    0x67, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x70, 0x65, 0x72, 0x69, 0x6f, 0x64, 0x69, 0x63, 0x20, 0x6e,
+    0x6f, 0x6f, 0x70, 0x00, 0x00, 0x11, 0x74, 0x73, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e,
+    0x5f, 0x12, 0x74, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x76, 0x00, 0x02,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x77, 0x61, 0x6c, 0x6c, 0x00, 0x00, 0x80, 0x6e,
+    0x87, 0x74, 0x01, 0x00, 0x00, 0x00, 0x03, 0x31, 0x00, 0x1c, 0x01, 0x00, 0x00, 0x02, 0x6f, 0x70,
+    0x00, 0x02, 0x00, 0x00, 0x00, 0x69, 0x00, 0x02, 0x6e, 0x73, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x64,
+    0x62, 0x2e, 0x63, 0x6f, 0x6c, 0x6c, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x00, 0x05, 0x75, 0x69,
+    0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6f, 0x00, 0x16, 0x00, 0x00, 0x00, 0x07, 0x5f, 0x69,
+    0x64, 0x00, 0x5f, 0x5e, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11,
+    0x74, 0x73, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x12, 0x74, 0x00, 0x01, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x76, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x09, 0x77, 0x61, 0x6c, 0x6c, 0x00, 0x00, 0x80, 0x6e, 0x87, 0x74, 0x01, 0x00, 0x00, 0x03,
+    0x6c, 0x73, 0x69, 0x64, 0x00, 0x48, 0x00, 0x00, 0x00, 0x05, 0x69, 0x64, 0x00, 0x10, 0x00, 0x00,
+    0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x05, 0x75, 0x69, 0x64, 0x00, 0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x74, 0x78,
+    0x6e, 0x4e, 0x75, 0x6d, 0x62, 0x65, 0x72, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x73, 0x74, 0x6d, 0x74, 0x49, 0x64, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x70, 0x72, 0x65,
+    0x76, 0x4f, 0x70, 0x54, 0x69, 0x6d, 0x65, 0x00, 0x1c, 0x00, 0x00, 0x00, 0x11, 0x74, 0x73, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x12, 0x74, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x32, 0x00, 0x87, 0x00, 0x00, 0x00, 0x02, 0x6f, 0x70, 0x00,
+    0x02, 0x00, 0x00, 0x00, 0x64, 0x00, 0x02, 0x6e, 0x73, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x64, 0x62,
+    0x2e, 0x63, 0x6f, 0x6c, 0x6c, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x00, 0x05, 0x75, 0x69, 0x00,
+    0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6f, 0x00, 0x16, 0x00, 0x00, 0x00, 0x07, 0x5f, 0x69, 0x64,
+    0x00, 0x5f, 0x5e, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x74,
+    0x73, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x12, 0x74, 0x00, 0x01, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x76, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x09, 0x77, 0x61, 0x6c, 0x6c, 0x00, 0x00, 0x80, 0x6e, 0x87, 0x74, 0x01, 0x00, 0x00, 0x00, 0x03,
+    0x33, 0x00, 0xb6, 0x00, 0x00, 0x00, 0x02, 0x6f, 0x70, 0x00, 0x02, 0x00, 0x00, 0x00, 0x75, 0x00,
+    0x02, 0x6e, 0x73, 0x00, 0x0e, 0x00, 0x00, 0x00, 0x64, 0x62, 0x2e, 0x63, 0x6f, 0x6c, 0x6c, 0x65,
+    0x63, 0x74, 0x69, 0x6f, 0x6e, 0x00, 0x05, 0x75, 0x69, 0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03,
+    0x6f, 0x00, 0x2b, 0x00, 0x00, 0x00, 0x10, 0x24, 0x76, 0x00, 0x02, 0x00, 0x00, 0x00, 0x03, 0x64,
+    0x69, 0x66, 0x66, 0x00, 0x18, 0x00, 0x00, 0x00, 0x03, 0x75, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10,
+    0x66, 0x69, 0x65, 0x6c, 0x64, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6f, 0x32,
+    0x00, 0x16, 0x00, 0x00, 0x00, 0x07, 0x5f, 0x69, 0x64, 0x00, 0x5f, 0x5e, 0x10, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x11, 0x74, 0x73, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00,
+    0x10, 0x5e, 0x5f, 0x12, 0x74, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x76,
+    0x00, 0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x09, 0x77, 0x61, 0x6c, 0x6c, 0x00, 0x00,
+    0x80, 0x6e, 0x87, 0x74, 0x01, 0x00, 0x00, 0x00, 0x03, 0x34, 0x00, 0x87, 0x00, 0x00, 0x00, 0x02,
+    0x6f, 0x70, 0x00, 0x02, 0x00, 0x00, 0x00, 0x69, 0x00, 0x02, 0x6e, 0x73, 0x00, 0x0e, 0x00, 0x00,
+    0x00, 0x64, 0x62, 0x2e, 0x63, 0x6f, 0x6c, 0x6c, 0x65, 0x63, 0x74, 0x69, 0x6f, 0x6e, 0x00, 0x05,
+    0x75, 0x69, 0x00, 0x10, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03, 0x6f, 0x00, 0x16, 0x00, 0x00, 0x00, 0x07,
+    0x5f, 0x69, 0x64, 0x00, 0x5f, 0x5e, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x11, 0x74, 0x73, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x10, 0x5e, 0x5f, 0x12, 0x74, 0x00,
+    0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x12, 0x76, 0x00, 0x02, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x09, 0x77, 0x61, 0x6c, 0x6c, 0x00, 0x00, 0x80, 0x6e, 0x87, 0x74, 0x01, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+/**
+ * Messages up to this size are compressed with the dictionary. Larger ones repeat their field names
+ * often enough to compress as well without it, and better with parameters chosen for their size.
+ */
+constexpr size_t kMaxDictionaryInputSize = 16 * 1024;
+
+/**
+ * The dictionary digested for compression and decompression, shared by every connection.
+ */
+struct Dictionaries {
+    Dictionaries()
+        : compression(ZSTD_createCDict(
+                          kOplogDictionaryV1, sizeof(kOplogDictionaryV1), ZSTD_CLEVEL_DEFAULT),
+                      ZSTD_freeCDict),
+          decompression(ZSTD_createDDict(kOplogDictionaryV1, sizeof(kOplogDictionaryV1)),
+                        ZSTD_freeDDict) {
+        invariant(compression && decompression);
+        invariant(ZSTD_getDictID_fromDDict(decompression.get()) == kOplogDictionaryV1Id);
+    }
+
+    std::unique_ptr<ZSTD_CDict, size_t (*)(ZSTD_CDict*)> compression;
+    std::unique_ptr<ZSTD_DDict, size_t (*)(ZSTD_DDict*)> decompression;
+};
+
+const Dictionaries& getDictionaries() {
+    static const Dictionaries dictionaries;
+    return dictionaries;
+}
+
+ZSTD_CCtx* getThreadCompressionContext() {
+    thread_local std::unique_ptr<ZSTD_CCtx, size_t (*)(ZSTD_CCtx*)> context{ZSTD_createCCtx(),
+                                                                            ZSTD_freeCCtx};
+    return context.get();
+}
+
+ZSTD_DCtx* getThreadDecompressionContext() {
+    thread_local std::unique_ptr<ZSTD_DCtx, size_t (*)(ZSTD_DCtx*)> context{ZSTD_createDCtx(),
+                                                                            ZSTD_freeDCtx};
+    return context.get();
+}
+
+}  // namespace
+
+ZstdOplogDictionaryMessageCompressor::ZstdOplogDictionaryMessageCompressor()
+    : MessageCompressorBase(MessageCompressor::kZstd, "zstd-oplog-v1"_sd) {}
+
+std::size_t ZstdOplogDictionaryMessageCompressor::decompressFrame(ConstDataRange input,
+                                                                  DataRange output) {
+    if (ZSTD_getDictID_fromFrame(input.data(), input.length()) == kOplogDictionaryV1Id) {
+        return ZSTD_decompress_usingDDict(getThreadDecompressionContext(),
+                                          const_cast<char*>(output.data()),
+                                          output.length(),
+                                          input.data(),
+                                          input.length(),
+                                          getDictionaries().decompression.get());
+    }
+    return ZSTD_decompress(
+        const_cast<char*>(output.data()), output.length(), input.data(), input.length());
+}
+
+std::size_t ZstdOplogDictionaryMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    return ZSTD_compressBound(inputSize);
+}
+
+StatusWith<std::size_t> ZstdOplogDictionaryMessageCompressor::compressData(ConstDataRange input,
+                                                                           DataRange output) {
+    size_t ret = input.length() <= kMaxDictionaryInputSize
+        ? ZSTD_compress_usingCDict(getThreadCompressionContext(),
+                                   const_cast<char*>(output.data()),
+                                   output.length(),
+                                   input.data(),
+                                   input.length(),
+                                   getDictionaries().compression.get())
+        : ZSTD_compressCCtx(getThreadCompressionContext(),
+                            const_cast<char*>(output.data()),
+                            output.length(),
+                            input.data(),
+                            input.length(),
+                            ZSTD_CLEVEL_DEFAULT);
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not compress input: " << ZSTD_getErrorName(ret)};
+    }
+    counterHitCompress(input.length(), ret);
+    return {ret};
+}
+
+StatusWith<std::size_t> ZstdOplogDictionaryMessageCompressor::decompressData(ConstDataRange input,
+                                                                             DataRange output) {
+    size_t ret = decompressFrame(input, output);
+
+    if (ZSTD_isError(ret)) {
+        return Status{ErrorCodes::BadValue,
+                      str::stream() << "Could not decompress message: " << ZSTD_getErrorName(ret)};
+    }
+
+    counterHitDecompress(input.length(), ret);
+    return {ret};
+}
+
+
+MONGO_INITIALIZER_GENERAL(ZstdOplogDictionaryMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(
+        std::make_unique<ZstdOplogDictionaryMessageCompressor>());
+}
+}  // namespace mongo
@@ -0,0 +1,69 @@
+/**
+ *    Copyright (C) 2021-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include "mongo/base/data_range.h"
+#include "mongo/transport/message_compressor_base.h"
+
+namespace mongo {
+
+/**
+ * A zstd compressor whose compression is primed with a fixed dictionary of representative
+ * replication traffic: oplog entries and the getMore reply envelope that carries them. Field names
+ * and value types that every small oplog batch repeats then compress into back references to the
+ * dictionary, rather than being spelled out again in every message.
+ *
+ * The compressor is negotiated during the hello handshake under its own name, "zstd-oplog-v1",
+ * which also versions the dictionary: both peers must hold byte-for-byte the same dictionary, and
+ * any change to its contents must ship under a new name and dictionary id. It does not claim a
+ * compressor id of its own, as those are shared with the drivers. Its messages are standard zstd
+ * frames sent under the zstd id, and carry the id of the dictionary they were compressed with, so
+ * that either zstd compressor can decompress them. Messages larger than 16KB are compressed without
+ * the dictionary, which no longer helps at that size.
+ */
+class ZstdOplogDictionaryMessageCompressor final : public MessageCompressorBase {
+public:
+    ZstdOplogDictionaryMessageCompressor();
+
+    std::size_t getMaxCompressedSize(size_t inputSize) override;
+
+    StatusWith<std::size_t> compressData(ConstDataRange input, DataRange output) override;
+
+    StatusWith<std::size_t> decompressData(ConstDataRange input, DataRange output) override;
+
+    /**
+     * Decompresses the zstd frame in 'input' into 'output', with the built-in dictionary when the
+     * frame was compressed with it. Returns the result of the zstd decompression call.
+     */
+    static std::size_t decompressFrame(ConstDataRange input, DataRange output);
+};
+
+}  // namespace mongo
@@ -94,10 +94,7 @@ public:
 
         ON_BLOCK_EXIT([&] {
             _recursionDepth--;
-            _executor->_stats.tasksEnded.fetchAndAdd(1);
-
-            auto lk = stdx::lock_guard(_executor->_mutex);
-            _executor->_checkForShutdown(lk);
+            _executor->_onTaskEnded();
         });
 
         std::forward<Task>(task)();
@@ -154,7 +151,7 @@ void ServiceExecutorFixed::join() noexcept {
         auto lk = stdx::unique_lock(_mutex);
         _beginShutdown(lk);
 
-        _shutdownCondition.wait(lk, [this]() { return _state == State::kStopped; });
+        _shutdownCondition.wait(lk, [this]() { return _state.load() == State::kStopped; });
         if (std::exchange(_isJoined, true)) {
             return;
         }
@@ -174,10 +171,10 @@ void ServiceExecutorFixed::join() noexcept {
 Status ServiceExecutorFixed::start() {
     {
         stdx::lock_guard<Latch> lk(_mutex);
-        switch (_state) {
+        switch (_state.load()) {
             case State::kNotStarted: {
                 // Time to start
-                _state = State::kRunning;
+                _state.store(State::kRunning);
             } break;
             case State::kRunning: {
                 return Status::OK();
@@ -219,7 +216,7 @@ Status ServiceExecutorFixed::start() {
             // race that immediately follows this check. ASIOReactor::stop() is not permanent, thus
             // our run() could "restart" the reactor.
             stdx::lock_guard<Latch> lk(_mutex);
-            if (_state != kRunning) {
+            if (_state.load() != kRunning) {
                 return;
             }
         }
@@ -249,8 +246,9 @@ Status ServiceExecutorFixed::shutdown(Milliseconds timeout) {
 
         // There is a world where we are able to simply do a timed wait upon a future chain.
         // However, that world likely requires an OperationContext available through shutdown.
-        if (!_shutdownCondition.wait_for(
-                lk, timeout.toSystemDuration(), [this] { return _state == State::kStopped; })) {
+        if (!_shutdownCondition.wait_for(lk, timeout.toSystemDuration(), [this] {
+                return _state.load() == State::kStopped;
+            })) {
             return Status(ErrorCodes::ExceededTimeLimit,
                           "Failed to shutdown all executor threads within the time limit");
         }
@@ -265,14 +263,17 @@ Status ServiceExecutorFixed::shutdown(Milliseconds timeout) {
 }
 
 void ServiceExecutorFixed::_beginShutdown(WithLock lk) {
-    switch (_state) {
+    switch (_state.load()) {
         case State::kNotStarted: {
             invariant(_waiters.empty());
             invariant(_tasksLeft() == 0);
-            _state = State::kStopped;
+            _state.store(State::kStopped);
         } break;
         case State::kRunning: {
-            _state = State::kStopping;
+            // Publishing the new state before `_checkForShutdown()` counts the tasks left pairs
+            // with `_admitTask()` and `_onTaskEnded()`, which update the counts before reading the
+            // state: either they observe the shutdown, or the shutdown observes their counts.
+            _state.store(State::kStopping);
 
             for (auto& waiter : _waiters) {
                 // Cancel any session we own.
@@ -293,7 +294,7 @@ void ServiceExecutorFixed::_beginShutdown(WithLock lk) {
 }
 
 void ServiceExecutorFixed::_checkForShutdown(WithLock) {
-    if (_state == State::kRunning) {
+    if (_state.load() == State::kRunning) {
         // We're actively running.
         return;
     }
@@ -318,7 +319,7 @@ void ServiceExecutorFixed::_checkForShutdown(WithLock) {
     //
     // From this point on, all of our threads will be idle. When the dtor runs, the thread pool will
     // experience a trivial shutdown() and join().
-    _state = State::kStopped;
+    _state.store(State::kStopped);
 
     LOGV2_DEBUG(
         4910505, kDiagnosticLogLevel, "Finishing shutdown", "name"_attr = _options.poolName);
@@ -342,14 +343,34 @@ void ServiceExecutorFixed::_checkForShutdown(WithLock) {
     reactor->stop();
 }
 
-Status ServiceExecutorFixed::scheduleTask(Task task, ScheduleFlags flags) try {
-    {
-        auto lk = stdx::unique_lock(_mutex);
-        if (_state != State::kRunning) {
-            return kInShutdown;
-        }
+bool ServiceExecutorFixed::_admitTask() {
+    _stats.tasksScheduled.fetchAndAdd(1);
+    if (MONGO_likely(_state.load() == State::kRunning)) {
+        return true;
+    }
+
+    _stats.tasksRejected.fetchAndAdd(1);
+    auto lk = stdx::lock_guard(_mutex);
+    if (_state.load() == State::kStopping) {
+        // Shutdown may have counted this task as left before it was refused here.
+        _checkForShutdown(lk);
+    }
+    return false;
+}
+
+void ServiceExecutorFixed::_onTaskEnded() {
+    _stats.tasksEnded.fetchAndAdd(1);
+    if (MONGO_likely(_state.load() == State::kRunning)) {
+        return;
+    }
+
+    auto lk = stdx::lock_guard(_mutex);
+    _checkForShutdown(lk);
+}
 
-        _stats.tasksScheduled.fetchAndAdd(1);
+Status ServiceExecutorFixed::scheduleTask(Task task, ScheduleFlags flags) try {
+    if (!_admitTask()) {
+        return kInShutdown;
     }
 
     auto mayExecuteTaskInline = [&] {
@@ -385,16 +406,9 @@ Status ServiceExecutorFixed::scheduleTask(Task task, ScheduleFlags flags) try {
 }
 
 void ServiceExecutorFixed::_schedule(OutOfLineExecutor::Task task) noexcept {
-    {
-        auto lk = stdx::unique_lock(_mutex);
-        if (_state != State::kRunning) {
-            lk.unlock();
-
-            task(kInShutdown);
-            return;
-        }
-
-        _stats.tasksScheduled.fetchAndAdd(1);
+    if (!_admitTask()) {
+        task(kInShutdown);
+        return;
     }
 
     _threadPool->schedule([this, task = std::move(task)](Status status) mutable {
@@ -418,7 +432,7 @@ void ServiceExecutorFixed::runOnDataAvailable(const SessionHandle& session,
     {
         // Make sure we're still allowed to schedule and track the session
         auto lk = stdx::unique_lock(_mutex);
-        if (_state != State::kRunning) {
+        if (_state.load() != State::kRunning) {
             lk.unlock();
             waiter.onCompletionCallback(kInShutdown);
             return;
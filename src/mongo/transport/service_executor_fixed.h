@@ -102,6 +102,17 @@ private:
     void _beginShutdown(WithLock);
     void _schedule(OutOfLineExecutor::Task task) noexcept;
 
+    /**
+     * Counts a new task as scheduled without taking `_mutex`. Returns false, counting the task as
+     * rejected as well, if the executor is not running.
+     */
+    bool _admitTask();
+
+    /**
+     * Called as each task ends. Only takes `_mutex` to check for shutdown once shutdown has begun.
+     */
+    void _onTaskEnded();
+
     auto _threadsRunning() const {
         auto ended = _stats.threadsEnded.load();
         auto started = _stats.threadsStarted.loadRelaxed();
@@ -115,9 +126,14 @@ private:
     }
 
     auto _tasksLeft() const {
+        // A task is counted as scheduled before it is counted as rejected or ended, so reading the
+        // scheduled count last never leaves fewer tasks than have been rejected or ended. These
+        // loads must be sequentially consistent to pair with the state checks in `_admitTask()` and
+        // `_onTaskEnded()`.
         auto ended = _stats.tasksEnded.load();
-        auto scheduled = _stats.tasksScheduled.loadRelaxed();
-        return scheduled - ended;
+        auto rejected = _stats.tasksRejected.load();
+        auto scheduled = _stats.tasksScheduled.load();
+        return scheduled - rejected - ended;
     }
 
     auto _tasksWaiting() const {
@@ -135,6 +151,7 @@ private:
         AtomicWord<size_t> threadsEnded{0};
 
         AtomicWord<size_t> tasksScheduled{0};
+        AtomicWord<size_t> tasksRejected{0};
         AtomicWord<size_t> tasksStarted{0};
         AtomicWord<size_t> tasksEnded{0};
 
@@ -152,8 +169,13 @@ private:
 
     /**
      * State transition diagram: kNotStarted ---> kRunning ---> kStopping ---> kStopped
+     *
+     * Transitions happen under `_mutex`, but the state is read without it when scheduling and
+     * ending tasks, so that the per-task path does not serialize every executor thread on
+     * `_mutex`.
      */
-    enum State { kNotStarted, kRunning, kStopping, kStopped } _state = kNotStarted;
+    enum State { kNotStarted, kRunning, kStopping, kStopped };
+    AtomicWord<State> _state{kNotStarted};
     bool _isJoined = false;
 
     ThreadPool::Options _options;
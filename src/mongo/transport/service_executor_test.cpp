@@ -357,6 +357,35 @@ TEST_F(ServiceExecutorFixedFixture, ScheduleFailsAfterShutdown) {
         executorHandle->scheduleTask([] { MONGO_UNREACHABLE; }, ServiceExecutor::kEmptyFlags));
 }
 
+TEST_F(ServiceExecutorFixedFixture, ShutdownRacingSchedulersRunsEveryAcceptedTask) {
+    auto executorHandle = ServiceExecutorHandle();
+    executorHandle.start();
+
+    constexpr auto kNumSchedulers = 4;
+    AtomicWord<int> accepted{0};
+    AtomicWord<int> ran{0};
+
+    // Each scheduler keeps scheduling until the executor refuses a task.
+    std::vector<stdx::thread> schedulers;
+    for (int i = 0; i < kNumSchedulers; ++i) {
+        schedulers.emplace_back([&, executor = *executorHandle] {
+            while (executor->scheduleTask([&] { ran.fetchAndAdd(1); }, ServiceExecutor::kEmptyFlags)
+                       .isOK()) {
+                accepted.fetchAndAdd(1);
+            }
+        });
+    }
+
+    sleepmillis(10);
+    ASSERT_OK(executorHandle->shutdown(kShutdownTime));
+    for (auto& thread : schedulers) {
+        thread.join();
+    }
+
+    // Shutdown only completes once every task the executor accepted has run.
+    ASSERT_EQ(ran.load(), accepted.load());
+}
+
 TEST_F(ServiceExecutorFixedFixture, RunTaskAfterWaitingForData) {
     auto tl = std::make_unique<TransportLayerMock>();
     auto session = tl->createSession();
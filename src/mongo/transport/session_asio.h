@@ -186,6 +186,9 @@ public:
 
     Status waitForData() noexcept override try {
         ensureSync();
+        if (_readAheadBegin != _readAheadEnd) {
+            return Status::OK();
+        }
         asio::error_code ec;
         getSocket().wait(asio::ip::tcp::socket::wait_read, ec);
         return errorCodeToStatus(ec);
@@ -195,6 +198,9 @@ public:
 
     Future<void> asyncWaitForData() noexcept override try {
         ensureAsync();
+        if (_readAheadBegin != _readAheadEnd) {
+            return Future<void>::makeReady();
+        }
         return getSocket().async_wait(asio::ip::tcp::socket::wait_read, UseFuture{});
     } catch (const DBException& ex) {
         return ex.toStatus();
@@ -252,6 +258,10 @@ public:
         if (!getSocket().is_open())
             return false;
 
+        // Data that was already read ahead from the socket would not be seen by the peek below.
+        if (_readAheadBegin != _readAheadEnd)
+            return true;
+
         auto swPollEvents = pollASIOSocket(getSocket(), POLLIN, Milliseconds{0});
         if (!swPollEvents.isOK()) {
             if (swPollEvents != ErrorCodes::NetworkTimeout) {
@@ -442,7 +452,7 @@ private:
 
         auto headerBuffer = SharedBuffer::allocate(kHeaderSize);
         auto ptr = headerBuffer.get();
-        return read(asio::buffer(ptr, kHeaderSize), baton)
+        return readMessageBytes(asio::buffer(ptr, kHeaderSize), baton)
             .then([headerBuffer = std::move(headerBuffer), this, baton]() mutable {
                 if (checkForHTTPRequest(asio::buffer(headerBuffer.get(), kHeaderSize))) {
                     return sendHTTPResponse(baton);
@@ -476,7 +486,7 @@ private:
                 memcpy(buffer.get(), headerBuffer.get(), kHeaderSize);
 
                 MsgData::View msgView(buffer.get());
-                return read(asio::buffer(msgView.data(), msgView.dataLen()), baton)
+                return readMessageBytes(asio::buffer(msgView.data(), msgView.dataLen()), baton)
                     .then([this, buffer = std::move(buffer), msgLen]() mutable {
                         if (_isIngressSession) {
                             networkCounter.hitPhysicalIn(msgLen);
@@ -486,6 +496,116 @@ private:
             });
     }
 
+    /**
+     * Returns true if message bytes may be received through the read-ahead buffer. The first bytes
+     * of an ingress session are inspected to detect a TLS handshake, and TLS records must go
+     * through the ssl stream, so only plain sockets past that point are read ahead.
+     */
+    bool canReadAhead() const {
+#ifdef MONGO_CONFIG_SSL
+        return _ranHandshake && !_sslSocket;
+#else
+        return true;
+#endif
+    }
+
+    /**
+     * Fills 'buffer' with the next bytes of the stream. Whenever the remainder is small, a single
+     * read_some() pulls everything that is already waiting on the socket into the read-ahead
+     * buffer, so that a small request costs one recv() for its header and body together, and
+     * pipelined requests are served without returning to the kernel.
+     */
+    Future<void> readMessageBytes(asio::mutable_buffer buffer, const BatonHandle& baton) {
+        if (!canReadAhead()) {
+            return read(buffer, baton);
+        }
+
+        const auto buffered = std::min(buffer.size(), _readAheadEnd - _readAheadBegin);
+        if (buffered) {
+            memcpy(buffer.data(), _readAheadBuffer.get() + _readAheadBegin, buffered);
+            _readAheadBegin += buffered;
+            buffer += buffered;
+        }
+
+        if (_readAheadBegin == _readAheadEnd) {
+            // Release drained buffers so that idle sessions do not pin them.
+            _readAheadBuffer.reset();
+            _readAheadBegin = _readAheadEnd = 0;
+        }
+
+        if (buffer.size() == 0) {
+            return Future<void>::makeReady();
+        }
+
+        if (buffer.size() >= kReadAheadBufferSize) {
+            // Large bodies are received in place, an extra copy would buy nothing.
+            return opportunisticRead(_socket, buffer, baton);
+        }
+
+        return fillReadAheadBuffer(baton).then(
+            [this, buffer, baton] { return readMessageBytes(buffer, baton); });
+    }
+
+    /**
+     * Appends whatever is available on the socket to the read-ahead buffer, waiting for at least
+     * one byte. Mirrors opportunisticRead() in how it falls back to the baton or to asio when the
+     * socket would block, except that it waits for the socket to become readable rather than
+     * handing the buffer to an asynchronous read. An async session waiting for its next request
+     * therefore does not hold a buffer; it is allocated again once there is something to read.
+     * A sync session keeps it for the blocking read, as that read already ties up its thread.
+     */
+    Future<void> fillReadAheadBuffer(const BatonHandle& baton) {
+        if (!_readAheadBuffer) {
+            _readAheadBuffer = std::make_unique<char[]>(kReadAheadBufferSize);
+        }
+        auto buffer = asio::buffer(_readAheadBuffer.get() + _readAheadEnd,
+                                   kReadAheadBufferSize - _readAheadEnd);
+
+        const bool shortRead =
+            MONGO_unlikely(transportLayerASIOshortOpportunisticReadWrite.shouldFail()) &&
+            _blockingMode == Async;
+
+        std::error_code ec;
+        size_t size;
+        do {
+            size = _socket.read_some(shortRead ? asio::buffer(buffer.data(), 1) : buffer, ec);
+        } while (ec == asio::error::interrupted);  // retry syscall EINTR
+
+        if (!ec) {
+            _readAheadEnd += size;
+            if (!shortRead) {
+                return Future<void>::makeReady();
+            }
+            ec = asio::error::would_block;
+        }
+
+        if (((ec == asio::error::would_block) || (ec == asio::error::try_again)) &&
+            (_blockingMode == Async)) {
+            if (_readAheadEnd == 0) {
+                _readAheadBuffer.reset();
+            }
+
+            if (auto networkingBaton = baton ? baton->networking() : nullptr;
+                networkingBaton && networkingBaton->canWait()) {
+                return networkingBaton->addSession(*this, NetworkingBaton::Type::In)
+                    .onError([](Status error) {
+                        if (ErrorCodes::isShutdownError(error)) {
+                            // See opportunisticRead().
+                            return Status::OK();
+                        }
+
+                        return error;
+                    })
+                    .then([this, baton] { return fillReadAheadBuffer(baton); });
+            }
+
+            return _socket.async_wait(asio::ip::tcp::socket::wait_read, UseFuture{})
+                .then([this, baton] { return fillReadAheadBuffer(baton); });
+        }
+
+        return futurize(ec);
+    }
+
     template <typename MutableBufferSequence>
     Future<void> read(const MutableBufferSequence& buffers, const BatonHandle& baton = nullptr) {
         // TODO SERVER-47229 Guard active ops for cancellation here.
@@ -852,6 +972,12 @@ private:
     std::shared_ptr<const SSLConnectionContext> _sslContext;
 #endif
 
+    // Bytes received past the end of the last message read. See readMessageBytes().
+    static constexpr size_t kReadAheadBufferSize = 16 * 1024;
+    std::unique_ptr<char[]> _readAheadBuffer;
+    size_t _readAheadBegin = 0;
+    size_t _readAheadEnd = 0;
+
     TransportLayerASIO* const _tl;
     bool _isIngressSession;
 };
@@ -32,12 +32,15 @@
 
 #include "mongo/transport/transport_layer_asio.h"
 
+#include <deque>
+
 #include "mongo/db/server_options.h"
 #include "mongo/logv2/log.h"
 #include "mongo/rpc/op_msg.h"
 #include "mongo/transport/service_entry_point.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/notification.h"
 #include "mongo/util/net/sock.h"
 
 #include "asio.hpp"
@@ -273,15 +276,24 @@ public:
     }
 
     void sendMessage() {
-        OpMsgBuilder builder;
-        builder.setBody(BSON("ping" << 1));
-        Message msg = builder.finish();
-        msg.header().setResponseToMsgId(0);
-        msg.header().setId(0);
-        OpMsg::appendChecksum(&msg);
+        sendMessages({BSON("ping" << 1)});
+    }
+
+    /* sends one message per body with a single write, so they arrive back to back */
+    void sendMessages(const std::vector<BSONObj>& bodies) {
+        std::string bytes;
+        for (const auto& body : bodies) {
+            OpMsgBuilder builder;
+            builder.setBody(body);
+            Message msg = builder.finish();
+            msg.header().setResponseToMsgId(0);
+            msg.header().setId(0);
+            OpMsg::appendChecksum(&msg);
+            bytes.append(msg.buf(), msg.size());
+        }
 
         std::error_code ec;
-        asio::write(_sock, asio::buffer(msg.buf(), msg.size()), ec);
+        asio::write(_sock, asio::buffer(bytes.data(), bytes.size()), ec);
         ASSERT_FALSE(ec);
     }
 
@@ -382,5 +394,87 @@ TEST(TransportLayerASIO, SwitchTimeoutModes) {
     tla->shutdown();
 }
 
+/* check that messages arriving back to back are each sourced intact */
+class PipelinedSEP : public TimeoutSEP {
+public:
+    explicit PipelinedSEP(std::vector<BSONObj> bodies, bool async = false)
+        : _bodies(std::move(bodies)), _received(_bodies.size()), _async(async) {}
+
+    void startSession(transport::SessionHandle session) override {
+        LOGV2(5843199, "Accepted connection", "remote"_attr = session->remote());
+        startWorkerThread([this, session = std::move(session)]() mutable {
+            for (size_t i = 0; i < _bodies.size(); ++i) {
+                auto swMsg = _async ? session->asyncSourceMessage().getNoThrow()
+                                    : session->sourceMessage();
+                ASSERT_OK(swMsg.getStatus());
+                ASSERT_BSONOBJ_EQ(OpMsg::parse(swMsg.getValue()).body, _bodies[i]);
+                _received[i].set();
+            }
+
+            session.reset();
+            notifyComplete();
+        });
+    }
+
+    /**
+     * Blocks until the session has sourced the 'i'th message.
+     */
+    void waitForMessage(size_t i) {
+        _received[i].get();
+    }
+
+private:
+    std::vector<BSONObj> _bodies;
+    std::deque<Notification<void>> _received;
+    bool _async;
+};
+
+TEST(TransportLayerASIO, SourcePipelinedMessages) {
+    std::vector<BSONObj> bodies;
+    for (int i = 0; i < 100; ++i) {
+        bodies.push_back(BSON("ping" << i));
+    }
+    // Bodies larger than the session's read-ahead buffer are read in place.
+    bodies.push_back(BSON("ping" << std::string(64 * 1024, 'x')));
+    bodies.push_back(BSON("ping"
+                          << "last"));
+
+    PipelinedSEP sep(bodies);
+    auto tla = makeAndStartTL(&sep);
+
+    TimeoutConnector connector(tla->listenerPort(), false);
+    connector.sendMessages(bodies);
+
+    ASSERT_TRUE(sep.waitForTimeout(Milliseconds{30000}));
+    tla->shutdown();
+}
+
+TEST(TransportLayerASIO, AsyncSourceMessagesAfterWaitingForData) {
+    std::vector<BSONObj> bodies;
+    for (int i = 0; i < 5; ++i) {
+        bodies.push_back(BSON("ping" << i));
+    }
+
+    PipelinedSEP sep(bodies, true /* async */);
+    auto tla = makeAndStartTL(&sep);
+
+    // Nothing else runs the ingress reactor in this test.
+    auto reactor = tla->getReactor(transport::TransportLayer::kIngress);
+    stdx::thread reactorThread([&] { reactor->run(); });
+
+    // Each message is only sent once the session has sourced the previous one, so the session
+    // has to wait for each message, with nothing in its read-ahead buffer.
+    TimeoutConnector connector(tla->listenerPort(), false);
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        connector.sendMessages({bodies[i]});
+        sep.waitForMessage(i);
+    }
+
+    ASSERT_TRUE(sep.waitForTimeout(Milliseconds{30000}));
+    reactor->stop();
+    reactorThread.join();
+    tla->shutdown();
+}
+
 }  // namespace
 }  // namespace mongo
@@ -48,6 +48,18 @@ using DoubleDouble = std::pair<double, double>;
  */
 class DoubleDoubleSummation {
 public:
+    /**
+     * Returns a summation that continues from the unevaluated sum of 'sum' and 'addend', as
+     * previously returned by getDoubleDouble().
+     */
+    static DoubleDoubleSummation create(double sum, double addend) {
+        DoubleDoubleSummation summation;
+        summation._sum = sum;
+        summation._addend = addend;
+        summation._special = sum;
+        return summation;
+    }
+
     /**
      * Adds x to the sum, keeping track of a compensation amount to be subtracted later.
      */